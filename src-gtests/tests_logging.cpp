@@ -0,0 +1,1924 @@
+// tests_logging.cpp — binary event logging
+// - MPSC ring buffer: concurrent producers, no lost or torn records, per-producer order kept
+// - Reserve/commit, peek/release: contiguous in-place records across wrap-around, batch peek of a full ring
+// - swclock_log_event() from many threads: events/s and lost-event counts, log file integrity
+// - Batched logger drain: write throughput and reader latency with event logging off vs. on
+// - Logger doorbell: idle wakeups, latency to disk, prompt stop
+// - Memory-mapped log segments: roll-over, total size limit, writer crash
+// - Compact v2 encoding: exact round trip, v1 vs v2 size and encode cost
+// - Sync points and sidecar index: every entry decodes, time/sequence seeks cover their range
+// - mmap segment reader: GB/s and events/s over 1..8 threads split at sync points
+// - Sampling policies: one in N, on change, token bucket; suppressed counters
+// - Flight recorder: last N events kept in order, dumps under load, SIGUSR2 trigger
+// - JSON-LD writer thread: queued entries kept in per-caller order, cost per call
+// - JSON-LD rotation: file swap vs. background rename/compress/prune latency, retention
+// - JSON-LD serializer: output identical to the printf formats, servo entries/s
+// - JSON-LD streaming compression: gzip frames, frame index seeks, truncated tail, write volume
+// - JSON-LD per-thread buffers: 1..32 logging threads, cost per call, per-caller order after the merge
+
+#include <gtest/gtest.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <set>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <zlib.h>
+
+#include "sw_clock.h"
+#include "sw_clock_seglog.h"
+#include "sw_clock_evcodec.h"
+#include "sw_clock_evindex.h"
+#include "sw_clock_evreader.h"
+#include "swclock_jsonld.h"
+
+// Producer threads in the stress benchmark go up to this count
+#ifndef BENCH_EVENTLOG_MAX_THREADS
+#define BENCH_EVENTLOG_MAX_THREADS 8
+#endif
+
+// Measurement window per thread count (ms)
+#ifndef BENCH_EVENTLOG_WINDOW_MS
+#define BENCH_EVENTLOG_WINDOW_MS 500
+#endif
+
+static inline long long mono_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts_to_ns(&ts);
+}
+
+// Record pushed by the ring buffer test; size varies with seq to exercise wrap-around
+struct RingRecord {
+  uint32_t producer;
+  uint32_t seq;
+  uint8_t  fill[48];
+};
+
+static size_t ring_record_size(uint32_t seq) {
+  return offsetof(RingRecord, fill) + (seq % sizeof(RingRecord::fill)) + 1;
+}
+
+TEST(EventLog, RingBufferMultiProducer) {
+  const unsigned kProducers = 4;
+  const uint32_t kPerProducer = 200000;
+
+  swclock_ringbuf_t* rb = (swclock_ringbuf_t*)malloc(sizeof(swclock_ringbuf_t));
+  ASSERT_NE(rb, nullptr);
+  swclock_ringbuf_init(rb);
+
+  std::vector<std::thread> producers;
+  for (unsigned p = 0; p < kProducers; p++) {
+    producers.emplace_back([rb, p]() {
+      RingRecord r;
+      r.producer = p;
+      for (uint32_t i = 0; i < kPerProducer; i++) {
+        r.seq = i;
+        memset(r.fill, (int)((p * 31 + i) & 0xFF), sizeof(r.fill));
+        // Retry on full so nothing is lost; the consumer below keeps up
+        while (!swclock_ringbuf_push(rb, &r, ring_record_size(i))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::vector<uint32_t> next(kProducers, 0);
+  uint64_t received = 0, torn = 0, out_of_order = 0;
+  const uint64_t expected = (uint64_t)kProducers * kPerProducer;
+  const long long give_up = mono_ns() + 30LL * 1000 * 1000 * 1000;
+
+  RingRecord r;
+  while (received < expected && mono_ns() < give_up) {
+    size_t n = 0;
+    if (!swclock_ringbuf_pop(rb, &r, sizeof(r), &n)) {
+      std::this_thread::yield();
+      continue;
+    }
+    received++;
+    if (r.producer >= kProducers || n != ring_record_size(r.seq)) {
+      torn++;
+      continue;
+    }
+    size_t fill_len = n - offsetof(RingRecord, fill);
+    for (size_t k = 0; k < fill_len; k++) {
+      if (r.fill[k] != (uint8_t)((r.producer * 31 + r.seq) & 0xFF)) {
+        torn++;
+        break;
+      }
+    }
+    // Each producer reserves its records in program order
+    if (r.seq != next[r.producer]) out_of_order++;
+    next[r.producer] = r.seq + 1;
+  }
+
+  for (auto& t : producers) t.join();
+
+  uint64_t written = 0, read = 0, overruns = 0;
+  swclock_ringbuf_stats(rb, &written, &read, &overruns);
+  printf("  %u producers: received=%llu/%llu torn=%llu out_of_order=%llu full_retries=%llu\n",
+         kProducers, (unsigned long long)received, (unsigned long long)expected,
+         (unsigned long long)torn, (unsigned long long)out_of_order,
+         (unsigned long long)overruns);
+
+  EXPECT_EQ(received, expected);
+  EXPECT_EQ(torn, 0u);
+  EXPECT_EQ(out_of_order, 0u);
+  EXPECT_EQ(written, expected);
+  EXPECT_EQ(read, expected);
+  EXPECT_TRUE(swclock_ringbuf_is_empty(rb));
+  free(rb);
+}
+
+// Reserve/commit and peek/release: records are contiguous and aligned across
+// wrap-around, and an uncommitted record holds back the ones behind it
+TEST(EventLog, RingBufferReserveCommitInPlace) {
+  swclock_ringbuf_t* rb = (swclock_ringbuf_t*)malloc(sizeof(swclock_ringbuf_t));
+  ASSERT_NE(rb, nullptr);
+  swclock_ringbuf_init(rb);
+
+  // Out-of-order commit: nothing is visible until the oldest record commits
+  uint8_t* a = (uint8_t*)swclock_ringbuf_reserve(rb, 10);
+  uint8_t* b = (uint8_t*)swclock_ringbuf_reserve(rb, 20);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  memset(a, 0xAA, 10);
+  memset(b, 0xBB, 20);
+  swclock_ringbuf_commit(rb, b);
+
+  const void* rec = nullptr;
+  size_t size = 0;
+  EXPECT_EQ(swclock_ringbuf_peek(rb, &rec, &size), 0u);
+  swclock_ringbuf_commit(rb, a);
+  size_t bytes = swclock_ringbuf_peek(rb, &rec, &size);
+  ASSERT_GT(bytes, 0u);
+  EXPECT_EQ(rec, (const void*)a);
+  EXPECT_EQ(size, 10u);
+  swclock_ringbuf_release(rb, bytes, 1);
+  bytes = swclock_ringbuf_peek(rb, &rec, &size);
+  EXPECT_EQ(rec, (const void*)b);
+  EXPECT_EQ(size, 20u);
+  swclock_ringbuf_release(rb, bytes, 1);
+  EXPECT_TRUE(swclock_ringbuf_is_empty(rb));
+
+  // Many laps with sizes that do not divide the buffer: every record is
+  // contiguous inside the buffer, 8-byte aligned and intact
+  const uint8_t* lo = rb->buffer;
+  const uint8_t* hi = rb->buffer + SWCLOCK_RINGBUF_SIZE;
+  uint64_t laps_bytes = 0, bad = 0;
+  uint32_t seq = 0;
+  while (laps_bytes < 5ull * SWCLOCK_RINGBUF_SIZE) {
+    size_t len = 100 + (seq * 7919) % 3000;
+    uint8_t* p = (uint8_t*)swclock_ringbuf_reserve(rb, len);
+    ASSERT_NE(p, nullptr);
+    if ((uintptr_t)p % SWCLOCK_RINGBUF_ALIGN != 0 || p < lo || p + len > hi) bad++;
+    memset(p, (int)(seq & 0xFF), len);
+    swclock_ringbuf_commit(rb, p);
+
+    bytes = swclock_ringbuf_peek(rb, &rec, &size);
+    ASSERT_GT(bytes, 0u);
+    const uint8_t* q = (const uint8_t*)rec;
+    if (q != p || size != len || q[0] != (uint8_t)seq || q[len - 1] != (uint8_t)seq) bad++;
+    swclock_ringbuf_release(rb, bytes, 1);
+    laps_bytes += len;
+    seq++;
+  }
+  EXPECT_EQ(bad, 0u);
+  EXPECT_TRUE(swclock_ringbuf_is_empty(rb));
+
+  uint64_t written = 0, read = 0;
+  swclock_ringbuf_stats(rb, &written, &read, nullptr);
+  EXPECT_EQ(written, (uint64_t)seq + 2);
+  EXPECT_EQ(read, written);
+  free(rb);
+}
+
+// A batch peek of an exactly full ring maps each record once and releases
+// exactly the ring's size
+TEST(EventLog, RingBufferPeekBatchFullRing) {
+  swclock_ringbuf_t* rb = (swclock_ringbuf_t*)malloc(sizeof(swclock_ringbuf_t));
+  ASSERT_NE(rb, nullptr);
+  swclock_ringbuf_init(rb);
+
+  // Header plus payload fills a quarter of the ring, so four records fill it
+  const size_t len = SWCLOCK_RINGBUF_SIZE / 4 - SWCLOCK_RINGBUF_ALIGN;
+  std::vector<uint8_t> rec(len);
+  for (int lap = 0; lap < 3; lap++) {
+    for (int i = 0; i < 4; i++) {
+      memset(rec.data(), lap * 4 + i + 1, len);
+      ASSERT_TRUE(swclock_ringbuf_push(rb, rec.data(), len));
+    }
+    EXPECT_EQ(swclock_ringbuf_available(rb), 0u);
+    EXPECT_FALSE(swclock_ringbuf_push(rb, rec.data(), 1));
+
+    struct iovec iov[16];
+    size_t iov_count = 0, records = 0;
+    size_t bytes = swclock_ringbuf_peek_batch(rb, iov, 16, &iov_count, &records);
+    EXPECT_EQ(bytes, (size_t)SWCLOCK_RINGBUF_SIZE);
+    EXPECT_EQ(records, 4u);
+    ASSERT_EQ(iov_count, 4u);
+    for (size_t i = 0; i < iov_count; i++) {
+      const uint8_t* q = (const uint8_t*)iov[i].iov_base;
+      EXPECT_EQ(iov[i].iov_len, len);
+      EXPECT_EQ(q[0], (uint8_t)(lap * 4 + i + 1));
+      EXPECT_EQ(q[len - 1], (uint8_t)(lap * 4 + i + 1));
+    }
+    swclock_ringbuf_release(rb, bytes, records);
+    EXPECT_TRUE(swclock_ringbuf_is_empty(rb));
+    EXPECT_EQ(swclock_ringbuf_used(rb), 0u);
+  }
+
+  uint64_t written = 0, read = 0;
+  swclock_ringbuf_stats(rb, &written, &read, nullptr);
+  EXPECT_EQ(written, 12u);
+  EXPECT_EQ(read, 12u);
+  free(rb);
+}
+
+// Decode the events in data[0, len), which must start at a sync point (the
+// end of the file header or an indexed offset), calling fn for each; returns
+// the number of well-formed events, or -1 if the data is corrupt. Stops at
+// the zero tail of a segment that was not closed.
+template <typename Fn>
+static long decode_events(const uint8_t* data, size_t len, uint16_t version, Fn fn) {
+  long events = 0;
+  size_t off = 0;
+  swclock_event_header_t eh;
+  uint8_t payload[SWCLOCK_EVCODEC_MAX_PAYLOAD];
+  swclock_evcodec_t dec;
+  swclock_evcodec_reset(&dec);
+
+  while (off < len) {
+    if (version >= SWCLOCK_EVCODEC_VERSION) {
+      size_t used;
+      int rc = swclock_evcodec_decode(&dec, data + off, len - off, &eh, payload, &used);
+      if (rc == 0) break;
+      if (rc < 0) return -1;
+      off += used;
+    } else {
+      if (len - off < sizeof(eh)) return -1;
+      memcpy(&eh, data + off, sizeof(eh));
+      if (eh.event_type == 0 && eh.timestamp_ns == 0) break;
+      off += sizeof(eh);
+      if (eh.payload_size > SWCLOCK_EVCODEC_MAX_PAYLOAD || len - off < eh.payload_size) return -1;
+      memcpy(payload, data + off, eh.payload_size);
+      off += eh.payload_size;
+    }
+    fn(eh, payload);
+    events++;
+  }
+  return events;
+}
+
+// Read a whole log segment and its format version; false if it is not one
+static bool read_event_segment(const char* path, std::vector<uint8_t>* data, uint16_t* version) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+
+  data->clear();
+  uint8_t chunk[65536];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data->insert(data->end(), chunk, chunk + n);
+  fclose(f);
+
+  swclock_event_log_header_t fh;
+  if (data->size() < sizeof(fh)) return false;
+  memcpy(&fh, data->data(), sizeof(fh));
+  *version = fh.version_major;
+  return fh.magic == SWCLOCK_EVENT_LOG_MAGIC;
+}
+
+// Visit each event of one log segment (format v1 or v2); returns the number
+// of well-formed events, or -1 if the file is unreadable or corrupt
+template <typename Fn>
+static long for_each_event(const char* path, Fn fn, uint16_t* version = nullptr) {
+  std::vector<uint8_t> data;
+  uint16_t v;
+  if (!read_event_segment(path, &data, &v)) return -1;
+  if (version) *version = v;
+  const size_t hdr = sizeof(swclock_event_log_header_t);
+  return decode_events(data.data() + hdr, data.size() - hdr, v, fn);
+}
+
+// Delete a log segment and its sidecar index
+static void unlink_event_segment(const char* name) {
+  char idx[300];
+  unlink(name);
+  swclock_evindex_path(name, idx, sizeof(idx));
+  unlink(idx);
+}
+
+// Parse one event log segment, collecting the sequence numbers
+static long parse_event_segment(const char* path, std::set<uint64_t>* seqs) {
+  return for_each_event(path, [seqs](const swclock_event_header_t& eh, const uint8_t*) {
+    seqs->insert(eh.sequence_num);
+  });
+}
+
+// Parse all segments of an event log (path, path.1, ...) and delete them
+static long parse_event_log(const char* path, std::set<uint64_t>* seqs) {
+  long total = 0;
+  for (uint32_t i = 0;; i++) {
+    char name[256];
+    swclock_seglog_segment_path(path, i, name, sizeof(name));
+    if (access(name, F_OK) != 0) break;
+    long n = parse_event_segment(name, seqs);
+    unlink_event_segment(name);
+    if (n < 0) return -1;
+    total += n;
+  }
+  return total;
+}
+
+// Build n marker events into buf as they appear on disk; returns the byte count
+static size_t make_marker_events(uint8_t* buf, uint64_t first_seq, int n) {
+  size_t off = 0;
+  for (int i = 0; i < n; i++) {
+    swclock_event_header_t h;
+    memset(&h, 0, sizeof(h));
+    h.sequence_num = first_seq + (uint64_t)i;
+    h.timestamp_ns = 1000 + h.sequence_num;
+    h.event_type   = SWCLOCK_EVENT_LOG_MARKER;
+    h.payload_size = sizeof(swclock_event_marker_payload_t);
+    memcpy(buf + off, &h, sizeof(h));
+    off += sizeof(h);
+    memset(buf + off, 0x5A, h.payload_size);
+    off += h.payload_size;
+  }
+  return off;
+}
+
+static const size_t kMarkerEventBytes =
+    sizeof(swclock_event_header_t) + sizeof(swclock_event_marker_payload_t);
+
+// Segments roll over at their size, never split a record, and the oldest
+// are deleted beyond the total size limit
+TEST(EventLog, SegmentRollOverAndSizeLimit) {
+  char path[128];
+  snprintf(path, sizeof(path), "/tmp/swclock_seglog_roll_%d.bin", (int)getpid());
+
+  swclock_event_log_header_t fh;
+  memset(&fh, 0, sizeof(fh));
+  fh.magic = SWCLOCK_EVENT_LOG_MAGIC;
+  fh.version_major = 1;
+
+  const uint64_t kSegment = 64 * 1024;
+  swclock_seglog_t* log = swclock_seglog_open(path, kSegment, 4 * kSegment, &fh, sizeof(fh));
+  ASSERT_NE(log, nullptr);
+
+  const int kEvents = 10000, kBatch = 100;
+  std::vector<uint8_t> buf(kBatch * kMarkerEventBytes);
+  for (int i = 0; i < kEvents; i += kBatch) {
+    make_marker_events(buf.data(), (uint64_t)i, kBatch);
+    struct iovec iov[kBatch];
+    for (int k = 0; k < kBatch; k++) {
+      iov[k].iov_base = buf.data() + k * kMarkerEventBytes;
+      iov[k].iov_len  = kMarkerEventBytes;
+    }
+    ASSERT_EQ(swclock_seglog_append(log, iov, kBatch), 0);
+  }
+
+  swclock_seglog_stats_t st;
+  swclock_seglog_get_stats(log, &st);
+  ASSERT_EQ(swclock_seglog_close(log), 0);
+
+  const uint64_t per_segment = (kSegment - sizeof(fh)) / kMarkerEventBytes;
+  printf("  %d events: %u segments, %u deleted, %llu bytes\n", kEvents, st.segments,
+         st.segments_deleted, (unsigned long long)st.bytes);
+  EXPECT_EQ(st.segments, (uint32_t)((kEvents + per_segment - 1) / per_segment));
+  EXPECT_EQ(st.segments - st.segments_deleted, 4u);
+  EXPECT_EQ(st.first_segment, st.segments - 4);
+  EXPECT_EQ(st.bytes, (uint64_t)kEvents * kMarkerEventBytes);
+
+  // Deleted segments are gone; the kept ones hold whole records, the last
+  // one truncated to its used length
+  char name[256];
+  for (uint32_t i = 0; i < st.first_segment; i++) {
+    swclock_seglog_segment_path(path, i, name, sizeof(name));
+    EXPECT_NE(access(name, F_OK), 0) << name;
+  }
+  swclock_seglog_segment_path(path, st.current_segment, name, sizeof(name));
+  struct stat sb;
+  ASSERT_EQ(stat(name, &sb), 0);
+  uint64_t last_events = kEvents - (uint64_t)st.current_segment * per_segment;
+  EXPECT_EQ((uint64_t)sb.st_size, sizeof(fh) + last_events * kMarkerEventBytes);
+
+  long kept = 0;
+  std::set<uint64_t> seqs;
+  for (uint32_t i = st.first_segment; i <= st.current_segment; i++) {
+    swclock_seglog_segment_path(path, i, name, sizeof(name));
+    long n = parse_event_segment(name, &seqs);
+    EXPECT_GT(n, 0) << name;
+    kept += n;
+    unlink(name);
+  }
+  EXPECT_EQ((uint64_t)kept, 3 * per_segment + last_events);
+  // The newest events survive
+  EXPECT_EQ(*seqs.rbegin(), (uint64_t)kEvents - 1);
+}
+
+// A writer that dies without closing leaves a pre-allocated segment whose
+// appended records are intact and whose unused tail reads as zeros
+TEST(EventLog, SegmentSurvivesWriterCrash) {
+  char path[128];
+  snprintf(path, sizeof(path), "/tmp/swclock_seglog_crash_%d.bin", (int)getpid());
+
+  const uint64_t kSegment = 1 << 20;
+  const int kEvents = 1000;
+
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    swclock_event_log_header_t fh;
+    memset(&fh, 0, sizeof(fh));
+    fh.magic = SWCLOCK_EVENT_LOG_MAGIC;
+    fh.version_major = 1;
+    swclock_seglog_t* log = swclock_seglog_open(path, kSegment, 0, &fh, sizeof(fh));
+    if (!log) _exit(1);
+    std::vector<uint8_t> buf(kMarkerEventBytes);
+    for (int i = 0; i < kEvents; i++) {
+      make_marker_events(buf.data(), (uint64_t)i, 1);
+      struct iovec iov = { buf.data(), kMarkerEventBytes };
+      if (swclock_seglog_append(log, &iov, 1) != 0) _exit(2);
+    }
+    _exit(0);  // No close: no truncate, no final msync
+  }
+
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+
+  struct stat sb;
+  ASSERT_EQ(stat(path, &sb), 0);
+  EXPECT_EQ((uint64_t)sb.st_size, kSegment);
+
+  std::set<uint64_t> seqs;
+  EXPECT_EQ(parse_event_segment(path, &seqs), kEvents);
+  EXPECT_EQ(seqs.size(), (size_t)kEvents);
+  unlink(path);
+}
+
+TEST(EventLog, MultiProducerStressBenchmark) {
+  setenv("SWCLOCK_DISABLE_JSONLD", "1", 1);
+
+  printf("\n  %7s | %14s | %12s | %10s | %10s\n",
+         "threads", "events/s", "logged", "dropped", "in file");
+
+  for (int nthreads = 1; nthreads <= BENCH_EVENTLOG_MAX_THREADS; nthreads *= 2) {
+    SwClock* c = swclock_create();
+    ASSERT_NE(c, nullptr);
+
+    char path[128];
+    snprintf(path, sizeof(path), "/tmp/swclock_eventlog_stress_%d_%d.bin", (int)getpid(), nthreads);
+    ASSERT_EQ(swclock_start_event_log(c, path), 0);
+
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> attempts(nthreads, 0);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < nthreads; t++) {
+      producers.emplace_back([c, t, &stop, &attempts]() {
+        swclock_event_marker_payload_t m;
+        memset(&m, 0, sizeof(m));
+        uint64_t n = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+          m.marker_id = (uint32_t)t;
+          swclock_log_event(c, SWCLOCK_EVENT_LOG_MARKER, &m, sizeof(m));
+          n++;
+        }
+        attempts[t] = n;
+      });
+    }
+
+    long long t0 = mono_ns();
+    usleep(BENCH_EVENTLOG_WINDOW_MS * 1000);
+    stop = true;
+    for (auto& th : producers) th.join();
+    long long elapsed = mono_ns() - t0;
+
+    swclock_stop_event_log(c);
+
+    swclock_event_log_stats_t st;
+    ASSERT_EQ(swclock_get_event_log_stats(c, &st), 0);
+    swclock_destroy(c);
+
+    uint64_t total_attempts = 0;
+    for (uint64_t a : attempts) total_attempts += a;
+
+    std::set<uint64_t> seqs;
+    long in_file = parse_event_log(path, &seqs);
+
+    printf("  %7d | %14.0f | %12llu | %10llu | %10ld\n",
+           nthreads, (double)st.logged * 1e9 / (double)elapsed,
+           (unsigned long long)st.logged, (unsigned long long)st.dropped, in_file);
+
+    // Start/stop markers and the poll thread's servo events come on top
+    EXPECT_GE(st.logged + st.dropped, total_attempts + 2);
+    EXPECT_EQ(st.written, st.logged);
+    EXPECT_EQ(in_file, (long)st.logged);
+    // No two records share a sequence number, i.e. none were merged or duplicated
+    EXPECT_EQ((long)seqs.size(), in_file);
+  }
+
+  unsetenv("SWCLOCK_DISABLE_JSONLD");
+}
+
+// Reader-side cost of event logging: one thread logs events flat out while the
+// test thread times swclock_gettime() (lock-free) and read-only swclock_adjtime()
+// (takes the clock lock) calls, with event logging off and on
+TEST(EventLog, DrainThroughputAndReaderLatency) {
+  setenv("SWCLOCK_DISABLE_JSONLD", "1", 1);
+
+  printf("\n  %-8s | %12s | %9s | %17s | %17s | %12s\n",
+         "logging", "written/s", "dropped", "gettime p99/max", "adjtime p99/max", "poll dur p99");
+  printf("  %-8s | %12s | %9s | %17s | %17s | %12s\n",
+         "", "", "", "(ns)", "(ns)", "(us)");
+
+  for (int on = 0; on <= 1; on++) {
+    SwClock* c = swclock_create();
+    ASSERT_NE(c, nullptr);
+
+    char path[128];
+    snprintf(path, sizeof(path), "/tmp/swclock_eventlog_drain_%d.bin", (int)getpid());
+    if (on) {
+      ASSERT_EQ(swclock_start_event_log(c, path), 0);
+    }
+
+    std::atomic<bool> stop{false};
+    std::thread producer([c, &stop]() {
+      swclock_event_marker_payload_t m;
+      memset(&m, 0, sizeof(m));
+      while (!stop.load(std::memory_order_relaxed)) {
+        swclock_log_event(c, SWCLOCK_EVENT_LOG_MARKER, &m, sizeof(m));
+      }
+    });
+
+    swclock_histogram_t get_lat, adj_lat;
+    memset(&get_lat, 0, sizeof(get_lat));
+    memset(&adj_lat, 0, sizeof(adj_lat));
+
+    long long t0 = mono_ns();
+    long long end = t0 + BENCH_EVENTLOG_WINDOW_MS * 1000000LL;
+    struct timespec ts;
+    struct timex tx;
+    for (unsigned i = 0; mono_ns() < end; i++) {
+      long long a = mono_ns();
+      swclock_gettime(c, CLOCK_REALTIME, &ts);
+      long long b = mono_ns();
+      swclock_histogram_record(&get_lat, b - a);
+
+      if ((i & 63) == 0) {
+        memset(&tx, 0, sizeof(tx));
+        a = mono_ns();
+        swclock_adjtime(c, &tx);
+        swclock_histogram_record(&adj_lat, mono_ns() - a);
+      }
+    }
+    stop = true;
+    producer.join();
+    long long elapsed = mono_ns() - t0;
+
+    if (on) swclock_stop_event_log(c);
+
+    swclock_event_log_stats_t st;
+    ASSERT_EQ(swclock_get_event_log_stats(c, &st), 0);
+    swclock_poll_stats_t ps;
+    ASSERT_EQ(swclock_get_poll_stats(c, &ps), 0);
+    swclock_destroy(c);
+
+    if (on) {
+      std::set<uint64_t> seqs;
+      EXPECT_EQ(parse_event_log(path, &seqs), (long)st.written);
+      EXPECT_EQ(st.written, st.logged);
+      EXPECT_GT(st.written, 0u);
+    }
+
+    printf("  %-8s | %12.0f | %9llu | %8llu/%8llu | %8llu/%8llu | %12.1f\n",
+           on ? "on" : "off", (double)st.written * 1e9 / (double)elapsed,
+           (unsigned long long)st.dropped,
+           (unsigned long long)swclock_histogram_quantile_ns(&get_lat, 0.99),
+           (unsigned long long)get_lat.max_ns,
+           (unsigned long long)swclock_histogram_quantile_ns(&adj_lat, 0.99),
+           (unsigned long long)adj_lat.max_ns,
+           swclock_histogram_quantile_ns(&ps.duration, 0.99) / 1000.0);
+  }
+
+  unsetenv("SWCLOCK_DISABLE_JSONLD");
+}
+
+// The logger thread sleeps on the ring's doorbell: an idle log costs one wakeup
+// per flush deadline, and events reach disk without waiting out a poll interval
+TEST(EventLog, DoorbellWakeupAndDiskLatency) {
+  setenv("SWCLOCK_DISABLE_JSONLD", "1", 1);
+
+  SwClock* c = swclock_create();
+  ASSERT_NE(c, nullptr);
+  // No PI step events from the poll thread; only the test logs
+  swclock_disable_pi_servo(c);
+
+  char path[128];
+  snprintf(path, sizeof(path), "/tmp/swclock_eventlog_doorbell_%d.bin", (int)getpid());
+  ASSERT_EQ(swclock_start_event_log(c, path), 0);
+  usleep(50 * 1000);
+
+  // Idle: only flush-deadline wakeups
+  swclock_event_log_stats_t st0, st1, st2;
+  ASSERT_EQ(swclock_get_event_log_stats(c, &st0), 0);
+  const int idle_ms = 1500;
+  usleep(idle_ms * 1000);
+  ASSERT_EQ(swclock_get_event_log_stats(c, &st1), 0);
+  uint64_t idle_wakeups = st1.wakeups - st0.wakeups;
+
+  // Sparse events: each one rings the doorbell
+  const int kEvents = 200;
+  swclock_event_marker_payload_t m;
+  memset(&m, 0, sizeof(m));
+  for (int i = 0; i < kEvents; i++) {
+    m.marker_id = (uint32_t)i;
+    swclock_log_event(c, SWCLOCK_EVENT_LOG_MARKER, &m, sizeof(m));
+    usleep(1000);
+  }
+  ASSERT_EQ(swclock_get_event_log_stats(c, &st2), 0);
+
+  // Stop wakes the logger instead of waiting out its deadline
+  long long t0 = mono_ns();
+  swclock_stop_event_log(c);
+  long long stop_ns = mono_ns() - t0;
+
+  swclock_destroy(c);
+  std::set<uint64_t> seqs;
+  parse_event_log(path, &seqs);
+  unsetenv("SWCLOCK_DISABLE_JSONLD");
+
+  const swclock_histogram_t* h = &st2.disk_latency;
+  printf("  idle: %llu wakeups in %d ms\n", (unsigned long long)idle_wakeups, idle_ms);
+  printf("  %d events 1 ms apart: %llu wakeups, latency to disk p50=%.1f us p99=%.1f us max=%.1f us\n",
+         kEvents, (unsigned long long)(st2.wakeups - st1.wakeups),
+         swclock_histogram_quantile_ns(h, 0.5) / 1000.0,
+         swclock_histogram_quantile_ns(h, 0.99) / 1000.0, h->max_ns / 1000.0);
+  printf("  stop: %.1f ms\n", stop_ns / 1e6);
+
+  // Default flush deadline is 1 s; a polling logger would wake ~1000 times
+  EXPECT_LE(idle_wakeups, 4u);
+  EXPECT_GE(h->count, (uint64_t)kEvents);
+  // Without the doorbell, events would sit until the flush deadline
+  EXPECT_LT(swclock_histogram_quantile_ns(h, 0.99), 100ull * 1000 * 1000);
+  EXPECT_LT(stop_ns, 100LL * 1000 * 1000);
+}
+
+// Encode events as v2 into buf; returns the encoded size
+static size_t encode_events_v2(const std::vector<swclock_event_header_t>& hdrs,
+                               const std::vector<std::vector<uint8_t>>& payloads,
+                               std::vector<uint8_t>* buf) {
+  swclock_evcodec_t enc;
+  swclock_evcodec_reset(&enc);
+  buf->resize(hdrs.size() * SWCLOCK_EVCODEC_MAX_RECORD);
+  size_t off = 0;
+  for (size_t i = 0; i < hdrs.size(); i++) {
+    off += swclock_evcodec_encode(&enc, &hdrs[i], payloads[i].data(), buf->data() + off);
+  }
+  buf->resize(off);
+  return off;
+}
+
+// Every event type, codec fallbacks and sequence/timestamp irregularities
+// decode to exactly what was encoded; truncated records are rejected
+TEST(EventLog, CompactEncodingRoundTrip) {
+  std::vector<swclock_event_header_t> hdrs;
+  std::vector<std::vector<uint8_t>> payloads;
+  auto add = [&](uint64_t seq, uint64_t ts, uint16_t type, const void* p, size_t n) {
+    swclock_event_header_t h;
+    memset(&h, 0, sizeof(h));
+    h.sequence_num = seq;
+    h.timestamp_ns = ts;
+    h.event_type = type;
+    h.payload_size = (uint16_t)n;
+    hdrs.push_back(h);
+    payloads.emplace_back((const uint8_t*)p, (const uint8_t*)p + n);
+  };
+
+  uint64_t seq = 0, ts = 1234567890123ull;
+  add(seq++, ts, SWCLOCK_EVENT_LOG_START, nullptr, 0);
+  for (int i = 0; i < 2000; i++) {
+    ts += 10000000 + (uint64_t)((i * 7919) % 40000) - 20000;
+
+    swclock_event_pi_step_payload_t pi;
+    memset(&pi, 0, sizeof(pi));
+    pi.pi_freq_ppm = 12.5 * exp(-i / 300.0) + 1e-4 * sin(i);
+    pi.pi_int_error_s = 1e-3 * exp(-i / 500.0);
+    pi.remaining_phase_ns = (int64_t)(1e6 * exp(-i / 200.0)) - 3;
+    pi.servo_enabled = 1;
+    if (i == 100) pi.padding = 0xDEADBEEF;  // Must fall back to raw
+    add(seq++, ts, SWCLOCK_EVENT_PI_STEP, &pi, sizeof(pi));
+
+    if (i % 50 == 0) {
+      swclock_event_adjtime_payload_t adj;
+      memset(&adj, 0, sizeof(adj));
+      adj.modes = 0x2001;
+      adj.offset_ns = -(int64_t)i * 1000;
+      adj.freq_scaled_ppm = (int64_t)i << 16;
+      adj.return_code = (i % 100) ? 0 : -1;
+      add(seq++, ts + 500, SWCLOCK_EVENT_ADJTIME_CALL, &adj, sizeof(adj));
+      add(seq++, ts + 900, SWCLOCK_EVENT_ADJTIME_RETURN, &adj, sizeof(adj));
+    }
+    if (i % 333 == 0) {
+      swclock_event_phase_slew_payload_t slew = { 5000000, -12345, 499.75, 10000, 0 };
+      add(seq++, ts + 1, SWCLOCK_EVENT_PHASE_SLEW_START, &slew, sizeof(slew));
+      swclock_event_frequency_clamp_payload_t clamp = { 812.5, 500.0, 500.0, 0 };
+      add(seq++, ts + 2, SWCLOCK_EVENT_FREQUENCY_CLAMP, &clamp, sizeof(clamp));
+      swclock_event_threshold_payload_t th = { -900000, 1000000, 1, 0 };
+      add(seq++, ts + 3, SWCLOCK_EVENT_THRESHOLD_CROSS, &th, sizeof(th));
+      swclock_event_marker_payload_t m;
+      memset(&m, 0, sizeof(m));
+      m.marker_id = (uint32_t)i;
+      snprintf(m.description, sizeof(m.description), "marker %d", i);
+      add(seq++, ts - 5000, SWCLOCK_EVENT_LOG_MARKER, &m, sizeof(m));  // Earlier than the last event
+    }
+    if (i % 700 == 0) seq += 3;          // Events dropped by a full ring
+    if (i % 900 == 0) {                  // Producers committing out of order
+      uint64_t s1 = hdrs[hdrs.size() - 1].sequence_num;
+      hdrs[hdrs.size() - 1].sequence_num = hdrs[hdrs.size() - 2].sequence_num;
+      hdrs[hdrs.size() - 2].sequence_num = s1;
+    }
+  }
+  uint32_t odd = 0x01020304;             // Known type, unexpected size
+  add(seq++, ts, SWCLOCK_EVENT_PI_STEP, &odd, sizeof(odd));
+  add(seq++, ts + 1, 0x77, nullptr, 0);  // Unknown type
+  add(seq++, ts + 2, SWCLOCK_EVENT_LOG_STOP, nullptr, 0);
+
+  std::vector<uint8_t> buf;
+  size_t bytes = encode_events_v2(hdrs, payloads, &buf);
+  ASSERT_GT(bytes, 0u);
+
+  // Followed by the zero tail of a pre-allocated segment
+  buf.resize(bytes + 64, 0);
+  swclock_evcodec_t dec;
+  swclock_evcodec_reset(&dec);
+  size_t off = 0, last_off = 0;
+  uint8_t payload[SWCLOCK_EVCODEC_MAX_PAYLOAD];
+  for (size_t i = 0; i < hdrs.size(); i++) {
+    swclock_event_header_t h;
+    size_t used = 0;
+    ASSERT_EQ(swclock_evcodec_decode(&dec, buf.data() + off, buf.size() - off, &h, payload, &used), 1)
+        << "event " << i;
+    EXPECT_EQ(h.sequence_num, hdrs[i].sequence_num) << "event " << i;
+    EXPECT_EQ(h.timestamp_ns, hdrs[i].timestamp_ns) << "event " << i;
+    EXPECT_EQ(h.event_type, hdrs[i].event_type) << "event " << i;
+    ASSERT_EQ(h.payload_size, hdrs[i].payload_size) << "event " << i;
+    EXPECT_EQ(memcmp(payload, payloads[i].data(), h.payload_size), 0) << "event " << i;
+    last_off = off;
+    off += used;
+  }
+  EXPECT_EQ(off, bytes);
+  swclock_event_header_t h;
+  size_t used;
+  EXPECT_EQ(swclock_evcodec_decode(&dec, buf.data() + off, buf.size() - off, &h, payload, &used), 0);
+
+  // Every strict prefix of a record is rejected, not misread
+  for (size_t cut = last_off + 1; cut < bytes; cut++) {
+    swclock_evcodec_t d;
+    swclock_evcodec_reset(&d);
+    size_t o = 0;
+    int rc;
+    while ((rc = swclock_evcodec_decode(&d, buf.data() + o, cut - o, &h, payload, &used)) == 1) o += used;
+    EXPECT_EQ(rc, -1) << "cut at " << cut;
+  }
+}
+
+// Capture a real servo run in both formats and compare size and encode cost
+TEST(EventLog, CompactEncodingSizeBenchmark) {
+  setenv("SWCLOCK_DISABLE_JSONLD", "1", 1);
+  setenv("SWCLOCK_EVENT_FORMAT", "1", 1);
+
+  SwClock* c = swclock_create();
+  ASSERT_NE(c, nullptr);
+  unsetenv("SWCLOCK_EVENT_FORMAT");
+
+  char path[128];
+  snprintf(path, sizeof(path), "/tmp/swclock_eventlog_v1_%d.bin", (int)getpid());
+  ASSERT_EQ(swclock_start_event_log(c, path), 0);
+
+  // A phase correction the servo works off, then steady state
+  struct timex tx;
+  memset(&tx, 0, sizeof(tx));
+  tx.modes  = ADJ_OFFSET | ADJ_MICRO;
+  tx.offset = 500;
+  swclock_adjtime(c, &tx);
+  usleep(3000 * 1000);
+  swclock_stop_event_log(c);
+  swclock_destroy(c);
+
+  std::vector<swclock_event_header_t> hdrs;
+  std::vector<std::vector<uint8_t>> payloads;
+  size_t v1_bytes = 0;
+  uint16_t version = 0;
+  long n = for_each_event(path, [&](const swclock_event_header_t& eh, const uint8_t* p) {
+    hdrs.push_back(eh);
+    payloads.emplace_back(p, p + eh.payload_size);
+    v1_bytes += sizeof(eh) + eh.payload_size;
+  }, &version);
+  unlink_event_segment(path);
+  unsetenv("SWCLOCK_DISABLE_JSONLD");
+  ASSERT_GT(n, 100);
+  EXPECT_EQ(version, 1);
+
+  // Synthetic multi-day steady state: a converged servo's PI steps at 100 Hz
+  std::vector<swclock_event_header_t> steady_hdrs;
+  std::vector<std::vector<uint8_t>> steady_payloads;
+  swclock_event_pi_step_payload_t pi;
+  memset(&pi, 0, sizeof(pi));
+  pi.servo_enabled = 1;
+  for (int i = 0; i < 100000; i++) {
+    swclock_event_header_t h;
+    memset(&h, 0, sizeof(h));
+    h.sequence_num = (uint64_t)i;
+    h.timestamp_ns = 1000000000000ull + (uint64_t)i * 10000000 + (uint64_t)((i * 7919) % 50000);
+    h.event_type   = SWCLOCK_EVENT_PI_STEP;
+    h.payload_size = sizeof(pi);
+    steady_hdrs.push_back(h);
+    steady_payloads.emplace_back((uint8_t*)&pi, (uint8_t*)&pi + sizeof(pi));
+  }
+  const size_t steady_v1 = steady_hdrs.size() * (sizeof(swclock_event_header_t) + sizeof(pi));
+
+  // Encode cost per event against the v1 copy into the log
+  std::vector<uint8_t> v2, v1(steady_v1);
+  const int kReps = 20;
+  long long t0 = mono_ns();
+  size_t steady_v2 = 0;
+  for (int r = 0; r < kReps; r++) steady_v2 = encode_events_v2(steady_hdrs, steady_payloads, &v2);
+  long long t1 = mono_ns();
+  for (int r = 0; r < kReps; r++) {
+    size_t off = 0;
+    for (size_t i = 0; i < steady_hdrs.size(); i++) {
+      memcpy(v1.data() + off, &steady_hdrs[i], sizeof(steady_hdrs[i]));
+      memcpy(v1.data() + off + sizeof(steady_hdrs[i]), steady_payloads[i].data(), sizeof(pi));
+      off += sizeof(steady_hdrs[i]) + sizeof(pi);
+    }
+  }
+  long long t2 = mono_ns();
+  double enc_ns = (double)(t1 - t0) / kReps / steady_hdrs.size();
+  double copy_ns = (double)(t2 - t1) / kReps / steady_hdrs.size();
+
+  std::vector<uint8_t> capture;
+  size_t v2_bytes = encode_events_v2(hdrs, payloads, &capture);
+
+  printf("  stream                  |  events |   v1 bytes |   v2 bytes | ratio\n");
+  printf("  servo capture (3 s)     | %7zu | %10zu | %10zu | %5.1fx\n",
+         hdrs.size(), v1_bytes, v2_bytes, (double)v1_bytes / v2_bytes);
+  printf("  converged PI, 100 Hz    | %7zu | %10zu | %10zu | %5.1fx\n",
+         steady_hdrs.size(), steady_v1, steady_v2, (double)steady_v1 / steady_v2);
+  printf("  per event: v2 encode %.1f ns, v1 copy %.1f ns\n", enc_ns, copy_ns);
+
+  EXPECT_GE((double)steady_v1 / steady_v2, 4.0);
+  EXPECT_GE((double)v1_bytes / v2_bytes, 2.0);
+}
+
+// Every index entry is a place decoding can start, and seeking by time or
+// sequence through the index decodes a small byte range that still holds
+// every matching event (both on-disk formats)
+TEST(EventLog, IndexSeek) {
+  setenv("SWCLOCK_DISABLE_JSONLD", "1", 1);
+
+  for (int format = 1; format <= SWCLOCK_EVCODEC_VERSION; format++) {
+    SCOPED_TRACE(format == 1 ? "format v1" : "format v2");
+    setenv("SWCLOCK_EVENT_FORMAT", format == 1 ? "1" : "2", 1);
+    SwClock* c = swclock_create();
+    ASSERT_NE(c, nullptr);
+    unsetenv("SWCLOCK_EVENT_FORMAT");
+    swclock_disable_pi_servo(c);
+
+    char path[128];
+    snprintf(path, sizeof(path), "/tmp/swclock_eventlog_index_%d.bin", (int)getpid());
+    ASSERT_EQ(swclock_start_event_log(c, path), 0);
+
+    // Bursts the logger keeps up with, so nothing is dropped
+    swclock_event_marker_payload_t m;
+    memset(&m, 0, sizeof(m));
+    for (int burst = 0; burst < 100; burst++) {
+      for (int i = 0; i < 500; i++) {
+        m.marker_id = (uint32_t)(burst * 500 + i);
+        swclock_log_event(c, SWCLOCK_EVENT_LOG_MARKER, &m, sizeof(m));
+      }
+      usleep(2000);
+    }
+    swclock_stop_event_log(c);
+    swclock_destroy(c);
+
+    std::vector<uint8_t> data;
+    uint16_t version = 0;
+    ASSERT_TRUE(read_event_segment(path, &data, &version));
+    EXPECT_EQ(version, format);
+    size_t count = 0;
+    swclock_event_index_entry_t* idx = swclock_evindex_load(path, &count);
+    ASSERT_NE(idx, nullptr);
+
+    // All events in file order
+    const size_t hdr = sizeof(swclock_event_log_header_t);
+    std::vector<swclock_event_header_t> all;
+    ASSERT_GT(decode_events(data.data() + hdr, data.size() - hdr, version,
+                            [&](const swclock_event_header_t& eh, const uint8_t*) { all.push_back(eh); }), 50000);
+
+    // One sync point per SWCLOCK_EVENT_SYNC_POINT_BYTES, each at its first record
+    size_t expected = (data.size() - hdr) / (64 << 10);
+    EXPECT_GE(count, expected);
+    EXPECT_LE(count, expected + 3);
+    EXPECT_EQ(idx[0].offset, hdr);
+    for (size_t k = 0; k < count; k++) {
+      ASSERT_LT(idx[k].offset, data.size());
+      swclock_event_header_t first;
+      memset(&first, 0, sizeof(first));
+      long n = decode_events(data.data() + idx[k].offset, data.size() - idx[k].offset, version,
+                        [&](const swclock_event_header_t& eh, const uint8_t*) {
+                          if (first.event_type == 0) first = eh;
+                        });
+      ASSERT_GT(n, 0) << "entry " << k;
+      EXPECT_EQ(first.sequence_num, idx[k].sequence_num) << "entry " << k;
+      EXPECT_EQ(first.timestamp_ns, idx[k].timestamp_ns) << "entry " << k;
+    }
+
+    // Seek like swclock_event_dump: start one sync point early, stop one late
+    auto range = [&](size_t first, size_t last_plus) {
+      uint64_t b = idx[first].offset;
+      uint64_t e = last_plus < count ? idx[last_plus].offset : data.size();
+      return std::make_pair(b, e);
+    };
+    size_t max_span = 0;
+    for (int t = 0; t < 50; t++) {
+      size_t i = (size_t)(t * 7919) % all.size();
+      size_t j = std::min(all.size() - 1, i + 2000);
+      uint64_t from = all[i].timestamp_ns, to = all[j].timestamp_ns;
+      uint64_t seq_from = all[i].sequence_num, seq_to = all[j].sequence_num;
+
+      auto tr = range(swclock_evindex_find_time(idx, count, from),
+                      swclock_evindex_find_time(idx, count, to) + 3);
+      auto sr = range(swclock_evindex_find_seq(idx, count, seq_from),
+                      swclock_evindex_find_seq(idx, count, seq_to) + 3);
+      max_span = std::max(max_span, (size_t)(tr.second - tr.first));
+
+      std::set<uint64_t> by_time, by_seq;
+      ASSERT_GE(decode_events(data.data() + tr.first, tr.second - tr.first, version,
+                              [&](const swclock_event_header_t& eh, const uint8_t*) {
+                                if (eh.timestamp_ns >= from && eh.timestamp_ns <= to) by_time.insert(eh.sequence_num);
+                              }), 0);
+      ASSERT_GE(decode_events(data.data() + sr.first, sr.second - sr.first, version,
+                              [&](const swclock_event_header_t& eh, const uint8_t*) {
+                                if (eh.sequence_num >= seq_from && eh.sequence_num <= seq_to) by_seq.insert(eh.sequence_num);
+                              }), 0);
+
+      size_t want_time = 0, want_seq = 0;
+      for (const auto& eh : all) {
+        if (eh.timestamp_ns >= from && eh.timestamp_ns <= to) want_time++;
+        if (eh.sequence_num >= seq_from && eh.sequence_num <= seq_to) want_seq++;
+      }
+      EXPECT_EQ(by_time.size(), want_time) << "from " << from << " to " << to;
+      EXPECT_EQ(by_seq.size(), want_seq) << "seq " << seq_from << "-" << seq_to;
+    }
+    printf("  v%d: %zu events, %zu bytes, %zu index entries; 2000-event seek maps <= %zu bytes\n",
+           format, all.size(), data.size(), count, max_span);
+    EXPECT_LT(max_span, data.size() / 4);
+
+    free(idx);
+    unlink_event_segment(path);
+  }
+  unsetenv("SWCLOCK_DISABLE_JSONLD");
+}
+
+// Write a segment of n synthetic PI steps in the given format, with a sync
+// point and index entry every SWCLOCK_EVENT_SYNC_POINT_BYTES like the logger
+static bool write_pi_segment(const char* path, uint16_t format, int n) {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  int idx_fd = swclock_evindex_create(path);
+  if (idx_fd < 0) {
+    fclose(f);
+    return false;
+  }
+
+  swclock_event_log_header_t fh;
+  memset(&fh, 0, sizeof(fh));
+  fh.magic = SWCLOCK_EVENT_LOG_MAGIC;
+  fh.version_major = format;
+  fh.start_time_ns = 1000000000000ull;
+  bool ok = fwrite(&fh, sizeof(fh), 1, f) == 1;
+
+  swclock_evcodec_t enc;
+  swclock_evcodec_reset(&enc);
+  std::vector<uint8_t> buf(1 << 20);
+  size_t used = 0;
+  uint64_t off = sizeof(fh), sync_off = 0;
+  bool fresh = true;
+  for (int i = 0; i < n && ok; i++) {
+    swclock_event_pi_step_payload_t pi;
+    memset(&pi, 0, sizeof(pi));
+    pi.pi_freq_ppm = 3.25 + 0.01 * sin(i / 50.0);
+    pi.pi_int_error_s = 1e-9 * (i % 97);
+    pi.remaining_phase_ns = (int64_t)((uint64_t)i * 7919 % 400) - 200;
+    pi.servo_enabled = 1;
+    swclock_event_header_t h;
+    memset(&h, 0, sizeof(h));
+    h.sequence_num = (uint64_t)i;
+    h.timestamp_ns = fh.start_time_ns + (uint64_t)i * 10000000 + (uint64_t)i * 7919 % 50000;
+    h.event_type = SWCLOCK_EVENT_PI_STEP;
+    h.payload_size = sizeof(pi);
+
+    if (fresh || off - sync_off >= (uint64_t)SWCLOCK_EVENT_SYNC_POINT_BYTES) {
+      swclock_event_index_entry_t e = { h.timestamp_ns, h.sequence_num, off };
+      ok = swclock_evindex_append(idx_fd, &e) == 0;
+      if (!fresh && format >= SWCLOCK_EVCODEC_VERSION) {
+        size_t k = swclock_evcodec_sync(&enc, buf.data() + used);
+        used += k;
+        off += k;
+      }
+      sync_off = e.offset;
+      fresh = false;
+    }
+
+    size_t k;
+    if (format >= SWCLOCK_EVCODEC_VERSION) {
+      k = swclock_evcodec_encode(&enc, &h, &pi, buf.data() + used);
+    } else {
+      memcpy(buf.data() + used, &h, sizeof(h));
+      memcpy(buf.data() + used + sizeof(h), &pi, sizeof(pi));
+      k = sizeof(h) + sizeof(pi);
+    }
+    used += k;
+    off += k;
+    if (used > buf.size() - 2 * SWCLOCK_EVCODEC_MAX_RECORD) {
+      ok = fwrite(buf.data(), 1, used, f) == used;
+      used = 0;
+    }
+  }
+  if (ok && used) ok = fwrite(buf.data(), 1, used, f) == used;
+  close(idx_fd);
+  return fclose(f) == 0 && ok;
+}
+
+// The mmap reader iterates whole segments of both formats, split at sync
+// points across 1..8 threads, and every split decodes the same events
+TEST(EventLog, ReaderThroughputBenchmark) {
+  const int kEvents = 2000000;
+  for (uint16_t format = 1; format <= SWCLOCK_EVCODEC_VERSION; format++) {
+    SCOPED_TRACE(format == 1 ? "format v1" : "format v2");
+    char path[128];
+    snprintf(path, sizeof(path), "/tmp/swclock_eventlog_reader_%d.bin", (int)getpid());
+    ASSERT_TRUE(write_pi_segment(path, format, kEvents));
+
+    swclock_evreader_t* r = swclock_evreader_open(path);
+    ASSERT_NE(r, nullptr);
+    size_t n_idx = 0;
+    ASSERT_NE(swclock_evreader_index(r, &n_idx), nullptr);
+    const uint64_t begin = sizeof(swclock_event_log_header_t);
+    const uint64_t size = swclock_evreader_size(r);
+
+    // Warm the page cache so every pass measures decoding, not disk reads
+    uint64_t want_sum = 0, want_count = 0;
+    {
+      swclock_evreader_cursor_t cur;
+      swclock_evreader_cursor_init(r, begin, size, &cur);
+      while (swclock_evreader_next(&cur) == 1) {
+        want_sum += cur.hdr->sequence_num ^ cur.hdr->timestamp_ns;
+        want_count++;
+      }
+    }
+    EXPECT_EQ(want_count, (uint64_t)kEvents);
+
+    printf("  v%u: %llu bytes, %zu sync points (hardware threads: %u)\n", format,
+           (unsigned long long)size, n_idx, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= 8; threads *= 2) {
+      std::vector<uint64_t> bounds(threads + 1);
+      size_t parts = swclock_evreader_split(r, begin, size, threads, bounds.data());
+      EXPECT_EQ(parts, (size_t)threads);
+
+      std::vector<uint64_t> sums(parts), counts(parts);
+      std::vector<int> errors(parts);
+      long long t0 = mono_ns();
+      std::vector<std::thread> workers;
+      for (size_t p = 0; p < parts; p++) {
+        workers.emplace_back([&, p] {
+          swclock_evreader_cursor_t cur;
+          swclock_evreader_cursor_init(r, bounds[p], bounds[p + 1], &cur);
+          int rc;
+          uint64_t sum = 0, count = 0;
+          double acc = 0;
+          while ((rc = swclock_evreader_next(&cur)) == 1) {
+            sum += cur.hdr->sequence_num ^ cur.hdr->timestamp_ns;
+            double freq;
+            memcpy(&freq, cur.payload, sizeof(freq));
+            acc += freq;
+            count++;
+          }
+          sums[p] = sum + (acc > 0 ? 0 : 1);
+          counts[p] = count;
+          errors[p] = rc;
+        });
+      }
+      for (auto& w : workers) w.join();
+      long long ns = mono_ns() - t0;
+
+      uint64_t sum = 0, count = 0;
+      for (size_t p = 0; p < parts; p++) {
+        sum += sums[p];
+        count += counts[p];
+        EXPECT_EQ(errors[p], 0) << "part " << p;
+      }
+      EXPECT_EQ(count, want_count) << threads << " threads";
+      EXPECT_EQ(sum, want_sum) << threads << " threads";
+      printf("  v%u, %u thread%s: %6.2f GB/s, %6.1f M events/s\n", format, threads,
+             threads == 1 ? " " : "s", (double)(size - begin) / ns,
+             (double)count * 1000.0 / ns);
+    }
+
+    swclock_evreader_close(r);
+    unlink_event_segment(path);
+  }
+}
+
+// Sampling policies drop events before they are queued, count them per type,
+// and leave the logged events with contiguous sequence numbers
+TEST(EventLog, SamplingPolicies) {
+  setenv("SWCLOCK_DISABLE_JSONLD", "1", 1);
+  setenv("SWCLOCK_EVENT_POLICY", "PI_STEP=1/10,0x30=rate:1/5", 1);
+  SwClock* c = swclock_create();
+  ASSERT_NE(c, nullptr);
+  unsetenv("SWCLOCK_EVENT_POLICY");
+
+  swclock_event_policy_t p;
+  ASSERT_EQ(swclock_get_event_policy(c, SWCLOCK_EVENT_PI_STEP, &p), 0);
+  EXPECT_EQ(p.mode, SWCLOCK_EVENT_POLICY_ONE_IN_N);
+  EXPECT_EQ(p.one_in_n, 10u);
+  ASSERT_EQ(swclock_get_event_policy(c, SWCLOCK_EVENT_FREQUENCY_CLAMP, &p), 0);
+  EXPECT_EQ(p.mode, SWCLOCK_EVENT_POLICY_RATE_LIMIT);
+  EXPECT_EQ(p.burst, 5u);
+
+  // Invalid policies are rejected
+  memset(&p, 0, sizeof(p));
+  p.mode = SWCLOCK_EVENT_POLICY_ONE_IN_N;
+  EXPECT_EQ(swclock_set_event_policy(c, SWCLOCK_EVENT_LOG_MARKER, &p), -1);
+  EXPECT_EQ(errno, EINVAL);
+  p.mode = SWCLOCK_EVENT_POLICY_RATE_LIMIT;
+  EXPECT_EQ(swclock_set_event_policy(c, SWCLOCK_EVENT_LOG_MARKER, &p), -1);
+  p.mode = SWCLOCK_EVENT_POLICY_ON_CHANGE;
+  p.change_delta = -1;
+  EXPECT_EQ(swclock_set_event_policy(c, SWCLOCK_EVENT_LOG_MARKER, &p), -1);
+  EXPECT_EQ(swclock_set_event_policy(c, (swclock_event_type_t)0x100, &p), -1);
+
+  char path[128];
+  snprintf(path, sizeof(path), "/tmp/swclock_eventlog_policy_%d.bin", (int)getpid());
+  ASSERT_EQ(swclock_start_event_log(c, path), 0);
+
+  // Markers 0-999 one in 10, 1000-1999 on a change of 5, 2000-2999 at 100/s
+  // in bursts of 10 (logged within a few ms, so about one burst), 3000-3999 all
+  const int kPhase = 1000;
+  swclock_event_marker_payload_t m;
+  memset(&m, 0, sizeof(m));
+  uint64_t suppressed[4];
+  for (int phase = 0; phase < 4; phase++) {
+    memset(&p, 0, sizeof(p));
+    p.mode = phase == 0 ? SWCLOCK_EVENT_POLICY_ONE_IN_N
+           : phase == 1 ? SWCLOCK_EVENT_POLICY_ON_CHANGE
+           : phase == 2 ? SWCLOCK_EVENT_POLICY_RATE_LIMIT
+                        : SWCLOCK_EVENT_POLICY_ALWAYS;
+    p.one_in_n = 10;
+    p.change_delta = 5;
+    p.max_per_s = 100;
+    p.burst = 10;
+    ASSERT_EQ(swclock_set_event_policy(c, SWCLOCK_EVENT_LOG_MARKER, &p), 0);
+    uint64_t before = swclock_get_event_suppressed(c, SWCLOCK_EVENT_LOG_MARKER);
+    long long t0 = mono_ns();
+    for (int i = 0; i < kPhase; i++) {
+      m.marker_id = (uint32_t)(phase * kPhase + i);
+      swclock_log_event(c, SWCLOCK_EVENT_LOG_MARKER, &m, sizeof(m));
+      if (i % 200 == 199) usleep(1000);   // Let the logger keep up
+    }
+    long long burst_ns = mono_ns() - t0;
+    suppressed[phase] = swclock_get_event_suppressed(c, SWCLOCK_EVENT_LOG_MARKER) - before;
+    if (phase == 2) {
+      // One burst plus whatever refilled at 100/s meanwhile
+      EXPECT_GE(suppressed[phase], (uint64_t)(kPhase - 10 - burst_ns / 10000000 - 1));
+    }
+  }
+
+  // Let the servo run: PI steps one in 10
+  usleep(500 * 1000);
+
+  // Counters are final once logging stopped
+  swclock_stop_event_log(c);
+  swclock_event_log_stats_t st;
+  ASSERT_EQ(swclock_get_event_log_stats(c, &st), 0);
+  uint64_t pi_suppressed = swclock_get_event_suppressed(c, SWCLOCK_EVENT_PI_STEP);
+  swclock_destroy(c);
+  unsetenv("SWCLOCK_DISABLE_JSONLD");
+
+  int logged[4] = {0, 0, 0, 0};
+  uint64_t pi_logged = 0, expect_seq = 0;
+  bool contiguous = true;
+  std::vector<uint32_t> on_change;
+  long n = for_each_event(path, [&](const swclock_event_header_t& eh, const uint8_t* payload) {
+    contiguous = contiguous && eh.sequence_num == expect_seq;
+    expect_seq = eh.sequence_num + 1;
+    if (eh.event_type == SWCLOCK_EVENT_PI_STEP) pi_logged++;
+    if (eh.event_type != SWCLOCK_EVENT_LOG_MARKER) return;
+    swclock_event_marker_payload_t mk;
+    memcpy(&mk, payload, sizeof(mk));
+    logged[mk.marker_id / kPhase]++;
+    if (mk.marker_id / kPhase == 1) on_change.push_back(mk.marker_id);
+  });
+  unlink_event_segment(path);
+  ASSERT_GT(n, 0);
+  EXPECT_TRUE(contiguous);
+  EXPECT_EQ(st.dropped, 0u);
+
+  EXPECT_EQ(logged[0], kPhase / 10);
+  EXPECT_EQ(logged[1], kPhase / 5);
+  for (size_t i = 0; i < on_change.size(); i++) EXPECT_EQ(on_change[i], (uint32_t)(kPhase + 5 * i));
+  EXPECT_GE(logged[2], 10);
+  EXPECT_LT(logged[2], 50);
+  EXPECT_EQ(logged[3], kPhase);
+  for (int phase = 0; phase < 4; phase++) {
+    EXPECT_EQ((uint64_t)logged[phase] + suppressed[phase], (uint64_t)kPhase) << "phase " << phase;
+  }
+
+  EXPECT_GT(pi_logged, 0u);
+  EXPECT_EQ(pi_logged, (pi_logged + pi_suppressed + 9) / 10);
+  EXPECT_EQ(st.suppressed, pi_suppressed + suppressed[0] + suppressed[1] + suppressed[2]);
+  printf("  markers logged: 1/10 %d, delta 5 %d, 100/s burst 10 %d, always %d; "
+         "PI steps logged %llu, suppressed %llu\n", logged[0], logged[1], logged[2], logged[3],
+         (unsigned long long)pi_logged, (unsigned long long)pi_suppressed);
+}
+
+TEST(EventLog, FlightRecorder) {
+  setenv("SWCLOCK_DISABLE_JSONLD", "1", 1);
+  SwClock* c = swclock_create();
+  ASSERT_NE(c, nullptr);
+  unsetenv("SWCLOCK_DISABLE_JSONLD");
+
+  char path[128], prefix[128];
+  snprintf(path, sizeof(path), "/tmp/swclock_flightrec_%d.bin", (int)getpid());
+  snprintf(prefix, sizeof(prefix), "/tmp/swclock_flightrec_%d", (int)getpid());
+  EXPECT_EQ(swclock_flight_recorder_dump(c, path), -1);
+  EXPECT_EQ(errno, ENOTSUP);
+
+  // 1000 rounds up to 1024 slots
+  swclock_flightrec_config_t cfg = { prefix, 1000, SWCLOCK_FLIGHTREC_ON_SIGNAL };
+  ASSERT_EQ(swclock_enable_flight_recorder(c, &cfg), 0);
+
+  // Overwrite the history a few times over, then dump: the last markers, in order
+  swclock_event_marker_payload_t m;
+  memset(&m, 0, sizeof(m));
+  const int kMarkers = 5000;
+  for (int i = 0; i < kMarkers; i++) {
+    m.marker_id = (uint32_t)i;
+    swclock_log_event(c, SWCLOCK_EVENT_LOG_MARKER, &m, sizeof(m));
+  }
+  long n = swclock_flight_recorder_dump(c, path);
+  EXPECT_GT(n, 1000);
+  EXPECT_LE(n, 1024);
+
+  uint64_t last_seq = 0;
+  uint32_t last_marker = 0, markers = 0;
+  bool ordered = true;
+  uint16_t version = 0;
+  long parsed = for_each_event(path, [&](const swclock_event_header_t& eh, const uint8_t* payload) {
+    ordered = ordered && (markers == 0 || eh.sequence_num > last_seq);
+    last_seq = eh.sequence_num;
+    if (eh.event_type != SWCLOCK_EVENT_LOG_MARKER) return;
+    swclock_event_marker_payload_t mk;
+    memcpy(&mk, payload, sizeof(mk));
+    ordered = ordered && (markers == 0 || mk.marker_id == last_marker + 1);
+    last_marker = mk.marker_id;
+    markers++;
+  }, &version);
+  EXPECT_EQ(parsed, n);
+  EXPECT_EQ(version, SWCLOCK_EVCODEC_VERSION);
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(last_marker, (uint32_t)(kMarkers - 1));
+  EXPECT_GT(markers, 900u);
+
+  // Nothing went through the disk event log
+  swclock_event_log_stats_t st;
+  ASSERT_EQ(swclock_get_event_log_stats(c, &st), 0);
+  EXPECT_EQ(st.logged, 0u);
+
+  // Dumps while four producers keep recording: every dump is in sequence
+  // order and each producer's markers in its own order
+  std::atomic<bool> stop(false);
+  std::vector<std::thread> producers;
+  for (int t = 0; t < 4; t++) {
+    producers.emplace_back([c, t, &stop] {
+      swclock_event_marker_payload_t pm;
+      memset(&pm, 0, sizeof(pm));
+      for (uint32_t i = 0; !stop.load(std::memory_order_relaxed); i++) {
+        pm.marker_id = ((uint32_t)t << 24) | (i & 0xFFFFFF);
+        swclock_log_event(c, SWCLOCK_EVENT_LOG_MARKER, &pm, sizeof(pm));
+      }
+    });
+  }
+  int bad_dumps = 0;
+  long min_events = 1 << 30;
+  for (int d = 0; d < 20; d++) {
+    long dn = swclock_flight_recorder_dump(c, path);
+    if (dn < min_events) min_events = dn;
+    uint64_t prev_seq = 0;
+    uint32_t prev_id[4] = {0, 0, 0, 0};
+    bool seen[4] = {false, false, false, false};
+    bool first = true, ok = true;
+    for_each_event(path, [&](const swclock_event_header_t& eh, const uint8_t* payload) {
+      ok = ok && (first || eh.sequence_num > prev_seq);
+      prev_seq = eh.sequence_num;
+      first = false;
+      if (eh.event_type != SWCLOCK_EVENT_LOG_MARKER) return;
+      swclock_event_marker_payload_t mk;
+      memcpy(&mk, payload, sizeof(mk));
+      uint32_t t = mk.marker_id >> 24, id = mk.marker_id & 0xFFFFFF;
+      if (t >= 4) return;
+      ok = ok && (!seen[t] || id > prev_id[t]);
+      prev_id[t] = id;
+      seen[t] = true;
+    });
+    if (!ok) bad_dumps++;
+  }
+  stop = true;
+  for (auto& th : producers) th.join();
+  EXPECT_EQ(bad_dumps, 0);
+  EXPECT_GT(min_events, 512);   // Only slots being written at the snapshot are skipped
+
+  // SIGUSR2 dumps to "<prefix>-<time>-signal.bin" on the trigger worker
+  raise(SIGUSR2);
+  swclock_flightrec_stats_t fs;
+  for (int i = 0; i < 200; i++) {
+    ASSERT_EQ(swclock_get_flight_recorder_stats(c, &fs), 0);
+    if (fs.dumps > 0) break;
+    usleep(10 * 1000);
+  }
+  EXPECT_EQ(fs.triggers, 1u);
+  EXPECT_EQ(fs.dumps, 1u);
+  EXPECT_EQ(fs.failures, 0u);
+  EXPECT_EQ(strncmp(fs.last_path, prefix, strlen(prefix)), 0);
+  EXPECT_NE(strstr(fs.last_path, "-signal.bin"), nullptr);
+  EXPECT_GT(for_each_event(fs.last_path, [](const swclock_event_header_t&, const uint8_t*) {}), 1000);
+  unlink(fs.last_path);
+
+  // Triggers stop with the recorder; the history stays dumpable
+  swclock_disable_flight_recorder(c);
+  m.marker_id = 0xFFFFFFFFu;
+  swclock_log_event(c, SWCLOCK_EVENT_LOG_MARKER, &m, sizeof(m));
+  bool late = false;
+  EXPECT_GT(swclock_flight_recorder_dump(c, path), 1000);
+  for_each_event(path, [&](const swclock_event_header_t& eh, const uint8_t* payload) {
+    if (eh.event_type != SWCLOCK_EVENT_LOG_MARKER) return;
+    swclock_event_marker_payload_t mk;
+    memcpy(&mk, payload, sizeof(mk));
+    late = late || mk.marker_id == 0xFFFFFFFFu;
+  });
+  EXPECT_FALSE(late);
+  swclock_destroy(c);
+  unlink(path);
+}
+
+TEST(JsonLd, QueuedWriterOrderAndCallCost) {
+  char path[128];
+  snprintf(path, sizeof(path), "/tmp/swclock_jsonld_%d.jsonl", (int)getpid());
+  unlink(path);
+  swclock_log_rotation_t rotation;
+  memset(&rotation, 0, sizeof(rotation));
+  swclock_jsonld_logger_t* logger = swclock_jsonld_init(path, &rotation, nullptr);
+  ASSERT_NE(logger, nullptr);
+
+  // Four callers log PI updates tagged (kp = caller, error_s = index); the
+  // calls only enqueue, so time them the way the servo sees them
+  const int kThreads = 4, kCalls = 5000;
+  std::vector<std::thread> threads;
+  std::vector<std::vector<long long>> lat(kThreads);
+  std::atomic<int> failed(0);
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t] {
+      lat[t].reserve(kCalls);
+      for (int i = 0; i < kCalls; i++) {
+        long long t0 = mono_ns();
+        if (swclock_jsonld_log_pi_update(logger, 1000000000ULL * 1700000000ULL + i, t, 0, i, 0, 0) != 0) {
+          failed++;
+        }
+        lat[t].push_back(mono_ns() - t0);
+        if (i % 25 == 24) usleep(1000);   // ~100k entries/s in all; each caller's buffer holds ~1700
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+  swclock_jsonld_log_system(logger, 0, "done", "{\"calls\":20000}");
+  ASSERT_EQ(swclock_jsonld_flush(logger), 0);
+
+  EXPECT_EQ(failed.load(), 0);
+  EXPECT_EQ(swclock_jsonld_get_dropped(logger), 0u);
+  EXPECT_EQ(swclock_jsonld_get_count(logger), (uint64_t)(kThreads * kCalls + 1));
+
+  // Every entry is on disk after the flush, each caller's in its own order
+  FILE* f = fopen(path, "r");
+  ASSERT_NE(f, nullptr);
+  std::vector<int> next(kThreads, 0);
+  int lines = 0, pi = 0, bad = 0;
+  bool saw_done = false;
+  char line[4096];
+  while (fgets(line, sizeof(line), f)) {
+    lines++;
+    if (strstr(line, "\"event_type\":\"done\"")) {
+      saw_done = strstr(line, "\"details\":{\"calls\":20000}") != nullptr;
+      continue;
+    }
+    const char* kp = strstr(line, "\"kp\":");
+    const char* err = strstr(line, "\"error_s\":");
+    if (!kp || !err || !strstr(line, "\"@type\":\"PIUpdate\"")) {
+      bad++;
+      continue;
+    }
+    int t = (int)atof(kp + 5), i = (int)atof(err + 10);
+    if (t < 0 || t >= kThreads || i != next[t]) bad++;
+    else next[t]++;
+    pi++;
+  }
+  fclose(f);
+  swclock_jsonld_close(logger);
+  unlink(path);
+
+  EXPECT_EQ(lines, kThreads * kCalls + 1);
+  EXPECT_EQ(pi, kThreads * kCalls);
+  EXPECT_EQ(bad, 0);
+  EXPECT_TRUE(saw_done);
+
+  std::vector<long long> all;
+  for (auto& v : lat) all.insert(all.end(), v.begin(), v.end());
+  std::sort(all.begin(), all.end());
+  double mean = 0;
+  for (long long v : all) mean += (double)v;
+  mean /= (double)all.size();
+  printf("  jsonld_log_pi_update: mean %.0f ns, p50 %lld ns, p99 %lld ns per call (%d threads)\n",
+         mean, all[all.size() / 2], all[all.size() * 99 / 100], kThreads);
+}
+
+TEST(JsonLd, BackgroundRotation) {
+  char path[128], name[160];
+  snprintf(path, sizeof(path), "/tmp/swclock_jsonrot_%d.jsonl", (int)getpid());
+  auto cleanup = [&] {
+    unlink(path);
+    for (int i = 1; i <= 8; i++) {
+      snprintf(name, sizeof(name), "%s.%d", path, i);
+      unlink(name);
+      snprintf(name, sizeof(name), "%s.%d.gz", path, i);
+      unlink(name);
+    }
+  };
+  cleanup();
+  swclock_log_rotation_t rotation;
+  memset(&rotation, 0, sizeof(rotation));
+  rotation.enabled = true;
+  rotation.max_size_mb = 1024;
+  rotation.max_files = 3;     // live file + .1.gz + .2.gz
+  rotation.compress = true;
+  rotation.compress_level = 9;
+  swclock_jsonld_logger_t* logger = swclock_jsonld_init(path, &rotation, nullptr);
+  ASSERT_NE(logger, nullptr);
+
+  // Five rotations of ~2000 entries each; the worker compresses behind them
+  const int kRotations = 5, kEntries = 2000;
+  int rotated = 0;
+  for (int r = 0; r < kRotations; r++) {
+    for (int i = 0; i < kEntries; i++) {
+      swclock_jsonld_log_pi_update(logger, 1000000000ULL * 1700000000ULL + i, r, 0, i, 0, 0);
+      if (i % 500 == 499) usleep(1000);
+    }
+    if (swclock_jsonld_rotate(logger) == 0) rotated++;
+    else EXPECT_EQ(errno, EBUSY);
+  }
+
+  swclock_jsonld_rotation_stats_t st;
+  for (int i = 0; i < 2000; i++) {
+    swclock_jsonld_get_rotation_stats(logger, &st);
+    if (st.pending == 0) break;
+    usleep(5000);
+  }
+  EXPECT_EQ(st.pending, 0u);
+  EXPECT_EQ(st.rotations, (uint64_t)rotated);
+  EXPECT_EQ(st.rotations + st.deferred, (uint64_t)kRotations);
+  EXPECT_EQ(st.compressed, (uint64_t)rotated);
+  EXPECT_EQ(st.failures, 0u);
+  EXPECT_GT(st.bytes_in, st.bytes_out);
+  EXPECT_EQ(st.swap_latency.count, (uint64_t)rotated);
+  EXPECT_EQ(st.job_latency.count, (uint64_t)rotated);
+  swclock_jsonld_close(logger);
+
+  // Retention: only .1.gz and .2.gz survive, gzip-framed, no staging leftovers
+  struct stat sb;
+  for (int i = 1; i <= 2; i++) {
+    snprintf(name, sizeof(name), "%s.%d.gz", path, i);
+    FILE* f = fopen(name, "rb");
+    ASSERT_NE(f, nullptr) << name;
+    unsigned char magic[2] = {0, 0};
+    EXPECT_EQ(fread(magic, 1, 2, f), 2u);
+    EXPECT_EQ(magic[0], 0x1f);
+    EXPECT_EQ(magic[1], 0x8b);
+    fclose(f);
+    snprintf(name, sizeof(name), "%s.%d", path, i);
+    EXPECT_NE(stat(name, &sb), 0) << name;
+  }
+  snprintf(name, sizeof(name), "%s.3.gz", path);
+  EXPECT_NE(stat(name, &sb), 0);
+  for (uint64_t i = 0; i < (uint64_t)kRotations; i++) {
+    snprintf(name, sizeof(name), "%s.rotating-%llu", path, (unsigned long long)i);
+    EXPECT_NE(stat(name, &sb), 0) << name;
+  }
+  cleanup();
+
+  printf("  rotation: swap mean %.1f us max %.1f us; background job mean %.1f us max %.1f us; "
+         "%llu -> %llu bytes\n",
+         (double)swclock_histogram_mean_ns(&st.swap_latency) / 1e3, (double)st.swap_latency.max_ns / 1e3,
+         (double)swclock_histogram_mean_ns(&st.job_latency) / 1e3, (double)st.job_latency.max_ns / 1e3,
+         (unsigned long long)st.bytes_in, (unsigned long long)st.bytes_out);
+}
+
+// Servo entry as the printf-based serializer formatted it
+static std::string jsonld_servo_expected(const swclock_system_context_t& sys, uint64_t ts, double freq,
+                                         int64_t phase, int64_t te, double pi_freq, double pi_int,
+                                         bool enabled) {
+  time_t sec = (time_t)(ts / 1000000000ULL);
+  struct tm tm_info;
+  gmtime_r(&sec, &tm_info);
+  char ts_buf[64], line[4096];
+  snprintf(ts_buf, sizeof(ts_buf), "%04d-%02d-%02dT%02d:%02d:%02d.%09uZ", tm_info.tm_year + 1900,
+           tm_info.tm_mon + 1, tm_info.tm_mday, tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec,
+           (unsigned)(ts % 1000000000ULL));
+  snprintf(line, sizeof(line),
+           "{\"@context\":{\"@vocab\":\"https://swclock.org/vocab#\","
+           "\"ieee1588\":\"https://standards.ieee.org/1588/vocab#\"},"
+           "\"@type\":\"ServoStateUpdate\",\"timestamp\":\"%s\",\"timestamp_monotonic_ns\":%llu,"
+           "\"event\":{\"freq_ppm\":%.6f,\"phase_error_ns\":%ld,\"time_error_ns\":%ld,"
+           "\"pi_freq_ppm\":%.6f,\"pi_int_error_s\":%.12f,\"servo_enabled\":%s},"
+           "\"system\":{\"hostname\":\"%s\",\"os\":\"%s\",\"kernel\":\"%s\",\"arch\":\"%s\","
+           "\"swclock_version\":\"%s\"}}\n",
+           ts_buf, (unsigned long long)ts, freq, (long)phase, (long)te, pi_freq, pi_int,
+           enabled ? "true" : "false", sys.hostname, sys.os, sys.kernel, sys.arch, sys.swclock_version);
+  return line;
+}
+
+TEST(JsonLd, ServoSerializer) {
+  char path[128];
+  snprintf(path, sizeof(path), "/tmp/swclock_jsonser_%d.jsonl", (int)getpid());
+  unlink(path);
+  swclock_log_rotation_t rotation;
+  memset(&rotation, 0, sizeof(rotation));
+  swclock_system_context_t sys;
+  memset(&sys, 0, sizeof(sys));
+  snprintf(sys.hostname, sizeof(sys.hostname), "bench-host");
+  snprintf(sys.os, sizeof(sys.os), "Linux");
+  snprintf(sys.kernel, sizeof(sys.kernel), "6.1.0");
+  snprintf(sys.arch, sizeof(sys.arch), "x86_64");
+  snprintf(sys.swclock_version, sizeof(sys.swclock_version), "2.0.0");
+  swclock_jsonld_logger_t* logger = swclock_jsonld_init(path, &rotation, &sys);
+  ASSERT_NE(logger, nullptr);
+
+  // Same bytes as the printf formats: magnitudes from 1e-13 to 1e20, ties,
+  // negative zero, and timestamps crossing seconds
+  const double edge[] = {0.0, -0.0, 0.5e-6, 1.5e-6, 2.5e-12, -2.5e-12, 1.0000005, -0.0000004,
+                         123456.7890125, 1e-13, -1e-13, 99999999.9999995, 1e20, -3.5e15, 0.1, 2.675};
+  const int kEdge = (int)(sizeof(edge) / sizeof(edge[0]));
+  std::vector<std::string> expected;
+  unsigned seed = 12345;
+  auto rnd = [&seed] { seed = seed * 1103515245u + 12345u; return (seed >> 8) & 0xffffff; };
+  uint64_t ts = 1700000000ULL * 1000000000ULL + 999000000ULL;
+  for (int i = 0; i < 3000; i++) {
+    double freq, pi_freq, pi_int;
+    if (i < kEdge * kEdge) {
+      freq = edge[i % kEdge];
+      pi_freq = edge[i / kEdge];
+      pi_int = edge[(i + 3) % kEdge];
+    } else {
+      double scale = std::pow(10.0, (int)(rnd() % 16) - 8);
+      freq = ((double)rnd() - 8388608.0) * scale;
+      pi_freq = (double)rnd() / 16777216.0 * 500.0 - 250.0;
+      pi_int = ((double)rnd() - 8388608.0) * 1e-15;
+    }
+    int64_t phase = (int64_t)rnd() * (i % 2 ? -977 : 1013);
+    int64_t te = i % 7 == 0 ? INT64_MIN + i : (int64_t)rnd() - 8388608;
+    ts += 337000 + rnd();
+    expected.push_back(jsonld_servo_expected(sys, ts, freq, phase, te, pi_freq, pi_int, i % 3 != 0));
+    ASSERT_EQ(swclock_jsonld_log_servo(logger, ts, freq, phase, te, pi_freq, pi_int, i % 3 != 0), 0);
+    if (i % 1000 == 999) {
+      ASSERT_EQ(swclock_jsonld_flush(logger), 0);
+    }
+  }
+  ASSERT_EQ(swclock_jsonld_flush(logger), 0);
+  FILE* f = fopen(path, "r");
+  ASSERT_NE(f, nullptr);
+  char line[4096];
+  size_t n = 0, mismatched = 0;
+  while (fgets(line, sizeof(line), f)) {
+    if (n < expected.size() && expected[n] != line && mismatched++ < 3) {
+      ADD_FAILURE() << "entry " << n << "\n  got      " << line << "  expected " << expected[n];
+    }
+    n++;
+  }
+  fclose(f);
+  EXPECT_EQ(n, expected.size());
+  EXPECT_EQ(mismatched, 0u);
+
+  // Throughput: batches of servo entries, each flushed to the file (the
+  // caller's buffer holds ~1700 records); the time is almost all formatting
+  const int kBatches = 200, kBatch = 1000;
+  long long t0 = mono_ns();
+  for (int b = 0; b < kBatches; b++) {
+    for (int i = 0; i < kBatch; i++) {
+      ts += 1000000;
+      swclock_jsonld_log_servo(logger, ts, 12.345678 + i * 1e-6, 1500 - i, -250 + i, 12.3 + i * 1e-7,
+                               3.2e-9 * i, true);
+    }
+    ASSERT_EQ(swclock_jsonld_flush(logger), 0);
+  }
+  long long elapsed = mono_ns() - t0;
+  EXPECT_EQ(swclock_jsonld_get_dropped(logger), 0u);
+  swclock_jsonld_close(logger);
+  unlink(path);
+  printf("  jsonld servo entries: %.0f entries/s (%.0f ns per entry, enqueue + format + write)\n",
+         (double)kBatches * kBatch * 1e9 / (double)elapsed, (double)elapsed / (kBatches * kBatch));
+}
+
+// Inflate one gzip member
+static std::string gunzip_member(const std::vector<unsigned char>& in) {
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  if (inflateInit2(&zs, 15 + 16) != Z_OK) return "";
+  std::string out;
+  char buf[65536];
+  zs.next_in = const_cast<Bytef*>(in.data());
+  zs.avail_in = (uInt)in.size();
+  int ret;
+  do {
+    zs.next_out = (Bytef*)buf;
+    zs.avail_out = sizeof(buf);
+    ret = inflate(&zs, Z_NO_FLUSH);
+    out.append(buf, sizeof(buf) - zs.avail_out);
+  } while (ret == Z_OK);
+  inflateEnd(&zs);
+  return ret == Z_STREAM_END ? out : "";
+}
+
+static int count_gz_lines(const char* path) {
+  gzFile gz = gzopen(path, "rb");
+  if (!gz) return -1;
+  char line[4096];
+  int n = 0;
+  while (gzgets(gz, line, sizeof(line))) {
+    if (strchr(line, '\n')) n++;
+  }
+  gzclose(gz);
+  return n;
+}
+
+TEST(JsonLd, StreamingCompression) {
+  char path[128], index_path[160], name[192];
+  snprintf(path, sizeof(path), "/tmp/swclock_jsonstream_%d.jsonl.gz", (int)getpid());
+  snprintf(index_path, sizeof(index_path), "%s%s", path, SWCLOCK_JSONLD_INDEX_SUFFIX);
+  auto cleanup = [&] {
+    unlink(path);
+    unlink(index_path);
+    for (const char* sfx : {"", ".gz", ".idx"}) {
+      snprintf(name, sizeof(name), "%s.1%s", path, sfx);
+      unlink(name);
+    }
+  };
+  cleanup();
+  swclock_log_rotation_t rotation;
+  memset(&rotation, 0, sizeof(rotation));
+  rotation.enabled = true;
+  rotation.max_size_mb = 1024;
+  rotation.max_files = 3;
+  rotation.compress = true;     // Ignored: frames are compressed already
+  rotation.stream_compress = true;
+  swclock_jsonld_logger_t* logger = swclock_jsonld_init(path, &rotation, nullptr);
+  ASSERT_NE(logger, nullptr);
+
+  const int kEntries = 20000;
+  uint64_t ts = 1700000000ULL * 1000000000ULL;
+  for (int i = 0; i < kEntries; i++) {
+    ts += 1000000;
+    ASSERT_EQ(swclock_jsonld_log_servo(logger, ts, 12.5 + (i % 97) * 1e-3, 1500 - (i % 211), -250 + (i % 53),
+                                       12.49 + (i % 89) * 1e-4, 3.2e-9 * (i % 1000), true), 0);
+    if (i % 1000 == 999) {
+      ASSERT_EQ(swclock_jsonld_flush(logger), 0);
+    }
+  }
+  ASSERT_EQ(swclock_jsonld_flush(logger), 0);
+  uint64_t raw = 0, written = 0;
+  swclock_jsonld_get_stream_bytes(logger, &raw, &written);
+
+  // The file is plain multi-member gzip with every entry
+  EXPECT_EQ(count_gz_lines(path), kEntries);
+  struct stat sb;
+  ASSERT_EQ(stat(path, &sb), 0);
+  EXPECT_EQ((uint64_t)sb.st_size, written);
+  EXPECT_GT(raw, 5 * written);
+
+  // The index covers the file frame by frame
+  FILE* f = fopen(index_path, "rb");
+  ASSERT_NE(f, nullptr);
+  swclock_jsonld_index_header_t hdr;
+  ASSERT_EQ(fread(&hdr, sizeof(hdr), 1, f), 1u);
+  EXPECT_EQ(hdr.magic, (uint32_t)SWCLOCK_JSONLD_INDEX_MAGIC);
+  EXPECT_EQ(hdr.entry_size, sizeof(swclock_jsonld_index_entry_t));
+  std::vector<swclock_jsonld_index_entry_t> frames;
+  swclock_jsonld_index_entry_t e;
+  while (fread(&e, sizeof(e), 1, f) == 1) frames.push_back(e);
+  fclose(f);
+  ASSERT_GT(frames.size(), 10u);
+  uint64_t offset = 0, entries = 0, raw_sum = 0;
+  for (size_t i = 0; i < frames.size(); i++) {
+    EXPECT_EQ(frames[i].offset, offset);
+    if (i > 0) {
+      EXPECT_GT(frames[i].timestamp_ns, frames[i - 1].timestamp_ns);
+    }
+    offset += frames[i].size;
+    entries += frames[i].entries;
+    raw_sum += frames[i].raw_size;
+  }
+  EXPECT_EQ(offset, (uint64_t)sb.st_size);
+  EXPECT_EQ(entries, (uint64_t)kEntries);
+  EXPECT_EQ(raw_sum, raw);
+
+  // Jump into a frame in the middle and inflate just that frame
+  const swclock_jsonld_index_entry_t& mid = frames[frames.size() / 2];
+  f = fopen(path, "rb");
+  ASSERT_NE(f, nullptr);
+  std::vector<unsigned char> member(mid.size);
+  ASSERT_EQ(fseek(f, (long)mid.offset, SEEK_SET), 0);
+  ASSERT_EQ(fread(member.data(), 1, member.size(), f), member.size());
+  fclose(f);
+  std::string text = gunzip_member(member);
+  EXPECT_EQ(text.size(), (size_t)mid.raw_size);
+  EXPECT_EQ((uint32_t)std::count(text.begin(), text.end(), '\n'), mid.entries);
+  char first_ts[64];
+  snprintf(first_ts, sizeof(first_ts), "\"timestamp_monotonic_ns\":%llu,", (unsigned long long)mid.timestamp_ns);
+  EXPECT_EQ(text.find(first_ts), text.find("\"timestamp_monotonic_ns\":"));
+
+  // A crash mid-frame: every complete frame before it still reads back
+  const swclock_jsonld_index_entry_t& last = frames.back();
+  snprintf(name, sizeof(name), "%s.1", path);
+  {
+    FILE* in = fopen(path, "rb");
+    FILE* out = fopen(name, "wb");
+    ASSERT_TRUE(in && out);
+    std::vector<char> data(last.offset + last.size / 2);
+    ASSERT_EQ(fread(data.data(), 1, data.size(), in), data.size());
+    fwrite(data.data(), 1, data.size(), out);
+    fclose(in);
+    fclose(out);
+  }
+  EXPECT_GE(count_gz_lines(name), kEntries - (int)last.entries);
+  unlink(name);
+
+  // Rotation moves the log and its index to .1 without recompressing
+  ASSERT_EQ(swclock_jsonld_rotate(logger), 0);
+  swclock_jsonld_rotation_stats_t st;
+  for (int i = 0; i < 2000; i++) {
+    swclock_jsonld_get_rotation_stats(logger, &st);
+    if (st.pending == 0) break;
+    usleep(5000);
+  }
+  EXPECT_EQ(st.compressed, 0u);
+  swclock_jsonld_log_system(logger, ts, "after_rotation", "{}");
+  swclock_jsonld_close(logger);
+  EXPECT_EQ(stat(name, &sb), 0);
+  EXPECT_EQ(count_gz_lines(name), kEntries);
+  snprintf(name, sizeof(name), "%s.1%s", path, SWCLOCK_JSONLD_INDEX_SUFFIX);
+  EXPECT_EQ(stat(name, &sb), 0);
+  snprintf(name, sizeof(name), "%s.1.gz", path);
+  EXPECT_NE(stat(name, &sb), 0);
+  EXPECT_EQ(count_gz_lines(path), 1);
+
+  // Reopened after a crash mid-frame and mid-index-entry: both tails are
+  // cut off, so frames appended now read back after the complete ones
+  {
+    snprintf(name, sizeof(name), "%s.1", path);
+    FILE* in = fopen(name, "rb");
+    FILE* out = fopen(path, "ab");
+    FILE* idx = fopen(index_path, "ab");
+    ASSERT_TRUE(in && out && idx);
+    std::vector<char> data(last.size / 2);
+    ASSERT_EQ(fseek(in, (long)last.offset, SEEK_SET), 0);
+    ASSERT_EQ(fread(data.data(), 1, data.size(), in), data.size());
+    fwrite(data.data(), 1, data.size(), out);
+    const char partial[10] = {0};
+    fwrite(partial, 1, sizeof(partial), idx);
+    fclose(in);
+    fclose(out);
+    fclose(idx);
+  }
+  logger = swclock_jsonld_init(path, &rotation, nullptr);
+  ASSERT_NE(logger, nullptr);
+  for (int i = 0; i < 10; i++) {
+    swclock_jsonld_log_system(logger, ts + i, "after_crash", "{}");
+  }
+  swclock_jsonld_close(logger);
+  EXPECT_EQ(count_gz_lines(path), 11);
+  ASSERT_EQ(stat(path, &sb), 0);
+  f = fopen(index_path, "rb");
+  ASSERT_NE(f, nullptr);
+  ASSERT_EQ(fread(&hdr, sizeof(hdr), 1, f), 1u);
+  offset = 0;
+  while (fread(&e, sizeof(e), 1, f) == 1) {
+    EXPECT_EQ(e.offset, offset);
+    offset += e.size;
+  }
+  EXPECT_EQ(ftell(f), (long)(sizeof(hdr) + 2 * sizeof(e)));
+  fclose(f);
+  EXPECT_EQ(offset, (uint64_t)sb.st_size);
+  cleanup();
+
+  printf("  jsonld stream: %llu entry bytes -> %llu written (%.1fx less), %zu frames of %.1f KB\n",
+         (unsigned long long)raw, (unsigned long long)written, (double)raw / (double)written,
+         frames.size(), (double)written / (double)frames.size() / 1024.0);
+}
+
+TEST(JsonLd, ThreadContention) {
+  char path[128];
+  snprintf(path, sizeof(path), "/tmp/swclock_jsoncont_%d.jsonl", (int)getpid());
+  unlink(path);
+  swclock_log_rotation_t rotation;
+  memset(&rotation, 0, sizeof(rotation));
+  swclock_jsonld_logger_t* logger = swclock_jsonld_init(path, &rotation, nullptr);
+  ASSERT_NE(logger, nullptr);
+
+  // Callers log PI updates tagged (kp = caller, error_s = index); every
+  // round of threads exits, so later rounds reuse the per-thread buffers
+  const int kCalls = 2000;
+  int caller = 0;
+  uint64_t total = 0;
+  for (int n = 1; n <= 32; n *= 2) {
+    std::vector<std::thread> threads;
+    std::vector<std::vector<long long>> lat(n);
+    std::atomic<int> failed(0);
+    const uint64_t dropped_before = swclock_jsonld_get_dropped(logger);
+    long long t0 = mono_ns();
+    for (int t = 0; t < n; t++) {
+      threads.emplace_back([&, t, id = caller + t] {
+        lat[t].reserve(kCalls);
+        for (int i = 0; i < kCalls; i++) {
+          long long c0 = mono_ns();
+          if (swclock_jsonld_log_pi_update(logger, 1000000000ULL * 1700000000ULL + i, id, 0, i, 0, 0) != 0) {
+            failed++;
+          }
+          lat[t].push_back(mono_ns() - c0);
+          if (i % 50 == 49) usleep(1000);
+        }
+      });
+    }
+    for (auto& th : threads) th.join();
+    long long elapsed = mono_ns() - t0;
+    caller += n;
+    total += (uint64_t)n * kCalls;
+
+    std::vector<long long> all;
+    for (auto& v : lat) all.insert(all.end(), v.begin(), v.end());
+    std::sort(all.begin(), all.end());
+    double mean = 0;
+    for (long long v : all) mean += (double)v;
+    mean /= (double)all.size();
+    printf("  jsonld %2d threads: mean %4.0f ns, p50 %4lld ns, p99 %6lld ns per call, %.0f calls/s, %llu dropped\n",
+           n, mean, all[all.size() / 2], all[all.size() * 99 / 100], (double)all.size() * 1e9 / (double)elapsed,
+           (unsigned long long)(swclock_jsonld_get_dropped(logger) - dropped_before));
+    EXPECT_EQ((uint64_t)failed.load(), swclock_jsonld_get_dropped(logger) - dropped_before);
+  }
+  ASSERT_EQ(swclock_jsonld_flush(logger), 0);
+  const uint64_t dropped = swclock_jsonld_get_dropped(logger);
+  EXPECT_EQ(swclock_jsonld_get_count(logger) + dropped, total);
+  swclock_jsonld_close(logger);
+
+  // Each caller's entries are in its own order; callers interleave
+  FILE* f = fopen(path, "r");
+  ASSERT_NE(f, nullptr);
+  std::vector<int> last(caller, -1);
+  uint64_t lines = 0, bad = 0;
+  char line[4096];
+  while (fgets(line, sizeof(line), f)) {
+    const char* kp = strstr(line, "\"kp\":");
+    const char* err = strstr(line, "\"error_s\":");
+    lines++;
+    if (!kp || !err) {
+      bad++;
+      continue;
+    }
+    int t = (int)atof(kp + 5), i = (int)atof(err + 10);
+    if (t < 0 || t >= caller || i <= last[t]) bad++;
+    else last[t] = i;
+  }
+  fclose(f);
+  unlink(path);
+  EXPECT_EQ(lines + dropped, total);
+  EXPECT_EQ(bad, 0u);
+}
@@ -0,0 +1,325 @@
+// tests_poll.cpp — background poll scheduling
+// - Shared poll scheduler: every registered clock is polled at SWCLOCK_POLL_NS
+// - Shared poll scheduler: a long tick on one worker does not hold up other tasks' deadlines
+// - Per-clock threads vs. shared scheduler: CPU usage and poll jitter vs. instance count
+// - Absolute-deadline polling and the wakeup-lateness / poll-duration histograms
+// - Adaptive poll rate: idle back-off, immediate wakeup on adjtime, slew unaffected
+
+#include <gtest/gtest.h>
+#include <time.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "sw_clock.h"
+#include "sw_clock_scheduler.h"
+
+// Largest instance count in the scaling benchmark
+#ifndef BENCH_POLL_MAX_CLOCKS
+#define BENCH_POLL_MAX_CLOCKS 256
+#endif
+
+// Measurement window per configuration (ms)
+#ifndef BENCH_POLL_WINDOW_MS
+#define BENCH_POLL_WINDOW_MS 1000
+#endif
+
+// Shared-scheduler CPU at the largest count may not exceed per-clock threads by more than this
+#ifndef BENCH_POLL_MAX_CPU_RATIO
+#define BENCH_POLL_MAX_CPU_RATIO 1.5
+#endif
+
+static inline long long process_cpu_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts_to_ns(&ts);
+}
+
+// Clocks without file logging so the benchmark measures polling, not I/O
+class QuietClocks {
+public:
+  QuietClocks() {
+    const char* v = getenv("SWCLOCK_DISABLE_JSONLD");
+    had_jsonld_ = (v != nullptr);
+    if (had_jsonld_) saved_jsonld_ = v;
+    setenv("SWCLOCK_DISABLE_JSONLD", "1", 1);
+  }
+  ~QuietClocks() {
+    for (SwClock* c : clocks) swclock_destroy(c);
+    if (had_jsonld_) setenv("SWCLOCK_DISABLE_JSONLD", saved_jsonld_.c_str(), 1);
+    else unsetenv("SWCLOCK_DISABLE_JSONLD");
+    swclock_use_shared_scheduler(0);
+  }
+  void create(int n) {
+    for (int i = 0; i < n; i++) {
+      SwClock* c = swclock_create();
+      ASSERT_NE(c, nullptr);
+      clocks.push_back(c);
+    }
+  }
+  void destroy_all() {
+    for (SwClock* c : clocks) swclock_destroy(c);
+    clocks.clear();
+  }
+  std::vector<SwClock*> clocks;
+private:
+  bool had_jsonld_ = false;
+  std::string saved_jsonld_;
+};
+
+TEST(Poll, SharedSchedulerPollsEveryClock) {
+  QuietClocks q;
+  ASSERT_EQ(swclock_use_shared_scheduler(2), 0);
+  q.create(32);
+
+  usleep(500 * 1000);
+
+  for (SwClock* c : q.clocks) {
+    swclock_poll_stats_t st;
+    ASSERT_EQ(swclock_get_poll_stats(c, &st), 0);
+    EXPECT_TRUE(st.shared_scheduler);
+    // ~50 polls expected in 500 ms at 100 Hz
+    EXPECT_GE(st.polls, 25u);
+  }
+
+  // Destroying while ticks are in flight must not race the workers
+  q.destroy_all();
+
+  ASSERT_EQ(swclock_use_shared_scheduler(0), 0);
+  q.create(1);
+  swclock_poll_stats_t st;
+  ASSERT_EQ(swclock_get_poll_stats(q.clocks[0], &st), 0);
+  EXPECT_FALSE(st.shared_scheduler);
+
+  EXPECT_EQ(swclock_use_shared_scheduler(100000), -1);
+}
+
+// A worker busy in a long tick must leave the other task's deadlines to an
+// idle worker instead of running them late after the tick returns
+static int64_t sched_slow_tick(void* arg, int64_t) {
+  ((std::atomic<int>*)arg)->fetch_add(1);
+  usleep(100 * 1000);
+  return 0;
+}
+
+static int64_t sched_fast_tick(void* arg, int64_t) {
+  ((std::atomic<int>*)arg)->fetch_add(1);
+  return 0;
+}
+
+TEST(Poll, SharedSchedulerLongTickDoesNotStallOthers) {
+  swclock_scheduler_t* s = swclock_scheduler_create(2);
+  ASSERT_NE(s, nullptr);
+
+  std::atomic<int> slow{0}, fast{0};
+  swclock_sched_task_t* a = swclock_scheduler_add(s, 10 * 1000 * 1000, sched_slow_tick, &slow);
+  usleep(5 * 1000);  // out of phase: b is not due when a is taken
+  swclock_sched_task_t* b = swclock_scheduler_add(s, 10 * 1000 * 1000, sched_fast_tick, &fast);
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+
+  usleep(500 * 1000);
+  swclock_scheduler_remove(s, b);
+  swclock_scheduler_remove(s, a);
+  swclock_scheduler_destroy(s);
+
+  printf("  500 ms, 10 ms period: slow (100 ms) ticks=%d, fast ticks=%d\n", slow.load(), fast.load());
+  EXPECT_GE(slow.load(), 2);
+  // ~50 expected; one run per slow tick if the second worker never took the timer
+  EXPECT_GE(fast.load(), 25);
+}
+
+struct PollBenchResult {
+  double cpu_pct;            // process CPU over the window, % of one core
+  double mean_late_us;       // mean over clocks of mean wakeup lateness
+  double p99_late_us;        // max over clocks of p99 wakeup lateness
+  double max_late_us;        // max over clocks
+  unsigned long long polls;  // total polls
+};
+
+static PollBenchResult run_poll_bench(int n, unsigned shared_threads) {
+  PollBenchResult r = {};
+  QuietClocks q;
+  swclock_use_shared_scheduler(shared_threads);
+  q.create(n);
+
+  usleep(100 * 1000);  // settle
+
+  struct timespec w0, w1;
+  clock_gettime(CLOCK_MONOTONIC, &w0);
+  long long cpu0 = process_cpu_ns();
+  usleep(BENCH_POLL_WINDOW_MS * 1000);
+  long long cpu1 = process_cpu_ns();
+  clock_gettime(CLOCK_MONOTONIC, &w1);
+
+  r.cpu_pct = 100.0 * (double)(cpu1 - cpu0) / (double)(ts_to_ns(&w1) - ts_to_ns(&w0));
+
+  double sum_mean = 0.0;
+  for (SwClock* c : q.clocks) {
+    swclock_poll_stats_t st;
+    swclock_get_poll_stats(c, &st);
+    sum_mean += (double)swclock_histogram_mean_ns(&st.wake_late) / 1e3;
+    r.p99_late_us = std::max(r.p99_late_us,
+                             (double)swclock_histogram_quantile_ns(&st.wake_late, 0.99) / 1e3);
+    r.max_late_us = std::max(r.max_late_us, (double)st.wake_late.max_ns / 1e3);
+    r.polls += st.polls;
+  }
+  r.mean_late_us = sum_mean / (double)n;
+  return r;
+}
+
+TEST(Poll, SchedulerScalingBenchmark) {
+  std::vector<int> counts;
+  for (int n = 1; n <= BENCH_POLL_MAX_CLOCKS; n *= 4) counts.push_back(n);
+  if (counts.back() != BENCH_POLL_MAX_CLOCKS) counts.push_back(BENCH_POLL_MAX_CLOCKS);
+
+  printf("\n  %8s | %-22s | %8s | %12s | %11s | %11s | %9s\n",
+         "clocks", "mode", "CPU %", "mean late us", "p99 late us", "max late us", "polls/clk");
+
+  PollBenchResult last_threads = {}, last_shared = {};
+  for (int n : counts) {
+    for (unsigned shared : {0u, 1u, 2u}) {
+      PollBenchResult r = run_poll_bench(n, shared);
+      char mode[32];
+      if (shared == 0) snprintf(mode, sizeof(mode), "thread per clock");
+      else snprintf(mode, sizeof(mode), "shared, %u worker%s", shared, shared > 1 ? "s" : "");
+      printf("  %8d | %-22s | %8.2f | %12.1f | %11.1f | %11.1f | %9.1f\n",
+             n, mode, r.cpu_pct, r.mean_late_us, r.p99_late_us, r.max_late_us,
+             (double)r.polls / n);
+
+      // Every clock keeps being polled in every mode
+      EXPECT_GT(r.polls, 0u);
+      if (n == BENCH_POLL_MAX_CLOCKS) {
+        if (shared == 0) last_threads = r;
+        if (shared == 1) last_shared = r;
+      }
+    }
+  }
+
+  EXPECT_LE(last_shared.cpu_pct, last_threads.cpu_pct * BENCH_POLL_MAX_CPU_RATIO + 1.0)
+      << "shared scheduler used more CPU than one thread per clock";
+}
+
+TEST(Poll, HistogramBuckets) {
+  swclock_histogram_t h;
+  memset(&h, 0, sizeof(h));
+
+  const int64_t samples[] = { -5, 0, 1, 2, 3, 1000, 1LL << 40 };
+  for (int64_t v : samples) swclock_histogram_record(&h, v);
+
+  EXPECT_EQ(h.count, 7u);
+  EXPECT_EQ(h.buckets[0], 2u);                        // -5 (clamped) and 0
+  EXPECT_EQ(h.buckets[1], 1u);                        // [1, 2)
+  EXPECT_EQ(h.buckets[2], 2u);                        // [2, 4)
+  EXPECT_EQ(h.buckets[10], 1u);                       // [512, 1024)
+  EXPECT_EQ(h.buckets[SWCLOCK_HIST_BUCKETS - 1], 1u); // saturating top bucket
+  EXPECT_EQ(h.max_ns, 1ULL << 40);
+
+  EXPECT_EQ(swclock_histogram_bucket_limit_ns(10), 1024u);
+  EXPECT_EQ(swclock_histogram_bucket_limit_ns(SWCLOCK_HIST_BUCKETS - 1), UINT64_MAX);
+
+  EXPECT_EQ(swclock_histogram_quantile_ns(&h, 0.5), 4u);         // 4th of 7 is in [2, 4)
+  EXPECT_EQ(swclock_histogram_quantile_ns(&h, 1.0), 1ULL << 40); // clamped to max
+  EXPECT_EQ(swclock_histogram_mean_ns(&h), ((1ULL << 40) + 1006) / 7);
+
+  swclock_histogram_t empty;
+  memset(&empty, 0, sizeof(empty));
+  EXPECT_EQ(swclock_histogram_quantile_ns(&empty, 0.99), 0u);
+}
+
+TEST(Poll, AbsoluteDeadlinePollTiming) {
+  for (unsigned shared : {0u, 1u}) {
+    QuietClocks q;
+    swclock_use_shared_scheduler(shared);
+    q.create(1);
+
+    long long t0 = monotonic_now_ns();
+    usleep(1000 * 1000);
+    swclock_poll_stats_t st;
+    ASSERT_EQ(swclock_get_poll_stats(q.clocks[0], &st), 0);
+    long long t1 = monotonic_now_ns();
+
+    // Deadlines on a fixed grid: one poll per elapsed period, minus skipped overruns
+    double expected = (double)(t1 - t0) / (double)(SWCLOCK_POLL_NS);
+    printf("  %-16s polls=%llu (expected ~%.0f) overruns=%llu late p50=%.1f us p99=%.1f us "
+           "max=%.1f us, duration p50=%.1f us max=%.1f us\n",
+           shared ? "shared scheduler" : "poll thread",
+           (unsigned long long)st.polls, expected, (unsigned long long)st.overruns,
+           swclock_histogram_quantile_ns(&st.wake_late, 0.5) / 1e3,
+           swclock_histogram_quantile_ns(&st.wake_late, 0.99) / 1e3,
+           st.wake_late.max_ns / 1e3,
+           swclock_histogram_quantile_ns(&st.duration, 0.5) / 1e3,
+           st.duration.max_ns / 1e3);
+
+    EXPECT_GE((double)(st.polls + st.overruns), expected * 0.9);
+    EXPECT_EQ(st.wake_late.count, st.polls);
+    EXPECT_EQ(st.duration.count, st.polls);
+    EXPECT_LT(swclock_histogram_quantile_ns(&st.wake_late, 0.5), (uint64_t)(SWCLOCK_POLL_NS) / 4);
+  }
+}
+
+static long long clock_offset_ns(SwClock* a, SwClock* b) {
+  struct timespec ta, tb;
+  swclock_gettime(a, CLOCK_REALTIME, &ta);
+  swclock_gettime(b, CLOCK_REALTIME, &tb);
+  return ts_to_ns(&tb) - ts_to_ns(&ta);
+}
+
+TEST(Poll, AdaptivePollBacksOffAndWakesOnAdjtime) {
+  const int64_t ceiling_ns = 320LL * 1000 * 1000;
+
+  for (unsigned shared : {0u, 1u}) {
+    SCOPED_TRACE(shared ? "shared scheduler" : "poll thread");
+    QuietClocks q;
+    swclock_use_shared_scheduler(shared);
+    q.create(2);
+    SwClock* fixed = q.clocks[0];
+    SwClock* adaptive = q.clocks[1];
+    ASSERT_EQ(swclock_set_adaptive_poll(adaptive, ceiling_ns), 0);
+    EXPECT_EQ(swclock_set_adaptive_poll(adaptive, SWCLOCK_POLL_MAX_PERIOD_NS + 1), -1);
+
+    // Idle: 10, 20, 40, ... ms up to the ceiling
+    usleep(1000 * 1000);
+    swclock_poll_stats_t idle;
+    ASSERT_EQ(swclock_get_poll_stats(adaptive, &idle), 0);
+    EXPECT_EQ(idle.period_ns, ceiling_ns);
+    EXPECT_LT(idle.polls, 15u);  // vs. ~100 at the fixed rate
+
+    // adjtime wakes the backed-off poller instead of waiting out the ceiling
+    long long offset_before = clock_offset_ns(fixed, adaptive);
+    struct timex tx = {};
+    tx.modes  = ADJ_OFFSET | ADJ_MICRO;
+    tx.offset = 100;  // 100 us slew on both clocks
+    ASSERT_EQ(swclock_adjtime(fixed, &tx), TIME_OK);
+    tx.modes  = ADJ_OFFSET | ADJ_MICRO;
+    tx.offset = 100;
+    ASSERT_EQ(swclock_adjtime(adaptive, &tx), TIME_OK);
+
+    long long t0 = monotonic_now_ns();
+    swclock_poll_stats_t st;
+    do {
+      usleep(1000);
+      swclock_get_poll_stats(adaptive, &st);
+    } while (st.polls == idle.polls && monotonic_now_ns() - t0 < ceiling_ns);
+    long long wake_ms = (monotonic_now_ns() - t0) / 1000000;
+    printf("  %-16s idle polls=%llu, first poll %lld ms after adjtime\n",
+           shared ? "shared scheduler" : "poll thread", (unsigned long long)idle.polls, wake_ms);
+    EXPECT_LT(wake_ms, 50);
+    EXPECT_EQ(st.period_ns, (int64_t)(SWCLOCK_POLL_NS));
+
+    // Slew completes identically at the variable rate, then backs off again
+    usleep(2500 * 1000);
+    EXPECT_EQ(swclock_get_remaining_phase_ns(adaptive), 0);
+    EXPECT_EQ(swclock_get_remaining_phase_ns(fixed), 0);
+    long long offset_after = clock_offset_ns(fixed, adaptive);
+    EXPECT_NEAR((double)(offset_after - offset_before), 0.0, 10000.0);
+
+    ASSERT_EQ(swclock_get_poll_stats(adaptive, &st), 0);
+    EXPECT_EQ(st.period_ns, ceiling_ns);
+  }
+}
@@ -0,0 +1,806 @@
+// tests_timebase.cpp — read-path (timebase) correctness and throughput
+// - Lock-free seqlock snapshot consistency under concurrent writers
+// - Multi-threaded swclock_gettime() ns/call scaling
+// - Shared-memory timebase page read from this and a forked process; one live writer per name, stale-page takeover
+// - Fixed-point mult/shift extrapolation accuracy and cost vs. double factor
+// - Calibrated TSC raw source: tracking vs. MONOTONIC_RAW, no step when switching back, read cost
+// - Batched raw->disciplined conversion: kernel equivalence and per-element cost
+// - Timebase history: delayed conversion matches conversion at capture time
+// - Read-path L1D misses while another core polls (struct SwClock layout; Linux perf counters)
+
+#include <gtest/gtest.h>
+#include <time.h>
+#include <math.h>
+#include <pthread.h>
+#include <vector>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#endif
+
+#include "sw_clock.h"
+#include "sw_clock_batch.h"
+
+#ifndef NS_PER_SEC
+#define NS_PER_SEC 1000000000LL
+#endif
+
+// Calls per thread for the read-throughput benchmark
+#ifndef BENCH_GETTIME_CALLS
+#define BENCH_GETTIME_CALLS 200000
+#endif
+
+// Allowed ns/call growth from 1 to 64 threads (lock-free readers should stay flat)
+#ifndef BENCH_GETTIME_MAX_SCALING
+#define BENCH_GETTIME_MAX_SCALING 4.0
+#endif
+
+// Extrapolation calls for the fixed-point vs. double benchmark
+#ifndef BENCH_EXTRAP_CALLS
+#define BENCH_EXTRAP_CALLS 10000000
+#endif
+
+// Upper bound for a TSC-backed swclock_gettime() relative to the
+// clock_gettime-backed one (same build, same run)
+#ifndef BENCH_TSC_GETTIME_MAX_RATIO
+#define BENCH_TSC_GETTIME_MAX_RATIO 1.5
+#endif
+
+// Elements per batch-conversion benchmark pass
+#ifndef BENCH_BATCH_ELEMENTS
+#define BENCH_BATCH_ELEMENTS (1 << 20)
+#endif
+
+// Upper bound on reader L1D misses per concurrent poll: with the timebase on
+// its own cache line a reader refetches about one line per publish
+#ifndef BENCH_READ_MISSES_PER_POLL_MAX
+#define BENCH_READ_MISSES_PER_POLL_MAX 3.0
+#endif
+
+static inline long long thread_cpu_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts_to_ns(&ts);
+}
+
+struct ReaderArgs {
+  SwClock* clk;
+  long calls;
+  std::atomic<bool>* go;
+  double ns_per_call;
+  long long errors;
+};
+
+static void* gettime_reader_main(void* arg) {
+  ReaderArgs* a = (ReaderArgs*)arg;
+  while (!a->go->load(std::memory_order_acquire)) { /* spin until all threads exist */ }
+
+  struct timespec ts;
+  long long t0 = thread_cpu_ns();
+  for (long i = 0; i < a->calls; i++) {
+    if (swclock_gettime(a->clk, CLOCK_REALTIME, &ts) != 0) a->errors++;
+  }
+  long long t1 = thread_cpu_ns();
+
+  a->ns_per_call = (double)(t1 - t0) / (double)a->calls;
+  return nullptr;
+}
+
+// Run `nthreads` concurrent readers and return the mean per-thread ns/call.
+static double run_gettime_readers(SwClock* clk, int nthreads, long calls, long long* errors) {
+  std::vector<pthread_t> threads(nthreads);
+  std::vector<ReaderArgs> args(nthreads);
+  std::atomic<bool> go(false);
+
+  for (int i = 0; i < nthreads; i++) {
+    args[i] = ReaderArgs{clk, calls, &go, 0.0, 0};
+    pthread_create(&threads[i], nullptr, gettime_reader_main, &args[i]);
+  }
+  go.store(true, std::memory_order_release);
+
+  double sum = 0.0;
+  for (int i = 0; i < nthreads; i++) {
+    pthread_join(threads[i], nullptr);
+    sum += args[i].ns_per_call;
+    *errors += args[i].errors;
+  }
+  return sum / (double)nthreads;
+}
+
+struct ConsistencyArgs {
+  SwClock* clk;
+  std::atomic<bool>* stop;
+  long long max_backstep_ns;
+  long long reads;
+};
+
+static void* consistency_reader_main(void* arg) {
+  ConsistencyArgs* a = (ConsistencyArgs*)arg;
+  struct timespec ts;
+  swclock_gettime(a->clk, CLOCK_MONOTONIC, &ts);
+  long long prev = ts_to_ns(&ts);
+  while (!a->stop->load(std::memory_order_acquire)) {
+    swclock_gettime(a->clk, CLOCK_MONOTONIC, &ts);
+    long long now = ts_to_ns(&ts);
+    if (prev - now > a->max_backstep_ns) a->max_backstep_ns = prev - now;
+    prev = now;
+    a->reads++;
+  }
+  return nullptr;
+}
+
+TEST(Timebase, GettimeConsistentDuringAdjustments) {
+  SwClock* clk = swclock_create();
+  ASSERT_NE(clk, nullptr);
+
+  // Readers hammer gettime while this thread keeps republishing via adjtime.
+  std::atomic<bool> stop(false);
+  pthread_t threads[4];
+  ConsistencyArgs args[4];
+  for (int i = 0; i < 4; i++) {
+    args[i] = ConsistencyArgs{clk, &stop, 0, 0};
+    pthread_create(&threads[i], nullptr, consistency_reader_main, &args[i]);
+  }
+
+  for (int i = 0; i < 200; i++) {
+    struct timex tx = {};
+    tx.modes = ADJ_FREQUENCY;
+    tx.freq  = (i & 1) ? (long)(5.0 * 65536.0) : (long)(-5.0 * 65536.0);
+    swclock_adjtime(clk, &tx);
+    sleep_ns(1000 * 1000);
+  }
+
+  stop.store(true, std::memory_order_release);
+  long long max_backstep_ns = 0, reads = 0;
+  for (int i = 0; i < 4; i++) {
+    pthread_join(threads[i], nullptr);
+    if (args[i].max_backstep_ns > max_backstep_ns) max_backstep_ns = args[i].max_backstep_ns;
+    reads += args[i].reads;
+  }
+
+  printf("\n=== Timebase consistency: %lld reads, max MONOTONIC back-step = %lld ns ===\n",
+         reads, max_backstep_ns);
+
+  // A torn snapshot (new base with old reference) shows up as a back-step of
+  // about one rebase interval (~1 ms). Legitimate rate changes while a reader
+  // is preempted account for at most a few hundred ns.
+  EXPECT_LT(max_backstep_ns, 10 * 1000);
+
+  swclock_destroy(clk);
+}
+
+TEST(Timebase, GettimeReadScaling) {
+  SwClock* clk = swclock_create();
+  ASSERT_NE(clk, nullptr);
+
+  // Keep the servo busy so the poll thread publishes new snapshots every tick.
+  struct timex tx = {};
+  tx.modes  = ADJ_OFFSET | ADJ_MICRO;
+  tx.offset = 100000;
+  swclock_adjtime(clk, &tx);
+
+  const int thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+  double ns_1 = 0.0, ns_64 = 0.0;
+  long long errors = 0;
+
+  printf("\n=== swclock_gettime() read scaling (%d calls/thread) ===\n", BENCH_GETTIME_CALLS);
+  printf("  %8s  %12s\n", "threads", "ns/call");
+  for (int n : thread_counts) {
+    double ns = run_gettime_readers(clk, n, BENCH_GETTIME_CALLS, &errors);
+    printf("  %8d  %12.1f\n", n, ns);
+    if (n == 1)  ns_1 = ns;
+    if (n == 64) ns_64 = ns;
+  }
+  printf("  scaling 64/1 = %.2fx (limit %.1fx)\n", ns_64 / ns_1, BENCH_GETTIME_MAX_SCALING);
+
+  EXPECT_EQ(errors, 0);
+  EXPECT_LT(ns_64, ns_1 * BENCH_GETTIME_MAX_SCALING);
+
+  swclock_destroy(clk);
+}
+
+TEST(Timebase, SharedMemoryReaderMatchesOwner) {
+  SwClock* clk = swclock_create();
+  ASSERT_NE(clk, nullptr);
+
+  char name[64];
+  snprintf(name, sizeof(name), "/swclock_gtest_%d", (int)getpid());
+  ASSERT_EQ(swclock_enable_shm(clk, name), 0) << strerror(errno);
+  EXPECT_EQ(swclock_enable_shm(clk, name), -1);  // already enabled
+
+  swclock_shm_reader_t* r = swclock_shm_open(name);
+  ASSERT_NE(r, nullptr) << strerror(errno);
+
+  // Step REALTIME so that a stale or unpublished page would be obvious.
+  struct timex tx = {};
+  tx.modes        = ADJ_SETOFFSET | ADJ_MICRO;
+  tx.time.tv_usec = 500000;
+  tx.offset       = 500000;
+  swclock_adjtime(clk, &tx);
+
+  // Same extrapolation on both sides: reads must interleave monotonically.
+  for (clockid_t id : {CLOCK_REALTIME, CLOCK_MONOTONIC}) {
+    struct timespec a, b, c;
+    swclock_shm_gettime(r, id, &a);
+    swclock_gettime(clk, id, &b);
+    swclock_shm_gettime(r, id, &c);
+    EXPECT_LE(ts_to_ns(&a), ts_to_ns(&b));
+    EXPECT_LE(ts_to_ns(&b), ts_to_ns(&c));
+  }
+
+  // Reader in another process
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  struct timespec before, after;
+  swclock_gettime(clk, CLOCK_REALTIME, &before);
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    long long child_ns = -1;
+    swclock_shm_reader_t* cr = swclock_shm_open(name);
+    struct timespec ts;
+    if (cr && swclock_shm_gettime(cr, CLOCK_REALTIME, &ts) == 0) child_ns = ts_to_ns(&ts);
+    ssize_t n = write(fds[1], &child_ns, sizeof(child_ns));
+    (void)n;
+    _exit(0);
+  }
+  long long child_ns = -1;
+  ASSERT_EQ(read(fds[0], &child_ns, sizeof(child_ns)), (ssize_t)sizeof(child_ns));
+  waitpid(pid, nullptr, 0);
+  swclock_gettime(clk, CLOCK_REALTIME, &after);
+  close(fds[0]);
+  close(fds[1]);
+
+  printf("\n=== Shared-memory timebase (cross-process) ===\n");
+  printf("  owner before : %" PRId64 " ns\n  child        : %lld ns\n  owner after  : %" PRId64 " ns\n",
+         ts_to_ns(&before), child_ns, ts_to_ns(&after));
+  EXPECT_LE(ts_to_ns(&before), child_ns);
+  EXPECT_LE(child_ns, ts_to_ns(&after));
+
+  // Read cost compared to the kernel clock
+  const int N = 200000;
+  struct timespec ts;
+  long long t0 = thread_cpu_ns();
+  for (int i = 0; i < N; i++) swclock_shm_gettime(r, CLOCK_REALTIME, &ts);
+  long long t1 = thread_cpu_ns();
+  for (int i = 0; i < N; i++) clock_gettime(CLOCK_REALTIME, &ts);
+  long long t2 = thread_cpu_ns();
+  double shm_ns = (double)(t1 - t0) / N, sys_ns = (double)(t2 - t1) / N;
+  printf("  swclock_shm_gettime: %.1f ns/call, clock_gettime: %.1f ns/call\n", shm_ns, sys_ns);
+  EXPECT_LT(shm_ns, 1000.0);
+
+  swclock_shm_close(r);
+  swclock_disable_shm(clk);
+  EXPECT_EQ(swclock_shm_open(name), nullptr);
+
+  swclock_destroy(clk);
+}
+
+TEST(Timebase, SharedMemoryPageOwnership) {
+  SwClock* a = swclock_create();
+  SwClock* b = swclock_create();
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+
+  char name[64];
+  snprintf(name, sizeof(name), "/swclock_gtest_own_%d", (int)getpid());
+  ASSERT_EQ(swclock_enable_shm(a, name), 0) << strerror(errno);
+
+  // A second writer must leave a live page alone
+  errno = 0;
+  EXPECT_EQ(swclock_enable_shm(b, name), -1);
+  EXPECT_EQ(errno, EEXIST);
+  swclock_shm_reader_t* r = swclock_shm_open(name);
+  ASSERT_NE(r, nullptr) << strerror(errno);
+  swclock_shm_close(r);
+  swclock_disable_shm(a);
+  EXPECT_EQ(swclock_shm_open(name), nullptr);
+
+  // A writer that exits without unlinking leaves a stale page behind
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    SwClock* c = swclock_create();
+    _exit(c && swclock_enable_shm(c, name) == 0 ? 0 : 1);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  // It is taken over in place: a reader mapped before the takeover follows
+  // the new writer
+  r = swclock_shm_open(name);
+  ASSERT_NE(r, nullptr) << strerror(errno);
+  ASSERT_EQ(swclock_enable_shm(b, name), 0) << strerror(errno);
+  struct timespec x, y, z;
+  swclock_shm_gettime(r, CLOCK_REALTIME, &x);
+  swclock_gettime(b, CLOCK_REALTIME, &y);
+  swclock_shm_gettime(r, CLOCK_REALTIME, &z);
+  EXPECT_LE(ts_to_ns(&x), ts_to_ns(&y));
+  EXPECT_LE(ts_to_ns(&y), ts_to_ns(&z));
+
+  swclock_shm_close(r);
+  swclock_disable_shm(b);
+  EXPECT_EQ(swclock_shm_open(name), nullptr);
+
+  swclock_destroy(a);
+  swclock_destroy(b);
+}
+
+TEST(Timebase, FixedPointRateAccuracy) {
+  // Rates in ppb so the reference product can be computed exactly in integers
+  const long long rates_ppb[] = {-200000, -37500, -1, 0, 1, 5000, 100000, 200000};
+  const struct { const char* label; long long ns; } intervals[] = {
+    {"1 ms", NS_PER_MS}, {"10 ms", 10 * NS_PER_MS}, {"1 s", NS_PER_SEC},
+    {"1 h", 3600 * NS_PER_SEC}, {"1 day", 86400 * NS_PER_SEC}, {"30 days", 30 * 86400 * NS_PER_SEC},
+  };
+
+  printf("\n=== Fixed-point (shift %d) vs. double extrapolation error ===\n", SWCLOCK_RATE_SHIFT);
+  printf("  %-8s  %14s  %14s  %12s\n", "elapsed", "fixed max(ns)", "double max(ns)", "bound(ns)");
+  for (const auto& iv : intervals) {
+    long long fixed_max = 0, double_max = 0;
+    for (long long ppb : rates_ppb) {
+      double factor = 1.0 + (double)ppb / 1e9;
+      __int128 exact = (__int128)iv.ns + ((__int128)iv.ns * ppb) / 1000000000;
+
+      long long fixed = (long long)mul_u64_shr((uint64_t)iv.ns,
+                                               factor_to_mult(factor, SWCLOCK_RATE_SHIFT),
+                                               SWCLOCK_RATE_SHIFT);
+      long long dbl = (long long)((double)iv.ns * factor);
+
+      long long fe = llabs((long long)(fixed - exact));
+      long long de = llabs((long long)(dbl - exact));
+      if (fe > fixed_max) fixed_max = fe;
+      if (de > double_max) double_max = de;
+    }
+
+    // mult rounding (2^-(shift+1)) + factor rounding in double (2^-52) + truncation
+    double bound = (double)iv.ns * (ldexp(1.0, -(SWCLOCK_RATE_SHIFT + 1)) + ldexp(1.0, -52)) + 2.0;
+    printf("  %-8s  %14lld  %14lld  %12.1f\n", iv.label, fixed_max, double_max, bound);
+    EXPECT_LE((double)fixed_max, bound) << iv.label;
+  }
+}
+
+TEST(Timebase, FixedPointRateBenchmark) {
+  // Typical gettime elapsed values: up to one poll interval past the rebase
+  std::vector<uint64_t> elapsed(4096);
+  uint64_t x = 88172645463325252ULL;
+  for (auto& e : elapsed) {
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    e = x % (uint64_t)SWCLOCK_POLL_NS;
+  }
+
+  const double factor = 1.0 + 37.5e-6;
+  const uint64_t mult = factor_to_mult(factor, SWCLOCK_RATE_SHIFT);
+  volatile int64_t sink = 0;
+
+  long long t0 = thread_cpu_ns();
+  int64_t acc = 0;
+  for (long i = 0; i < BENCH_EXTRAP_CALLS; i++) {
+    acc += (int64_t)((double)(int64_t)elapsed[i & 4095] * factor);
+  }
+  sink = acc;
+  long long t1 = thread_cpu_ns();
+  acc = 0;
+  for (long i = 0; i < BENCH_EXTRAP_CALLS; i++) {
+    acc += (int64_t)mul_u64_shr(elapsed[i & 4095], mult, SWCLOCK_RATE_SHIFT);
+  }
+  sink = acc;
+  long long t2 = thread_cpu_ns();
+  (void)sink;
+
+  double double_ns = (double)(t1 - t0) / BENCH_EXTRAP_CALLS;
+  double fixed_ns  = (double)(t2 - t1) / BENCH_EXTRAP_CALLS;
+  printf("\n=== Extrapolation cost (%d calls) ===\n", BENCH_EXTRAP_CALLS);
+  printf("  double factor : %.2f ns/call\n  mult/shift    : %.2f ns/call\n", double_ns, fixed_ns);
+
+  // Integer path must not be a regression (generous margin for noisy hosts)
+  EXPECT_LT(fixed_ns, double_ns * 2.0 + 1.0);
+}
+
+static long long mono_raw_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+  return ts_to_ns(&ts);
+}
+
+TEST(Timebase, TscRawSourceTracksMonotonicRaw) {
+  if (!swclock_rawsrc_tsc_available()) {
+    GTEST_SKIP() << "no invariant TSC on this CPU";
+  }
+  ASSERT_EQ(swclock_rawsrc_select(SWCLOCK_RAWSRC_TSC), 0) << strerror(errno);
+  ASSERT_EQ(swclock_rawsrc_active(), SWCLOCK_RAWSRC_TSC);
+
+  // The SwClock poll thread drives calibration
+  SwClock* clk = swclock_create();
+  ASSERT_NE(clk, nullptr);
+
+  long long max_err_ns = 0, backsteps = 0, samples = 0;
+  long long prev_tsc = swclock_rawsrc_now_ns();
+  struct timespec ts;
+  swclock_gettime(clk, CLOCK_MONOTONIC, &ts);
+  long long prev_mono = ts_to_ns(&ts);
+
+  long long end = mono_raw_ns() + 3 * NS_PER_SEC;
+  while (mono_raw_ns() < end) {
+    // Bracket the TSC read with MONOTONIC_RAW reads; error is distance outside the bracket
+    long long r0 = mono_raw_ns();
+    long long t  = swclock_rawsrc_now_ns();
+    long long r1 = mono_raw_ns();
+    long long err = (t < r0) ? r0 - t : (t > r1) ? t - r1 : 0;
+    if (err > max_err_ns) max_err_ns = err;
+    if (t < prev_tsc) backsteps++;
+    prev_tsc = t;
+
+    swclock_gettime(clk, CLOCK_MONOTONIC, &ts);
+    if (ts_to_ns(&ts) < prev_mono) backsteps++;
+    prev_mono = ts_to_ns(&ts);
+
+    samples++;
+    sleep_ns(1000 * 1000);
+  }
+
+  swclock_rawsrc_stats_t st;
+  ASSERT_EQ(swclock_rawsrc_get_stats(&st), 0);
+  printf("\n=== TSC raw source vs. CLOCK_MONOTONIC_RAW (%lld samples) ===\n", samples);
+  printf("  tsc_hz=%.0f calibrations=%llu resyncs=%llu last_err=%lld ns max_cal_err=%lld ns\n",
+         st.tsc_hz, (unsigned long long)st.calibrations, (unsigned long long)st.resyncs,
+         (long long)st.last_error_ns, (long long)st.max_abs_error_ns);
+  printf("  max bracket error = %lld ns, back-steps = %lld\n", max_err_ns, backsteps);
+
+  EXPECT_EQ(st.source, SWCLOCK_RAWSRC_TSC);
+  EXPECT_GE(st.calibrations, 1u);
+  EXPECT_EQ(backsteps, 0);
+  EXPECT_LT(max_err_ns, 20 * 1000);
+
+  swclock_destroy(clk);
+  ASSERT_EQ(swclock_rawsrc_select(SWCLOCK_RAWSRC_CLOCK_GETTIME), 0);
+}
+
+TEST(Timebase, TscRawSourceSwitchBackDoesNotStep) {
+  if (!swclock_rawsrc_tsc_available()) {
+    GTEST_SKIP() << "no invariant TSC on this CPU";
+  }
+
+  // No clock runs calibration here, so the TSC timeline drifts off
+  // MONOTONIC_RAW by the initial frequency estimate error
+  long long backsteps = 0, max_step_ns = 0;
+  for (int round = 0; round < 4; round++) {
+    ASSERT_EQ(swclock_rawsrc_select(SWCLOCK_RAWSRC_TSC), 0) << strerror(errno);
+    sleep_ns(300 * NS_PER_MS);
+
+    long long before = swclock_rawsrc_now_ns();
+    ASSERT_EQ(swclock_rawsrc_select(SWCLOCK_RAWSRC_CLOCK_GETTIME), 0);
+    long long prev = before;
+    for (int i = 0; i < 100000; i++) {
+      long long t = swclock_rawsrc_now_ns();
+      if (t < prev) {
+        backsteps++;
+        if (prev - t > max_step_ns) max_step_ns = prev - t;
+      }
+      prev = t;
+    }
+  }
+
+  // The carried offset is slewed out
+  sleep_ns(100 * NS_PER_MS);
+  long long r0 = mono_raw_ns();
+  long long t  = swclock_rawsrc_now_ns();
+  long long r1 = mono_raw_ns();
+  long long err = (t < r0) ? r0 - t : (t > r1) ? t - r1 : 0;
+
+  printf("\n=== TSC -> clock_gettime switch ===\n");
+  printf("  back-steps = %lld (largest %lld ns), error after 100 ms = %lld ns\n",
+         backsteps, max_step_ns, err);
+  EXPECT_EQ(backsteps, 0);
+  EXPECT_LT(err, 20 * 1000);
+}
+
+TEST(Timebase, TscRawSourceReadCost) {
+  if (!swclock_rawsrc_tsc_available()) {
+    GTEST_SKIP() << "no invariant TSC on this CPU";
+  }
+
+  SwClock* clk = swclock_create();
+  ASSERT_NE(clk, nullptr);
+
+  const int N = 1000000;
+  struct timespec ts;
+  volatile long long sink = 0;
+
+  auto measure = [&](bool gettime) {
+    long long t0 = thread_cpu_ns();
+    for (int i = 0; i < N; i++) {
+      if (gettime) swclock_gettime(clk, CLOCK_REALTIME, &ts);
+      else sink = swclock_rawsrc_now_ns();
+    }
+    return (double)(thread_cpu_ns() - t0) / N;
+  };
+
+  double raw_sys = measure(false), gettime_sys = measure(true);
+  ASSERT_EQ(swclock_rawsrc_select(SWCLOCK_RAWSRC_TSC), 0);
+  double raw_tsc = measure(false), gettime_tsc = measure(true);
+  ASSERT_EQ(swclock_rawsrc_select(SWCLOCK_RAWSRC_CLOCK_GETTIME), 0);
+  (void)sink;
+
+  printf("\n=== Raw source read cost (ns/call) ===\n");
+  printf("  %-16s  %12s  %16s\n", "source", "raw read", "swclock_gettime");
+  printf("  %-16s  %12.1f  %16.1f\n", "clock_gettime", raw_sys, gettime_sys);
+  printf("  %-16s  %12.1f  %16.1f\n", "tsc", raw_tsc, gettime_tsc);
+
+  EXPECT_LT(gettime_tsc, gettime_sys * BENCH_TSC_GETTIME_MAX_RATIO);
+
+  swclock_destroy(clk);
+}
+
+TEST(Timebase, BatchConversionMatchesScalarAndGettime) {
+  // Kernel equivalence over rates of both signs and elapsed of both signs,
+  // including values past the vector kernel's exact range.
+  const int64_t ref = 5000LL * NS_PER_SEC, base = 1700000000LL * NS_PER_SEC;
+  const double rates_ppm[] = {-500.0, -37.25, -0.001, 0.0, 0.001, 12.5, 200.0, 3000.0};
+  std::vector<int64_t> raw(4099), out_s(raw.size()), out_v(raw.size());
+
+  uint64_t x = 0x9E3779B97F4A7C15ULL;
+  for (size_t i = 0; i < raw.size(); i++) {
+    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+    int64_t span = (i % 7 == 0) ? (1LL << 53) : (i % 3 == 0) ? 86400 * NS_PER_SEC : NS_PER_SEC;
+    raw[i] = ref + (int64_t)(x % (uint64_t)(2 * span)) - span;
+  }
+
+  bool have_avx2 = true;
+  for (double ppm : rates_ppm) {
+    uint64_t mult = factor_to_mult(1.0 + ppm / 1e6, SWCLOCK_RATE_SHIFT);
+    swclock_batch_convert_scalar(ref, base, mult, SWCLOCK_RATE_SHIFT, raw.data(), out_s.data(), raw.size());
+    for (size_t i = 0; i < raw.size(); i += 97) {
+      EXPECT_EQ(out_s[i], base + mul_s64_shr(raw[i] - ref, mult, SWCLOCK_RATE_SHIFT));
+    }
+    if (swclock_batch_convert_avx2(ref, base, mult, SWCLOCK_RATE_SHIFT, raw.data(), out_v.data(), raw.size()) != 0) {
+      have_avx2 = false;
+      continue;
+    }
+    size_t mismatches = 0;
+    for (size_t i = 0; i < raw.size(); i++) mismatches += (out_s[i] != out_v[i]);
+    EXPECT_EQ(mismatches, 0u) << "rate " << ppm << " ppm";
+  }
+  if (!have_avx2) printf("  (AVX2 kernel unavailable; scalar only)\n");
+
+  // Against the live clock: converting "now" lands between two gettime reads
+  SwClock* clk = swclock_create();
+  ASSERT_NE(clk, nullptr);
+  for (clockid_t id : {CLOCK_REALTIME, CLOCK_MONOTONIC}) {
+    struct timespec before, after;
+    swclock_gettime(clk, id, &before);
+    int64_t now_raw = swclock_rawsrc_now_ns(), conv = 0;
+    swclock_gettime(clk, id, &after);
+    ASSERT_EQ(swclock_raw_to_time_batch(clk, id, &now_raw, &conv, 1), 0);
+    EXPECT_LE(ts_to_ns(&before), conv + 1);
+    EXPECT_LE(conv, ts_to_ns(&after) + 1);
+  }
+  int64_t dummy = 0;
+  EXPECT_EQ(swclock_raw_to_time_batch(clk, CLOCK_PROCESS_CPUTIME_ID, &dummy, &dummy, 1), -1);
+  EXPECT_EQ(errno, EINVAL);
+  swclock_destroy(clk);
+}
+
+TEST(Timebase, BatchConversionBenchmark) {
+  SwClock* clk = swclock_create();
+  ASSERT_NE(clk, nullptr);
+
+  // Captured timestamps spread over the last 100 ms
+  const size_t n = BENCH_BATCH_ELEMENTS;
+  std::vector<int64_t> raw(n), out(n);
+  int64_t now = swclock_rawsrc_now_ns();
+  for (size_t i = 0; i < n; i++) raw[i] = now - 100 * NS_PER_MS + (int64_t)(i * (100 * NS_PER_MS / n));
+
+  struct timespec ts;
+  swclock_gettime(clk, CLOCK_REALTIME, &ts);
+  int64_t ref = ts_to_ns(&ts) - swclock_rawsrc_now_ns();
+  uint64_t mult = factor_to_mult(1.0 + 12.5e-6, SWCLOCK_RATE_SHIFT);
+
+  auto per_elem = [&](auto fn) {
+    long long best = 0;
+    for (int rep = 0; rep < 5; rep++) {
+      long long t0 = thread_cpu_ns();
+      fn();
+      long long dt = thread_cpu_ns() - t0;
+      if (rep == 0 || dt < best) best = dt;
+    }
+    return (double)best / (double)n;
+  };
+
+  double scalar_ns = per_elem([&] {
+    swclock_batch_convert_scalar(now, now + ref, mult, SWCLOCK_RATE_SHIFT, raw.data(), out.data(), n);
+  });
+  double avx2_ns = -1.0;
+  if (swclock_batch_convert_avx2(now, now + ref, mult, SWCLOCK_RATE_SHIFT, raw.data(), out.data(), n) == 0) {
+    avx2_ns = per_elem([&] {
+      swclock_batch_convert_avx2(now, now + ref, mult, SWCLOCK_RATE_SHIFT, raw.data(), out.data(), n);
+    });
+  }
+  double api_ns = per_elem([&] {
+    swclock_raw_to_time_batch(clk, CLOCK_REALTIME, raw.data(), out.data(), n);
+  });
+  double gettime_ns = per_elem([&] {
+    for (size_t i = 0; i < n; i += 16) swclock_gettime(clk, CLOCK_REALTIME, &ts);
+  }) * 16.0;
+
+  printf("\n=== Batched raw->REALTIME conversion (%zu elements, kernel %s) ===\n",
+         n, swclock_batch_kernel_name());
+  printf("  scalar kernel            : %6.2f ns/element\n", scalar_ns);
+  if (avx2_ns >= 0) printf("  avx2 kernel              : %6.2f ns/element\n", avx2_ns);
+  printf("  swclock_raw_to_time_batch: %6.2f ns/element\n", api_ns);
+  printf("  swclock_gettime (per call): %5.2f ns\n", gettime_ns);
+
+  EXPECT_LT(api_ns, gettime_ns);
+#ifdef __OPTIMIZE__
+  // Unoptimized builds keep every intrinsic's result in memory
+  if (avx2_ns >= 0) {
+    EXPECT_LT(avx2_ns, scalar_ns * 1.5);
+  }
+#endif
+
+  swclock_destroy(clk);
+}
+
+TEST(Timebase, HistoricalConversionMatchesCaptureTime) {
+  SwClock* clk = swclock_create();
+  ASSERT_NE(clk, nullptr);
+
+  // ~1.5 s of captures while the rate flips between +/-100 ppm and the clock is stepped
+  std::vector<int64_t> raw, at_capture;
+  for (int i = 0; i < 150; i++) {
+    if (i % 5 == 0) {
+      struct timex tx = {};
+      tx.modes = ADJ_FREQUENCY;
+      tx.freq  = ppm_to_ntp_freq(((i / 5) & 1) ? 100.0 : -100.0);
+      swclock_adjtime(clk, &tx);
+    }
+    if (i == 75) {
+      struct timespec now;
+      swclock_gettime(clk, CLOCK_REALTIME, &now);
+      struct timespec stepped = ns_to_ts(ts_to_ns(&now) + 10 * NS_PER_MS);
+      ASSERT_EQ(swclock_settime(clk, CLOCK_REALTIME, &stepped), 0);
+    }
+
+    int64_t r = swclock_rawsrc_now_ns(), v = 0;
+    ASSERT_EQ(swclock_raw_to_time_batch(clk, CLOCK_REALTIME, &r, &v, 1), 0);
+    raw.push_back(r);
+    at_capture.push_back(v);
+    sleep_ns(10 * NS_PER_MS);
+  }
+
+  // Delayed post-processing: everything at once, in place
+  std::vector<int64_t> later(raw);
+  EXPECT_EQ(swclock_raw_to_time_batch(clk, CLOCK_REALTIME, later.data(), later.data(), later.size()), 0);
+
+  // What the current rate and offset alone would give
+  struct timespec now;
+  swclock_gettime(clk, CLOCK_REALTIME, &now);
+  int64_t raw_now = swclock_rawsrc_now_ns();
+
+  long long max_err = 0, max_naive_err = 0;
+  for (size_t i = 0; i < raw.size(); i++) {
+    long long err   = llabs((long long)(later[i] - at_capture[i]));
+    long long naive = llabs((long long)((ts_to_ns(&now) - (raw_now - raw[i])) - at_capture[i]));
+    if (err > max_err) max_err = err;
+    if (naive > max_naive_err) max_naive_err = naive;
+  }
+
+  printf("\n=== Delayed conversion of %zu captures (rate flips + 10 ms step) ===\n", raw.size());
+  printf("  with history : max |delayed - at capture| = %lld ns\n", max_err);
+  printf("  current rate : max |delayed - at capture| = %lld ns\n", max_naive_err);
+
+  // Poll-thread publishes racing a capture differ only by rounding
+  EXPECT_LE(max_err, 2);
+  EXPECT_GT(max_naive_err, 1000 * 1000);
+
+  // Older than anything retained: extrapolated and reported
+  struct timespec ts;
+  EXPECT_EQ(swclock_raw_to_time(clk, CLOCK_REALTIME, raw[0] - 3600 * NS_PER_SEC, &ts), 1);
+
+  swclock_destroy(clk);
+}
+
+#ifdef __linux__
+
+// L1D read-miss counter for the calling thread, or -1 if unavailable
+static int open_l1d_miss_counter() {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = PERF_COUNT_HW_CACHE_L1D |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void pin_to_cpu(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+struct PollerArgs {
+  SwClock* clk;
+  std::atomic<bool>* stop;
+  long polls;
+};
+
+static void* busy_poller_main(void* arg) {
+  PollerArgs* a = (PollerArgs*)arg;
+  pin_to_cpu(1);
+  while (!a->stop->load(std::memory_order_relaxed)) {
+    swclock_poll(a->clk);
+    a->polls++;
+  }
+  return nullptr;
+}
+
+TEST(Timebase, ReadPathCacheMissesWhilePolling) {
+  if (sysconf(_SC_NPROCESSORS_ONLN) < 2) {
+    GTEST_SKIP() << "needs two CPUs to observe cross-core misses";
+  }
+  int fd = open_l1d_miss_counter();
+  if (fd < 0) {
+    GTEST_SKIP() << "L1D miss counter unavailable (perf_event_open: " << strerror(errno) << ")";
+  }
+
+  SwClock* clk = swclock_create();
+  ASSERT_NE(clk, nullptr);
+  pin_to_cpu(0);
+
+  const long N = 2000000;
+  struct timespec ts;
+  auto misses_for_reads = [&]() {
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    for (long i = 0; i < N; i++) swclock_gettime(clk, CLOCK_REALTIME, &ts);
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    long long count = 0;
+    if (read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) count = -1;
+    return count;
+  };
+
+  long long idle = misses_for_reads();
+
+  // Another core mutates writer state and publishes as fast as it can
+  std::atomic<bool> stop(false);
+  PollerArgs pa = { clk, &stop, 0 };
+  pthread_t poller;
+  ASSERT_EQ(pthread_create(&poller, nullptr, busy_poller_main, &pa), 0);
+  usleep(10000);
+  long polls0 = pa.polls;
+  long long busy = misses_for_reads();
+  long polls = pa.polls - polls0;
+  stop.store(true);
+  pthread_join(poller, nullptr);
+  close(fd);
+
+  double per_poll = polls > 0 ? (double)(busy - idle) / (double)polls : 0.0;
+  printf("\n=== swclock_gettime() L1D read misses (%ld reads) ===\n", N);
+  printf("  idle:                %lld (%.3f per 1000 reads)\n", idle, 1000.0 * idle / N);
+  printf("  concurrent polling:  %lld (%.3f per 1000 reads), %ld polls, %.2f extra misses/poll\n",
+         busy, 1000.0 * busy / N, polls, per_poll);
+
+  ASSERT_GE(idle, 0);
+  ASSERT_GE(busy, 0);
+  EXPECT_LE(per_poll, BENCH_READ_MISSES_PER_POLL_MAX);
+
+  swclock_destroy(clk);
+}
+
+#endif /* __linux__ */
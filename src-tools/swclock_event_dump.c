@@ -3,10 +3,21 @@
  * @brief SwClock event log binary dump tool
  *
  * Reads binary event log files generated by SwClock event logging and
- * converts them to human-readable text format.
+ * converts them to human-readable text, CSV, or a columnar binary file for
+ * analysis scripts. Both the fixed-size v1 records and the compact v2
+ * encoding (sw_clock_evcodec.h) are read through the mmap-based reader
+ * (sw_clock_evreader.h). Segmented logs (log.bin, log.bin.1, ...) are dumped
+ * one segment file at a time; each starts with its own file header.
  *
- * Usage: swclock_event_dump <event_log.bin> [output.txt]
- *        If output.txt is omitted, writes to stdout
+ * Usage: swclock_event_dump [--from T] [--to T] [--seq N[-M]] [--type T]
+ *                           [--format text|csv|bin] [--threads N] [--stats]
+ *                           <event_log.bin> [output]
+ *        If output is omitted, writes to stdout. Time and sequence ranges
+ *        seek via the segment's sidecar index (sw_clock_evindex.h) and only
+ *        touch the byte range that covers them.
+ *
+ * With --threads, the range is split at sync points into chunks that are
+ * decoded and formatted in parallel, then merged by sequence number.
  *
  * @author SwClock Development Team
  * @date 2025-01-19
@@ -16,199 +27,932 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <stdarg.h>
 #include <time.h>
 #include <errno.h>
+#include <stdbool.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <strings.h>
 #include "../src/sw_clock/sw_clock_events.h"
+#include "../src/sw_clock/sw_clock_evcodec.h"
+#include "../src/sw_clock/sw_clock_evindex.h"
+#include "../src/sw_clock/sw_clock_evreader.h"
+
+/** Encoded bytes per parallel decode chunk */
+#define DUMP_CHUNK_BYTES   (1u << 20)
+
+/** Rows per block of the columnar binary output */
+#define DUMP_BIN_BLOCK_ROWS 65536
+
+/** Columnar binary output file magic */
+#define DUMP_BIN_MAGIC     "SWEVCOL1"
+
+/**
+ * @brief Output format
+ */
+typedef enum {
+    DUMP_FORMAT_TEXT,
+    DUMP_FORMAT_CSV,
+    DUMP_FORMAT_BIN
+} dump_format_t;
+
+/**
+ * @brief Growable output buffer
+ */
+typedef struct {
+    char*  data;
+    size_t len;
+    size_t cap;
+} outbuf_t;
+
+static bool ob_reserve(outbuf_t* ob, size_t n) {
+    if (ob->len + n <= ob->cap) return true;
+    size_t cap = ob->cap ? ob->cap : 4096;
+    while (cap < ob->len + n) cap *= 2;
+    char* data = realloc(ob->data, cap);
+    if (!data) return false;
+    ob->data = data;
+    ob->cap = cap;
+    return true;
+}
+
+static void ob_printf(outbuf_t* ob, const char* fmt, ...) {
+    for (;;) {
+        va_list ap;
+        va_start(ap, fmt);
+        size_t room = ob->cap - ob->len;
+        int n = vsnprintf(ob->data ? ob->data + ob->len : NULL, room, fmt, ap);
+        va_end(ap);
+        if (n < 0) return;
+        if ((size_t)n < room) {
+            ob->len += (size_t)n;
+            return;
+        }
+        if (!ob_reserve(ob, (size_t)n + 1)) return;
+    }
+}
+
+/**
+ * @brief Formatting state of one thread
+ */
+typedef struct {
+    outbuf_t out;
+    int64_t  cached_sec;        /**< Second whose date prefix is cached */
+    char     date[64];          /**< "YYYY-MM-DD HH:MM:SS" of cached_sec */
+} render_t;
 
 /**
  * @brief Print formatted timestamp
  */
-static void print_timestamp(FILE* out, uint64_t ns_since_epoch) {
-    time_t sec = ns_since_epoch / 1000000000ULL;
+static void print_timestamp(render_t* rd, uint64_t ns_since_epoch) {
+    int64_t sec = (int64_t)(ns_since_epoch / 1000000000ULL);
     uint64_t ns = ns_since_epoch % 1000000000ULL;
-    struct tm tm_val;
-    gmtime_r(&sec, &tm_val);
-    fprintf(out, "%04d-%02d-%02d %02d:%02d:%02d.%09llu",
-            tm_val.tm_year + 1900, tm_val.tm_mon + 1, tm_val.tm_mday,
-            tm_val.tm_hour, tm_val.tm_min, tm_val.tm_sec, ns);
+
+    // Events arrive many per second; only redo the calendar math per second
+    if (sec != rd->cached_sec || !rd->date[0]) {
+        time_t t = (time_t)sec;
+        struct tm tm_val;
+        gmtime_r(&t, &tm_val);
+        snprintf(rd->date, sizeof(rd->date), "%04d-%02d-%02d %02d:%02d:%02d",
+                 tm_val.tm_year + 1900, tm_val.tm_mon + 1, tm_val.tm_mday,
+                 tm_val.tm_hour, tm_val.tm_min, tm_val.tm_sec);
+        rd->cached_sec = sec;
+    }
+    ob_printf(&rd->out, "%s.%09llu", rd->date, (unsigned long long)ns);
 }
 
 /**
  * @brief Print event header
  */
-static void print_event_header(FILE* out, swclock_event_header_t* hdr) {
-    fprintf(out, "[%010llu] ", hdr->sequence_num);
-    print_timestamp(out, hdr->timestamp_ns);
-    fprintf(out, " | %-20s | ", swclock_event_type_name(hdr->event_type));
+static void print_event_header(render_t* rd, const swclock_event_header_t* hdr) {
+    ob_printf(&rd->out, "[%010llu] ", (unsigned long long)hdr->sequence_num);
+    print_timestamp(rd, hdr->timestamp_ns);
+    ob_printf(&rd->out, " | %-20s | ", swclock_event_type_name(hdr->event_type));
 }
 
 /**
  * @brief Print adjtime event payload
  */
-static void print_adjtime_payload(FILE* out, swclock_event_adjtime_payload_t* p) {
-    fprintf(out, "modes=0x%04x offset=%lld ns freq=%lld scaled_ppm return=%d",
-            p->modes, p->offset_ns, p->freq_scaled_ppm, p->return_code);
+static void print_adjtime_payload(render_t* rd, const swclock_event_adjtime_payload_t* p) {
+    ob_printf(&rd->out, "modes=0x%04x offset=%lld ns freq=%lld scaled_ppm return=%d",
+              p->modes, (long long)p->offset_ns, (long long)p->freq_scaled_ppm, p->return_code);
 }
 
 /**
  * @brief Print PI step event payload
  */
-static void print_pi_step_payload(FILE* out, swclock_event_pi_step_payload_t* p) {
-    fprintf(out, "freq=%.3f ppm int_error=%.9f s phase=%lld ns enabled=%d",
-            p->pi_freq_ppm, p->pi_int_error_s, p->remaining_phase_ns, p->servo_enabled);
+static void print_pi_step_payload(render_t* rd, const swclock_event_pi_step_payload_t* p) {
+    ob_printf(&rd->out, "freq=%.3f ppm int_error=%.9f s phase=%lld ns enabled=%d",
+              p->pi_freq_ppm, p->pi_int_error_s, (long long)p->remaining_phase_ns, p->servo_enabled);
 }
 
 /**
  * @brief Print phase slew event payload
  */
-static void print_phase_slew_payload(FILE* out, swclock_event_phase_slew_payload_t* p) {
-    fprintf(out, "target=%lld ns current=%lld ns rate=%.3f ns/s duration=%u ms",
-            p->target_phase_ns, p->current_phase_ns, p->slew_rate_ns_per_s, p->duration_ms);
+static void print_phase_slew_payload(render_t* rd, const swclock_event_phase_slew_payload_t* p) {
+    ob_printf(&rd->out, "target=%lld ns current=%lld ns rate=%.3f ns/s duration=%u ms",
+              (long long)p->target_phase_ns, (long long)p->current_phase_ns,
+              p->slew_rate_ns_per_s, p->duration_ms);
 }
 
 /**
  * @brief Print frequency clamp event payload
  */
-static void print_frequency_clamp_payload(FILE* out, swclock_event_frequency_clamp_payload_t* p) {
-    fprintf(out, "requested=%.3f ppm clamped=%.3f ppm max=%.3f ppm",
-            p->requested_ppm, p->clamped_ppm, p->max_ppm);
+static void print_frequency_clamp_payload(render_t* rd, const swclock_event_frequency_clamp_payload_t* p) {
+    ob_printf(&rd->out, "requested=%.3f ppm clamped=%.3f ppm max=%.3f ppm",
+              p->requested_ppm, p->clamped_ppm, p->max_ppm);
 }
 
 /**
  * @brief Print generic event payload as hex dump
  */
-static void print_hex_dump(FILE* out, uint8_t* data, uint32_t size) {
+static void print_hex_dump(render_t* rd, const uint8_t* data, uint32_t size) {
+    static const char digits[] = "0123456789abcdef";
+    static const char wrap[] = "\n                                                     ";
+
+    // Hand-rolled: one ob_printf() per byte dominated dumps of marker events
+    if (!ob_reserve(&rd->out, (size_t)size * 3 + (size / 16) * (sizeof(wrap) - 1))) return;
+    char* p = rd->out.data + rd->out.len;
     for (uint32_t i = 0; i < size; i++) {
-        fprintf(out, "%02x ", data[i]);
-        if ((i + 1) % 16 == 0) fprintf(out, "\n                                                     ");
+        *p++ = digits[data[i] >> 4];
+        *p++ = digits[data[i] & 0xF];
+        *p++ = ' ';
+        if ((i + 1) % 16 == 0) {
+            memcpy(p, wrap, sizeof(wrap) - 1);
+            p += sizeof(wrap) - 1;
+        }
     }
+    rd->out.len = (size_t)(p - rd->out.data);
 }
 
 /**
- * @brief Process event log file
+ * @brief Print one event as text: header, then payload interpreted by event type
  */
-static int process_event_log(FILE* in, FILE* out) {
-    // Read and validate file header
-    swclock_event_log_header_t file_hdr;
-    if (fread(&file_hdr, sizeof(file_hdr), 1, in) != 1) {
-        fprintf(stderr, "Error: Failed to read file header\n");
-        return -1;
+static void print_event(render_t* rd, const swclock_event_header_t* hdr, const uint8_t* payload) {
+    print_event_header(rd, hdr);
+
+    // Payloads may be unaligned in the mapping (v1); the structs are packed
+    if (hdr->payload_size > 0) {
+        switch (hdr->event_type) {
+            case SWCLOCK_EVENT_ADJTIME_CALL:
+            case SWCLOCK_EVENT_ADJTIME_RETURN:
+                print_adjtime_payload(rd, (const swclock_event_adjtime_payload_t*)payload);
+                break;
+            case SWCLOCK_EVENT_PI_STEP:
+                print_pi_step_payload(rd, (const swclock_event_pi_step_payload_t*)payload);
+                break;
+            case SWCLOCK_EVENT_PHASE_SLEW_START:
+            case SWCLOCK_EVENT_PHASE_SLEW_DONE:
+                print_phase_slew_payload(rd, (const swclock_event_phase_slew_payload_t*)payload);
+                break;
+            case SWCLOCK_EVENT_FREQUENCY_CLAMP:
+                print_frequency_clamp_payload(rd, (const swclock_event_frequency_clamp_payload_t*)payload);
+                break;
+            default:
+                print_hex_dump(rd, payload, hdr->payload_size);
+                break;
+        }
     }
 
-    if (file_hdr.magic != SWCLOCK_EVENT_LOG_MAGIC) {
-        fprintf(stderr, "Error: Invalid magic number (expected 0x%08x, got 0x%08x)\n",
-                SWCLOCK_EVENT_LOG_MAGIC, file_hdr.magic);
-        return -1;
+    ob_printf(&rd->out, "\n");
+}
+
+/** CSV columns: the fields of every payload type; a row fills those of its type */
+static const char csv_header[] =
+    "sequence_num,timestamp_ns,event_type,"
+    "modes,offset_ns,freq_scaled_ppm,return_code,"
+    "pi_freq_ppm,pi_int_error_s,remaining_phase_ns,servo_enabled,"
+    "target_phase_ns,current_phase_ns,slew_rate_ns_per_s,duration_ms,"
+    "requested_ppm,clamped_ppm,max_ppm,"
+    "phase_error_ns,threshold_ns,crossing_type,"
+    "marker_id\n";
+
+/**
+ * @brief Print one event as a CSV row (doubles with full precision)
+ */
+static void print_event_csv(render_t* rd, const swclock_event_header_t* hdr, const uint8_t* payload) {
+    ob_printf(&rd->out, "%llu,%llu,%s,", (unsigned long long)hdr->sequence_num,
+              (unsigned long long)hdr->timestamp_ns, swclock_event_type_name(hdr->event_type));
+
+    size_t n = hdr->payload_size;
+    switch (hdr->event_type) {
+        case SWCLOCK_EVENT_ADJTIME_CALL:
+        case SWCLOCK_EVENT_ADJTIME_RETURN:
+            if (n == sizeof(swclock_event_adjtime_payload_t)) {
+                const swclock_event_adjtime_payload_t* p = (const swclock_event_adjtime_payload_t*)payload;
+                ob_printf(&rd->out, "%u,%lld,%lld,%d,,,,,,,,,,,,,,,\n", p->modes, (long long)p->offset_ns,
+                          (long long)p->freq_scaled_ppm, p->return_code);
+                return;
+            }
+            break;
+        case SWCLOCK_EVENT_PI_STEP:
+            if (n == sizeof(swclock_event_pi_step_payload_t)) {
+                const swclock_event_pi_step_payload_t* p = (const swclock_event_pi_step_payload_t*)payload;
+                ob_printf(&rd->out, ",,,,%.17g,%.17g,%lld,%d,,,,,,,,,,,\n", p->pi_freq_ppm, p->pi_int_error_s,
+                          (long long)p->remaining_phase_ns, p->servo_enabled);
+                return;
+            }
+            break;
+        case SWCLOCK_EVENT_PHASE_SLEW_START:
+        case SWCLOCK_EVENT_PHASE_SLEW_DONE:
+            if (n == sizeof(swclock_event_phase_slew_payload_t)) {
+                const swclock_event_phase_slew_payload_t* p = (const swclock_event_phase_slew_payload_t*)payload;
+                ob_printf(&rd->out, ",,,,,,,,%lld,%lld,%.17g,%u,,,,,,,\n", (long long)p->target_phase_ns,
+                          (long long)p->current_phase_ns, p->slew_rate_ns_per_s, p->duration_ms);
+                return;
+            }
+            break;
+        case SWCLOCK_EVENT_FREQUENCY_CLAMP:
+            if (n == sizeof(swclock_event_frequency_clamp_payload_t)) {
+                const swclock_event_frequency_clamp_payload_t* p =
+                    (const swclock_event_frequency_clamp_payload_t*)payload;
+                ob_printf(&rd->out, ",,,,,,,,,,,,%.17g,%.17g,%.17g,,,,\n", p->requested_ppm,
+                          p->clamped_ppm, p->max_ppm);
+                return;
+            }
+            break;
+        case SWCLOCK_EVENT_THRESHOLD_CROSS:
+            if (n == sizeof(swclock_event_threshold_payload_t)) {
+                const swclock_event_threshold_payload_t* p = (const swclock_event_threshold_payload_t*)payload;
+                ob_printf(&rd->out, ",,,,,,,,,,,,,,,%lld,%lld,%u,\n", (long long)p->phase_error_ns,
+                          (long long)p->threshold_ns, p->crossing_type);
+                return;
+            }
+            break;
+        case SWCLOCK_EVENT_LOG_MARKER:
+            if (n == sizeof(swclock_event_marker_payload_t)) {
+                const swclock_event_marker_payload_t* p = (const swclock_event_marker_payload_t*)payload;
+                ob_printf(&rd->out, ",,,,,,,,,,,,,,,,,,%u\n", p->marker_id);
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+    ob_printf(&rd->out, ",,,,,,,,,,,,,,,,,,\n");
+}
+
+/**
+ * @brief Row of the columnar binary output, before it is split into columns
+ */
+typedef struct {
+    uint64_t sequence_num;
+    uint64_t timestamp_ns;
+    uint16_t event_type;
+    uint16_t payload_size;
+    uint8_t  payload[SWCLOCK_EVCODEC_MAX_PAYLOAD];
+} bin_row_t;
+
+/**
+ * @brief Column descriptor in the columnar binary file header
+ *
+ * dtype is a NumPy type string, so a block column maps directly onto an
+ * array (e.g. numpy.frombuffer(data, dtype="<u8", count=rows)).
+ */
+typedef struct __attribute__((packed)) {
+    char name[24];
+    char dtype[8];
+} bin_column_t;
+
+static const bin_column_t bin_columns[] = {
+    { "sequence_num", "<u8" },
+    { "timestamp_ns", "<u8" },
+    { "event_type",   "<u2" },
+    { "payload_size", "<u2" },
+    { "payload",      "|V64" },
+};
+
+/**
+ * @brief Event selection from the command line
+ */
+typedef struct {
+    bool     has_from, from_rel;    /**< --from given; relative to log start */
+    bool     has_to, to_rel;        /**< --to given; relative to log start */
+    uint64_t from_ns, to_ns;        /**< Timestamp range (inclusive) */
+    bool     has_seq;               /**< --seq given */
+    uint64_t seq_first, seq_last;   /**< Sequence range (inclusive) */
+    int      type;                  /**< Event type, -1 for all */
+} dump_filter_t;
+
+static bool filter_match(const dump_filter_t* f, const swclock_event_header_t* hdr) {
+    if (f->has_from && hdr->timestamp_ns < f->from_ns) return false;
+    if (f->has_to && hdr->timestamp_ns > f->to_ns) return false;
+    if (f->has_seq && (hdr->sequence_num < f->seq_first || hdr->sequence_num > f->seq_last)) return false;
+    if (f->type >= 0 && hdr->event_type != f->type) return false;
+    return true;
+}
+
+/**
+ * @brief Formatted event inside a chunk's output buffer
+ */
+typedef struct {
+    uint64_t seq;
+    size_t   off;
+    size_t   len;
+} rec_ref_t;
+
+/**
+ * @brief One range of the segment, decoded and formatted by one thread
+ */
+typedef struct {
+    const swclock_evreader_t* reader;
+    const dump_filter_t* filter;
+    dump_format_t format;
+    uint64_t begin, end;
+
+    render_t   rd;              /**< Formatted events */
+    rec_ref_t* recs;            /**< Events in sequence order */
+    size_t     nrecs, cap;
+    size_t     next;            /**< Merge position */
+    uint64_t   decoded;
+    bool       corrupt;
+    uint64_t   corrupt_offset;
+} chunk_t;
+
+static int rec_cmp(const void* a, const void* b) {
+    const rec_ref_t* x = (const rec_ref_t*)a;
+    const rec_ref_t* y = (const rec_ref_t*)b;
+    return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+static bool chunk_push(chunk_t* ch, uint64_t seq, size_t off, size_t len) {
+    if (ch->nrecs == ch->cap) {
+        size_t cap = ch->cap ? ch->cap * 2 : 1024;
+        rec_ref_t* recs = realloc(ch->recs, cap * sizeof(*recs));
+        if (!recs) return false;
+        ch->recs = recs;
+        ch->cap = cap;
     }
+    ch->recs[ch->nrecs++] = (rec_ref_t){ seq, off, len };
+    return true;
+}
+
+static void chunk_free(chunk_t* ch) {
+    free(ch->rd.out.data);
+    free(ch->recs);
+    memset(&ch->rd, 0, sizeof(ch->rd));
+    ch->recs = NULL;
+    ch->nrecs = ch->cap = ch->next = 0;
+}
+
+/**
+ * @brief Decode and format one chunk (thread body)
+ */
+static void* chunk_decode(void* arg) {
+    chunk_t* ch = (chunk_t*)arg;
+    swclock_evreader_cursor_t cur;
+    swclock_evreader_cursor_init(ch->reader, ch->begin, ch->end, &cur);
 
-    // Print file header
-    fprintf(out, "=== SwClock Event Log ===\n");
-    fprintf(out, "Format Version: %u.%u\n", file_hdr.version_major, file_hdr.version_minor);
-    fprintf(out, "SwClock Version: %s\n", file_hdr.swclock_version);
-    fprintf(out, "Start Time: ");
-    print_timestamp(out, file_hdr.start_time_ns);
-    fprintf(out, "\n");
-    fprintf(out, "\n");
-    fprintf(out, "%-12s %-30s   %-20s   %s\n", "Sequence", "Timestamp", "Event Type", "Payload");
-    fprintf(out, "------------ ------------------------------ -------------------- --------------\n");
-
-    // Read events
-    uint64_t event_count = 0;
-    while (!feof(in)) {
-        // Read event header
-        swclock_event_header_t evt_hdr;
-        size_t nread = fread(&evt_hdr, sizeof(evt_hdr), 1, in);
-        if (nread == 0) break;  // End of file
-        if (nread != 1) {
-            fprintf(stderr, "Warning: Incomplete event header at offset %ld\n", ftell(in) - sizeof(evt_hdr));
+    int rc;
+    while ((rc = swclock_evreader_next(&cur)) == 1) {
+        ch->decoded++;
+        if (!filter_match(ch->filter, cur.hdr)) continue;
+
+        size_t off = ch->rd.out.len;
+        switch (ch->format) {
+            case DUMP_FORMAT_TEXT:
+                print_event(&ch->rd, cur.hdr, cur.payload);
+                break;
+            case DUMP_FORMAT_CSV:
+                print_event_csv(&ch->rd, cur.hdr, cur.payload);
+                break;
+            case DUMP_FORMAT_BIN: {
+                bin_row_t row;
+                memset(&row, 0, sizeof(row));
+                row.sequence_num = cur.hdr->sequence_num;
+                row.timestamp_ns = cur.hdr->timestamp_ns;
+                row.event_type   = cur.hdr->event_type;
+                row.payload_size = cur.hdr->payload_size;
+                memcpy(row.payload, cur.payload, cur.hdr->payload_size);
+                if (ob_reserve(&ch->rd.out, sizeof(row))) {
+                    memcpy(ch->rd.out.data + ch->rd.out.len, &row, sizeof(row));
+                    ch->rd.out.len += sizeof(row);
+                }
+                break;
+            }
+        }
+        if (ch->rd.out.len == off || !chunk_push(ch, cur.hdr->sequence_num, off, ch->rd.out.len - off)) {
+            ch->corrupt = true;     // Out of memory: report like a decode failure
+            ch->corrupt_offset = cur.offset;
             break;
         }
+    }
+    if (rc < 0) {
+        ch->corrupt = true;
+        ch->corrupt_offset = cur.offset;
+    }
 
-        // Validate event type (use a reasonable maximum)
-        if (evt_hdr.event_type >= 0xFF) {
-            fprintf(stderr, "Warning: Invalid event type %u at sequence %llu\n",
-                    evt_hdr.event_type, evt_hdr.sequence_num);
-            break;
+    // Producers commit concurrently, so file order is only nearly sequence order
+    bool sorted = true;
+    for (size_t i = 1; i < ch->nrecs && sorted; i++) sorted = ch->recs[i - 1].seq <= ch->recs[i].seq;
+    if (!sorted) qsort(ch->recs, ch->nrecs, sizeof(*ch->recs), rec_cmp);
+    return NULL;
+}
+
+/**
+ * @brief Destination of merged events
+ */
+typedef struct {
+    FILE*         out;
+    dump_format_t format;
+    bin_row_t*    block;        /**< Pending rows of the columnar output */
+    size_t        block_rows;
+    uint64_t      printed;
+    bool          failed;
+} sink_t;
+
+static void sink_flush_block(sink_t* s) {
+    if (s->block_rows == 0) return;
+
+    uint64_t rows = s->block_rows;
+    bool ok = fwrite(&rows, sizeof(rows), 1, s->out) == 1;
+    for (size_t i = 0; ok && i < s->block_rows; i++) ok = fwrite(&s->block[i].sequence_num, 8, 1, s->out) == 1;
+    for (size_t i = 0; ok && i < s->block_rows; i++) ok = fwrite(&s->block[i].timestamp_ns, 8, 1, s->out) == 1;
+    for (size_t i = 0; ok && i < s->block_rows; i++) ok = fwrite(&s->block[i].event_type, 2, 1, s->out) == 1;
+    for (size_t i = 0; ok && i < s->block_rows; i++) ok = fwrite(&s->block[i].payload_size, 2, 1, s->out) == 1;
+    for (size_t i = 0; ok && i < s->block_rows; i++) {
+        ok = fwrite(s->block[i].payload, SWCLOCK_EVCODEC_MAX_PAYLOAD, 1, s->out) == 1;
+    }
+    if (!ok) s->failed = true;
+    s->block_rows = 0;
+}
+
+static void sink_emit(sink_t* s, const char* data, size_t len) {
+    if (s->format == DUMP_FORMAT_BIN) {
+        memcpy(&s->block[s->block_rows++], data, sizeof(bin_row_t));
+        if (s->block_rows == DUMP_BIN_BLOCK_ROWS) sink_flush_block(s);
+    } else if (fwrite(data, 1, len, s->out) != len) {
+        s->failed = true;
+    }
+    s->printed++;
+}
+
+/**
+ * @brief Merge chunks by sequence number, emitting events below limit
+ *
+ * carry holds events of earlier chunks that were held back; on return it
+ * holds the events at or above limit, which may still interleave with the
+ * next chunks.
+ */
+static void merge_chunks(chunk_t* chunks, size_t n, chunk_t* carry, uint64_t limit, sink_t* s) {
+    chunk_t* src[n + 1];
+    size_t nsrc = 0;
+    src[nsrc++] = carry;
+    for (size_t i = 0; i < n; i++) src[nsrc++] = &chunks[i];
+
+    chunk_t held;
+    memset(&held, 0, sizeof(held));
+    held.format = carry->format;
+
+    for (;;) {
+        // Few sources (one per thread): a linear scan beats a heap here;
+        // ties go to the earlier chunk
+        chunk_t* best = NULL;
+        for (size_t i = 0; i < nsrc; i++) {
+            chunk_t* c = src[i];
+            if (c->next < c->nrecs && (!best || c->recs[c->next].seq < best->recs[best->next].seq)) best = c;
         }
+        if (!best) break;
 
-        // Print event header
-        print_event_header(out, &evt_hdr);
+        const rec_ref_t* r = &best->recs[best->next++];
+        const char* data = best->rd.out.data + r->off;
+        if (r->seq < limit) {
+            sink_emit(s, data, r->len);
+        } else if (ob_reserve(&held.rd.out, r->len) && chunk_push(&held, r->seq, held.rd.out.len, r->len)) {
+            memcpy(held.rd.out.data + held.rd.out.len, data, r->len);
+            held.rd.out.len += r->len;
+        }
+    }
 
-        // Read and print payload
-        if (evt_hdr.payload_size > 0) {
-            uint8_t payload_buf[256];  // Max payload size
-            if (evt_hdr.payload_size > sizeof(payload_buf)) {
-                fprintf(stderr, "Error: Payload size %u exceeds maximum\n", evt_hdr.payload_size);
-                break;
-            }
+    chunk_free(carry);
+    *carry = held;
+}
 
-            if (fread(payload_buf, evt_hdr.payload_size, 1, in) != 1) {
-                fprintf(stderr, "Warning: Failed to read payload at sequence %llu\n", evt_hdr.sequence_num);
-                break;
+/**
+ * @brief Decode [begin, end) of the segment on `threads` threads and emit the
+ *        matching events in sequence order
+ *
+ * @return Events decoded
+ */
+static uint64_t dump_range(const swclock_evreader_t* r, uint64_t begin, uint64_t end,
+                           const dump_filter_t* f, unsigned threads, sink_t* s) {
+    size_t want = (size_t)((end - begin) / DUMP_CHUNK_BYTES) + 1;
+    if (want < threads) want = threads;
+
+    uint64_t* bounds = malloc((want + 1) * sizeof(*bounds));
+    chunk_t* chunks = calloc(2 * (size_t)threads, sizeof(*chunks));
+    pthread_t* tids = malloc(threads * sizeof(*tids));
+    if (!bounds || !chunks || !tids) {
+        fprintf(stderr, "Error: Out of memory\n");
+        free(bounds);
+        free(chunks);
+        free(tids);
+        s->failed = true;
+        return 0;
+    }
+    size_t nchunks = swclock_evreader_split(r, begin, end, want, bounds);
+
+    // Two rounds of chunks live at once: the next round's first sequence
+    // numbers bound what of the current round can be emitted in order
+    chunk_t carry;
+    memset(&carry, 0, sizeof(carry));
+    carry.format = s->format;
+    chunk_t* cur = chunks;
+    chunk_t* nxt = chunks + threads;
+    size_t ncur = 0, done = 0;
+    uint64_t decoded = 0;
+
+    for (;;) {
+        // Decode the next round
+        size_t nnxt = 0;
+        while (nnxt < threads && done < nchunks) {
+            chunk_t* ch = &nxt[nnxt++];
+            memset(ch, 0, sizeof(*ch));
+            ch->reader = r;
+            ch->filter = f;
+            ch->format = s->format;
+            ch->begin  = bounds[done];
+            ch->end    = bounds[done + 1];
+            done++;
+        }
+        for (size_t i = 1; i < nnxt; i++) {
+            if (pthread_create(&tids[i], NULL, chunk_decode, &nxt[i]) != 0) {
+                chunk_decode(&nxt[i]);
+                tids[i] = 0;
             }
+        }
+        if (nnxt) chunk_decode(&nxt[0]);
+        for (size_t i = 1; i < nnxt; i++) {
+            if (tids[i]) pthread_join(tids[i], NULL);
+        }
+
+        // Emit the current round up to the next round's lowest sequence number
+        uint64_t limit = UINT64_MAX;
+        for (size_t i = 0; i < nnxt; i++) {
+            if (nxt[i].nrecs && nxt[i].recs[0].seq < limit) limit = nxt[i].recs[0].seq;
+        }
+        merge_chunks(cur, ncur, &carry, nnxt ? limit : UINT64_MAX, s);
 
-            // Interpret payload based on event type
-            switch (evt_hdr.event_type) {
-                case SWCLOCK_EVENT_ADJTIME_CALL:
-                case SWCLOCK_EVENT_ADJTIME_RETURN:
-                    print_adjtime_payload(out, (swclock_event_adjtime_payload_t*)payload_buf);
-                    break;
-                case SWCLOCK_EVENT_PI_STEP:
-                    print_pi_step_payload(out, (swclock_event_pi_step_payload_t*)payload_buf);
-                    break;
-                case SWCLOCK_EVENT_PHASE_SLEW_START:
-                case SWCLOCK_EVENT_PHASE_SLEW_DONE:
-                    print_phase_slew_payload(out, (swclock_event_phase_slew_payload_t*)payload_buf);
-                    break;
-                case SWCLOCK_EVENT_FREQUENCY_CLAMP:
-                    print_frequency_clamp_payload(out, (swclock_event_frequency_clamp_payload_t*)payload_buf);
-                    break;
-                default:
-                    print_hex_dump(out, payload_buf, evt_hdr.payload_size);
-                    break;
+        bool stop = false;
+        for (size_t i = 0; i < ncur; i++) {
+            decoded += cur[i].decoded;
+            if (cur[i].corrupt) {
+                fprintf(stderr, "Warning: Corrupt or truncated event at offset %llu\n",
+                        (unsigned long long)cur[i].corrupt_offset);
+                stop = true;
             }
+            chunk_free(&cur[i]);
+        }
+        if (nnxt == 0) break;
+        if (stop) {
+            // Nothing after a corrupt record is trusted
+            for (size_t i = 0; i < nnxt; i++) chunk_free(&nxt[i]);
+            merge_chunks(NULL, 0, &carry, UINT64_MAX, s);
+            break;
+        }
+
+        chunk_t* t = cur;
+        cur = nxt;
+        nxt = t;
+        ncur = nnxt;
+    }
+
+    chunk_free(&carry);
+    free(bounds);
+    free(chunks);
+    free(tids);
+    return decoded;
+}
+
+/**
+ * @brief Narrow [*begin, *end) to the sync points around the filter range
+ *
+ * Uses the segment's sidecar index (sw_clock_evindex.h); leaves the range
+ * alone if there is none. Returns true if the index was used.
+ */
+static bool index_range(const swclock_evreader_t* r, const dump_filter_t* f,
+                        uint64_t* begin, uint64_t* end) {
+    size_t n;
+    const swclock_event_index_entry_t* idx = swclock_evreader_index(r, &n);
+    if (!idx) return false;
+
+    // Start one sync point early and stop one late: records between sync
+    // points are only nearly in order (see swclock_evindex_find_time())
+    size_t first = 0, last = n;
+    if (f->has_from) {
+        size_t i = swclock_evindex_find_time(idx, n, f->from_ns);
+        if (i > first) first = i;
+    }
+    if (f->has_seq) {
+        size_t i = swclock_evindex_find_seq(idx, n, f->seq_first);
+        if (i > first) first = i;
+    }
+    if (f->has_to) {
+        size_t i = swclock_evindex_find_time(idx, n, f->to_ns) + 3;
+        if (i < last) last = i;
+    }
+    if (f->has_seq) {
+        size_t i = swclock_evindex_find_seq(idx, n, f->seq_last) + 3;
+        if (i < last) last = i;
+    }
+
+    uint64_t b = *begin, e = *end;
+    if (first < n && idx[first].offset >= b && idx[first].offset <= e) b = idx[first].offset;
+    if (last < n && idx[last].offset >= b && idx[last].offset <= e) e = idx[last].offset;
+    if (first >= last) e = b;
+
+    *begin = b;
+    *end = e;
+    return true;
+}
+
+/**
+ * @brief Process event log file
+ */
+static int process_event_log(const char* path, FILE* out, dump_filter_t* f, dump_format_t format,
+                             unsigned threads, bool stats) {
+    swclock_evreader_t* r = swclock_evreader_open(path);
+    if (!r) {
+        if (errno == EINVAL) {
+            fprintf(stderr, "Error: '%s' is not a SwClock event log of a supported version\n", path);
+        } else {
+            fprintf(stderr, "Error: Failed to open input file '%s': %s\n", path, strerror(errno));
+        }
+        return -1;
+    }
+    const swclock_event_log_header_t* file_hdr = swclock_evreader_header(r);
+    uint64_t size = swclock_evreader_size(r);
+
+    // Times relative to the log start
+    if (f->from_rel) f->from_ns += file_hdr->start_time_ns;
+    if (f->to_rel) f->to_ns += file_hdr->start_time_ns;
+
+    // Byte range to decode: all events, or the indexed part covering the filter
+    uint64_t begin = sizeof(*file_hdr), end = size;
+    bool filtered = f->has_from || f->has_to || f->has_seq || f->type >= 0;
+    bool indexed = false;
+    if (f->has_from || f->has_to || f->has_seq) {
+        indexed = index_range(r, f, &begin, &end);
+        if (!indexed) {
+            fprintf(stderr, "Note: No index for '%s'; scanning the whole file\n", path);
         }
+    }
+
+    sink_t sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.out = out;
+    sink.format = format;
+
+    if (format == DUMP_FORMAT_TEXT) {
+        // Print file header
+        render_t rd;
+        memset(&rd, 0, sizeof(rd));
+        ob_printf(&rd.out, "=== SwClock Event Log ===\n");
+        ob_printf(&rd.out, "Format Version: %u.%u\n", file_hdr->version_major, file_hdr->version_minor);
+        ob_printf(&rd.out, "SwClock Version: %.16s\n", file_hdr->swclock_version);
+        ob_printf(&rd.out, "Start Time: ");
+        print_timestamp(&rd, file_hdr->start_time_ns);
+        ob_printf(&rd.out, "\n\n");
+        ob_printf(&rd.out, "%-12s %-30s   %-20s   %s\n", "Sequence", "Timestamp", "Event Type", "Payload");
+        ob_printf(&rd.out, "------------ ------------------------------ -------------------- --------------\n");
+        fwrite(rd.out.data, 1, rd.out.len, out);
+        free(rd.out.data);
+    } else if (format == DUMP_FORMAT_CSV) {
+        fputs(csv_header, out);
+    } else {
+        // Columnar: magic, column count, descriptors; then blocks of
+        // { uint64 rows; each column's rows values back to back }
+        uint32_t ncols[2] = { sizeof(bin_columns) / sizeof(bin_columns[0]), 0 };
+        fwrite(DUMP_BIN_MAGIC, 1, 8, out);
+        fwrite(ncols, sizeof(ncols), 1, out);
+        fwrite(bin_columns, sizeof(bin_columns), 1, out);
+        sink.block = malloc(DUMP_BIN_BLOCK_ROWS * sizeof(bin_row_t));
+        if (!sink.block) {
+            fprintf(stderr, "Error: Out of memory\n");
+            swclock_evreader_close(r);
+            return -1;
+        }
+    }
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    uint64_t decoded = (end > begin) ? dump_range(r, begin, end, f, threads, &sink) : 0;
+    sink_flush_block(&sink);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    free(sink.block);
+
+    if (format == DUMP_FORMAT_TEXT) {
+        if (filtered) {
+            fprintf(out, "\n=== Matching Events: %llu (decoded %llu, %llu of %llu bytes%s) ===\n",
+                    (unsigned long long)sink.printed, (unsigned long long)decoded,
+                    (unsigned long long)(end - begin), (unsigned long long)size,
+                    indexed ? " via index" : "");
+        } else {
+            fprintf(out, "\n=== Total Events: %llu ===\n", (unsigned long long)sink.printed);
+        }
+    }
 
-        fprintf(out, "\n");
-        event_count++;
+    if (stats) {
+        double s = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+        fprintf(stderr, "Decoded %llu events (%llu bytes, %llu output) in %.3f s on %u thread%s: "
+                "%.2f GB/s, %.1f M events/s\n",
+                (unsigned long long)decoded, (unsigned long long)(end - begin),
+                (unsigned long long)sink.printed, s, threads, threads == 1 ? "" : "s",
+                s > 0 ? (double)(end - begin) / s / 1e9 : 0.0,
+                s > 0 ? (double)decoded / s / 1e6 : 0.0);
+    }
+
+    swclock_evreader_close(r);
+    if (sink.failed) {
+        fprintf(stderr, "Error: Failed to write output\n");
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parse "[+]seconds[.fraction]" into nanoseconds
+ */
+static int parse_time(const char* s, uint64_t* ns, bool* relative) {
+    *relative = (*s == '+');
+    if (*relative) s++;
+
+    char* end;
+    errno = 0;
+    unsigned long long sec = strtoull(s, &end, 10);
+    if (errno || end == s) return -1;
+
+    uint64_t frac = 0, scale = 1000000000ULL;
+    if (*end == '.') {
+        for (end++; *end >= '0' && *end <= '9'; end++) {
+            if (scale > 1) {
+                scale /= 10;
+                frac += (uint64_t)(*end - '0') * scale;
+            }
+        }
     }
+    if (*end) return -1;
 
-    fprintf(out, "\n=== Total Events: %llu ===\n", event_count);
+    *ns = (uint64_t)sec * 1000000000ULL + frac;
     return 0;
 }
 
+/**
+ * @brief Parse "N", "N-M" or "N-" into an inclusive sequence range
+ */
+static int parse_seq(const char* s, uint64_t* first, uint64_t* last) {
+    char* end;
+    errno = 0;
+    *first = strtoull(s, &end, 10);
+    if (errno || end == s) return -1;
+    if (*end == '\0') {
+        *last = *first;
+        return 0;
+    }
+    if (*end != '-') return -1;
+    if (end[1] == '\0') {
+        *last = UINT64_MAX;
+        return 0;
+    }
+    const char* m = end + 1;
+    *last = strtoull(m, &end, 10);
+    return (errno || end == m || *end || *last < *first) ? -1 : 0;
+}
+
+/**
+ * @brief Parse an event type name (PI_STEP) or number (18, 0x12)
+ */
+static int parse_type(const char* s) {
+    for (int t = 1; t <= 0xFF; t++) {
+        if (strcasecmp(s, swclock_event_type_name((swclock_event_type_t)t)) == 0) return t;
+    }
+    char* end;
+    long t = strtol(s, &end, 0);
+    return (end != s && *end == '\0' && t > 0 && t <= 0xFFFF) ? (int)t : -1;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Usage: %s [options] <event_log.bin> [output]\n", prog);
+    fprintf(stderr, "  If output is omitted, writes to stdout\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --from T       Events at or after T\n");
+    fprintf(stderr, "  --to T         Events at or before T\n");
+    fprintf(stderr, "                 T is seconds[.fraction] on the event timestamp clock,\n");
+    fprintf(stderr, "                 or +seconds relative to the log start\n");
+    fprintf(stderr, "  --seq N[-M]    Events with sequence number N (to M; N- for all after N)\n");
+    fprintf(stderr, "  --type T       Events of one type (name such as PI_STEP, or number)\n");
+    fprintf(stderr, "  --format F     text (default), csv, or bin (columnar, see below)\n");
+    fprintf(stderr, "  --threads N    Decode and format on N threads (default 1)\n");
+    fprintf(stderr, "  --stats        Report decode throughput on stderr\n");
+    fprintf(stderr, "  Time and sequence ranges seek via the segment's .idx index and only\n");
+    fprintf(stderr, "  read the part of the file that covers them.\n");
+    fprintf(stderr, "  bin output: \"%s\", uint32 column count, uint32 0, then per column\n", DUMP_BIN_MAGIC);
+    fprintf(stderr, "  a 24-byte name and an 8-byte NumPy dtype; then blocks of uint64 rows\n");
+    fprintf(stderr, "  followed by each column's values for those rows.\n");
+}
+
 /**
  * @brief Main entry point
  */
 int main(int argc, char** argv) {
-    if (argc < 2 || argc > 3) {
-        fprintf(stderr, "Usage: %s <event_log.bin> [output.txt]\n", argv[0]);
-        fprintf(stderr, "  If output.txt is omitted, writes to stdout\n");
-        return 1;
+    static const struct option options[] = {
+        { "from",    required_argument, NULL, 'f' },
+        { "to",      required_argument, NULL, 't' },
+        { "seq",     required_argument, NULL, 's' },
+        { "type",    required_argument, NULL, 'y' },
+        { "format",  required_argument, NULL, 'F' },
+        { "threads", required_argument, NULL, 'j' },
+        { "stats",   no_argument,       NULL, 'S' },
+        { "help",    no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    dump_filter_t filter;
+    memset(&filter, 0, sizeof(filter));
+    filter.type = -1;
+    dump_format_t format = DUMP_FORMAT_TEXT;
+    unsigned threads = 1;
+    bool stats = false;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "hj:", options, NULL)) != -1) {
+        switch (opt) {
+            case 'f':
+                filter.has_from = true;
+                if (parse_time(optarg, &filter.from_ns, &filter.from_rel) != 0) {
+                    fprintf(stderr, "Error: Invalid --from time '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 't':
+                filter.has_to = true;
+                if (parse_time(optarg, &filter.to_ns, &filter.to_rel) != 0) {
+                    fprintf(stderr, "Error: Invalid --to time '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 's':
+                filter.has_seq = true;
+                if (parse_seq(optarg, &filter.seq_first, &filter.seq_last) != 0) {
+                    fprintf(stderr, "Error: Invalid --seq range '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'y':
+                filter.type = parse_type(optarg);
+                if (filter.type < 0) {
+                    fprintf(stderr, "Error: Unknown event type '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'F':
+                if (strcmp(optarg, "text") == 0) {
+                    format = DUMP_FORMAT_TEXT;
+                } else if (strcmp(optarg, "csv") == 0) {
+                    format = DUMP_FORMAT_CSV;
+                } else if (strcmp(optarg, "bin") == 0) {
+                    format = DUMP_FORMAT_BIN;
+                } else {
+                    fprintf(stderr, "Error: Unknown format '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'j': {
+                long n = strtol(optarg, NULL, 10);
+                if (n < 1 || n > 256) {
+                    fprintf(stderr, "Error: --threads must be 1..256\n");
+                    return 1;
+                }
+                threads = (unsigned)n;
+                break;
+            }
+            case 'S':
+                stats = true;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
     }
 
-    const char* input_file = argv[1];
-    FILE* in = fopen(input_file, "rb");
-    if (!in) {
-        fprintf(stderr, "Error: Failed to open input file '%s': %s\n",
-                input_file, strerror(errno));
+    if (argc - optind < 1 || argc - optind > 2) {
+        usage(argv[0]);
         return 1;
     }
 
+    const char* input_file = argv[optind];
     FILE* out = stdout;
-    if (argc == 3) {
-        out = fopen(argv[2], "w");
+    if (argc - optind == 2) {
+        out = fopen(argv[optind + 1], format == DUMP_FORMAT_BIN ? "wb" : "w");
         if (!out) {
             fprintf(stderr, "Error: Failed to open output file '%s': %s\n",
-                    argv[2], strerror(errno));
-            fclose(in);
+                    argv[optind + 1], strerror(errno));
             return 1;
         }
     }
 
-    int ret = process_event_log(in, out);
+    int ret = process_event_log(input_file, out, &filter, format, threads, stats);
 
-    fclose(in);
     if (out != stdout) {
         fclose(out);
     }
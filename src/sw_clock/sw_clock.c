@@ -4,6 +4,8 @@
 #include <errno.h>
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -12,10 +14,22 @@
 #include <math.h>
 #include <inttypes.h> // for PRId64
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <stdarg.h>
 #include <syslog.h>
+#include <unistd.h>
 
 #include "sw_clock.h"
+#include "sw_clock_timebase.h"
+#include "sw_clock_shm.h"
+#include "sw_clock_batch.h"
+#include "sw_clock_history.h"
+#include "sw_clock_scheduler.h"
+#include "sw_clock_seglog.h"
+#include "sw_clock_evcodec.h"
+#include "sw_clock_evindex.h"
+#include "sw_clock_flightrec.h"
+#include "sw_clock_evpolicy.h"
 #include "swclock_jsonld.h"
 #include "sw_clock_commercial_log.h"
 
@@ -68,7 +82,19 @@ static inline double scaledppm_to_ppm(long scaled) {
 
 // ================= Core state =================
 
+// Layout: three regions on separate cache lines, so the lock-free read path
+// shares no line with state the poll thread or writers mutate between
+// publishes, and cold logging state stays out of both.
 struct SwClock {
+    // ---- Hot, read-mostly: the only line swclock_gettime() touches ----
+
+    // Seqlock-published bases/rate, read lock-free by gettime; written only
+    // by swclock_publish_timebase()
+    _Alignas(SWCLOCK_CACHELINE) swclock_timebase_t timebase;
+
+    // ---- Writer / poll-private: mutated under the write lock every poll ----
+
+    _Alignas(SWCLOCK_CACHELINE)
     pthread_rwlock_t lock;  // Changed from mutex to rwlock (poll=writer, gettime=reader)
 
     // Reference epoch from hardware raw time (updated only by poll thread)
@@ -78,8 +104,9 @@ struct SwClock {
     int64_t base_rt_ns;        // REALTIME
     int64_t base_mono_ns;      // disciplined synthetic timebase
 
-    // Cached total factor for gettime extrapolation
-    double cached_total_factor;
+    // Fixed-point total rate (factor * 2^SWCLOCK_RATE_SHIFT) used for
+    // extrapolation since ref_mono_raw; recomputed on every publish
+    uint64_t cached_mult;
 
     // Base frequency bias set by ADJ_FREQUENCY (scaled-ppm)
     long    freq_scaled_ppm;
@@ -110,23 +137,68 @@ struct SwClock {
     long    tick;     // tick (nanoseconds)
     int     tai;      // TAI offset (seconds)
 
+    // Adaptive poll rate: poll_period_ns doubles while the servo is idle, up
+    // to poll_max_period_ns (<= SWCLOCK_POLL_NS: fixed rate)
+    int64_t   poll_period_ns;
+    int64_t   poll_max_period_ns;
+    int       poll_fast_left;          // fast polls still owed after adjtime
+
+    // Poll timing statistics, recorded by each background tick
+    uint64_t  poll_ticks;
+    uint64_t  poll_overruns;           // wakeups a full period or more late
+    swclock_histogram_t poll_wake_late; // wakeup time - deadline
+    swclock_histogram_t poll_duration;  // tick run time
+
+    // ---- Cold: threads, configuration, logging ----
+
     // Background poll thread
+    _Alignas(SWCLOCK_CACHELINE)
     pthread_t poll_thread;
     bool      poll_thread_running;
     bool      stop_flag;
 
+    // Wakes poll_thread early (adjtime while backed off, destroy)
+    pthread_mutex_t poll_wait_lock;
+    pthread_cond_t  poll_wait_cv;
+    bool            poll_kick;
+
+    // Registration with the shared poll scheduler (NULL when using poll_thread)
+    swclock_scheduler_t*  poll_sched;
+    swclock_sched_task_t* poll_task;
+
+    // Optional cross-process copy of the timebase (NULL if disabled)
+    swclock_shm_page_t* shm_page;
+    char shm_name[256];
+
     // Logging support
     FILE* log_fp;         // CSV file handle
     bool  is_logging;     // true if logging is active
     bool  servo_log_enabled;  // true if SWCLOCK_SERVO_LOG was set at creation
 
     // Event logging support (Priority 1 Recommendation 2)
-    FILE* event_log_fp;             // Binary event log file
+    swclock_seglog_t* event_log;    // Mapped binary log segments (owned by the logger thread while running)
     bool  event_logging_enabled;    // Event logging active flag
-    swclock_ringbuf_t event_ringbuf; // Lock-free event buffer
+    swclock_ringbuf_t* event_ringbuf; // Lock-free event buffer (allocated on first start, 1 MB)
     pthread_t event_logger_thread;  // Background logger thread
-    bool event_logger_running;      // Logger thread status
-    uint64_t event_sequence;        // Event sequence number
+    bool event_logger_running;      // Logger thread status (atomic access)
+    uint64_t event_sequence;        // Event sequence number (atomic fetch-add, any thread)
+    int64_t event_flush_ns;         // Longest logger sleep without a doorbell
+    pthread_mutex_t event_stats_lock; // Guards the logger's statistics below
+    uint64_t event_wakeups;         // Logger thread wakeups
+    swclock_histogram_t event_disk_latency; // Event timestamp to its copy into the log
+    uint32_t event_segments;        // Log segment files created this session
+    int64_t event_segment_bytes;    // Size of each log segment file
+    int64_t event_log_max_bytes;    // Limit on all segments of one log
+    int event_format;               // On-disk format version written (1 or 2)
+    swclock_evcodec_t event_codec;  // v2 encoder state (logger thread)
+    char* event_log_path;           // Path of segment 0
+    int event_index_fd;             // Sidecar index of the current segment (-1 if none)
+    bool event_segment_fresh;       // Next record is the first of the log
+    uint64_t event_sync_offset;     // Last sync point in the current segment
+    uint64_t event_sync_ts;         // Timestamp of the record after it
+    swclock_evpolicy_t event_policy; // Per-type sampling policies and suppressed counters
+    swclock_flightrec_t* flightrec; // In-memory event history (allocated on first enable, kept until destroy)
+    bool flightrec_enabled;         // Events also go to the flight recorder
 
     // Real-time monitoring (Priority 2 Recommendation 7)
     swclock_monitor_t* monitor;     // Monitoring context (NULL if disabled)
@@ -134,10 +206,26 @@ struct SwClock {
     // JSON-LD structured logging (Priority 2 Recommendation 10)
     swclock_jsonld_logger_t* jsonld_logger;  // JSON-LD logger (NULL if disabled)
     bool monitoring_enabled;         // Monitoring active flag
+
+    // ---- Timebase history (written per publish, read by raw-to-time conversion) ----
+
+    // Every published timebase, for converting past raw timestamps
+    _Alignas(SWCLOCK_CACHELINE) swclock_history_t history;
 };
 
-// Forward declaration
-static void* swclock_poll_thread_main(void* arg);
+_Static_assert(sizeof(swclock_timebase_t) <= SWCLOCK_CACHELINE,
+               "the read path must fit in one cache line");
+_Static_assert(offsetof(struct SwClock, lock) >= SWCLOCK_CACHELINE,
+               "writer state must not share the timebase cache line");
+
+// Forward declarations
+static void*   swclock_poll_thread_main(void* arg);
+static int64_t swclock_poll_tick(void* arg, int64_t deadline_ns);
+static void    swclock_poll_kick(SwClock* c);
+
+// Worker threads of the shared poll scheduler for new clocks; 0 = one poll
+// thread per clock, -1 = not configured (SWCLOCK_SHARED_POLL_THREADS decides)
+static _Atomic int g_shared_poll_threads = -1;
 
 // Compute total rate factor from base freq + PI freq correction (in ppm)
 static inline double total_factor(const struct SwClock* c) {
@@ -146,16 +234,37 @@ static inline double total_factor(const struct SwClock* c) {
     return 1.0 + total_ppm / 1.0e6;
 }
 
-// Advance time bases to now using current total factor and update remaining phase bookkeeping.
+// Publish the current bases/rate for lock-free readers. Caller holds the write lock.
+// Called after every change of freq_scaled_ppm or pi_freq_ppm, so this is where
+// the fixed-point multiplier is refreshed.
+static void swclock_publish_timebase(SwClock* c) {
+    c->cached_mult = factor_to_mult(total_factor(c), SWCLOCK_RATE_SHIFT);
+
+    swclock_timebase_snapshot_t snap = {
+        .ref_raw_ns   = ts_to_ns(&c->ref_mono_raw),
+        .base_rt_ns   = c->base_rt_ns,
+        .base_mono_ns = c->base_mono_ns,
+        .mult         = c->cached_mult,
+        .shift        = SWCLOCK_RATE_SHIFT
+    };
+    swclock_timebase_publish(&c->timebase, &snap);
+    swclock_history_append(&c->history, &snap);
+    if (c->shm_page) {
+        swclock_shm_publish(c->shm_page, &snap);
+    }
+}
+
+// Advance time bases to now using the published rate and update remaining phase bookkeeping.
 static void swclock_rebase_now_and_update(SwClock* c) {
-    struct timespec now_raw;
-    if (clock_gettime(CLOCK_MONOTONIC_RAW, &now_raw) != 0) return;
+    struct timespec now_raw = ns_to_ts(swclock_rawsrc_now_ns());
 
     int64_t elapsed_raw_ns = ts_to_ns(&now_raw) - ts_to_ns(&c->ref_mono_raw);
     if (elapsed_raw_ns < 0) elapsed_raw_ns = 0;
 
+    // Same integer extrapolation as readers, so the rebase is seamless for them
     double factor = total_factor(c);
-    int64_t adj_elapsed_ns = (int64_t)((double)elapsed_raw_ns * factor);
+    int64_t adj_elapsed_ns = (int64_t)mul_u64_shr((uint64_t)elapsed_raw_ns, c->cached_mult,
+                                                  SWCLOCK_RATE_SHIFT);
 
     DEBUG_LOG("rebase: elapsed_raw=%lld ns, factor=%.9f, adj_elapsed=%lld ns",
               (long long)elapsed_raw_ns, factor, (long long)adj_elapsed_ns);
@@ -194,9 +303,6 @@ static void swclock_rebase_now_and_update(SwClock* c) {
     }
 
     c->ref_mono_raw = now_raw;
-
-    // Cache total factor for gettime extrapolation
-    c->cached_total_factor = factor;
 }
 
 
@@ -219,6 +325,16 @@ long long swclock_get_remaining_phase_ns(SwClock* c) {
     return remaining;
 }
 
+static void swclock_event_emit(SwClock* c, swclock_event_type_t event_type,
+                               const void* payload, size_t payload_size);
+
+// Whether an event is logged, decided by its type's sampling policy before
+// the caller builds it; value is what SWCLOCK_EVENT_POLICY_ON_CHANGE compares
+static inline bool swclock_event_admit(SwClock* c, swclock_event_type_t event_type, double value) {
+    return (c->event_logging_enabled || c->flightrec_enabled) &&
+           swclock_evpolicy_admit(&c->event_policy, event_type, value);
+}
+
 // One PI control step. dt_s is the elapsed RAW time since last poll in seconds.
 static void swclock_pi_step(SwClock* c, double dt_s) {
 
@@ -230,6 +346,12 @@ static void swclock_pi_step(SwClock* c, double dt_s) {
     // Error is the remaining phase (seconds). Positive error => need faster time (positive ppm).
     double err_s = (double)c->remaining_phase_ns / 1e9;
 
+    // The poll interval varies (adaptive polling, kicks, host stalls); bound the
+    // integration step to a few servo polls so one late poll cannot wind up
+    // the integrator
+    double max_dt_s = (double)SWCLOCK_PI_MAX_DT_NS / 1e9;
+    if (dt_s > max_dt_s) dt_s = max_dt_s;
+
     // Integrator
     c->pi_int_error_s += err_s * dt_s;
 
@@ -259,26 +381,29 @@ static void swclock_pi_step(SwClock* c, double dt_s) {
 
     c->pi_freq_ppm = u_ppm;
 
-    // Log frequency clamp event if clamped
-    if (clamped) {
+    // Log frequency clamp event if clamped (and sampled)
+    double requested_ppm = (SWCLOCK_PI_KP_PPM_PER_S * err_s) + (SWCLOCK_PI_KI_PPM_PER_S2 * c->pi_int_error_s);
+    if (clamped && swclock_event_admit(c, SWCLOCK_EVENT_FREQUENCY_CLAMP, requested_ppm)) {
         swclock_event_frequency_clamp_payload_t clamp_payload = {
-            .requested_ppm = (SWCLOCK_PI_KP_PPM_PER_S * err_s) + (SWCLOCK_PI_KI_PPM_PER_S2 * c->pi_int_error_s),
+            .requested_ppm = requested_ppm,
             .clamped_ppm = u_ppm,
             .max_ppm = SWCLOCK_PI_MAX_PPM
         };
-        swclock_log_event(c, SWCLOCK_EVENT_FREQUENCY_CLAMP, &clamp_payload, sizeof(clamp_payload));
+        swclock_event_emit(c, SWCLOCK_EVENT_FREQUENCY_CLAMP, &clamp_payload, sizeof(clamp_payload));
     }
 
-    // Log PI step event
-    swclock_event_pi_step_payload_t pi_payload = {
-        .pi_freq_ppm = c->pi_freq_ppm,
-        .pi_int_error_s = c->pi_int_error_s,
-        .remaining_phase_ns = c->remaining_phase_ns,
-        .servo_enabled = c->pi_servo_enabled ? 1 : 0
-    };
-    swclock_log_event(c, SWCLOCK_EVENT_PI_STEP, &pi_payload, sizeof(pi_payload));
+    // Log PI step event (if sampled)
+    if (swclock_event_admit(c, SWCLOCK_EVENT_PI_STEP, c->pi_freq_ppm)) {
+        swclock_event_pi_step_payload_t pi_payload = {
+            .pi_freq_ppm = c->pi_freq_ppm,
+            .pi_int_error_s = c->pi_int_error_s,
+            .remaining_phase_ns = c->remaining_phase_ns,
+            .servo_enabled = c->pi_servo_enabled ? 1 : 0
+        };
+        swclock_event_emit(c, SWCLOCK_EVENT_PI_STEP, &pi_payload, sizeof(pi_payload));
+    }
 
-    // JSON-LD logging
+    // JSON-LD logging (queued as a binary record; formatted on the logger's thread)
     if (c->jsonld_logger) {
         struct timespec ts;
         clock_gettime(CLOCK_REALTIME, &ts);
@@ -337,6 +462,9 @@ void swclock_poll(SwClock* c) {
     struct timespec poll_start;
     clock_gettime(CLOCK_REALTIME, &poll_start);
 
+    // Keep the TSC raw source (if selected) calibrated; rate-limited internally
+    swclock_rawsrc_calibrate();
+
     // Acquire write lock (exclusive) - no gettime() calls can proceed while poll updates
     pthread_rwlock_wrlock(&c->lock);
 
@@ -357,6 +485,10 @@ void swclock_poll(SwClock* c) {
         if (c->stuck_poll_count > 20) {
             DEBUG_LOG("WARNING: Servo stuck! remaining_phase_ns=%lld for %d polls, pi_int_error_s=%.9f, pi_freq_ppm=%.3f",
                       c->remaining_phase_ns, c->stuck_poll_count, c->pi_int_error_s, c->pi_freq_ppm);
+            // Once per stall: keep the history that led into it (the dump runs elsewhere)
+            if (c->stuck_poll_count == 21) {
+                swclock_flightrec_trigger(c->flightrec, SWCLOCK_FLIGHTREC_ON_WATCHDOG);
+            }
         }
     } else {
         c->stuck_poll_count = 0;
@@ -378,32 +510,63 @@ void swclock_poll(SwClock* c) {
     // Update error estimates based on current state
     swclock_update_error_estimates(c);
 
+    swclock_publish_timebase(c);
+
     pthread_rwlock_unlock(&c->lock);
 }
 
 // ================= Public API =================
 
 SwClock* swclock_create(void) {
-    SwClock* c = (SwClock*)calloc(1, sizeof(SwClock));
-    if (!c) return NULL;
+    // Cache-line aligned so the region boundaries in struct SwClock hold
+    SwClock* c = NULL;
+    if (posix_memalign((void**)&c, _Alignof(SwClock), sizeof(SwClock)) != 0) return NULL;
+    memset(c, 0, sizeof(*c));
 
     pthread_rwlock_init(&c->lock, NULL);
 
-    clock_gettime(CLOCK_MONOTONIC_RAW, &c->ref_mono_raw);
+    // Optional process-wide TSC raw source; must be selected before the first raw read
+    const char* raw_source = getenv("SWCLOCK_RAW_SOURCE");
+    if (raw_source && strcmp(raw_source, "tsc") == 0 &&
+        swclock_rawsrc_select(SWCLOCK_RAWSRC_TSC) != 0) {
+        SWCLOCK_LOG_WARN("swclock_create: TSC raw source unavailable (%s), using clock_gettime",
+                         strerror(errno));
+    }
+
+    int64_t raw_ns = swclock_rawsrc_now_ns();
+    c->ref_mono_raw = ns_to_ts(raw_ns);
 
-    struct timespec sys_rt = {0}, sys_mono_raw = {0};
+    struct timespec sys_rt = {0};
     clock_gettime(CLOCK_REALTIME, &sys_rt);
-    clock_gettime(CLOCK_MONOTONIC_RAW, &sys_mono_raw);
 
     c->base_rt_ns   = ts_to_ns(&sys_rt);
-    c->base_mono_ns = ts_to_ns(&sys_mono_raw);
+    c->base_mono_ns = raw_ns;
 
     c->freq_scaled_ppm    = 0;
     c->pi_freq_ppm        = 0.0;
     c->pi_int_error_s     = 0.0;
     c->pi_servo_enabled   = true;
     c->remaining_phase_ns = 0;
-    c->cached_total_factor = 1.0;
+    c->cached_mult = factor_to_mult(1.0, SWCLOCK_RATE_SHIFT);
+
+    swclock_timebase_snapshot_t snap = {
+        .ref_raw_ns   = ts_to_ns(&c->ref_mono_raw),
+        .base_rt_ns   = c->base_rt_ns,
+        .base_mono_ns = c->base_mono_ns,
+        .mult         = c->cached_mult,
+        .shift        = SWCLOCK_RATE_SHIFT
+    };
+    swclock_timebase_init(&c->timebase, &snap);
+    swclock_history_init(&c->history);
+    swclock_history_append(&c->history, &snap);
+
+    // Optional shared-memory timebase for other processes
+    c->shm_page = NULL;
+    const char* shm_name = getenv("SWCLOCK_SHM_NAME");
+    if (shm_name && *shm_name && swclock_enable_shm(c, shm_name) != 0) {
+        SWCLOCK_LOG_WARN("swclock_create: failed to publish shm timebase %s: %s",
+                         shm_name, strerror(errno));
+    }
 
     // Initialize watchdog
     c->last_remaining_phase_ns = 0;
@@ -431,11 +594,64 @@ SwClock* swclock_create(void) {
     c->servo_log_enabled = (disable_servo_log == NULL || atoi(disable_servo_log) == 0);
 
     // Initialize event logging fields
-    c->event_log_fp = NULL;
+    c->event_log = NULL;
     c->event_logging_enabled = false;
     c->event_logger_running = false;
     c->event_sequence = 0;
-    swclock_ringbuf_init(&c->event_ringbuf);
+    c->event_ringbuf = NULL;
+    c->event_log_path = NULL;
+    c->event_index_fd = -1;
+    pthread_mutex_init(&c->event_stats_lock, NULL);
+
+    // Event logger flush deadline (SWCLOCK_EVENT_FLUSH_MS overrides)
+    c->event_flush_ns = SWCLOCK_EVENT_FLUSH_NS;
+    const char* flush_ms = getenv("SWCLOCK_EVENT_FLUSH_MS");
+    if (flush_ms && atoll(flush_ms) > 0) {
+        c->event_flush_ns = atoll(flush_ms) * NS_PER_MS;
+    }
+
+    // Event log segment sizing (SWCLOCK_EVENT_SEGMENT_MB / SWCLOCK_EVENT_LOG_MAX_MB override)
+    c->event_segment_bytes = SWCLOCK_EVENT_SEGMENT_BYTES;
+    c->event_log_max_bytes = SWCLOCK_EVENT_LOG_MAX_BYTES;
+    const char* segment_mb = getenv("SWCLOCK_EVENT_SEGMENT_MB");
+    if (segment_mb && atoll(segment_mb) > 0) {
+        c->event_segment_bytes = atoll(segment_mb) << 20;
+    }
+    const char* log_max_mb = getenv("SWCLOCK_EVENT_LOG_MAX_MB");
+    if (log_max_mb && atoll(log_max_mb) >= 0) {
+        c->event_log_max_bytes = atoll(log_max_mb) << 20;
+    }
+
+    // Compact v2 event encoding unless SWCLOCK_EVENT_FORMAT=1 asks for fixed records
+    c->event_format = SWCLOCK_EVCODEC_VERSION;
+    const char* event_format = getenv("SWCLOCK_EVENT_FORMAT");
+    if (event_format && atoi(event_format) == 1) {
+        c->event_format = 1;
+    }
+
+    // Every event type logged unless SWCLOCK_EVENT_POLICY samples it
+    swclock_evpolicy_init(&c->event_policy);
+    const char* event_policy = getenv("SWCLOCK_EVENT_POLICY");
+    if (event_policy && swclock_evpolicy_parse(&c->event_policy, event_policy) != 0) {
+        SWCLOCK_LOG_WARN("Ignoring malformed part of SWCLOCK_EVENT_POLICY='%s'", event_policy);
+    }
+
+    // SWCLOCK_FLIGHTREC=<prefix> keeps recent events in memory and dumps them
+    // on any trigger
+    c->flightrec = NULL;
+    c->flightrec_enabled = false;
+    const char* flightrec_prefix = getenv("SWCLOCK_FLIGHTREC");
+    if (flightrec_prefix && *flightrec_prefix) {
+        swclock_flightrec_config_t fr_config = {
+            .dump_prefix = flightrec_prefix,
+            .events = 0,
+            .triggers = SWCLOCK_FLIGHTREC_ON_THRESHOLD | SWCLOCK_FLIGHTREC_ON_WATCHDOG |
+                        SWCLOCK_FLIGHTREC_ON_SIGNAL
+        };
+        if (swclock_enable_flight_recorder(c, &fr_config) != 0) {
+            SWCLOCK_LOG_WARN("Failed to start flight recorder '%s'", flightrec_prefix);
+        }
+    }
 
     // Initialize monitoring fields (Rec 7)
     c->monitor = NULL;
@@ -454,7 +670,12 @@ SwClock* swclock_create(void) {
             .max_files = 10,
             .compress = true
         };
-        c->jsonld_logger = swclock_jsonld_init("logs/swclock.jsonl", &rotation, NULL);
+        // SWCLOCK_JSONLD_STREAM=1: write gzip frames as the log grows
+        // instead of compressing each log after rotation (flash devices)
+        const char* jsonld_stream = getenv("SWCLOCK_JSONLD_STREAM");
+        rotation.stream_compress = jsonld_stream != NULL && atoi(jsonld_stream) != 0;
+        c->jsonld_logger = swclock_jsonld_init(
+            rotation.stream_compress ? "logs/swclock.jsonl.gz" : "logs/swclock.jsonl", &rotation, NULL);
         if (c->jsonld_logger) {
             // Log system startup event
             struct timespec ts;
@@ -463,10 +684,61 @@ SwClock* swclock_create(void) {
             char details[256];
             snprintf(details, sizeof(details), "{\"version\":\"2.0.0\",\"build\":\"commercial\"}");
             swclock_jsonld_log_system(c->jsonld_logger, timestamp_ns, "swclock_start", details);
+            // On disk before the clock is handed out; also keeps the writer
+            // thread's cold first pass out of the caller's first calls
+            swclock_jsonld_flush(c->jsonld_logger);
+        }
+    }
+
+    // Poll thread wakeup (CLOCK_MONOTONIC deadlines)
+    pthread_mutex_init(&c->poll_wait_lock, NULL);
+    pthread_condattr_t poll_cv_attr;
+    pthread_condattr_init(&poll_cv_attr);
+#if !defined(__APPLE__)
+    pthread_condattr_setclock(&poll_cv_attr, CLOCK_MONOTONIC);
+#endif
+    pthread_cond_init(&c->poll_wait_cv, &poll_cv_attr);
+    pthread_condattr_destroy(&poll_cv_attr);
+    c->poll_kick = false;
+
+    // Adaptive poll rate (off unless SWCLOCK_ADAPTIVE_POLL_MAX_MS is set)
+    c->poll_period_ns     = SWCLOCK_POLL_NS;
+    c->poll_max_period_ns = SWCLOCK_POLL_NS;
+    c->poll_fast_left     = 0;
+    const char* adaptive_max_ms = getenv("SWCLOCK_ADAPTIVE_POLL_MAX_MS");
+    if (adaptive_max_ms && *adaptive_max_ms &&
+        swclock_set_adaptive_poll(c, atoll(adaptive_max_ms) * NS_PER_MS) != 0) {
+        SWCLOCK_LOG_WARN("swclock_create: invalid SWCLOCK_ADAPTIVE_POLL_MAX_MS=%s", adaptive_max_ms);
+    }
+
+    // Either register with the shared poll scheduler or start a private poll thread
+    int shared_threads = atomic_load(&g_shared_poll_threads);
+    if (shared_threads < 0) {
+        const char* env_threads = getenv("SWCLOCK_SHARED_POLL_THREADS");
+        shared_threads = env_threads ? atoi(env_threads) : 0;
+    }
+
+    c->poll_sched = NULL;
+    c->poll_task  = NULL;
+    if (shared_threads > 0) {
+        c->poll_sched = swclock_scheduler_shared_acquire((unsigned)shared_threads);
+        if (c->poll_sched) {
+            c->poll_task = swclock_scheduler_add(c->poll_sched, SWCLOCK_POLL_NS,
+                                                 swclock_poll_tick, c);
+            if (!c->poll_task) {
+                swclock_scheduler_shared_release();
+                c->poll_sched = NULL;
+            }
+        }
+        if (!c->poll_task) {
+            SWCLOCK_LOG_WARN("swclock_create: shared poll scheduler unavailable (%s), "
+                             "using a poll thread", strerror(errno));
         }
     }
 
-    if (pthread_create(&c->poll_thread, NULL, swclock_poll_thread_main, c) != 0) {
+    if (c->poll_task) {
+        c->poll_thread_running = false;
+    } else if (pthread_create(&c->poll_thread, NULL, swclock_poll_thread_main, c) != 0) {
         c->poll_thread_running = false;
     }
 
@@ -476,19 +748,30 @@ SwClock* swclock_create(void) {
 void swclock_destroy(SwClock* c) {
     if (!c) return;
 
-    if (c->poll_thread_running) {
-        // First, signal the thread to stop
-        pthread_rwlock_wrlock(&c->lock);
-        c->stop_flag = true;
-        pthread_rwlock_unlock(&c->lock);
+    if (c->poll_task || c->poll_thread_running) {
+        if (c->poll_task) {
+            // Unregister; waits for a tick in progress on a scheduler worker
+            swclock_scheduler_remove(c->poll_sched, c->poll_task);
+            c->poll_task  = NULL;
+            c->poll_sched = NULL;
+            swclock_scheduler_shared_release();
+        } else {
+            // First, signal the thread to stop
+            pthread_rwlock_wrlock(&c->lock);
+            c->stop_flag = true;
+            pthread_rwlock_unlock(&c->lock);
+            swclock_poll_kick(c);
 
-        // Wait for thread to exit
-        pthread_join(c->poll_thread, NULL);
+            // Wait for thread to exit
+            pthread_join(c->poll_thread, NULL);
+        }
 
         // Now safely close the logs
         swclock_close_log(c);
         swclock_stop_event_log(c);
 
+        swclock_disable_flight_recorder(c);
+
         // Disable monitoring
         if (c->monitoring_enabled) {
             swclock_enable_monitoring(c, false);
@@ -505,8 +788,15 @@ void swclock_destroy(SwClock* c) {
         }
     }
 
+    swclock_disable_shm(c);
+
+    pthread_cond_destroy(&c->poll_wait_cv);
+    pthread_mutex_destroy(&c->poll_wait_lock);
+    pthread_mutex_destroy(&c->event_stats_lock);
     pthread_rwlock_destroy(&c->lock);
 
+    swclock_flightrec_destroy(c->flightrec);
+    free(c->event_ringbuf);
     free(c);
 }
 
@@ -522,42 +812,105 @@ int swclock_gettime(SwClock* c, clockid_t clk_id, struct timespec *tp) {
         return clock_gettime(CLOCK_MONOTONIC_RAW, tp);
     }
 
-    // Acquire read lock (non-exclusive) - multiple gettime() calls can proceed concurrently
-    // Poll thread will not update while any reader holds the lock
-    pthread_rwlock_rdlock(&c->lock);
+    if (clk_id != CLOCK_REALTIME && clk_id != CLOCK_MONOTONIC) {
+        errno = EINVAL;
+        return -1;
+    }
 
-    // Read all values atomically
-    int64_t base_ns;
-    switch (clk_id) {
-        case CLOCK_REALTIME:
-            base_ns = c->base_rt_ns;
-            break;
-        case CLOCK_MONOTONIC:
-            base_ns = c->base_mono_ns;
-            break;
-        default:
-            pthread_rwlock_unlock(&c->lock);
-            errno = EINVAL;
-            return -1;
+    // Lock-free snapshot of the timebase published by the poll thread.
+    // Readers never write shared state, so they scale with thread count.
+    swclock_timebase_snapshot_t snap;
+    swclock_timebase_read(&c->timebase, &snap);
+
+    int64_t base_ns = (clk_id == CLOCK_REALTIME) ? snap.base_rt_ns : snap.base_mono_ns;
+
+    // Extrapolate current time from last published state
+    int64_t current_ns = swclock_timebase_extrapolate(&snap, base_ns, swclock_rawsrc_now_ns());
+
+    *tp = ns_to_ts(current_ns);
+    return 0;
+}
+
+// Chunk size for batch conversion: raw values are staged on the stack so
+// the output may alias the input while old timestamps are patched up.
+#define SWCLOCK_BATCH_CHUNK 256
+
+int swclock_raw_to_time_batch(SwClock* c, clockid_t clk_id, const int64_t* raw_ns,
+                              int64_t* out_ns, size_t n) {
+    if (!c || (n && (!raw_ns || !out_ns))) {
+        errno = EINVAL;
+        return -1;
     }
 
-    struct timespec ref_time = c->ref_mono_raw;
-    double factor = c->cached_total_factor;
+    if (clk_id == CLOCK_MONOTONIC_RAW) {
+        if (out_ns != raw_ns) memmove(out_ns, raw_ns, n * sizeof(*out_ns));
+        return 0;
+    }
 
-    pthread_rwlock_unlock(&c->lock);
+    if (clk_id != CLOCK_REALTIME && clk_id != CLOCK_MONOTONIC) {
+        errno = EINVAL;
+        return -1;
+    }
 
-    // Extrapolate current time from last poll state (outside lock)
-    struct timespec now_raw;
-    clock_gettime(CLOCK_MONOTONIC_RAW, &now_raw);
+    // Timestamps at or after the current reference use the live snapshot;
+    // older ones use the history segment that was in force at the time.
+    swclock_timebase_snapshot_t snap, seg;
+    swclock_timebase_read(&c->timebase, &snap);
+
+    int64_t seg_start_ns = 0, seg_end_ns = INT64_MIN;   // empty until first lookup
+    bool    seg_stale = false;
+    int     stale = 0;
+
+    int64_t chunk[SWCLOCK_BATCH_CHUNK];
+    for (size_t off = 0; off < n; off += SWCLOCK_BATCH_CHUNK) {
+        size_t m = (n - off < SWCLOCK_BATCH_CHUNK) ? n - off : SWCLOCK_BATCH_CHUNK;
+        memcpy(chunk, raw_ns + off, m * sizeof(*chunk));
+
+        // Convert runs of consecutive timestamps that share a segment in one
+        // kernel call; sorted or clustered input gives long runs.
+        size_t i = 0;
+        while (i < m) {
+            const swclock_timebase_snapshot_t* use = &snap;
+            int64_t lo = snap.ref_raw_ns, hi = INT64_MAX;
+
+            if (chunk[i] < snap.ref_raw_ns) {
+                if (chunk[i] < seg_start_ns || chunk[i] >= seg_end_ns) {
+                    int rc = swclock_history_find(&c->history, chunk[i], &seg, &seg_end_ns);
+                    if (rc < 0) {
+                        errno = EAGAIN;
+                        return -1;
+                    }
+                    seg_stale    = (rc == 1);
+                    seg_start_ns = seg_stale ? INT64_MIN : seg.ref_raw_ns;
+                }
+                use = &seg;
+                lo  = seg_start_ns;
+                hi  = seg_end_ns;
+            }
 
-    int64_t elapsed_raw_ns = ts_to_ns(&now_raw) - ts_to_ns(&ref_time);
-    if (elapsed_raw_ns < 0) elapsed_raw_ns = 0;
+            size_t j = i + 1;
+            while (j < m && chunk[j] >= lo && chunk[j] < hi) j++;
+            if (use == &seg && seg_stale) stale += (int)(j - i);
 
-    int64_t adj_elapsed_ns = (int64_t)((double)elapsed_raw_ns * factor);
-    int64_t current_ns = base_ns + adj_elapsed_ns;
+            int64_t base_ns = (clk_id == CLOCK_REALTIME) ? use->base_rt_ns : use->base_mono_ns;
+            swclock_batch_convert(use->ref_raw_ns, base_ns, use->mult, use->shift,
+                                  chunk + i, out_ns + off + i, j - i);
+            i = j;
+        }
+    }
+    return stale;
+}
 
-    *tp = ns_to_ts(current_ns);
-    return 0;
+int swclock_raw_to_time(SwClock* c, clockid_t clk_id, int64_t raw_ns, struct timespec* tp) {
+    if (!tp) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int64_t out_ns;
+    int rc = swclock_raw_to_time_batch(c, clk_id, &raw_ns, &out_ns, 1);
+    if (rc >= 0) *tp = ns_to_ts(out_ns);
+    return rc;
 }
 
 int swclock_settime(SwClock* c, clockid_t clk_id, const struct timespec *tp) {
@@ -571,6 +924,7 @@ int swclock_settime(SwClock* c, clockid_t clk_id, const struct timespec *tp) {
     c->remaining_phase_ns = 0;
     c->pi_int_error_s = 0.0;
     c->pi_freq_ppm = 0.0;
+    swclock_publish_timebase(c);
     pthread_rwlock_unlock(&c->lock);
     return 0;
 }
@@ -701,8 +1055,19 @@ int swclock_adjtime(SwClock* c, struct timex *tptr) {
     tptr->tick      = c->tick;
     tptr->tai       = c->tai;
 
+    swclock_publish_timebase(c);
+
+    // Poll at the full rate for a while; wake the poller if it is backed off
+    bool wake_poller = (c->poll_period_ns > SWCLOCK_POLL_NS);
+    c->poll_period_ns = SWCLOCK_POLL_NS;
+    c->poll_fast_left = SWCLOCK_POLL_FAST_AFTER_ADJTIME;
+
     pthread_rwlock_unlock(&c->lock);
 
+    if (wake_poller) {
+        swclock_poll_kick(c);
+    }
+
     // Log adjtime return event
     swclock_event_adjtime_payload_t adj_payload_return = {
         .modes = modes,
@@ -720,14 +1085,14 @@ void swclock_reset(SwClock* c) {
     /* IMPORTANT: Not thread-safe use pthread_rwlock_wrlock(&c->lock); to call this function */
     if (!c) return;
 
-    clock_gettime(CLOCK_MONOTONIC_RAW, &c->ref_mono_raw);
+    int64_t raw_ns = swclock_rawsrc_now_ns();
+    c->ref_mono_raw = ns_to_ts(raw_ns);
 
-    struct timespec sys_rt = {0}, sys_mono_raw = {0};
+    struct timespec sys_rt = {0};
     clock_gettime(CLOCK_REALTIME, &sys_rt);
-    clock_gettime(CLOCK_MONOTONIC_RAW, &sys_mono_raw);
 
     c->base_rt_ns   = ts_to_ns(&sys_rt);
-    c->base_mono_ns = ts_to_ns(&sys_mono_raw);
+    c->base_mono_ns = raw_ns;
 
     c->freq_scaled_ppm    = 0;
     c->pi_freq_ppm        = 0.0;
@@ -744,120 +1109,290 @@ void swclock_reset(SwClock* c) {
     c->stop_flag           = false;
     c->poll_thread_running = true;
 
+    swclock_publish_timebase(c);
+
     // c->pi_servo_enabled: Not reset, we respect the previous state
 }
 
 
+// ================= Shared-memory timebase =================
+
+int swclock_enable_shm(SwClock* c, const char* name) {
+    if (!c || !name || !*name) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pthread_rwlock_wrlock(&c->lock);
+
+    if (c->shm_page) {
+        pthread_rwlock_unlock(&c->lock);
+        errno = EBUSY;
+        return -1;
+    }
+
+    swclock_timebase_snapshot_t snap;
+    swclock_timebase_read(&c->timebase, &snap);
+
+    c->shm_page = swclock_shm_create(name, &snap);
+    if (!c->shm_page) {
+        pthread_rwlock_unlock(&c->lock);
+        return -1;
+    }
+    strncpy(c->shm_name, name, sizeof(c->shm_name) - 1);
+    c->shm_name[sizeof(c->shm_name) - 1] = '\0';
+
+    pthread_rwlock_unlock(&c->lock);
+    return 0;
+}
+
+void swclock_disable_shm(SwClock* c) {
+    if (!c) return;
+
+    pthread_rwlock_wrlock(&c->lock);
+    if (c->shm_page) {
+        swclock_shm_destroy(c->shm_page, c->shm_name);
+        c->shm_page = NULL;
+        c->shm_name[0] = '\0';
+    }
+    pthread_rwlock_unlock(&c->lock);
+}
+
+
 // ================= Background thread =================
 
-static void* swclock_poll_thread_main(void* arg) {
+// One background poll: servo update plus the per-poll logging and monitoring.
+// Runs on the clock's poll thread or on a shared scheduler worker; never
+// concurrently for the same clock.
+static int64_t swclock_poll_tick(void* arg, int64_t deadline_ns) {
     SwClock* c = (SwClock*)arg;
-    struct timespec ts = { .tv_sec = 0, .tv_nsec = SWCLOCK_POLL_NS };
+    int64_t wake_ns = monotonic_now_ns();
 
-    while (1) {
-        // Sleep first to avoid a busy loop
-        nanosleep(&ts, NULL);
+    swclock_poll(c);
 
+    // Conditional servo state logging (enabled via SWCLOCK_SERVO_LOG env var)
+    // NOTE: This logging is for debugging/audit purposes and has minimal overhead
+    // when disabled (flag checked once at swclock_create time)
+    if (c->servo_log_enabled) {
         pthread_rwlock_wrlock(&c->lock);
-        bool stop = c->stop_flag;
+        if (c->log_fp && c->is_logging) {
+            swclock_log(c);  // ENABLED: Priority 1 Recommendation 5
+        }
         pthread_rwlock_unlock(&c->lock);
-        if (stop) break;
+    }
 
-        swclock_poll(c);
+    // JSON-LD ServoStateUpdate logging (independent of CSV logging)
+    // Read servo state inside lock, then log outside to avoid blocking
+    if (c->jsonld_logger && c->servo_log_enabled) {
+        double freq_ppm_snapshot;
+        int64_t phase_error_ns_snapshot;
+        int64_t time_error_ns_snapshot;
+        double pi_freq_ppm_snapshot;
+        double pi_int_error_s_snapshot;
+        bool servo_enabled_snapshot;
+        uint64_t timestamp_ns;
 
-        // Conditional servo state logging (enabled via SWCLOCK_SERVO_LOG env var)
-        // NOTE: This logging is for debugging/audit purposes and has minimal overhead
-        // when disabled (flag checked once at swclock_create time)
-        if (c->servo_log_enabled) {
-            pthread_rwlock_wrlock(&c->lock);
-            if (c->log_fp && c->is_logging) {
-                swclock_log(c);  // ENABLED: Priority 1 Recommendation 5
-            }
-            pthread_rwlock_unlock(&c->lock);
-        }
+        pthread_rwlock_wrlock(&c->lock);
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        timestamp_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+        // Calculate phase and time errors
+        phase_error_ns_snapshot = c->remaining_phase_ns;
+
+        // Calculate SwClock time directly (don't call swclock_gettime while holding lock)
+        int64_t elapsed_raw_ns = swclock_rawsrc_now_ns() - ts_to_ns(&c->ref_mono_raw);
+        if (elapsed_raw_ns < 0) elapsed_raw_ns = 0;
+        int64_t adj_elapsed_ns = (int64_t)mul_u64_shr((uint64_t)elapsed_raw_ns, c->cached_mult,
+                                                      SWCLOCK_RATE_SHIFT);
+        int64_t sw_time_ns = c->base_rt_ns + adj_elapsed_ns;
+        int64_t sys_time_ns = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+        time_error_ns_snapshot = sys_time_ns - sw_time_ns;
+
+        // Snapshot other servo state
+        freq_ppm_snapshot = scaledppm_to_ppm(c->freq_scaled_ppm);
+        pi_freq_ppm_snapshot = c->pi_freq_ppm;
+        pi_int_error_s_snapshot = c->pi_int_error_s;
+        servo_enabled_snapshot = c->pi_servo_enabled;
+        pthread_rwlock_unlock(&c->lock);
 
-        // JSON-LD ServoStateUpdate logging (independent of CSV logging)
-        // Read servo state inside lock, then log outside to avoid blocking
-        if (c->jsonld_logger && c->servo_log_enabled) {
-            double freq_ppm_snapshot;
-            int64_t phase_error_ns_snapshot;
-            int64_t time_error_ns_snapshot;
-            double pi_freq_ppm_snapshot;
-            double pi_int_error_s_snapshot;
-            bool servo_enabled_snapshot;
-            uint64_t timestamp_ns;
+        // Log outside the critical section to avoid blocking other threads
+        swclock_jsonld_log_servo(c->jsonld_logger, timestamp_ns,
+            freq_ppm_snapshot,
+            phase_error_ns_snapshot, time_error_ns_snapshot,
+            pi_freq_ppm_snapshot, pi_int_error_s_snapshot,
+            servo_enabled_snapshot);
+    }
 
-            pthread_rwlock_wrlock(&c->lock);
-            struct timespec ts;
-            clock_gettime(CLOCK_REALTIME, &ts);
-            timestamp_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
-
-            // Calculate phase and time errors
-            phase_error_ns_snapshot = c->remaining_phase_ns;
-
-            // Calculate SwClock time directly (don't call swclock_gettime while holding lock)
-            struct timespec now_raw;
-            clock_gettime(CLOCK_MONOTONIC_RAW, &now_raw);
-            int64_t elapsed_raw_ns = ts_to_ns(&now_raw) - ts_to_ns(&c->ref_mono_raw);
-            if (elapsed_raw_ns < 0) elapsed_raw_ns = 0;
-            int64_t adj_elapsed_ns = (int64_t)((double)elapsed_raw_ns * c->cached_total_factor);
-            int64_t sw_time_ns = c->base_rt_ns + adj_elapsed_ns;
-            int64_t sys_time_ns = (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
-            time_error_ns_snapshot = sys_time_ns - sw_time_ns;
-
-            // Snapshot other servo state
-            freq_ppm_snapshot = scaledppm_to_ppm(c->freq_scaled_ppm);
-            pi_freq_ppm_snapshot = c->pi_freq_ppm;
-            pi_int_error_s_snapshot = c->pi_int_error_s;
-            servo_enabled_snapshot = c->pi_servo_enabled;
-            pthread_rwlock_unlock(&c->lock);
+    // Real-time monitoring: Add TE sample to circular buffer (Rec 7)
+    if (c->monitoring_enabled && c->monitor) {
+        // Compute Time Error: Reference_Time - SwClock_Disciplined_Time
+        // Both must be in the same time domain (REALTIME)
 
-            // Log outside the critical section to avoid blocking other threads
-            swclock_jsonld_log_servo(c->jsonld_logger, timestamp_ns,
-                freq_ppm_snapshot,
-                phase_error_ns_snapshot, time_error_ns_snapshot,
-                pi_freq_ppm_snapshot, pi_int_error_s_snapshot,
-                servo_enabled_snapshot);
-        }
+        // Reference: System's CLOCK_REALTIME (undisciplined)
+        struct timespec sys_realtime;
+        clock_gettime(CLOCK_REALTIME, &sys_realtime);
+        int64_t ref_time_ns = ts_to_ns(&sys_realtime);
+
+        // SwClock's disciplined REALTIME
+        struct timespec sw_realtime;
+        swclock_gettime(c, CLOCK_REALTIME, &sw_realtime);
+        int64_t swclock_time_ns = ts_to_ns(&sw_realtime);
 
-        // Real-time monitoring: Add TE sample to circular buffer (Rec 7)
-        if (c->monitoring_enabled && c->monitor) {
-            // Compute Time Error: Reference_Time - SwClock_Disciplined_Time
-            // Both must be in the same time domain (REALTIME)
+        // TE = Reference - SwClock (positive means SwClock is behind)
+        int64_t te_ns = ref_time_ns - swclock_time_ns;
 
-            // Reference: System's CLOCK_REALTIME (undisciplined)
-            struct timespec sys_realtime;
-            clock_gettime(CLOCK_REALTIME, &sys_realtime);
-            int64_t ref_time_ns = ts_to_ns(&sys_realtime);
+        // Use the raw timeline for timestamp (monotonic, steady reference)
+        uint64_t timestamp_ns = (uint64_t)swclock_rawsrc_now_ns();
 
-            // SwClock's disciplined REALTIME
-            struct timespec sw_realtime;
-            swclock_gettime(c, CLOCK_REALTIME, &sw_realtime);
-            int64_t swclock_time_ns = ts_to_ns(&sw_realtime);
+        swclock_monitor_add_sample(c->monitor, timestamp_ns, te_ns);
+    }
 
-            // TE = Reference - SwClock (positive means SwClock is behind)
-            int64_t te_ns = ref_time_ns - swclock_time_ns;
+    // Timing evidence for the servo: how late this tick woke and how long it ran
+    int64_t late_ns = wake_ns - deadline_ns;
+    int64_t done_ns = monotonic_now_ns();
 
-            // Use MONOTONIC_RAW for timestamp (monotonic, steady reference)
-            struct timespec now_mono;
-            clock_gettime(CLOCK_MONOTONIC_RAW, &now_mono);
-            uint64_t timestamp_ns = (uint64_t)ts_to_ns(&now_mono);
+    pthread_rwlock_wrlock(&c->lock);
+    c->poll_ticks++;
+    if (late_ns >= c->poll_period_ns) c->poll_overruns++;
+    swclock_histogram_record(&c->poll_wake_late, late_ns);
+    swclock_histogram_record(&c->poll_duration, done_ns - wake_ns);
+
+    // Adaptive rate: full rate while slewing, after adjtime or while monitoring
+    // (TE statistics assume the nominal sample rate); otherwise back off
+    // geometrically to the ceiling
+    bool busy = c->remaining_phase_ns != 0 || c->pi_freq_ppm != 0.0 ||
+                c->pi_int_error_s != 0.0 || c->monitoring_enabled || c->poll_fast_left > 0;
+    if (c->poll_fast_left > 0) c->poll_fast_left--;
+    if (busy || c->poll_max_period_ns <= SWCLOCK_POLL_NS) {
+        c->poll_period_ns = SWCLOCK_POLL_NS;
+    } else if (c->poll_period_ns < c->poll_max_period_ns) {
+        c->poll_period_ns *= 2;
+        if (c->poll_period_ns > c->poll_max_period_ns) c->poll_period_ns = c->poll_max_period_ns;
+    }
+    int64_t next_period_ns = c->poll_period_ns;
+    pthread_rwlock_unlock(&c->lock);
+
+    return next_period_ns;
+}
+
+// Wake the poller now: the poll thread via its condvar, or the scheduler task
+static void swclock_poll_kick(SwClock* c) {
+    if (c->poll_task) {
+        swclock_scheduler_kick(c->poll_sched, c->poll_task);
+        return;
+    }
+    pthread_mutex_lock(&c->poll_wait_lock);
+    c->poll_kick = true;
+    pthread_cond_signal(&c->poll_wait_cv);
+    pthread_mutex_unlock(&c->poll_wait_lock);
+}
+
+// Sleep until an absolute CLOCK_MONOTONIC deadline or a kick. Returns true if kicked.
+static bool swclock_poll_wait(SwClock* c, int64_t deadline_ns) {
+    pthread_mutex_lock(&c->poll_wait_lock);
+    while (!c->poll_kick) {
+#if defined(__APPLE__)
+        // No pthread_condattr_setclock(): wait relative to now
+        int64_t rel_ns = deadline_ns - monotonic_now_ns();
+        if (rel_ns <= 0) break;
+        struct timespec rel = ns_to_ts(rel_ns);
+        pthread_cond_timedwait_relative_np(&c->poll_wait_cv, &c->poll_wait_lock, &rel);
+#else
+        struct timespec abs = ns_to_ts(deadline_ns);
+        if (pthread_cond_timedwait(&c->poll_wait_cv, &c->poll_wait_lock, &abs) == ETIMEDOUT) break;
+#endif
+    }
+    bool kicked = c->poll_kick;
+    c->poll_kick = false;
+    pthread_mutex_unlock(&c->poll_wait_lock);
+    return kicked;
+}
+
+static void* swclock_poll_thread_main(void* arg) {
+    SwClock* c = (SwClock*)arg;
 
-            swclock_monitor_add_sample(c->monitor, timestamp_ns, te_ns);
+    // Absolute deadlines: the period does not stretch by the tick's run time
+    int64_t deadline_ns = monotonic_now_ns() + SWCLOCK_POLL_NS;
+
+    while (1) {
+        if (swclock_poll_wait(c, deadline_ns)) {
+            deadline_ns = monotonic_now_ns();
+        }
+
+        pthread_rwlock_wrlock(&c->lock);
+        bool stop = c->stop_flag;
+        pthread_rwlock_unlock(&c->lock);
+        if (stop) break;
+
+        int64_t period_ns = swclock_poll_tick(c, deadline_ns);
+
+        // Next deadline on the same grid; skip periods the tick overran
+        deadline_ns += period_ns;
+        int64_t now_ns = monotonic_now_ns();
+        if (deadline_ns <= now_ns) {
+            deadline_ns += ((now_ns - deadline_ns) / period_ns + 1) * period_ns;
         }
     }
     return NULL;
 }
 
+int swclock_use_shared_scheduler(unsigned threads) {
+    if (threads > SWCLOCK_SCHED_MAX_THREADS) {
+        errno = EINVAL;
+        return -1;
+    }
+    atomic_store(&g_shared_poll_threads, (int)threads);
+    return 0;
+}
+
+int swclock_set_adaptive_poll(SwClock* c, int64_t max_period_ns) {
+    if (!c || max_period_ns < 0 || max_period_ns > SWCLOCK_POLL_MAX_PERIOD_NS) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pthread_rwlock_wrlock(&c->lock);
+    c->poll_max_period_ns = (max_period_ns > SWCLOCK_POLL_NS) ? max_period_ns : SWCLOCK_POLL_NS;
+    bool wake_poller = (c->poll_period_ns > c->poll_max_period_ns);
+    if (wake_poller) c->poll_period_ns = c->poll_max_period_ns;
+    pthread_rwlock_unlock(&c->lock);
+
+    // A lower ceiling takes effect now, not after the current long sleep
+    if (wake_poller) {
+        swclock_poll_kick(c);
+    }
+    return 0;
+}
+
+int swclock_get_poll_stats(SwClock* c, swclock_poll_stats_t* stats) {
+    if (!c || !stats) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pthread_rwlock_rdlock(&c->lock);
+    stats->polls            = c->poll_ticks;
+    stats->overruns         = c->poll_overruns;
+    stats->wake_late        = c->poll_wake_late;
+    stats->duration         = c->poll_duration;
+    stats->period_ns        = c->poll_period_ns;
+    stats->shared_scheduler = (c->poll_task != NULL);
+    pthread_rwlock_unlock(&c->lock);
+    return 0;
+}
+
 void swclock_enable_PIServo(SwClock* c)
 {
     if (!c) return;
 
     if (true != c->pi_servo_enabled) {
         pthread_rwlock_wrlock(&c->lock);
+        swclock_rebase_now_and_update(c);
         c->pi_servo_enabled = true;
         c->pi_int_error_s   = 0.0;
         c->pi_freq_ppm      = 0.0;
+        swclock_publish_timebase(c);
         pthread_rwlock_unlock(&c->lock);
 
         // Log PI enable event
@@ -872,9 +1407,11 @@ void swclock_disable_PIServo(SwClock* c)
 
     if (true == c->pi_servo_enabled) {
         pthread_rwlock_wrlock(&c->lock);
+        swclock_rebase_now_and_update(c);
         c->pi_servo_enabled = false;
         c->pi_int_error_s   = 0.0;
         c->pi_freq_ppm      = 0.0;
+        swclock_publish_timebase(c);
         pthread_rwlock_unlock(&c->lock);
     }
 }
@@ -964,9 +1501,7 @@ void swclock_start_log(SwClock* c, const char* filename) {
 void swclock_log(SwClock* c) {
     if (!c || !c->is_logging || !c->log_fp) return;
 
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC_RAW, &now);
-    long long now_ns = ts_to_ns(&now);
+    long long now_ns = swclock_rawsrc_now_ns();
 
     fprintf(c->log_fp,
         "%lld,"        // timestamp
@@ -1035,11 +1570,20 @@ void swclock_close_log(SwClock* c) {
 
 // Forward declaration
 static void* swclock_event_logger_thread_main(void* arg);
+static size_t swclock_event_drain(SwClock* c);
 
 static uint64_t swclock_get_timestamp_ns(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
-    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    return (uint64_t)swclock_rawsrc_now_ns();
+}
+
+// File header of event logs and flight recorder dumps
+static void swclock_event_file_header(SwClock* c, swclock_event_log_header_t* header) {
+    memset(header, 0, sizeof(*header));
+    header->magic         = SWCLOCK_EVENT_LOG_MAGIC;
+    header->version_major = (uint16_t)c->event_format;
+    header->version_minor = 0;
+    header->start_time_ns = swclock_get_timestamp_ns();
+    strncpy(header->swclock_version, SWCLOCK_VERSION, sizeof(header->swclock_version) - 1);
 }
 
 int swclock_start_event_log(SwClock* c, const char* filename) {
@@ -1053,43 +1597,58 @@ int swclock_start_event_log(SwClock* c, const char* filename) {
         return -1;
     }
 
-    // Open binary log file
-    c->event_log_fp = fopen(filename, "wb");
-    if (!c->event_log_fp) {
+    // File header, repeated at the start of every segment
+    swclock_event_log_header_t header;
+    swclock_event_file_header(c, &header);
+
+    // Map the first log segment; from here on only the logger thread appends
+    swclock_seglog_t* log = swclock_seglog_open(filename, c->event_segment_bytes,
+                                                c->event_log_max_bytes,
+                                                &header, sizeof(header));
+    if (!log) {
         pthread_rwlock_unlock(&c->lock);
         return -1;
     }
 
-    // Write file header
-    swclock_event_log_header_t header = {
-        .magic = SWCLOCK_EVENT_LOG_MAGIC,
-        .version_major = 1,
-        .version_minor = 0,
-        .start_time_ns = swclock_get_timestamp_ns()
-    };
-    strncpy(header.swclock_version, SWCLOCK_VERSION, sizeof(header.swclock_version) - 1);
-
-    if (fwrite(&header, sizeof(header), 1, c->event_log_fp) != 1) {
-        fclose(c->event_log_fp);
-        c->event_log_fp = NULL;
+    // Ring buffer lives out of line and is kept until destroy, so a concurrent
+    // swclock_log_event() never sees it freed
+    if (!c->event_ringbuf) {
+        c->event_ringbuf = (swclock_ringbuf_t*)malloc(sizeof(swclock_ringbuf_t));
+        if (!c->event_ringbuf) {
+            swclock_seglog_close(log);
+            pthread_rwlock_unlock(&c->lock);
+            return -1;
+        }
+    }
+    swclock_ringbuf_init(c->event_ringbuf);
+    c->event_log_path = strdup(filename);
+    if (!c->event_log_path) {
+        swclock_seglog_close(log);
         pthread_rwlock_unlock(&c->lock);
         return -1;
     }
-    fflush(c->event_log_fp);
-
-    // Initialize ring buffer
-    swclock_ringbuf_init(&c->event_ringbuf);
-    c->event_sequence = 0;
+    c->event_log = log;
+    // The flight recorder's history spans sessions; keep its numbering
+    if (!c->flightrec_enabled) c->event_sequence = 0;
+    c->event_segment_fresh = true;
+    swclock_evpolicy_reset(&c->event_policy);
+    pthread_mutex_lock(&c->event_stats_lock);
+    c->event_wakeups = 0;
+    c->event_segments = 1;
+    memset(&c->event_disk_latency, 0, sizeof(c->event_disk_latency));
+    pthread_mutex_unlock(&c->event_stats_lock);
     c->event_logging_enabled = true;
 
     // Start background logger thread
-    c->event_logger_running = true;
+    __atomic_store_n(&c->event_logger_running, true, __ATOMIC_RELEASE);
     if (pthread_create(&c->event_logger_thread, NULL,
                       swclock_event_logger_thread_main, c) != 0) {
         c->event_logging_enabled = false;
         c->event_logger_running = false;
-        fclose(c->event_log_fp);
-        c->event_log_fp = NULL;
+        swclock_seglog_close(log);
+        c->event_log = NULL;
+        free(c->event_log_path);
+        c->event_log_path = NULL;
         pthread_rwlock_unlock(&c->lock);
         return -1;
     }
@@ -1112,80 +1671,356 @@ void swclock_stop_event_log(SwClock* c) {
         return;
     }
 
-    // Log stop event
+    // Log stop event, then turn producers away
     pthread_rwlock_unlock(&c->lock);
     swclock_log_event(c, SWCLOCK_EVENT_LOG_STOP, NULL, 0);
     pthread_rwlock_wrlock(&c->lock);
-
-    // Stop logger thread
-    c->event_logger_running = false;
+    c->event_logging_enabled = false;
     pthread_rwlock_unlock(&c->lock);
 
+    // Stop logger thread; it drains what was committed before it exits
+    __atomic_store_n(&c->event_logger_running, false, __ATOMIC_RELEASE);
+    swclock_ringbuf_wake(c->event_ringbuf);
     pthread_join(c->event_logger_thread, NULL);
 
-    pthread_rwlock_wrlock(&c->lock);
+    // Events from producers that raced the flag above
+    while (swclock_event_drain(c) > 0) {
+    }
 
-    // Close file
-    if (c->event_log_fp) {
-        fclose(c->event_log_fp);
-        c->event_log_fp = NULL;
+    // Truncate the last segment to its used length and unmap
+    if (swclock_seglog_close(c->event_log) != 0) {
+        SWCLOCK_LOG_WARN("Event log close failed: %s", strerror(errno));
     }
+    c->event_log = NULL;
+    if (c->event_index_fd >= 0) {
+        close(c->event_index_fd);
+        c->event_index_fd = -1;
+    }
+    free(c->event_log_path);
+    c->event_log_path = NULL;
+}
 
-    c->event_logging_enabled = false;
+// Start a new sidecar index for the segment the log just moved to
+static void swclock_event_index_open(SwClock* c) {
+    if (c->event_index_fd >= 0) close(c->event_index_fd);
 
-    pthread_rwlock_unlock(&c->lock);
+    swclock_seglog_stats_t seg;
+    char name[1024];
+    swclock_seglog_get_stats(c->event_log, &seg);
+    c->event_index_fd = -1;
+    if (swclock_seglog_segment_path(c->event_log_path, seg.current_segment, name, sizeof(name)) == 0) {
+        c->event_index_fd = swclock_evindex_create(name);
+    }
+    if (c->event_index_fd < 0) {
+        SWCLOCK_LOG_WARN("Event log index not written: %s", strerror(errno));
+    }
 }
 
-void swclock_log_event(SwClock* c, swclock_event_type_t event_type,
-                      const void* payload, size_t payload_size) {
-    if (!c || !c->event_logging_enabled) return;
+// Copy (v1) or encode (v2) a batch of events straight into the mapped log
+// segment. A sync point, recorded in the segment's index, starts every
+// segment and follows every SWCLOCK_EVENT_SYNC_POINT_BYTES of records or
+// SWCLOCK_EVENT_SYNC_POINT_NS of event time; in v2 a sync marker there
+// restarts the delta coding so decoding can begin at it.
+static void swclock_event_write(SwClock* c, const struct iovec* iov, size_t count) {
+    const bool v1 = (c->event_format == 1);
+
+    for (size_t i = 0; i < count; i++) {
+        const swclock_event_header_t* h = (const swclock_event_header_t*)iov[i].iov_base;
+        size_t max = v1 ? iov[i].iov_len : SWCLOCK_EVCODEC_SYNC_SIZE + SWCLOCK_EVCODEC_MAX_RECORD;
+        bool new_segment;
+
+        uint8_t* dst = (uint8_t*)swclock_seglog_reserve(c->event_log, max, &new_segment);
+        if (!dst) {
+            SWCLOCK_LOG_WARN("Event log append failed: %s", strerror(errno));
+            return;
+        }
+        if (c->event_segment_fresh) {
+            new_segment = true;
+            c->event_segment_fresh = false;
+        }
+
+        uint64_t offset = swclock_seglog_offset(c->event_log);
+        size_t len = 0;
+        if (new_segment ||
+            offset - c->event_sync_offset >= (uint64_t)SWCLOCK_EVENT_SYNC_POINT_BYTES ||
+            (int64_t)(h->timestamp_ns - c->event_sync_ts) >= SWCLOCK_EVENT_SYNC_POINT_NS) {
+            if (new_segment) {
+                swclock_evcodec_reset(&c->event_codec);
+                swclock_event_index_open(c);
+            } else if (!v1) {
+                len = swclock_evcodec_sync(&c->event_codec, dst);
+            }
+            c->event_sync_offset = offset;
+            c->event_sync_ts = h->timestamp_ns;
+
+            swclock_event_index_entry_t entry = {
+                .timestamp_ns = h->timestamp_ns,
+                .sequence_num = h->sequence_num,
+                .offset = offset
+            };
+            if (c->event_index_fd >= 0 && swclock_evindex_append(c->event_index_fd, &entry) != 0) {
+                SWCLOCK_LOG_WARN("Event log index write failed: %s", strerror(errno));
+                close(c->event_index_fd);
+                c->event_index_fd = -1;
+            }
+        }
+
+        if (v1) {
+            memcpy(dst, iov[i].iov_base, iov[i].iov_len);
+            len += iov[i].iov_len;
+        } else {
+            len += swclock_evcodec_encode(&c->event_codec, h, h + 1, dst + len);
+        }
+        swclock_seglog_commit(c->event_log, len);
+    }
+}
+
+// Copy (v1) or encode (v2) one batch of committed events straight from ring
+// memory into the mapped log segment, then release it. Consumer side: logger thread, or stop after
+// join. Returns the number of events drained.
+static size_t swclock_event_drain(SwClock* c) {
+    struct iovec iov[SWCLOCK_EVENT_BATCH_IOV];
+    size_t iov_count = 0, records = 0;
+
+    size_t ring_bytes = swclock_ringbuf_peek_batch(c->event_ringbuf, iov,
+                                                   SWCLOCK_EVENT_BATCH_IOV,
+                                                   &iov_count, &records);
+    if (records == 0) {
+        // Only wrap padding
+        swclock_ringbuf_release(c->event_ringbuf, ring_bytes, 0);
+        return 0;
+    }
+
+    swclock_event_write(c, iov, iov_count);
+
+    // Latency to the log, from each event's timestamp (one event per iovec);
+    // read before the release zeroes the records
+    uint64_t now = swclock_get_timestamp_ns();
+    swclock_seglog_stats_t seg;
+    swclock_seglog_get_stats(c->event_log, &seg);
+    pthread_mutex_lock(&c->event_stats_lock);
+    for (size_t i = 0; i < iov_count; i++) {
+        const swclock_event_header_t* h = (const swclock_event_header_t*)iov[i].iov_base;
+        swclock_histogram_record(&c->event_disk_latency, (int64_t)(now - h->timestamp_ns));
+    }
+    c->event_segments = seg.segments;
+    pthread_mutex_unlock(&c->event_stats_lock);
+
+    swclock_ringbuf_release(c->event_ringbuf, ring_bytes, records);
+    return records;
+}
+
+static void swclock_event_emit(SwClock* c, swclock_event_type_t event_type,
+                               const void* payload, size_t payload_size) {
+    if (payload_size > SWCLOCK_EVENT_MAX_SIZE - sizeof(swclock_event_header_t)) return;
+
+    // Serialize straight into ring memory (non-blocking; dropped if full) and,
+    // in flight-recorder mode, over the recorder's oldest event
+    uint8_t* slot = NULL;
+    if (c->event_logging_enabled) {
+        slot = (uint8_t*)swclock_ringbuf_reserve(c->event_ringbuf,
+                                                 sizeof(swclock_event_header_t) + payload_size);
+    }
+    uint64_t ticket = 0;
+    uint8_t* fr_slot = NULL;
+    if (c->flightrec_enabled) {
+        fr_slot = (uint8_t*)swclock_flightrec_reserve(c->flightrec, &ticket);
+    }
+    if (!slot && !fr_slot) return;
 
-    // Build event header
     swclock_event_header_t header = {
         .sequence_num = __atomic_fetch_add(&c->event_sequence, 1, __ATOMIC_SEQ_CST),
         .timestamp_ns = swclock_get_timestamp_ns(),
-        .event_type = event_type,
+        .event_type   = event_type,
         .payload_size = (uint16_t)payload_size,
-        .reserved = 0
+        .reserved     = 0
     };
+    if (slot) {
+        memcpy(slot, &header, sizeof(header));
+        if (payload && payload_size > 0) {
+            memcpy(slot + sizeof(header), payload, payload_size);
+        }
+        swclock_ringbuf_commit(c->event_ringbuf, slot);
+    }
+    if (fr_slot) {
+        memcpy(fr_slot, &header, sizeof(header));
+        if (payload && payload_size > 0) {
+            memcpy(fr_slot + sizeof(header), payload, payload_size);
+        }
+        swclock_flightrec_commit(c->flightrec, ticket);
+    }
+}
+
+void swclock_log_event(SwClock* c, swclock_event_type_t event_type,
+                      const void* payload, size_t payload_size) {
+    if (!c || !(c->event_logging_enabled || c->flightrec_enabled)) return;
+    if (!swclock_evpolicy_admit_payload(&c->event_policy, event_type, payload, payload_size)) return;
+    swclock_event_emit(c, event_type, payload, payload_size);
+}
+
+int swclock_set_event_policy(SwClock* c, swclock_event_type_t event_type,
+                             const swclock_event_policy_t* policy) {
+    if (!c) {
+        errno = EINVAL;
+        return -1;
+    }
+    // Setters are serialized by the lock; admission never takes it
+    pthread_rwlock_wrlock(&c->lock);
+    int ret = swclock_evpolicy_set(&c->event_policy, event_type, policy);
+    pthread_rwlock_unlock(&c->lock);
+    return ret;
+}
+
+int swclock_get_event_policy(SwClock* c, swclock_event_type_t event_type,
+                             swclock_event_policy_t* policy) {
+    if (!c) {
+        errno = EINVAL;
+        return -1;
+    }
+    pthread_rwlock_rdlock(&c->lock);
+    int ret = swclock_evpolicy_get(&c->event_policy, event_type, policy);
+    pthread_rwlock_unlock(&c->lock);
+    return ret;
+}
+
+uint64_t swclock_get_event_suppressed(SwClock* c, swclock_event_type_t event_type) {
+    return c ? swclock_evpolicy_suppressed(&c->event_policy, event_type) : 0;
+}
+
+// Monitor threshold alerts (compute thread)
+static void swclock_flightrec_alert(void* ctx, const char* metric, double value, double threshold) {
+    (void)metric;
+    (void)value;
+    (void)threshold;
+    SwClock* c = (SwClock*)ctx;
+    swclock_flightrec_trigger(__atomic_load_n(&c->flightrec, __ATOMIC_ACQUIRE),
+                              SWCLOCK_FLIGHTREC_ON_THRESHOLD);
+}
+
+int swclock_enable_flight_recorder(SwClock* c, const swclock_flightrec_config_t* config) {
+    if (!c || !config) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pthread_rwlock_wrlock(&c->lock);
+
+    // Kept until destroy, like the event ring, so producers never see it freed
+    if (!c->flightrec) {
+        swclock_flightrec_t* fr = swclock_flightrec_create(config->events);
+        if (!fr) {
+            pthread_rwlock_unlock(&c->lock);
+            return -1;
+        }
+        __atomic_store_n(&c->flightrec, fr, __ATOMIC_RELEASE);
+    }
+
+    swclock_flightrec_t* fr = c->flightrec;
+    swclock_event_log_header_t header;
+    swclock_event_file_header(c, &header);
+    pthread_rwlock_unlock(&c->lock);
+
+    // Restarting the triggers waits for a triggered dump in progress; the
+    // poll thread must not wait with it
+    const char* prefix = config->dump_prefix ? config->dump_prefix : "logs/flightrec";
+    if (swclock_flightrec_start_triggers(fr, prefix, config->triggers, &header) != 0) {
+        return -1;
+    }
+
+    pthread_rwlock_wrlock(&c->lock);
+    c->flightrec_enabled = true;
+    pthread_rwlock_unlock(&c->lock);
+    return 0;
+}
 
-    // Combine header + payload into single buffer
-    uint8_t event_buffer[SWCLOCK_EVENT_MAX_SIZE];
-    memcpy(event_buffer, &header, sizeof(header));
-    if (payload && payload_size > 0) {
-        memcpy(event_buffer + sizeof(header), payload, payload_size);
+void swclock_disable_flight_recorder(SwClock* c) {
+    if (!c) return;
+
+    pthread_rwlock_wrlock(&c->lock);
+    c->flightrec_enabled = false;
+    pthread_rwlock_unlock(&c->lock);
+
+    // Waits for a triggered dump in progress; the history is kept for
+    // swclock_flight_recorder_dump()
+    swclock_flightrec_stop_triggers(c->flightrec);
+}
+
+long swclock_flight_recorder_dump(SwClock* c, const char* path) {
+    if (!c || !path) {
+        errno = EINVAL;
+        return -1;
     }
 
-    // Push to ring buffer (non-blocking)
-    swclock_ringbuf_push(&c->event_ringbuf, event_buffer,
-                        sizeof(header) + payload_size);
+    pthread_rwlock_rdlock(&c->lock);
+    swclock_flightrec_t* fr = c->flightrec;
+    swclock_event_log_header_t header;
+    swclock_event_file_header(c, &header);
+    pthread_rwlock_unlock(&c->lock);
+
+    if (!fr) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    return swclock_flightrec_write(fr, path, &header);
+}
+
+int swclock_get_flight_recorder_stats(SwClock* c, swclock_flightrec_stats_t* stats) {
+    if (!c || !stats) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!c->flightrec) {
+        memset(stats, 0, sizeof(*stats));
+        return 0;
+    }
+    swclock_flightrec_get_stats(c->flightrec, stats);
+    return 0;
+}
+
+int swclock_get_event_log_stats(SwClock* c, swclock_event_log_stats_t* stats) {
+    if (!c || !stats) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+
+    // The ring buffer is only replaced under the lock and never freed before destroy
+    pthread_rwlock_rdlock(&c->lock);
+    if (c->event_ringbuf) {
+        swclock_ringbuf_stats(c->event_ringbuf, &stats->logged, &stats->written, &stats->dropped);
+        stats->pending_bytes = swclock_ringbuf_used(c->event_ringbuf);
+    }
+    pthread_rwlock_unlock(&c->lock);
+
+    pthread_mutex_lock(&c->event_stats_lock);
+    stats->wakeups      = c->event_wakeups;
+    stats->disk_latency = c->event_disk_latency;
+    stats->segments     = c->event_segments;
+    stats->suppressed   = swclock_evpolicy_suppressed_total(&c->event_policy);
+    pthread_mutex_unlock(&c->event_stats_lock);
+    return 0;
 }
 
 static void* swclock_event_logger_thread_main(void* arg) {
     SwClock* c = (SwClock*)arg;
-    uint8_t event_buffer[SWCLOCK_EVENT_MAX_SIZE];
 
-    while (c->event_logger_running || !swclock_ringbuf_is_empty(&c->event_ringbuf)) {
-        size_t event_size;
+    // Never takes c->lock: the seglog belongs to this thread until stop joins it
+    for (;;) {
+        bool running = __atomic_load_n(&c->event_logger_running, __ATOMIC_ACQUIRE);
 
-        // Pop event from ring buffer
-        if (swclock_ringbuf_pop(&c->event_ringbuf, event_buffer,
-                               SWCLOCK_EVENT_MAX_SIZE, &event_size)) {
-            // Write to file
-            pthread_rwlock_wrlock(&c->lock);
-            if (c->event_log_fp) {
-                fwrite(event_buffer, 1, event_size, c->event_log_fp);
-                fflush(c->event_log_fp);
-            }
-            pthread_rwlock_unlock(&c->lock);
-        } else {
-            // No events available, sleep briefly
-            struct timespec ts = { .tv_sec = 0, .tv_nsec = 1000000 }; // 1ms
-            nanosleep(&ts, NULL);
+        if (swclock_event_drain(c) == 0) {
+            if (!running && swclock_ringbuf_is_empty(c->event_ringbuf)) break;
+
+            // Nothing committed: sleep until a producer rings or the flush deadline
+            swclock_ringbuf_wait(c->event_ringbuf, c->event_flush_ns);
+            pthread_mutex_lock(&c->event_stats_lock);
+            c->event_wakeups++;
+            pthread_mutex_unlock(&c->event_stats_lock);
         }
 
         // Check for overruns
-        if (swclock_ringbuf_clear_overrun(&c->event_ringbuf)) {
+        if (swclock_ringbuf_clear_overrun(c->event_ringbuf)) {
             SWCLOCK_LOG_WARN("Event ring buffer overrun detected");
         }
     }
@@ -1219,6 +2054,10 @@ int swclock_enable_monitoring(SwClock* c, bool enable) {
             return -1;
         }
 
+        // Threshold alerts also trigger flight recorder dumps
+        c->monitor->alert_hook = swclock_flightrec_alert;
+        c->monitor->alert_hook_ctx = c;
+
         // Start background computation thread
         if (swclock_monitor_start_compute_thread(c->monitor) != 0) {
             swclock_monitor_destroy(c->monitor);
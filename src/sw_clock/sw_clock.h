@@ -22,6 +22,10 @@ extern "C" {
 #include "sw_clock_events.h"
 #include "sw_clock_ringbuf.h"
 #include "sw_clock_monitor.h"
+#include "sw_clock_shm.h"
+#include "sw_clock_rawsrc.h"
+#include "sw_clock_histogram.h"
+#include "sw_clock_flightrec.h"
 #include <stdio.h>
 
 // -------- timex compatibility (for macOS) -------------------
@@ -116,6 +120,35 @@ void     swclock_destroy(SwClock* c);
  */
 int      swclock_gettime(SwClock* c, clockid_t clk_id, struct timespec *tp);
 
+/**
+ * Convert captured raw timestamps (CLOCK_MONOTONIC_RAW, ns) to disciplined
+ * time in one pass, lock-free. Timestamps at or after the last rebase use
+ * the current timebase snapshot (AVX2 kernel when available); older ones
+ * use the timebase segment that was in force when they were taken, from a
+ * bounded history (SWCLOCK_HISTORY_SEGMENTS), so delayed post-processing
+ * gives the same result as converting at capture time.
+ * @param c Pointer to SwClock instance
+ * @param clk_id Clock ID (CLOCK_REALTIME, CLOCK_MONOTONIC; CLOCK_MONOTONIC_RAW copies)
+ * @param raw_ns Input raw timestamps in nanoseconds
+ * @param out_ns Output timestamps in nanoseconds (may alias raw_ns)
+ * @param n Number of timestamps
+ * @return Number of timestamps older than the retained history (converted
+ *         by extrapolating the oldest segment; normally 0), or -1 on failure
+ *         (errno set)
+ */
+int      swclock_raw_to_time_batch(SwClock* c, clockid_t clk_id, const int64_t* raw_ns,
+                                   int64_t* out_ns, size_t n);
+
+/**
+ * Convert a single captured raw timestamp; see swclock_raw_to_time_batch().
+ * @param c Pointer to SwClock instance
+ * @param clk_id Clock ID (CLOCK_REALTIME, CLOCK_MONOTONIC, CLOCK_MONOTONIC_RAW)
+ * @param raw_ns Raw timestamp in nanoseconds
+ * @param tp Pointer to timespec structure to receive the time
+ * @return 0 on success, 1 if raw_ns predates the retained history, -1 on failure (errno set)
+ */
+int      swclock_raw_to_time(SwClock* c, clockid_t clk_id, int64_t raw_ns, struct timespec* tp);
+
 /** 
  * Functionally identical to Linux clock_settime for REALTIME (MONOTONIC cannot be set) 
  * @param c Pointer to SwClock instance
@@ -139,6 +172,72 @@ int      swclock_adjtime(SwClock* c, struct timex *tptr);
  */
 void     swclock_poll(SwClock* c);
 
+/**
+ * Background poll timing of a clock. Polls run on absolute CLOCK_MONOTONIC
+ * deadlines every period_ns; lateness and run time are recorded on every
+ * poll, so sustained host load shows up here before it shows up as servo
+ * error.
+ */
+typedef struct {
+    uint64_t polls;                 /**< Background polls run */
+    int64_t  period_ns;             /**< Current poll period (SWCLOCK_POLL_NS unless backed off) */
+    uint64_t overruns;              /**< Polls that woke a full period or more late */
+    swclock_histogram_t wake_late;  /**< Wakeup time minus deadline */
+    swclock_histogram_t duration;   /**< Poll body run time (servo update, logging, monitoring) */
+    bool     shared_scheduler;      /**< Polled by the shared scheduler (else own thread) */
+} swclock_poll_stats_t;
+
+/**
+ * Get background poll timing statistics (counted since creation).
+ * @param c Pointer to SwClock instance
+ * @param stats Output statistics
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int      swclock_get_poll_stats(SwClock* c, swclock_poll_stats_t* stats);
+
+/**
+ * Adaptive poll rate. While the servo is idle (no phase left to slew, zero
+ * PI output, monitoring off) the poll period doubles after each poll up to
+ * max_period_ns; slewing, monitoring or an swclock_adjtime() call return
+ * it to SWCLOCK_POLL_NS, and adjtime wakes a backed-off poller at once.
+ * Also enabled at creation by SWCLOCK_ADAPTIVE_POLL_MAX_MS.
+ * @param c Pointer to SwClock instance
+ * @param max_period_ns Ceiling (up to SWCLOCK_POLL_MAX_PERIOD_NS); values
+ *                      <= SWCLOCK_POLL_NS restore the fixed rate (default)
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int      swclock_set_adaptive_poll(SwClock* c, int64_t max_period_ns);
+
+/**
+ * Select how clocks created from now on are polled: threads > 0 registers
+ * them with one process-wide scheduler served by that many worker threads
+ * (sharing one deadline heap and wakeup instead of a thread per clock);
+ * 0 gives each clock its own poll thread (default). Overrides
+ * SWCLOCK_SHARED_POLL_THREADS. The worker count is fixed while any clock
+ * uses the shared scheduler.
+ * @param threads Shared worker threads (0 .. SWCLOCK_SCHED_MAX_THREADS)
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int      swclock_use_shared_scheduler(unsigned threads);
+
+/**
+ * Publish this clock's timebase into a named POSIX shared-memory page.
+ * Other processes read it with swclock_shm_open()/swclock_shm_gettime()
+ * (see sw_clock_shm.h) without IPC or locks. Also enabled at creation
+ * time by setting SWCLOCK_SHM_NAME.
+ * @param c Pointer to SwClock instance
+ * @param name Shared memory object name (e.g. "/swclock0")
+ * @return 0 on success, -1 on failure (errno set, EBUSY if already enabled,
+ *         EEXIST if another live process publishes under name)
+ */
+int      swclock_enable_shm(SwClock* c, const char* name);
+
+/**
+ * Stop publishing and unlink the shared-memory timebase page.
+ * @param c Pointer to SwClock instance
+ */
+void     swclock_disable_shm(SwClock* c);
+
 /**
  * Start logging clock state to a file.
  * @param c Pointer to SwClock instance
@@ -189,6 +288,115 @@ void     swclock_stop_event_log(SwClock* c);
 void     swclock_log_event(SwClock* c, swclock_event_type_t event_type,
                            const void* payload, size_t payload_size);
 
+/**
+ * Event logging counters for the current (or last) event log session.
+ * swclock_log_event() may be called from any thread; events that find the
+ * ring buffer full are dropped and counted, never blocked on. The logger
+ * thread sleeps until a producer commits into an empty ring, or at most
+ * SWCLOCK_EVENT_FLUSH_MS (default 1000 ms).
+ */
+typedef struct {
+    uint64_t logged;                /**< Events accepted into the ring buffer */
+    uint64_t dropped;               /**< Events lost because the ring buffer was full */
+    uint64_t written;               /**< Events drained by the logger thread */
+    uint64_t pending_bytes;         /**< Ring buffer bytes not yet drained */
+    uint64_t wakeups;               /**< Logger thread wakeups on an empty ring (doorbell or flush deadline) */
+    swclock_histogram_t disk_latency; /**< Event timestamp to its copy into the mapped log */
+    uint32_t segments;              /**< Log segment files created (oldest may be deleted) */
+    uint64_t suppressed;            /**< Events rejected by sampling policies (all types) */
+} swclock_event_log_stats_t;
+
+/**
+ * Get event logging counters.
+ * @param c Pointer to SwClock instance
+ * @param stats Output counters (all zero if event logging never started)
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int      swclock_get_event_log_stats(SwClock* c, swclock_event_log_stats_t* stats);
+
+/**
+ * Set the sampling policy of one event type (default SWCLOCK_EVENT_POLICY_ALWAYS).
+ * Takes effect for the next event of that type and resets its sampling
+ * state; rejected events are never built or queued, only counted. Initial
+ * policies can also come from SWCLOCK_EVENT_POLICY, e.g.
+ * "PI_STEP=1/10,FREQUENCY_CLAMP=rate:1/5" (see sw_clock_evpolicy.h).
+ * @param c Pointer to SwClock instance
+ * @param event_type Event type (0x01-0xFF)
+ * @param policy Policy (see swclock_event_policy_t)
+ * @return 0 on success, -1 on failure (errno = EINVAL)
+ */
+int      swclock_set_event_policy(SwClock* c, swclock_event_type_t event_type,
+                                  const swclock_event_policy_t* policy);
+
+/**
+ * Get the sampling policy of one event type.
+ * @param c Pointer to SwClock instance
+ * @param event_type Event type
+ * @param policy Output policy
+ * @return 0 on success, -1 on failure (errno = EINVAL)
+ */
+int      swclock_get_event_policy(SwClock* c, swclock_event_type_t event_type,
+                                  swclock_event_policy_t* policy);
+
+/**
+ * Events of one type rejected by its sampling policy since the event log
+ * was (last) started.
+ * @param c Pointer to SwClock instance
+ * @param event_type Event type
+ * @return Suppressed event count
+ */
+uint64_t swclock_get_event_suppressed(SwClock* c, swclock_event_type_t event_type);
+
+/**
+ * Flight recorder configuration.
+ */
+typedef struct {
+    const char* dump_prefix;    /**< Triggered dump path prefix (NULL: "logs/flightrec") */
+    uint32_t    events;         /**< Events kept (0: SWCLOCK_FLIGHTREC_EVENTS); fixed by the first enable */
+    uint32_t    triggers;       /**< SWCLOCK_FLIGHTREC_ON_* bits that start a dump (0: API dumps only) */
+} swclock_flightrec_config_t;
+
+/**
+ * Keep the most recent events in memory (flight-recorder mode).
+ * Events admitted by their sampling policy are written over the oldest
+ * ones in a fixed in-memory history, with or without an event log file and
+ * with no logger thread. The history is written out only by
+ * swclock_flight_recorder_dump() or when a trigger fires: a monitoring
+ * threshold alert, the servo watchdog (servo stuck), or SIGUSR2. Triggered
+ * dumps run on a worker thread, at most once per 10 s, to
+ * "<prefix>-<UTC time>-<reason>.bin". Calling it again changes the
+ * triggers. Also enabled by SWCLOCK_FLIGHTREC=<prefix> (all triggers).
+ * @param c Pointer to SwClock instance
+ * @param config Configuration
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int      swclock_enable_flight_recorder(SwClock* c, const swclock_flightrec_config_t* config);
+
+/**
+ * Stop recording and triggering; the history is kept for a later dump.
+ * @param c Pointer to SwClock instance
+ */
+void     swclock_disable_flight_recorder(SwClock* c);
+
+/**
+ * Write the flight recorder history to an event log file, oldest first.
+ * Producers are not paused; the file is replaced atomically and can be
+ * read with swclock_event_dump.
+ * @param c Pointer to SwClock instance
+ * @param path Output file
+ * @return Events written, or -1 on failure (errno = ENOTSUP if the flight
+ *         recorder was never enabled)
+ */
+long     swclock_flight_recorder_dump(SwClock* c, const char* path);
+
+/**
+ * Get flight recorder trigger counters (all zero if never enabled).
+ * @param c Pointer to SwClock instance
+ * @param stats Output counters
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int      swclock_get_flight_recorder_stats(SwClock* c, swclock_flightrec_stats_t* stats);
+
 /**
  * Enable real-time monitoring mode.
  * @param c Pointer to SwClock instance
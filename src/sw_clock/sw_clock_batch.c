@@ -0,0 +1,151 @@
+/**
+ * @file sw_clock_batch.c
+ * @brief Scalar and AVX2 batched timestamp conversion kernels
+ */
+
+#include "sw_clock_batch.h"
+#include "sw_clock_utilities.h"
+#include <errno.h>
+#include <stdatomic.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+  #include <immintrin.h>
+  #define SWCLOCK_HAVE_AVX2_KERNEL 1
+#else
+  #define SWCLOCK_HAVE_AVX2_KERNEL 0
+#endif
+
+void swclock_batch_convert_scalar(int64_t ref_raw_ns, int64_t base_ns, uint64_t mult,
+                                  uint32_t shift, const int64_t* raw, int64_t* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = base_ns + mul_s64_shr(raw[i] - ref_raw_ns, mult, shift);
+    }
+}
+
+#if SWCLOCK_HAVE_AVX2_KERNEL
+
+// Largest |elapsed| the vector kernel handles exactly (keeps partial products < 2^53)
+#define SWCLOCK_BATCH_MAX_ELAPSED (1LL << 51)
+
+// Largest |mult - 2^shift| the vector kernel handles (±3900 ppm at shift 48)
+#define SWCLOCK_BATCH_MAX_DELTA   (1ULL << 40)
+
+__attribute__((target("avx2")))
+static void swclock_batch_kernel_avx2(int64_t ref_raw_ns, int64_t base_ns, uint64_t mult,
+                                      uint32_t shift, const int64_t* raw, int64_t* out,
+                                      size_t n) {
+    // out = base + e + floor(e * d / 2^shift), d = mult - 2^shift, computed as
+    // sign * |e| * |d| from 32-bit halves:
+    //   |e|*|d| = p2 * 2^64 + p1 * 2^32 + p0
+    //   q = |e|*|d| >> shift = (p2 << (64 - shift)) + ((p1 + (p0 >> 32)) >> (shift - 32))
+    int64_t  d    = (int64_t)(mult - (1ULL << shift));
+    uint64_t dabs = (d < 0) ? (uint64_t)0 - (uint64_t)d : (uint64_t)d;
+
+    const __m256i vref    = _mm256_set1_epi64x(ref_raw_ns);
+    const __m256i vbase   = _mm256_set1_epi64x(base_ns);
+    const __m256i vd_lo   = _mm256_set1_epi64x((int64_t)(dabs & 0xffffffffULL));
+    const __m256i vd_hi   = _mm256_set1_epi64x((int64_t)(dabs >> 32));
+    const __m256i vdsign  = _mm256_set1_epi64x((d < 0) ? -1 : 0);
+    const __m256i vlimit  = _mm256_set1_epi64x(SWCLOCK_BATCH_MAX_ELAPSED);
+    const __m256i vneg1   = _mm256_set1_epi64x(-1);
+    const __m256i vlo32   = _mm256_set1_epi64x(0xffffffffLL);
+    const __m256i vremmsk = _mm256_set1_epi64x((int64_t)((1ULL << (shift - 32)) - 1));
+    const __m256i vzero   = _mm256_setzero_si256();
+    const __m128i sh_mid  = _mm_cvtsi32_si128((int)(shift - 32));
+    const __m128i sh_hi   = _mm_cvtsi32_si128((int)(64 - shift));
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i e     = _mm256_sub_epi64(_mm256_loadu_si256((const __m256i*)(raw + i)), vref);
+        __m256i esign = _mm256_cmpgt_epi64(vzero, e);
+        __m256i eabs  = _mm256_sub_epi64(_mm256_xor_si256(e, esign), esign);
+
+        // 0 <= |e| < 2^51 in every lane, else do this group in scalar
+        __m256i ok = _mm256_and_si256(_mm256_cmpgt_epi64(vlimit, eabs),
+                                      _mm256_cmpgt_epi64(eabs, vneg1));
+        if (_mm256_movemask_pd(_mm256_castsi256_pd(ok)) != 0xf) {
+            swclock_batch_convert_scalar(ref_raw_ns, base_ns, mult, shift, raw + i, out + i, 4);
+            continue;
+        }
+
+        __m256i e_hi = _mm256_srli_epi64(eabs, 32);
+        __m256i p0   = _mm256_mul_epu32(eabs, vd_lo);
+        __m256i p1   = _mm256_add_epi64(_mm256_mul_epu32(e_hi, vd_lo),
+                                        _mm256_mul_epu32(eabs, vd_hi));
+        __m256i p2   = _mm256_mul_epu32(e_hi, vd_hi);
+        __m256i mid  = _mm256_add_epi64(p1, _mm256_srli_epi64(p0, 32));
+        __m256i q    = _mm256_add_epi64(_mm256_sll_epi64(p2, sh_hi), _mm256_srl_epi64(mid, sh_mid));
+
+        // Negative products round toward -inf: -(q + 1) if any remainder bit is set
+        __m256i rem  = _mm256_or_si256(_mm256_and_si256(mid, vremmsk), _mm256_and_si256(p0, vlo32));
+        __m256i nz   = _mm256_xor_si256(_mm256_cmpeq_epi64(rem, vzero), vneg1);
+        __m256i negq = _mm256_sub_epi64(vzero, _mm256_sub_epi64(q, nz));
+        __m256i corr = _mm256_blendv_epi8(q, negq, _mm256_xor_si256(esign, vdsign));
+
+        __m256i res  = _mm256_add_epi64(_mm256_add_epi64(vbase, e), corr);
+        _mm256_storeu_si256((__m256i*)(out + i), res);
+    }
+
+    swclock_batch_convert_scalar(ref_raw_ns, base_ns, mult, shift, raw + i, out + i, n - i);
+}
+
+// AVX2 kernel where its delta form applies, scalar otherwise
+static void swclock_batch_convert_vector(int64_t ref_raw_ns, int64_t base_ns, uint64_t mult,
+                                         uint32_t shift, const int64_t* raw, int64_t* out,
+                                         size_t n) {
+    // Delta form needs 32 <= shift < 64 and a small |mult - 2^shift|
+    if (shift < 32 || shift > 63) {
+        swclock_batch_convert_scalar(ref_raw_ns, base_ns, mult, shift, raw, out, n);
+        return;
+    }
+    int64_t  d    = (int64_t)(mult - (1ULL << shift));
+    uint64_t dabs = (d < 0) ? (uint64_t)0 - (uint64_t)d : (uint64_t)d;
+    if (dabs >= SWCLOCK_BATCH_MAX_DELTA) {
+        swclock_batch_convert_scalar(ref_raw_ns, base_ns, mult, shift, raw, out, n);
+        return;
+    }
+
+    swclock_batch_kernel_avx2(ref_raw_ns, base_ns, mult, shift, raw, out, n);
+}
+
+#endif /* SWCLOCK_HAVE_AVX2_KERNEL */
+
+typedef void (*swclock_batch_fn)(int64_t, int64_t, uint64_t, uint32_t,
+                                 const int64_t*, int64_t*, size_t);
+
+// Kernel for this CPU, resolved on first use
+static _Atomic(swclock_batch_fn) g_kernel;
+
+static swclock_batch_fn swclock_batch_kernel(void) {
+    swclock_batch_fn fn = atomic_load_explicit(&g_kernel, memory_order_relaxed);
+    if (fn) return fn;
+
+    fn = swclock_batch_convert_scalar;
+#if SWCLOCK_HAVE_AVX2_KERNEL
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) fn = swclock_batch_convert_vector;
+#endif
+    // Racing first callers all resolve the same kernel
+    atomic_store_explicit(&g_kernel, fn, memory_order_relaxed);
+    return fn;
+}
+
+int swclock_batch_convert_avx2(int64_t ref_raw_ns, int64_t base_ns, uint64_t mult,
+                               uint32_t shift, const int64_t* raw, int64_t* out, size_t n) {
+    swclock_batch_fn fn = swclock_batch_kernel();
+    if (fn == swclock_batch_convert_scalar) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    fn(ref_raw_ns, base_ns, mult, shift, raw, out, n);
+    return 0;
+}
+
+void swclock_batch_convert(int64_t ref_raw_ns, int64_t base_ns, uint64_t mult, uint32_t shift,
+                           const int64_t* raw, int64_t* out, size_t n) {
+    swclock_batch_kernel()(ref_raw_ns, base_ns, mult, shift, raw, out, n);
+}
+
+const char* swclock_batch_kernel_name(void) {
+    return (swclock_batch_kernel() == swclock_batch_convert_scalar) ? "scalar" : "avx2";
+}
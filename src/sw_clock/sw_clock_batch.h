@@ -0,0 +1,76 @@
+/**
+ * @file sw_clock_batch.h
+ * @brief Batched raw-to-disciplined timestamp conversion kernels
+ *
+ * Converts arrays of raw (CLOCK_MONOTONIC_RAW timeline) timestamps with a
+ * single timebase snapshot:
+ *
+ *   out[i] = base_ns + floor((raw[i] - ref_raw_ns) * mult / 2^shift)
+ *
+ * Elapsed values may be negative (timestamps captured before the last
+ * rebase). All kernels produce bit-identical results; the vector kernel
+ * uses the delta form e + floor(e * (mult - 2^shift) / 2^shift), which
+ * needs only 32x32-bit multiplies.
+ *
+ * Kernels: scalar (always) and AVX2 (x86-64, selected at runtime). A
+ * NEON kernel can be added behind swclock_batch_convert() the same way.
+ *
+ * Most callers want swclock_raw_to_time_batch() in sw_clock.h.
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_BATCH_H
+#define SWCLOCK_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Convert with the best kernel available on this CPU
+ *
+ * @param ref_raw_ns Snapshot reference raw time (ns)
+ * @param base_ns Disciplined time at ref_raw_ns (ns)
+ * @param mult Fixed-point rate multiplier
+ * @param shift Fraction bits of mult
+ * @param raw Input raw timestamps (ns)
+ * @param out Output disciplined timestamps (ns); may alias raw
+ * @param n Number of elements
+ */
+void swclock_batch_convert(int64_t ref_raw_ns, int64_t base_ns, uint64_t mult, uint32_t shift,
+                           const int64_t* raw, int64_t* out, size_t n);
+
+/**
+ * @brief Portable scalar kernel (reference implementation)
+ */
+void swclock_batch_convert_scalar(int64_t ref_raw_ns, int64_t base_ns, uint64_t mult,
+                                  uint32_t shift, const int64_t* raw, int64_t* out, size_t n);
+
+/**
+ * @brief AVX2 kernel
+ *
+ * Elements outside the kernel's exact range (|elapsed| >= 2^51 ns, about
+ * 26 days) and rates it cannot represent fall back to the scalar kernel.
+ *
+ * @return 0 on success, -1 with errno = ENOTSUP if AVX2 is not available
+ */
+int swclock_batch_convert_avx2(int64_t ref_raw_ns, int64_t base_ns, uint64_t mult,
+                               uint32_t shift, const int64_t* raw, int64_t* out, size_t n);
+
+/**
+ * @brief Name of the kernel swclock_batch_convert() dispatches to
+ *
+ * @return "avx2" or "scalar"
+ */
+const char* swclock_batch_kernel_name(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_BATCH_H */
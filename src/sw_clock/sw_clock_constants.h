@@ -35,9 +35,71 @@ extern "C" {
 // Limit the PI frequency correction (in ppm)
 #define SWCLOCK_PI_MAX_PPM       200.0   // ppm conservative default
 
+// Longest PI integration step; a later poll (host stall, the first poll
+// after an adaptive back-off) integrates only this much
+#define SWCLOCK_PI_MAX_DT_NS     (4LL * SWCLOCK_POLL_NS)  // 40 ms
+
 // When the remaining phase error magnitude drops below this, zero the PI
 #define SWCLOCK_PHASE_EPS_NS     20000LL   // 20 µs
 
+// Cache line size used to keep read-path and writer state apart
+#if defined(__APPLE__) && defined(__aarch64__)
+#define SWCLOCK_CACHELINE        128
+#else
+#define SWCLOCK_CACHELINE        64
+#endif
+
+// Fraction bits of the fixed-point rate multiplier (factor * 2^shift).
+// With a 128-bit intermediate product the rounding error is bounded by
+// 2^-(shift+1) of the elapsed time (< 0.2 ns per day) plus 1 ns truncation.
+#define SWCLOCK_RATE_SHIFT       48
+
+// TSC raw source calibration (see sw_clock_rawsrc.h)
+#define SWCLOCK_TSC_CALIB_INITIAL_NS   (10LL * NS_PER_MS)    // first frequency estimate window
+#define SWCLOCK_TSC_CALIB_INTERVAL_NS  (1000LL * NS_PER_MS)  // drift re-estimation period
+#define SWCLOCK_TSC_RESYNC_NS          (1000LL * NS_PER_US)  // re-anchor (behind) or fast slew (ahead) above 1 ms
+#define SWCLOCK_TSC_MAX_SLEW_PPM       500.0                 // max rate correction per interval
+#define SWCLOCK_TSC_RESYNC_SLEW_PPM    5000.0                // max rate correction when far ahead
+
+// Timebase history retained for converting past raw timestamps (power of two).
+// One segment per publish: 2048 segments cover ~20 s at the 10 ms poll rate.
+#define SWCLOCK_HISTORY_SEGMENTS       2048
+
+// Shared poll scheduler (see sw_clock_scheduler.h): ticks due within the
+// slack are run in the same wakeup instead of sleeping again
+#define SWCLOCK_SCHED_SLACK_NS         (200LL * NS_PER_US)
+#define SWCLOCK_SCHED_MAX_THREADS      64
+
+// Adaptive polling (swclock_set_adaptive_poll()): largest allowed ceiling on
+// the backed-off poll period, and full-rate polls owed after each adjtime
+#define SWCLOCK_POLL_MAX_PERIOD_NS     (10000LL * NS_PER_MS)
+#define SWCLOCK_POLL_FAST_AFTER_ADJTIME 10
+
+// Event logger thread: records per drain batch, and the longest it
+// sleeps on an empty ring before waking without a doorbell
+// (SWCLOCK_EVENT_FLUSH_MS overrides the latter)
+#define SWCLOCK_EVENT_BATCH_IOV        256
+#define SWCLOCK_EVENT_FLUSH_NS         (1000LL * NS_PER_MS)
+
+// Binary event log segments (see sw_clock_seglog.h): size of each
+// pre-allocated segment file, limit on all segments of one log (oldest
+// deleted first), and dirty bytes between asynchronous msync() calls.
+// SWCLOCK_EVENT_SEGMENT_MB / SWCLOCK_EVENT_LOG_MAX_MB override the first two.
+#define SWCLOCK_EVENT_SEGMENT_BYTES    (64LL << 20)
+#define SWCLOCK_EVENT_LOG_MAX_BYTES    (1024LL << 20)
+#define SWCLOCK_SEGLOG_SYNC_BYTES      (256LL << 10)
+
+// Event log sync points (see sw_clock_evindex.h): at most this many record
+// bytes or this much event time between two indexed places to start decoding
+#define SWCLOCK_EVENT_SYNC_POINT_BYTES (64LL << 10)
+#define SWCLOCK_EVENT_SYNC_POINT_NS    (1000LL * NS_PER_MS)
+
+// Flight recorder (see sw_clock_flightrec.h): events kept in memory (~6 MB,
+// about ten minutes of a 100 Hz servo), and the shortest time between two
+// triggered dumps, so a persisting alert does not flood the disk
+#define SWCLOCK_FLIGHTREC_EVENTS       65536
+#define SWCLOCK_FLIGHTREC_MIN_INTERVAL_NS (10000LL * NS_PER_MS)
+
 
 #ifdef __cplusplus
 } // extern "C"
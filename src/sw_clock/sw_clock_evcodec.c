@@ -0,0 +1,325 @@
+/**
+ * @file sw_clock_evcodec.c
+ * @brief Compact (format v2) event record encoding
+ */
+
+#include "sw_clock_evcodec.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+
+enum {
+    FIELD_U32,
+    FIELD_I32,
+    FIELD_I64,
+    FIELD_F64,
+    FIELD_PAD32                 // Stored only if zero; otherwise the payload goes raw
+};
+
+typedef struct {
+    uint8_t kind;
+    uint8_t offset;
+} evcodec_field_t;
+
+typedef struct {
+    uint16_t size;              // Payload struct size; 0 = no payload codec
+    uint8_t  nfields;
+    evcodec_field_t fields[6];
+} evcodec_layout_t;
+
+#define F(kind, type, member) { kind, (uint8_t)offsetof(type, member) }
+
+static const evcodec_layout_t adjtime_layout = {
+    sizeof(swclock_event_adjtime_payload_t), 5, {
+        F(FIELD_U32,   swclock_event_adjtime_payload_t, modes),
+        F(FIELD_I64,   swclock_event_adjtime_payload_t, offset_ns),
+        F(FIELD_I64,   swclock_event_adjtime_payload_t, freq_scaled_ppm),
+        F(FIELD_I32,   swclock_event_adjtime_payload_t, return_code),
+        F(FIELD_PAD32, swclock_event_adjtime_payload_t, padding) } };
+
+static const evcodec_layout_t pi_step_layout = {
+    sizeof(swclock_event_pi_step_payload_t), 5, {
+        F(FIELD_F64,   swclock_event_pi_step_payload_t, pi_freq_ppm),
+        F(FIELD_F64,   swclock_event_pi_step_payload_t, pi_int_error_s),
+        F(FIELD_I64,   swclock_event_pi_step_payload_t, remaining_phase_ns),
+        F(FIELD_I32,   swclock_event_pi_step_payload_t, servo_enabled),
+        F(FIELD_PAD32, swclock_event_pi_step_payload_t, padding) } };
+
+static const evcodec_layout_t phase_slew_layout = {
+    sizeof(swclock_event_phase_slew_payload_t), 5, {
+        F(FIELD_I64,   swclock_event_phase_slew_payload_t, target_phase_ns),
+        F(FIELD_I64,   swclock_event_phase_slew_payload_t, current_phase_ns),
+        F(FIELD_F64,   swclock_event_phase_slew_payload_t, slew_rate_ns_per_s),
+        F(FIELD_U32,   swclock_event_phase_slew_payload_t, duration_ms),
+        F(FIELD_PAD32, swclock_event_phase_slew_payload_t, padding) } };
+
+static const evcodec_layout_t frequency_clamp_layout = {
+    sizeof(swclock_event_frequency_clamp_payload_t), 4, {
+        F(FIELD_F64,   swclock_event_frequency_clamp_payload_t, requested_ppm),
+        F(FIELD_F64,   swclock_event_frequency_clamp_payload_t, clamped_ppm),
+        F(FIELD_F64,   swclock_event_frequency_clamp_payload_t, max_ppm),
+        F(FIELD_PAD32, swclock_event_frequency_clamp_payload_t, padding) } };
+
+static const evcodec_layout_t threshold_layout = {
+    sizeof(swclock_event_threshold_payload_t), 4, {
+        F(FIELD_I64,   swclock_event_threshold_payload_t, phase_error_ns),
+        F(FIELD_I64,   swclock_event_threshold_payload_t, threshold_ns),
+        F(FIELD_U32,   swclock_event_threshold_payload_t, crossing_type),
+        F(FIELD_PAD32, swclock_event_threshold_payload_t, padding) } };
+
+#undef F
+
+// Prediction slot of an event type, and its payload layout (NULL if none)
+static unsigned evcodec_slot(uint16_t event_type, const evcodec_layout_t** layout) {
+    switch (event_type) {
+        case SWCLOCK_EVENT_ADJTIME_CALL:     *layout = &adjtime_layout;         return 1;
+        case SWCLOCK_EVENT_ADJTIME_RETURN:   *layout = &adjtime_layout;         return 2;
+        case SWCLOCK_EVENT_PI_STEP:          *layout = &pi_step_layout;         return 3;
+        case SWCLOCK_EVENT_PHASE_SLEW_START: *layout = &phase_slew_layout;      return 4;
+        case SWCLOCK_EVENT_PHASE_SLEW_DONE:  *layout = &phase_slew_layout;      return 5;
+        case SWCLOCK_EVENT_FREQUENCY_CLAMP:  *layout = &frequency_clamp_layout; return 6;
+        case SWCLOCK_EVENT_THRESHOLD_CROSS:  *layout = &threshold_layout;       return 7;
+        default:                             *layout = NULL;                    return 0;
+    }
+}
+
+static inline uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+static inline uint8_t* put_varint(uint8_t* p, uint64_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+// Returns the new position, or NULL if the varint is truncated or too long
+static inline const uint8_t* get_varint(const uint8_t* p, const uint8_t* end, uint64_t* v) {
+    uint64_t r = 0;
+    for (unsigned shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        r |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = r;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+// Loads/stores of payload fields, widened to 64 bits
+static inline uint64_t load_field(const uint8_t* base, const evcodec_field_t* f) {
+    switch (f->kind) {
+        case FIELD_I32: { int32_t v;  memcpy(&v, base + f->offset, 4); return (uint64_t)(int64_t)v; }
+        case FIELD_I64:
+        case FIELD_F64: { uint64_t v; memcpy(&v, base + f->offset, 8); return v; }
+        default:        { uint32_t v; memcpy(&v, base + f->offset, 4); return v; }
+    }
+}
+
+static inline void store_field(uint8_t* base, const evcodec_field_t* f, uint64_t v) {
+    if (f->kind == FIELD_I64 || f->kind == FIELD_F64) {
+        memcpy(base + f->offset, &v, 8);
+    } else {
+        uint32_t w = (uint32_t)v;
+        memcpy(base + f->offset, &w, 4);
+    }
+}
+
+// Code a payload against the previous one of its type; returns the length, or
+// 0 if it has to go raw (nonzero padding)
+static size_t encode_payload(const evcodec_layout_t* layout, const uint8_t* cur,
+                             const uint8_t* prev, uint8_t* out) {
+    uint8_t* p = out;
+
+    for (unsigned i = 0; i < layout->nfields; i++) {
+        const evcodec_field_t* f = &layout->fields[i];
+        uint64_t v = load_field(cur, f);
+
+        if (f->kind == FIELD_PAD32) {
+            if (v != 0) return 0;
+        } else if (f->kind == FIELD_F64) {
+            // XOR with the previous value: slowly changing doubles share sign,
+            // exponent and high mantissa bytes; keep only the bytes that differ
+            uint64_t x = v ^ load_field(prev, f);
+            unsigned lead = 0, trail = 0;
+            if (x == 0) {
+                lead = 8;
+            } else {
+                while (!(x >> (56 - 8 * lead) & 0xFF)) lead++;
+                while (!(x >> (8 * trail) & 0xFF)) trail++;
+            }
+            *p++ = (uint8_t)(lead | trail << 4);
+            for (unsigned b = trail; b < 8 - lead; b++) {
+                *p++ = (uint8_t)(x >> (8 * b));
+            }
+        } else {
+            p = put_varint(p, zigzag((int64_t)(v - load_field(prev, f))));
+        }
+    }
+    return (size_t)(p - out);
+}
+
+// Inverse of encode_payload; returns 0 on success, -1 if in is malformed
+static int decode_payload(const evcodec_layout_t* layout, const uint8_t* in, size_t len,
+                          const uint8_t* prev, uint8_t* out) {
+    const uint8_t* p = in;
+    const uint8_t* end = in + len;
+
+    for (unsigned i = 0; i < layout->nfields; i++) {
+        const evcodec_field_t* f = &layout->fields[i];
+
+        if (f->kind == FIELD_PAD32) {
+            store_field(out, f, 0);
+        } else if (f->kind == FIELD_F64) {
+            if (p >= end) return -1;
+            unsigned lead = *p & 0x0F, trail = *p >> 4;
+            p++;
+            if (lead + trail > 8 || (size_t)(end - p) < 8 - lead - trail) return -1;
+            uint64_t x = 0;
+            for (unsigned b = trail; b < 8 - lead; b++) {
+                x |= (uint64_t)*p++ << (8 * b);
+            }
+            store_field(out, f, load_field(prev, f) ^ x);
+        } else {
+            uint64_t d;
+            if (!(p = get_varint(p, end, &d))) return -1;
+            store_field(out, f, load_field(prev, f) + (uint64_t)unzigzag(d));
+        }
+    }
+    return p == end ? 0 : -1;
+}
+
+void swclock_evcodec_reset(swclock_evcodec_t* st) {
+    memset(st, 0, sizeof(*st));
+    st->seq = UINT64_MAX;       // First sequence number 0 codes as a zero delta
+}
+
+static const uint8_t evcodec_sync_marker[SWCLOCK_EVCODEC_SYNC_SIZE] = {
+    0x80, 0x80, 0x04, 'S', 'Y', 'N', 'C', '!'
+};
+
+size_t swclock_evcodec_sync(swclock_evcodec_t* st, uint8_t* out) {
+    memcpy(out, evcodec_sync_marker, sizeof(evcodec_sync_marker));
+    swclock_evcodec_reset(st);
+    return sizeof(evcodec_sync_marker);
+}
+
+// Timestamp prediction: previous delta of the same type, or the last event's
+// time for a type's first event
+static inline uint64_t predict_ts(const swclock_evcodec_t* st, unsigned slot) {
+    return st->slot[slot].has_ts ? st->slot[slot].ts + (uint64_t)st->slot[slot].dts : st->ts;
+}
+
+static inline void update_ts(swclock_evcodec_t* st, unsigned slot, uint64_t ts) {
+    if (st->slot[slot].has_ts) st->slot[slot].dts = (int64_t)(ts - st->slot[slot].ts);
+    st->slot[slot].ts = ts;
+    st->slot[slot].has_ts = 1;
+    st->ts = ts;
+}
+
+size_t swclock_evcodec_encode(swclock_evcodec_t* st, const swclock_event_header_t* hdr,
+                              const void* payload, uint8_t* out) {
+    if (hdr->event_type == 0 || hdr->payload_size > SWCLOCK_EVCODEC_MAX_PAYLOAD ||
+        (hdr->payload_size && !payload)) {
+        errno = EINVAL;
+        return 0;
+    }
+
+    const evcodec_layout_t* layout;
+    unsigned slot = evcodec_slot(hdr->event_type, &layout);
+    uint8_t* p = out;
+
+    p = put_varint(p, hdr->event_type);
+    p = put_varint(p, zigzag((int64_t)(hdr->sequence_num - st->seq - 1)));
+    p = put_varint(p, zigzag((int64_t)(hdr->timestamp_ns - predict_ts(st, slot))));
+    st->seq = hdr->sequence_num;
+    update_ts(st, slot, hdr->timestamp_ns);
+
+    uint8_t coded[SWCLOCK_EVCODEC_MAX_RECORD];
+    size_t coded_len = 0;
+    bool known = layout && hdr->payload_size == layout->size;
+    if (known) {
+        coded_len = encode_payload(layout, (const uint8_t*)payload, st->slot[slot].prev, coded);
+    }
+
+    if (coded_len && coded_len < hdr->payload_size) {
+        p = put_varint(p, (uint64_t)coded_len << 1 | 1);
+        memcpy(p, coded, coded_len);
+        p += coded_len;
+    } else {
+        p = put_varint(p, (uint64_t)hdr->payload_size << 1);
+        if (hdr->payload_size) memcpy(p, payload, hdr->payload_size);
+        p += hdr->payload_size;
+    }
+
+    if (known) memcpy(st->slot[slot].prev, payload, layout->size);
+    return (size_t)(p - out);
+}
+
+int swclock_evcodec_decode(swclock_evcodec_t* st, const uint8_t* in, size_t len,
+                           swclock_event_header_t* hdr, void* payload, size_t* consumed) {
+    const uint8_t* p = in;
+    const uint8_t* end = in + len;
+
+    while ((size_t)(end - p) >= sizeof(evcodec_sync_marker) &&
+           memcmp(p, evcodec_sync_marker, sizeof(evcodec_sync_marker)) == 0) {
+        swclock_evcodec_reset(st);
+        p += sizeof(evcodec_sync_marker);
+    }
+    if (p == end || *p == 0) return 0;
+
+    uint64_t type, dseq, dts, plen;
+
+    if (!(p = get_varint(p, end, &type)) || type == 0 || type > UINT16_MAX ||
+        !(p = get_varint(p, end, &dseq)) ||
+        !(p = get_varint(p, end, &dts)) ||
+        !(p = get_varint(p, end, &plen))) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    bool coded = plen & 1;
+    plen >>= 1;
+    if (plen > SWCLOCK_EVCODEC_MAX_PAYLOAD || plen > (uint64_t)(end - p)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    const evcodec_layout_t* layout;
+    unsigned slot = evcodec_slot((uint16_t)type, &layout);
+    bool known = false;
+
+    if (coded) {
+        if (!layout || decode_payload(layout, p, (size_t)plen, st->slot[slot].prev,
+                                      (uint8_t*)payload) != 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        hdr->payload_size = layout->size;
+        known = true;
+    } else {
+        memcpy(payload, p, (size_t)plen);
+        hdr->payload_size = (uint16_t)plen;
+        known = layout && plen == layout->size;
+    }
+    p += plen;
+
+    hdr->event_type   = (uint16_t)type;
+    hdr->sequence_num = st->seq + 1 + (uint64_t)unzigzag(dseq);
+    hdr->timestamp_ns = predict_ts(st, slot) + (uint64_t)unzigzag(dts);
+    hdr->reserved     = 0;
+    st->seq = hdr->sequence_num;
+    update_ts(st, slot, hdr->timestamp_ns);
+    if (known) memcpy(st->slot[slot].prev, payload, layout->size);
+
+    *consumed = (size_t)(p - in);
+    return 1;
+}
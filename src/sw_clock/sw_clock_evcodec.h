@@ -0,0 +1,134 @@
+/**
+ * @file sw_clock_evcodec.h
+ * @brief Compact (format v2) encoding of binary event records
+ *
+ * Format v1 stores every event as the fixed swclock_event_header_t followed
+ * by the raw payload struct. Format v2 (file header version_major 2) codes
+ * each record against the previous records of the same segment:
+ *
+ *   varint  event_type                     (0 never occurs: marks the end)
+ *   varint  zigzag(seq - prev_seq - 1)     (0 for consecutive events)
+ *   varint  zigzag(ts - predicted_ts)      (delta-of-delta per event type)
+ *   varint  (payload_len << 1) | coded
+ *   payload_len bytes of payload
+ *
+ * For event types with a known payload struct, a coded payload stores each
+ * field against the same field of that type's previous payload: integers
+ * as zigzag varint deltas, doubles as the XOR of their bits with the
+ * leading and trailing zero bytes stripped (one control byte), and padding
+ * not at all. A payload that would not get smaller, or has nonzero padding
+ * or an unexpected size, is stored raw. Periodic PI_STEP events at a
+ * converged servo shrink from 56 bytes to under 10.
+ *
+ * The state is reset at the start of every segment, so each segment
+ * decodes on its own, and at every sync marker
+ *
+ *   varint  0x10000  "SYNC!"               (8 bytes; not a valid event type)
+ *
+ * so decoding can also start at any marker (see sw_clock_evindex.h).
+ * Encoder and decoder must see the same records in the same order. Host
+ * byte order is assumed little-endian, as for v1.
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_EVCODEC_H
+#define SWCLOCK_EVCODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sw_clock_events.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief On-disk format version written with the v2 encoding
+ */
+#define SWCLOCK_EVCODEC_VERSION 2
+
+/**
+ * @brief Largest payload a record can carry (bytes)
+ */
+#define SWCLOCK_EVCODEC_MAX_PAYLOAD (SWCLOCK_EVENT_MAX_SIZE - sizeof(swclock_event_header_t))
+
+/**
+ * @brief Largest encoded record (bytes); encode output buffers need this much
+ */
+#define SWCLOCK_EVCODEC_MAX_RECORD (32 + SWCLOCK_EVCODEC_MAX_PAYLOAD)
+
+/**
+ * @brief Number of per-type prediction slots (slot 0 is shared by types without a payload codec)
+ */
+#define SWCLOCK_EVCODEC_SLOTS 8
+
+/**
+ * @brief Encoder/decoder state (one per direction, reset per segment)
+ */
+typedef struct {
+    uint64_t seq;               /**< Last sequence number */
+    uint64_t ts;                /**< Last timestamp (any type) */
+    struct {
+        uint64_t ts;            /**< Last timestamp of this type */
+        int64_t  dts;           /**< Last timestamp delta of this type */
+        uint8_t  has_ts;        /**< ts/dts are valid */
+        uint8_t  prev[SWCLOCK_EVCODEC_MAX_PAYLOAD]; /**< Last payload of this type */
+    } slot[SWCLOCK_EVCODEC_SLOTS];
+} swclock_evcodec_t;
+
+/**
+ * @brief Reset to the state at the start of a segment
+ */
+void swclock_evcodec_reset(swclock_evcodec_t* st);
+
+/**
+ * @brief Size of a sync marker (bytes)
+ */
+#define SWCLOCK_EVCODEC_SYNC_SIZE 8
+
+/**
+ * @brief Write a sync marker and reset the state
+ *
+ * @param st Encoder state
+ * @param out Output, at least SWCLOCK_EVCODEC_SYNC_SIZE bytes
+ * @return SWCLOCK_EVCODEC_SYNC_SIZE
+ */
+size_t swclock_evcodec_sync(swclock_evcodec_t* st, uint8_t* out);
+
+/**
+ * @brief Encode one record
+ *
+ * @param st Encoder state
+ * @param hdr Event header (reserved field is not stored)
+ * @param payload hdr->payload_size bytes of payload
+ * @param out Output, at least SWCLOCK_EVCODEC_MAX_RECORD bytes
+ * @return Encoded length, or 0 if the record cannot be encoded (event type 0
+ *         or payload larger than SWCLOCK_EVCODEC_MAX_PAYLOAD; errno = EINVAL)
+ */
+size_t swclock_evcodec_encode(swclock_evcodec_t* st, const swclock_event_header_t* hdr,
+                              const void* payload, uint8_t* out);
+
+/**
+ * @brief Decode one record
+ *
+ * @param st Decoder state
+ * @param in Encoded data
+ * @param len Bytes available at in
+ * @param hdr Decoded header (reserved = 0)
+ * @param payload Decoded payload, at least SWCLOCK_EVCODEC_MAX_PAYLOAD bytes
+ * @param consumed Bytes of in used by the record, including any sync
+ *        markers before it (which reset the state)
+ * @return 1 for a record, 0 at the end of the data (no bytes left or a zero
+ *         byte: the unused tail of a segment), -1 if the data is corrupt or
+ *         truncated (errno = EINVAL)
+ */
+int swclock_evcodec_decode(swclock_evcodec_t* st, const uint8_t* in, size_t len,
+                           swclock_event_header_t* hdr, void* payload, size_t* consumed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_EVCODEC_H */
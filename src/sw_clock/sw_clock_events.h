@@ -141,6 +141,31 @@ typedef struct __attribute__((packed)) {
     uint32_t reserved[8];       /**< Reserved for future use */
 } swclock_event_log_header_t;
 
+/**
+ * @brief Sampling policy of one event type
+ *
+ * Policies decide before an event is built whether it is logged at all;
+ * suppressed events take no sequence number and are only counted. The
+ * value compared by SWCLOCK_EVENT_POLICY_ON_CHANGE is one field of the
+ * payload: offset_ns (ADJTIME_*), pi_freq_ppm (PI_STEP), current_phase_ns
+ * (PHASE_SLEW_*), requested_ppm (FREQUENCY_CLAMP), phase_error_ns
+ * (THRESHOLD_CROSS), marker_id (LOG_MARKER); 0 for types without payload.
+ */
+typedef enum {
+    SWCLOCK_EVENT_POLICY_ALWAYS = 0,    /**< Log every event (default) */
+    SWCLOCK_EVENT_POLICY_ONE_IN_N,      /**< Log the first of every one_in_n events */
+    SWCLOCK_EVENT_POLICY_ON_CHANGE,     /**< Log when the value moved by >= change_delta since the last logged event */
+    SWCLOCK_EVENT_POLICY_RATE_LIMIT     /**< Token bucket: max_per_s on average, bursts of up to burst */
+} swclock_event_policy_mode_t;
+
+typedef struct {
+    swclock_event_policy_mode_t mode;
+    uint32_t one_in_n;          /**< ONE_IN_N: sampling period (>= 1) */
+    double   change_delta;      /**< ON_CHANGE: minimum change of the value (>= 0) */
+    double   max_per_s;         /**< RATE_LIMIT: sustained events per second (> 0) */
+    uint32_t burst;             /**< RATE_LIMIT: bucket size (0 is taken as 1) */
+} swclock_event_policy_t;
+
 /**
  * @brief Get human-readable event type name
  * 
@@ -0,0 +1,114 @@
+/**
+ * @file sw_clock_evindex.c
+ * @brief Event log sidecar index
+ */
+
+#include "sw_clock_evindex.h"
+#include "sw_clock_utilities.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int swclock_evindex_path(const char* segment_path, char* buf, size_t len) {
+    int n = snprintf(buf, len, "%s%s", segment_path, SWCLOCK_EVENT_INDEX_SUFFIX);
+    if (n < 0 || (size_t)n >= len) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return 0;
+}
+
+int swclock_evindex_create(const char* segment_path) {
+    char name[1024];
+    if (swclock_evindex_path(segment_path, name, sizeof(name)) != 0) return -1;
+
+    int fd = open(name, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+
+    swclock_event_index_header_t header = {
+        .magic = SWCLOCK_EVENT_INDEX_MAGIC,
+        .version = 1,
+        .entry_size = sizeof(swclock_event_index_entry_t)
+    };
+    if (swclock_write_all(fd, &header, sizeof(header)) != 0) {
+        int saved = errno;
+        close(fd);
+        unlink(name);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+int swclock_evindex_append(int fd, const swclock_event_index_entry_t* entry) {
+    return swclock_write_all(fd, entry, sizeof(*entry));
+}
+
+swclock_event_index_entry_t* swclock_evindex_load(const char* segment_path, size_t* count) {
+    char name[1024];
+    *count = 0;
+    if (swclock_evindex_path(segment_path, name, sizeof(name)) != 0) return NULL;
+
+    int fd = open(name, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    swclock_event_index_header_t header;
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        header.magic != SWCLOCK_EVENT_INDEX_MAGIC || header.version != 1 ||
+        header.entry_size != sizeof(swclock_event_index_entry_t)) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    size_t n = ((size_t)st.st_size - sizeof(header)) / sizeof(swclock_event_index_entry_t);
+    if (n == 0) {
+        close(fd);
+        errno = ENOENT;
+        return NULL;
+    }
+
+    swclock_event_index_entry_t* entries =
+        (swclock_event_index_entry_t*)malloc(n * sizeof(*entries));
+    size_t bytes = n * sizeof(*entries);
+    if (!entries || pread(fd, entries, bytes, sizeof(header)) != (ssize_t)bytes) {
+        int saved = entries ? EIO : ENOMEM;
+        free(entries);
+        close(fd);
+        errno = saved;
+        return NULL;
+    }
+    close(fd);
+
+    *count = n;
+    return entries;
+}
+
+// Entry before the last one whose key is <= target (see header)
+#define EVINDEX_FIND(entries, count, field, target)                     \
+    do {                                                                \
+        size_t lo = 0, hi = (count);                                    \
+        while (lo < hi) {                                               \
+            size_t mid = lo + (hi - lo) / 2;                            \
+            if ((entries)[mid].field <= (target)) lo = mid + 1;         \
+            else hi = mid;                                              \
+        }                                                               \
+        /* lo = number of entries with key <= target */                 \
+        return lo >= 2 ? lo - 2 : 0;                                    \
+    } while (0)
+
+size_t swclock_evindex_find_time(const swclock_event_index_entry_t* entries, size_t count,
+                                 uint64_t timestamp_ns) {
+    EVINDEX_FIND(entries, count, timestamp_ns, timestamp_ns);
+}
+
+size_t swclock_evindex_find_seq(const swclock_event_index_entry_t* entries, size_t count,
+                                uint64_t sequence_num) {
+    EVINDEX_FIND(entries, count, sequence_num, sequence_num);
+}
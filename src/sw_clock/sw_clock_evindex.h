@@ -0,0 +1,118 @@
+/**
+ * @file sw_clock_evindex.h
+ * @brief Sidecar time/sequence index for binary event log segments
+ *
+ * The event logger places a sync point in each log segment every
+ * SWCLOCK_EVENT_SYNC_POINT_BYTES of records or SWCLOCK_EVENT_SYNC_POINT_NS of
+ * event time, and at the start of every segment. Decoding can start at any
+ * sync point: in format v2 a sync marker resets the delta coding
+ * (swclock_evcodec_sync()); format v1 records are self-contained anyway.
+ *
+ * Each sync point is recorded in "<segment>.idx" as the timestamp and
+ * sequence number of the first record after it and its file offset, so a
+ * reader can binary-search the index and map only the byte range it needs
+ * instead of scanning the segment from the start. The index is a hint:
+ * readers check that an offset lies inside the segment, and a missing or
+ * short index only means scanning more.
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_EVINDEX_H
+#define SWCLOCK_EVINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Index file magic number
+ */
+#define SWCLOCK_EVENT_INDEX_MAGIC 0x58495753  /* "SWIX" in ASCII */
+
+/**
+ * @brief Index file name suffix, appended to the segment file name
+ */
+#define SWCLOCK_EVENT_INDEX_SUFFIX ".idx"
+
+/**
+ * @brief Index file header
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             /**< SWCLOCK_EVENT_INDEX_MAGIC */
+    uint16_t version;           /**< Index format version (1) */
+    uint16_t entry_size;        /**< sizeof(swclock_event_index_entry_t) */
+    uint64_t reserved;          /**< Reserved for future use */
+} swclock_event_index_header_t;
+
+/**
+ * @brief One sync point
+ */
+typedef struct __attribute__((packed)) {
+    uint64_t timestamp_ns;      /**< Timestamp of the first record after the sync point */
+    uint64_t sequence_num;      /**< Sequence number of that record */
+    uint64_t offset;            /**< File offset of the sync point in the segment */
+} swclock_event_index_entry_t;
+
+/**
+ * @brief Index file name of a segment
+ *
+ * @return 0 on success, -1 if buf is too small (errno = ENAMETOOLONG)
+ */
+int swclock_evindex_path(const char* segment_path, char* buf, size_t len);
+
+/**
+ * @brief Create (truncate) the index of a segment and write its header
+ *
+ * @return File descriptor, or -1 on failure (errno set)
+ */
+int swclock_evindex_create(const char* segment_path);
+
+/**
+ * @brief Append one sync point
+ *
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int swclock_evindex_append(int fd, const swclock_event_index_entry_t* entry);
+
+/**
+ * @brief Load the index of a segment
+ *
+ * A trailing partial entry (writer killed mid-write) is ignored.
+ *
+ * @param segment_path Segment file name
+ * @param count Number of entries
+ * @return Entries (free() them), or NULL if there is no valid index or it is
+ *         empty (errno set)
+ */
+swclock_event_index_entry_t* swclock_evindex_load(const char* segment_path, size_t* count);
+
+/**
+ * @brief Sync point to start reading from for events at or after timestamp_ns
+ *
+ * Records between two sync points are only nearly in timestamp order
+ * (producers commit concurrently), so this is the sync point before the
+ * last one starting at or before timestamp_ns.
+ *
+ * @return Entry index (0 if timestamp_ns precedes the whole index)
+ */
+size_t swclock_evindex_find_time(const swclock_event_index_entry_t* entries, size_t count,
+                                 uint64_t timestamp_ns);
+
+/**
+ * @brief Sync point to start reading from for events with sequence >= sequence_num
+ *
+ * Same rule as swclock_evindex_find_time(), on sequence numbers.
+ */
+size_t swclock_evindex_find_seq(const swclock_event_index_entry_t* entries, size_t count,
+                                uint64_t sequence_num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_EVINDEX_H */
@@ -0,0 +1,273 @@
+/**
+ * @file sw_clock_evpolicy.c
+ * @brief Per-event-type sampling and rate limits
+ */
+
+#include "sw_clock_evpolicy.h"
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+// ON_CHANGE: no event logged yet (quiet NaN)
+#define EVPOLICY_NO_VALUE 0x7FF8000000000000ULL
+
+static void evpolicy_reset_slot(swclock_evpolicy_slot_t* s) {
+    __atomic_store_n(&s->count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->last_bits, EVPOLICY_NO_VALUE, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->tat_ns, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->suppressed, 0, __ATOMIC_RELAXED);
+}
+
+void swclock_evpolicy_init(swclock_evpolicy_t* p) {
+    memset(p, 0, sizeof(*p));
+    for (unsigned t = 0; t < SWCLOCK_EVPOLICY_TYPES; t++) {
+        p->slot[t].policy.mode = SWCLOCK_EVENT_POLICY_ALWAYS;
+        evpolicy_reset_slot(&p->slot[t]);
+    }
+}
+
+int swclock_evpolicy_set(swclock_evpolicy_t* p, unsigned type, const swclock_event_policy_t* policy) {
+    if (type >= SWCLOCK_EVPOLICY_TYPES || !policy) {
+        errno = EINVAL;
+        return -1;
+    }
+    switch (policy->mode) {
+        case SWCLOCK_EVENT_POLICY_ALWAYS:
+            break;
+        case SWCLOCK_EVENT_POLICY_ONE_IN_N:
+            if (policy->one_in_n == 0) {
+                errno = EINVAL;
+                return -1;
+            }
+            break;
+        case SWCLOCK_EVENT_POLICY_ON_CHANGE:
+            if (!(policy->change_delta >= 0)) {
+                errno = EINVAL;
+                return -1;
+            }
+            break;
+        case SWCLOCK_EVENT_POLICY_RATE_LIMIT:
+            if (!(policy->max_per_s > 0) || policy->max_per_s > 1e9) {
+                errno = EINVAL;
+                return -1;
+            }
+            break;
+        default:
+            errno = EINVAL;
+            return -1;
+    }
+
+    // Events admitted while the parameters change are simply logged. An
+    // admitter that read the old mode may still see the new parameters, so
+    // they are stored atomically and checked again on the admit side.
+    swclock_evpolicy_slot_t* s = &p->slot[type];
+    __atomic_store_n(&s->mode, (uint8_t)SWCLOCK_EVENT_POLICY_ALWAYS, __ATOMIC_RELEASE);
+
+    uint32_t burst = policy->burst ? policy->burst : 1;
+    uint64_t interval_ns = 0, tolerance_ns = 0;
+    if (policy->mode == SWCLOCK_EVENT_POLICY_RATE_LIMIT) {
+        interval_ns  = (uint64_t)llround(1e9 / policy->max_per_s);
+        if (interval_ns == 0) interval_ns = 1;
+        tolerance_ns = (uint64_t)(burst - 1) * interval_ns;
+    }
+    double change_delta = policy->change_delta;
+    s->policy = *policy;
+    __atomic_store_n(&s->one_in_n, policy->one_in_n, __ATOMIC_RELAXED);
+    __atomic_store(&s->change_delta, &change_delta, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->interval_ns, interval_ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->tolerance_ns, tolerance_ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->last_bits, EVPOLICY_NO_VALUE, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->tat_ns, 0, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&s->mode, (uint8_t)policy->mode, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int swclock_evpolicy_get(const swclock_evpolicy_t* p, unsigned type, swclock_event_policy_t* policy) {
+    if (type >= SWCLOCK_EVPOLICY_TYPES || !policy) {
+        errno = EINVAL;
+        return -1;
+    }
+    *policy = p->slot[type].policy;
+    return 0;
+}
+
+uint64_t swclock_evpolicy_suppressed(const swclock_evpolicy_t* p, unsigned type) {
+    if (type >= SWCLOCK_EVPOLICY_TYPES) return 0;
+    return __atomic_load_n(&p->slot[type].suppressed, __ATOMIC_RELAXED);
+}
+
+uint64_t swclock_evpolicy_suppressed_total(const swclock_evpolicy_t* p) {
+    uint64_t total = 0;
+    for (unsigned t = 0; t < SWCLOCK_EVPOLICY_TYPES; t++) {
+        total += __atomic_load_n(&p->slot[t].suppressed, __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+void swclock_evpolicy_reset(swclock_evpolicy_t* p) {
+    for (unsigned t = 0; t < SWCLOCK_EVPOLICY_TYPES; t++) {
+        evpolicy_reset_slot(&p->slot[t]);
+    }
+}
+
+double swclock_evpolicy_value(unsigned type, const void* payload, size_t payload_size) {
+    if (!payload) return 0.0;
+
+    // Payload structs are packed; read fields through their offsets
+#define EVPOLICY_FIELD(T, field)                                              \
+    do {                                                                      \
+        if (payload_size < offsetof(T, field) + sizeof(((T*)0)->field)) {     \
+            return 0.0;                                                       \
+        }                                                                     \
+        __typeof__(((T*)0)->field) v;                                         \
+        memcpy(&v, (const uint8_t*)payload + offsetof(T, field), sizeof(v)); \
+        return (double)v;                                                     \
+    } while (0)
+
+    switch (type) {
+        case SWCLOCK_EVENT_ADJTIME_CALL:
+        case SWCLOCK_EVENT_ADJTIME_RETURN:
+            EVPOLICY_FIELD(swclock_event_adjtime_payload_t, offset_ns);
+        case SWCLOCK_EVENT_PI_STEP:
+            EVPOLICY_FIELD(swclock_event_pi_step_payload_t, pi_freq_ppm);
+        case SWCLOCK_EVENT_PHASE_SLEW_START:
+        case SWCLOCK_EVENT_PHASE_SLEW_DONE:
+            EVPOLICY_FIELD(swclock_event_phase_slew_payload_t, current_phase_ns);
+        case SWCLOCK_EVENT_FREQUENCY_CLAMP:
+            EVPOLICY_FIELD(swclock_event_frequency_clamp_payload_t, requested_ppm);
+        case SWCLOCK_EVENT_THRESHOLD_CROSS:
+            EVPOLICY_FIELD(swclock_event_threshold_payload_t, phase_error_ns);
+        case SWCLOCK_EVENT_LOG_MARKER:
+            EVPOLICY_FIELD(swclock_event_marker_payload_t, marker_id);
+        default:
+            return 0.0;
+    }
+#undef EVPOLICY_FIELD
+}
+
+bool swclock_evpolicy_admit_slow(swclock_evpolicy_t* p, unsigned type, double value) {
+    swclock_evpolicy_slot_t* s = &p->slot[type];
+    bool admit = true;
+
+    switch (__atomic_load_n(&s->mode, __ATOMIC_ACQUIRE)) {
+        case SWCLOCK_EVENT_POLICY_ONE_IN_N: {
+            // 0 only while another policy is being set: log the event
+            uint32_t one_in_n = __atomic_load_n(&s->one_in_n, __ATOMIC_RELAXED);
+            uint64_t n = __atomic_fetch_add(&s->count, 1, __ATOMIC_RELAXED);
+            admit = one_in_n == 0 || (n % one_in_n) == 0;
+            break;
+        }
+        case SWCLOCK_EVENT_POLICY_ON_CHANGE: {
+            double delta;
+            __atomic_load(&s->change_delta, &delta, __ATOMIC_RELAXED);
+            uint64_t bits = __atomic_load_n(&s->last_bits, __ATOMIC_RELAXED);
+            double last;
+            memcpy(&last, &bits, sizeof(last));
+            // Delta 0 means any change; NaN (nothing logged yet) always counts
+            admit = isnan(last) || isnan(value) ||
+                    (delta > 0 ? fabs(value - last) >= delta : value != last);
+            if (admit) {
+                memcpy(&bits, &value, sizeof(bits));
+                __atomic_store_n(&s->last_bits, bits, __ATOMIC_RELAXED);
+            }
+            break;
+        }
+        case SWCLOCK_EVENT_POLICY_RATE_LIMIT: {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            uint64_t now = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+            uint64_t interval_ns  = __atomic_load_n(&s->interval_ns, __ATOMIC_RELAXED);
+            uint64_t tolerance_ns = __atomic_load_n(&s->tolerance_ns, __ATOMIC_RELAXED);
+            uint64_t tat = __atomic_load_n(&s->tat_ns, __ATOMIC_RELAXED);
+            for (;;) {
+                if (tat > now && tat - now > tolerance_ns) {
+                    admit = false;
+                    break;
+                }
+                uint64_t next = (tat > now ? tat : now) + interval_ns;
+                if (__atomic_compare_exchange_n(&s->tat_ns, &tat, next, true,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    break;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    if (!admit) __atomic_fetch_add(&s->suppressed, 1, __ATOMIC_RELAXED);
+    return admit;
+}
+
+// Event type by name (PI_STEP) or number (18, 0x12)
+static int evpolicy_parse_type(const char* s, size_t len) {
+    char name[32];
+    if (len == 0 || len >= sizeof(name)) return -1;
+    memcpy(name, s, len);
+    name[len] = '\0';
+
+    for (unsigned t = 1; t < SWCLOCK_EVPOLICY_TYPES; t++) {
+        if (strcasecmp(name, swclock_event_type_name((swclock_event_type_t)t)) == 0) return (int)t;
+    }
+    char* end;
+    long t = strtol(name, &end, 0);
+    return (*end == '\0' && t > 0 && t < SWCLOCK_EVPOLICY_TYPES) ? (int)t : -1;
+}
+
+static int evpolicy_parse_spec(const char* s, const char* end, swclock_event_policy_t* policy) {
+    char* e;
+    memset(policy, 0, sizeof(*policy));
+
+    if ((size_t)(end - s) == 6 && strncasecmp(s, "always", 6) == 0) {
+        policy->mode = SWCLOCK_EVENT_POLICY_ALWAYS;
+        return 0;
+    }
+    if (strncmp(s, "1/", 2) == 0) {
+        policy->mode = SWCLOCK_EVENT_POLICY_ONE_IN_N;
+        unsigned long n = strtoul(s + 2, &e, 10);
+        policy->one_in_n = (uint32_t)n;
+        return (e == end && e != s + 2 && n > 0 && n <= UINT32_MAX) ? 0 : -1;
+    }
+    if (strncasecmp(s, "delta:", 6) == 0) {
+        policy->mode = SWCLOCK_EVENT_POLICY_ON_CHANGE;
+        policy->change_delta = strtod(s + 6, &e);
+        return (e == end && e != s + 6) ? 0 : -1;
+    }
+    if (strncasecmp(s, "rate:", 5) == 0) {
+        policy->mode = SWCLOCK_EVENT_POLICY_RATE_LIMIT;
+        policy->max_per_s = strtod(s + 5, &e);
+        if (e == s + 5) return -1;
+        if (*e == '/') {
+            const char* b = e + 1;
+            policy->burst = (uint32_t)strtoul(b, &e, 10);
+            if (e == b) return -1;
+        }
+        return e == end ? 0 : -1;
+    }
+    return -1;
+}
+
+int swclock_evpolicy_parse(swclock_evpolicy_t* p, const char* spec) {
+    const char* s = spec;
+    while (s && *s) {
+        const char* end = strchr(s, ',');
+        if (!end) end = s + strlen(s);
+        const char* eq = memchr(s, '=', (size_t)(end - s));
+
+        swclock_event_policy_t policy;
+        int type = eq ? evpolicy_parse_type(s, (size_t)(eq - s)) : -1;
+        if (type < 0 || evpolicy_parse_spec(eq + 1, end, &policy) != 0 ||
+            swclock_evpolicy_set(p, (unsigned)type, &policy) != 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        s = *end ? end + 1 : end;
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * @file sw_clock_evpolicy.h
+ * @brief Per-event-type sampling and rate limits for the event log
+ *
+ * The servo logs PI_STEP on every poll and FREQUENCY_CLAMP on every clamped
+ * poll; during a long slew that is a steady stream of identical records.
+ * A policy table holds one swclock_event_policy_t per event type (0x00-0xFF)
+ * and decides, before a caller builds the header or payload, whether an
+ * event is logged:
+ *
+ * - ALWAYS costs one atomic load and a compare (the default for all types).
+ * - ONE_IN_N counts events with an atomic fetch-add.
+ * - ON_CHANGE keeps the value of the last logged event; racing callers may
+ *   both log a change, never neither.
+ * - RATE_LIMIT is a token bucket kept as one atomic "theoretical arrival
+ *   time" (GCRA): an event conforms if it is no more than (burst - 1)
+ *   intervals early, and moves the time on by one interval.
+ *
+ * Every rejected event is counted per type, so the log keeps its audit
+ * value: a reader can tell how many events a policy hid.
+ *
+ * Setting a policy resets that type's sampling state. Admission is
+ * lock-free and safe from any thread; setters must be serialized by the
+ * caller.
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_EVPOLICY_H
+#define SWCLOCK_EVPOLICY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sw_clock_events.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of event types with a policy (event_type < this)
+ */
+#define SWCLOCK_EVPOLICY_TYPES 256
+
+/**
+ * @brief Policy and sampling state of one event type
+ */
+typedef struct {
+    uint8_t  mode;              /**< swclock_event_policy_mode_t; read first on every event */
+    uint32_t one_in_n;
+    double   change_delta;
+    uint64_t interval_ns;       /**< RATE_LIMIT: time per token */
+    uint64_t tolerance_ns;      /**< RATE_LIMIT: (burst - 1) * interval_ns */
+    swclock_event_policy_t policy; /**< As set, for swclock_evpolicy_get() */
+
+    uint64_t count;             /**< ONE_IN_N: events seen */
+    uint64_t last_bits;         /**< ON_CHANGE: value of the last logged event (NaN: none) */
+    uint64_t tat_ns;            /**< RATE_LIMIT: theoretical arrival time */
+    uint64_t suppressed;        /**< Events rejected */
+} swclock_evpolicy_slot_t;
+
+/**
+ * @brief Policy table (one per clock)
+ */
+typedef struct {
+    swclock_evpolicy_slot_t slot[SWCLOCK_EVPOLICY_TYPES];
+} swclock_evpolicy_t;
+
+/**
+ * @brief Set every type to SWCLOCK_EVENT_POLICY_ALWAYS and clear the counters
+ */
+void swclock_evpolicy_init(swclock_evpolicy_t* p);
+
+/**
+ * @brief Set the policy of one event type and reset its sampling state
+ *
+ * @return 0 on success, -1 if the type is out of range or the policy
+ *         parameters are invalid (errno = EINVAL)
+ */
+int swclock_evpolicy_set(swclock_evpolicy_t* p, unsigned type, const swclock_event_policy_t* policy);
+
+/**
+ * @brief Get the policy of one event type
+ *
+ * @return 0 on success, -1 if the type is out of range (errno = EINVAL)
+ */
+int swclock_evpolicy_get(const swclock_evpolicy_t* p, unsigned type, swclock_event_policy_t* policy);
+
+/**
+ * @brief Events of one type rejected since the last reset
+ */
+uint64_t swclock_evpolicy_suppressed(const swclock_evpolicy_t* p, unsigned type);
+
+/**
+ * @brief Events of all types rejected since the last reset
+ */
+uint64_t swclock_evpolicy_suppressed_total(const swclock_evpolicy_t* p);
+
+/**
+ * @brief Clear the rejected-event counters and the sampling state of all types
+ *
+ * Policies are kept. Not safe against concurrent admission.
+ */
+void swclock_evpolicy_reset(swclock_evpolicy_t* p);
+
+/**
+ * @brief Apply policies from a string: "TYPE=SPEC[,TYPE=SPEC...]"
+ *
+ * TYPE is an event type name (PI_STEP) or number (0x12). SPEC is one of
+ * "always", "1/N" (one in N), "delta:D" (on change by at least D), or
+ * "rate:R[/B]" (at most R per second, bursts of B).
+ *
+ * @return 0 on success, -1 on a malformed entry (errno = EINVAL; entries
+ *         before it are applied)
+ */
+int swclock_evpolicy_parse(swclock_evpolicy_t* p, const char* spec);
+
+/**
+ * @brief The value ON_CHANGE compares for an event (see swclock_event_policy_t)
+ */
+double swclock_evpolicy_value(unsigned type, const void* payload, size_t payload_size);
+
+/**
+ * @brief Slow path of swclock_evpolicy_admit() for types not set to ALWAYS
+ */
+bool swclock_evpolicy_admit_slow(swclock_evpolicy_t* p, unsigned type, double value);
+
+/**
+ * @brief Decide whether an event is logged; counts it if not
+ *
+ * @param value The event's ON_CHANGE value (see swclock_event_policy_t),
+ *        computed by the caller before building the payload
+ */
+static inline bool swclock_evpolicy_admit(swclock_evpolicy_t* p, unsigned type, double value) {
+    if (type >= SWCLOCK_EVPOLICY_TYPES ||
+        __atomic_load_n(&p->slot[type].mode, __ATOMIC_ACQUIRE) == SWCLOCK_EVENT_POLICY_ALWAYS) {
+        return true;
+    }
+    return swclock_evpolicy_admit_slow(p, type, value);
+}
+
+/**
+ * @brief swclock_evpolicy_admit() for an already built payload
+ *
+ * The value is only extracted if the type has a policy other than ALWAYS.
+ */
+static inline bool swclock_evpolicy_admit_payload(swclock_evpolicy_t* p, unsigned type,
+                                                  const void* payload, size_t payload_size) {
+    if (type >= SWCLOCK_EVPOLICY_TYPES ||
+        __atomic_load_n(&p->slot[type].mode, __ATOMIC_ACQUIRE) == SWCLOCK_EVENT_POLICY_ALWAYS) {
+        return true;
+    }
+    return swclock_evpolicy_admit_slow(p, type, swclock_evpolicy_value(type, payload, payload_size));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_EVPOLICY_H */
@@ -0,0 +1,193 @@
+/**
+ * @file sw_clock_evreader.c
+ * @brief Memory-mapped event log segment reader
+ */
+
+#include "sw_clock_evreader.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct swclock_evreader {
+    const uint8_t* map;
+    uint64_t size;
+    swclock_event_log_header_t header;
+    swclock_event_index_entry_t* index;
+    size_t index_count;
+};
+
+swclock_evreader_t* swclock_evreader_open(const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return NULL;
+    }
+    if ((uint64_t)st.st_size < sizeof(swclock_event_log_header_t)) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int saved = errno;
+    close(fd);
+    if (map == MAP_FAILED) {
+        errno = saved;
+        return NULL;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    swclock_evreader_t* r = (swclock_evreader_t*)calloc(1, sizeof(*r));
+    if (!r) {
+        munmap(map, (size_t)st.st_size);
+        errno = ENOMEM;
+        return NULL;
+    }
+    r->map  = (const uint8_t*)map;
+    r->size = (uint64_t)st.st_size;
+    memcpy(&r->header, r->map, sizeof(r->header));
+
+    if (r->header.magic != SWCLOCK_EVENT_LOG_MAGIC || r->header.version_major < 1 ||
+        r->header.version_major > SWCLOCK_EVCODEC_VERSION) {
+        swclock_evreader_close(r);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    // The index is optional; drop it if any offset is out of place
+    r->index = swclock_evindex_load(path, &r->index_count);
+    for (size_t i = 0; r->index && i < r->index_count; i++) {
+        uint64_t prev = i ? r->index[i - 1].offset : 0;
+        if (r->index[i].offset < sizeof(r->header) || r->index[i].offset >= r->size ||
+            r->index[i].offset < prev) {
+            free(r->index);
+            r->index = NULL;
+            r->index_count = 0;
+        }
+    }
+    return r;
+}
+
+void swclock_evreader_close(swclock_evreader_t* r) {
+    if (!r) return;
+    munmap((void*)r->map, (size_t)r->size);
+    free(r->index);
+    free(r);
+}
+
+const swclock_event_log_header_t* swclock_evreader_header(const swclock_evreader_t* r) {
+    return &r->header;
+}
+
+uint64_t swclock_evreader_size(const swclock_evreader_t* r) {
+    return r->size;
+}
+
+const swclock_event_index_entry_t* swclock_evreader_index(const swclock_evreader_t* r, size_t* count) {
+    *count = r->index_count;
+    return r->index;
+}
+
+// First sync point at or after target and before end, from the index or (v2)
+// by scanning for a marker; end if there is none
+static uint64_t evreader_sync_after(const swclock_evreader_t* r, uint64_t target, uint64_t end) {
+    if (r->index) {
+        size_t lo = 0, hi = r->index_count;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (r->index[mid].offset < target) lo = mid + 1;
+            else hi = mid;
+        }
+        return (lo < r->index_count && r->index[lo].offset < end) ? r->index[lo].offset : end;
+    }
+
+    if (r->header.version_major < SWCLOCK_EVCODEC_VERSION || target >= end) return end;
+
+    // Any sync marker will do; the encoder writes the same bytes each time
+    uint8_t marker[SWCLOCK_EVCODEC_SYNC_SIZE];
+    swclock_evcodec_t scratch;
+    swclock_evcodec_sync(&scratch, marker);
+
+    const uint8_t* p = r->map + target;
+    const uint8_t* stop = r->map + end;
+    while ((size_t)(stop - p) >= sizeof(marker)) {
+        p = (const uint8_t*)memchr(p, marker[0], (size_t)(stop - p) - sizeof(marker) + 1);
+        if (!p) break;
+        if (memcmp(p, marker, sizeof(marker)) == 0) return (uint64_t)(p - r->map);
+        p++;
+    }
+    return end;
+}
+
+size_t swclock_evreader_split(const swclock_evreader_t* r, uint64_t begin, uint64_t end,
+                              size_t parts, uint64_t* bounds) {
+    if (end > r->size) end = r->size;
+    if (begin > end) begin = end;
+    if (parts == 0) parts = 1;
+
+    size_t n = 0;
+    bounds[0] = begin;
+    for (size_t i = 1; i < parts; i++) {
+        uint64_t target = begin + (end - begin) * i / parts;
+        if (target <= bounds[n]) continue;
+        uint64_t at = evreader_sync_after(r, target, end);
+        if (at >= end) break;
+        if (at > bounds[n]) bounds[++n] = at;
+    }
+    bounds[++n] = end;
+    return n;
+}
+
+void swclock_evreader_cursor_init(const swclock_evreader_t* r, uint64_t begin, uint64_t end,
+                                  swclock_evreader_cursor_t* cur) {
+    if (end > r->size) end = r->size;
+    cur->hdr     = NULL;
+    cur->payload = NULL;
+    cur->offset  = begin < end ? begin : end;
+    cur->base    = r->map;
+    cur->end     = end;
+    cur->version = r->header.version_major;
+    swclock_evcodec_reset(&cur->codec);
+}
+
+int swclock_evreader_next(swclock_evreader_cursor_t* cur) {
+    const uint8_t* p = cur->base + cur->offset;
+    size_t left = (size_t)(cur->end - cur->offset);
+
+    if (cur->version >= SWCLOCK_EVCODEC_VERSION) {
+        size_t used;
+        int rc = swclock_evcodec_decode(&cur->codec, p, left, &cur->decoded, cur->buf, &used);
+        if (rc <= 0) return rc;
+        cur->hdr     = &cur->decoded;
+        cur->payload = cur->buf;
+        cur->offset += used;
+        return 1;
+    }
+
+    // v1: header and payload in place
+    if (left == 0) return 0;
+    if (left < sizeof(swclock_event_header_t)) {
+        errno = EINVAL;
+        return -1;
+    }
+    const swclock_event_header_t* h = (const swclock_event_header_t*)p;
+    if (h->event_type == 0 && h->timestamp_ns == 0 && h->payload_size == 0) return 0;
+    if (h->payload_size > SWCLOCK_EVCODEC_MAX_PAYLOAD ||
+        left - sizeof(*h) < h->payload_size) {
+        errno = EINVAL;
+        return -1;
+    }
+    cur->hdr     = h;
+    cur->payload = p + sizeof(*h);
+    cur->offset += sizeof(*h) + h->payload_size;
+    return 1;
+}
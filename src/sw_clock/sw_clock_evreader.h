@@ -0,0 +1,120 @@
+/**
+ * @file sw_clock_evreader.h
+ * @brief Memory-mapped reader for binary event log segments
+ *
+ * Maps one log segment read-only and iterates its events in place:
+ *
+ * - Format v1 headers and payloads are returned as pointers into the
+ *   mapping; nothing is copied. Format v2 records are decoded into the
+ *   cursor (sw_clock_evcodec.h).
+ * - A cursor covers any byte range that starts at a sync point, so
+ *   independent cursors can decode parts of one segment on different
+ *   threads. swclock_evreader_split() finds such parts from the sidecar
+ *   index (sw_clock_evindex.h), or for v2 from the sync markers themselves.
+ * - Pages outside the ranges a caller decodes are never touched.
+ *
+ * A reader is immutable once open and may be shared between threads;
+ * each thread uses its own cursor.
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_EVREADER_H
+#define SWCLOCK_EVREADER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sw_clock_events.h"
+#include "sw_clock_evcodec.h"
+#include "sw_clock_evindex.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Opaque segment reader
+ */
+typedef struct swclock_evreader swclock_evreader_t;
+
+/**
+ * @brief Iteration state over one byte range of a segment
+ *
+ * After swclock_evreader_next() returns 1, hdr and payload describe the
+ * current event until the next call.
+ */
+typedef struct {
+    const swclock_event_header_t* hdr;  /**< Current event header */
+    const uint8_t* payload;             /**< Current payload, hdr->payload_size bytes */
+    uint64_t offset;                    /**< File offset of the next record */
+
+    const uint8_t* base;                /**< Mapping (file offset 0) */
+    uint64_t end;                       /**< File offset where the range ends */
+    uint16_t version;                   /**< Segment format version */
+    swclock_evcodec_t codec;            /**< v2 decoder state */
+    swclock_event_header_t decoded;     /**< v2 decoded header */
+    uint8_t buf[SWCLOCK_EVCODEC_MAX_PAYLOAD]; /**< v2 decoded payload */
+} swclock_evreader_cursor_t;
+
+/**
+ * @brief Map a segment, check its file header and load its index if present
+ *
+ * @return Reader, or NULL on failure (errno set; EINVAL if the file is not
+ *         an event log or has an unsupported version)
+ */
+swclock_evreader_t* swclock_evreader_open(const char* path);
+
+/**
+ * @brief Unmap and free
+ */
+void swclock_evreader_close(swclock_evreader_t* r);
+
+/**
+ * @brief File header of the segment
+ */
+const swclock_event_log_header_t* swclock_evreader_header(const swclock_evreader_t* r);
+
+/**
+ * @brief Segment file size (bytes)
+ */
+uint64_t swclock_evreader_size(const swclock_evreader_t* r);
+
+/**
+ * @brief Sidecar index entries, or NULL if the segment has no index
+ */
+const swclock_event_index_entry_t* swclock_evreader_index(const swclock_evreader_t* r, size_t* count);
+
+/**
+ * @brief Split [begin, end) at sync points into at most parts ranges of similar size
+ *
+ * begin must itself be a sync point (e.g. the end of the file header).
+ * Without an index, v2 segments are split at sync markers found by
+ * scanning near each target offset; v1 segments are not split.
+ *
+ * @param bounds Receives n + 1 offsets: range i is [bounds[i], bounds[i + 1])
+ * @return Number of ranges n (>= 1)
+ */
+size_t swclock_evreader_split(const swclock_evreader_t* r, uint64_t begin, uint64_t end,
+                              size_t parts, uint64_t* bounds);
+
+/**
+ * @brief Start iterating [begin, end); begin must be a sync point
+ */
+void swclock_evreader_cursor_init(const swclock_evreader_t* r, uint64_t begin, uint64_t end,
+                                  swclock_evreader_cursor_t* cur);
+
+/**
+ * @brief Advance to the next event
+ *
+ * @return 1 for an event, 0 at the end of the range (or the zero tail of a
+ *         segment that was not closed), -1 if the data is corrupt (errno =
+ *         EINVAL; cur->offset is where decoding stopped)
+ */
+int swclock_evreader_next(swclock_evreader_cursor_t* cur);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_EVREADER_H */
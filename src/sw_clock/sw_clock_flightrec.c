@@ -0,0 +1,466 @@
+/**
+ * @file sw_clock_flightrec.c
+ * @brief In-memory flight recorder for binary events
+ */
+
+#include "sw_clock_flightrec.h"
+#include "sw_clock_constants.h"
+#include "sw_clock_evcodec.h"
+#include "sw_clock_utilities.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// One event; seq is 2 * ticket + 1 while written, 2 * ticket + 2 once committed
+typedef struct {
+    uint64_t seq;
+    uint8_t  data[SWCLOCK_EVENT_MAX_SIZE];
+} flightrec_slot_t;
+
+struct swclock_flightrec {
+    flightrec_slot_t* slots;
+    uint64_t mask;
+
+    // Written by every producer
+    _Alignas(SWCLOCK_CACHELINE) uint64_t head;  // Next ticket
+    uint8_t pad[SWCLOCK_CACHELINE - sizeof(uint64_t)];
+
+    // Trigger worker
+    pthread_mutex_t lock;
+    pthread_cond_t  cv;
+    pthread_t       worker;
+    bool            worker_running;
+    bool            stop;
+    uint32_t        triggers;       // Enabled reasons
+    uint32_t        pending;        // Reasons not yet dumped
+    char*           prefix;
+    swclock_event_log_header_t header;
+    uint64_t        last_dump_ns;   // CLOCK_MONOTONIC of the last triggered dump
+    swclock_flightrec_stats_t stats;
+    swclock_flightrec_t* sig_next;  // Recorders dumping on SIGUSR2
+};
+
+static uint64_t flightrec_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+swclock_flightrec_t* swclock_flightrec_create(uint32_t events) {
+    if (events == 0) events = SWCLOCK_FLIGHTREC_EVENTS;
+    if (events > (1u << 24)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    uint64_t cap = 1;
+    while (cap < events) cap <<= 1;
+
+    void* mem = NULL;
+    if (posix_memalign(&mem, SWCLOCK_CACHELINE, sizeof(swclock_flightrec_t)) != 0) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    swclock_flightrec_t* fr = (swclock_flightrec_t*)mem;
+    memset(fr, 0, sizeof(*fr));
+
+    // Zeroed slots read as never committed
+    fr->slots = (flightrec_slot_t*)calloc((size_t)cap, sizeof(flightrec_slot_t));
+    if (!fr->slots) {
+        free(fr);
+        errno = ENOMEM;
+        return NULL;
+    }
+    fr->mask = cap - 1;
+    pthread_mutex_init(&fr->lock, NULL);
+    pthread_cond_init(&fr->cv, NULL);
+    return fr;
+}
+
+void swclock_flightrec_destroy(swclock_flightrec_t* fr) {
+    if (!fr) return;
+    swclock_flightrec_stop_triggers(fr);
+    pthread_mutex_destroy(&fr->lock);
+    pthread_cond_destroy(&fr->cv);
+    free(fr->prefix);
+    free(fr->slots);
+    free(fr);
+}
+
+uint32_t swclock_flightrec_capacity(const swclock_flightrec_t* fr) {
+    return (uint32_t)(fr->mask + 1);
+}
+
+uint64_t swclock_flightrec_recorded(const swclock_flightrec_t* fr) {
+    return __atomic_load_n(&fr->head, __ATOMIC_RELAXED);
+}
+
+void* swclock_flightrec_reserve(swclock_flightrec_t* fr, uint64_t* ticket) {
+    uint64_t t = __atomic_fetch_add(&fr->head, 1, __ATOMIC_RELAXED);
+    flightrec_slot_t* s = &fr->slots[t & fr->mask];
+
+    // Mark the slot as being written before touching its data
+    __atomic_store_n(&s->seq, 2 * t + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    *ticket = t;
+    return s->data;
+}
+
+void swclock_flightrec_commit(swclock_flightrec_t* fr, uint64_t ticket) {
+    __atomic_store_n(&fr->slots[ticket & fr->mask].seq, 2 * ticket + 2, __ATOMIC_RELEASE);
+}
+
+// Copy the committed events of the last lap into out (SWCLOCK_EVENT_MAX_SIZE
+// bytes each); returns the number copied
+static size_t flightrec_snapshot(swclock_flightrec_t* fr, uint8_t* out) {
+    uint64_t head = __atomic_load_n(&fr->head, __ATOMIC_ACQUIRE);
+    uint64_t cap = fr->mask + 1;
+    uint64_t first = head > cap ? head - cap : 0;
+    size_t n = 0;
+
+    for (uint64_t t = first; t < head; t++) {
+        flightrec_slot_t* s = &fr->slots[t & fr->mask];
+        uint64_t before = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        if (before != 2 * t + 2) continue;   // Still being written, or already overwritten
+
+        uint8_t* dst = out + n * SWCLOCK_EVENT_MAX_SIZE;
+        memcpy(dst, s->data, SWCLOCK_EVENT_MAX_SIZE);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) != before) continue;
+
+        const swclock_event_header_t* h = (const swclock_event_header_t*)dst;
+        if (h->event_type == 0 || h->payload_size > SWCLOCK_EVCODEC_MAX_PAYLOAD) continue;
+        n++;
+    }
+    return n;
+}
+
+static int flightrec_cmp(const void* a, const void* b) {
+    const swclock_event_header_t* x = (const swclock_event_header_t*)a;
+    const swclock_event_header_t* y = (const swclock_event_header_t*)b;
+    return (x->sequence_num > y->sequence_num) - (x->sequence_num < y->sequence_num);
+}
+
+long swclock_flightrec_write(swclock_flightrec_t* fr, const char* path,
+                             const swclock_event_log_header_t* header) {
+    if (!fr || !path || !header) {
+        errno = EINVAL;
+        return -1;
+    }
+    const size_t cap = (size_t)fr->mask + 1;
+    const bool v2 = header->version_major >= SWCLOCK_EVCODEC_VERSION;
+
+    uint8_t* recs = (uint8_t*)malloc(cap * SWCLOCK_EVENT_MAX_SIZE);
+    uint8_t* out = (uint8_t*)malloc(sizeof(*header) + cap * (v2 ? SWCLOCK_EVCODEC_MAX_RECORD
+                                                               : SWCLOCK_EVENT_MAX_SIZE));
+    size_t tmp_len = strlen(path) + 5;
+    char* tmp = (char*)malloc(tmp_len);
+    if (!recs || !out || !tmp) {
+        free(recs);
+        free(out);
+        free(tmp);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    // Producers commit out of ticket order only when they race; sort if so
+    size_t n = flightrec_snapshot(fr, recs);
+    for (size_t i = 1; i < n; i++) {
+        if (flightrec_cmp(recs + (i - 1) * SWCLOCK_EVENT_MAX_SIZE, recs + i * SWCLOCK_EVENT_MAX_SIZE) > 0) {
+            qsort(recs, n, SWCLOCK_EVENT_MAX_SIZE, flightrec_cmp);
+            break;
+        }
+    }
+
+    swclock_event_log_header_t fh = *header;
+    if (n > 0) fh.start_time_ns = ((const swclock_event_header_t*)recs)->timestamp_ns;
+    memcpy(out, &fh, sizeof(fh));
+    size_t len = sizeof(fh);
+
+    swclock_evcodec_t enc;
+    swclock_evcodec_reset(&enc);
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t* rec = recs + i * SWCLOCK_EVENT_MAX_SIZE;
+        const swclock_event_header_t* h = (const swclock_event_header_t*)rec;
+        if (v2) {
+            len += swclock_evcodec_encode(&enc, h, rec + sizeof(*h), out + len);
+        } else {
+            memcpy(out + len, rec, sizeof(*h) + h->payload_size);
+            len += sizeof(*h) + h->payload_size;
+        }
+    }
+    free(recs);
+
+    // Write beside the target and rename, so the dump appears whole or not at all
+    snprintf(tmp, tmp_len, "%s.tmp", path);
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    int ret = -1;
+    if (fd >= 0) {
+        ret = swclock_write_all(fd, out, len);
+        if (ret == 0) ret = fsync(fd);
+        int saved = errno;
+        close(fd);
+        if (ret == 0) ret = rename(tmp, path);
+        if (ret != 0) {
+            saved = errno;
+            unlink(tmp);
+        }
+        errno = saved;
+    }
+    int saved = errno;
+    free(out);
+    free(tmp);
+    errno = saved;
+    return ret == 0 ? (long)n : -1;
+}
+
+// ---- SIGUSR2: handler -> self-pipe -> watcher thread -> recorders ----
+
+static pthread_mutex_t g_sig_lock = PTHREAD_MUTEX_INITIALIZER;
+static swclock_flightrec_t* g_sig_list;     // Recorders with SWCLOCK_FLIGHTREC_ON_SIGNAL
+static int g_sig_wfd = -1;                  // Pipe write end (read by the handler)
+static struct sigaction g_sig_prev;
+
+static void flightrec_on_sigusr2(int sig) {
+    (void)sig;
+    int saved = errno;
+    int fd = __atomic_load_n(&g_sig_wfd, __ATOMIC_RELAXED);
+    if (fd >= 0) {
+        char b = 1;
+        ssize_t r = write(fd, &b, 1);   // Full pipe: a wakeup is pending anyway
+        (void)r;
+    }
+    errno = saved;
+}
+
+static void* flightrec_sig_main(void* arg) {
+    int fd = (int)(intptr_t)arg;
+    char buf[64];
+    for (;;) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+
+        pthread_mutex_lock(&g_sig_lock);
+        for (swclock_flightrec_t* fr = g_sig_list; fr; fr = fr->sig_next) {
+            swclock_flightrec_trigger(fr, SWCLOCK_FLIGHTREC_ON_SIGNAL);
+        }
+        pthread_mutex_unlock(&g_sig_lock);
+    }
+    close(fd);
+    return NULL;
+}
+
+// The pipe and its watcher are created once and kept for the process
+// lifetime: a handler running on another thread may hold g_sig_wfd after
+// the last recorder is gone, and a closed fd could be reused by then
+static int flightrec_sig_pipe(void) {
+    if (g_sig_wfd >= 0) return 0;
+
+    int p[2];
+    if (pipe(p) != 0) return -1;
+    fcntl(p[0], F_SETFD, FD_CLOEXEC);
+    fcntl(p[1], F_SETFD, FD_CLOEXEC);
+    fcntl(p[1], F_SETFL, O_NONBLOCK);
+
+    pthread_t t;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int rc = pthread_create(&t, &attr, flightrec_sig_main, (void*)(intptr_t)p[0]);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        close(p[0]);
+        close(p[1]);
+        errno = rc;
+        return -1;
+    }
+    __atomic_store_n(&g_sig_wfd, p[1], __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int flightrec_sig_register(swclock_flightrec_t* fr) {
+    pthread_mutex_lock(&g_sig_lock);
+    if (!g_sig_list) {
+        if (flightrec_sig_pipe() != 0) {
+            pthread_mutex_unlock(&g_sig_lock);
+            return -1;
+        }
+
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = flightrec_on_sigusr2;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGUSR2, &sa, &g_sig_prev);
+    }
+    fr->sig_next = g_sig_list;
+    g_sig_list = fr;
+    pthread_mutex_unlock(&g_sig_lock);
+    return 0;
+}
+
+static void flightrec_sig_unregister(swclock_flightrec_t* fr) {
+    pthread_mutex_lock(&g_sig_lock);
+    for (swclock_flightrec_t** p = &g_sig_list; *p; p = &(*p)->sig_next) {
+        if (*p == fr) {
+            *p = fr->sig_next;
+            fr->sig_next = NULL;
+            if (!g_sig_list) {
+                // Last one: restore the old disposition. The pipe stays; a
+                // late wakeup finds the list empty
+                sigaction(SIGUSR2, &g_sig_prev, NULL);
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_sig_lock);
+}
+
+// ---- Trigger worker ----
+
+// "threshold", "watchdog+signal", ...
+static void flightrec_reason_name(uint32_t reasons, char* buf, size_t len) {
+    static const struct { uint32_t bit; const char* name; } names[] = {
+        { SWCLOCK_FLIGHTREC_ON_THRESHOLD, "threshold" },
+        { SWCLOCK_FLIGHTREC_ON_WATCHDOG,  "watchdog" },
+        { SWCLOCK_FLIGHTREC_ON_SIGNAL,    "signal" },
+    };
+    buf[0] = '\0';
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (!(reasons & names[i].bit)) continue;
+        size_t used = strlen(buf);
+        snprintf(buf + used, len - used, "%s%s", used ? "+" : "", names[i].name);
+    }
+}
+
+static void* flightrec_worker_main(void* arg) {
+    swclock_flightrec_t* fr = (swclock_flightrec_t*)arg;
+
+    pthread_mutex_lock(&fr->lock);
+    for (;;) {
+        while (!fr->stop && !fr->pending) {
+            pthread_cond_wait(&fr->cv, &fr->lock);
+        }
+        if (fr->stop) break;
+
+        // At most one dump per interval; later triggers wait and coalesce
+        uint64_t now = flightrec_now_ns();
+        if (fr->last_dump_ns && now - fr->last_dump_ns < (uint64_t)SWCLOCK_FLIGHTREC_MIN_INTERVAL_NS) {
+            uint64_t wait_ns = fr->last_dump_ns + SWCLOCK_FLIGHTREC_MIN_INTERVAL_NS - now;
+            struct timespec abs;
+            clock_gettime(CLOCK_REALTIME, &abs);
+            abs.tv_sec += (time_t)(wait_ns / 1000000000ULL);
+            abs.tv_nsec += (long)(wait_ns % 1000000000ULL);
+            if (abs.tv_nsec >= 1000000000L) {
+                abs.tv_sec++;
+                abs.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&fr->cv, &fr->lock, &abs);
+            continue;
+        }
+
+        uint32_t reasons = fr->pending;
+        fr->pending = 0;
+        fr->last_dump_ns = now;
+        swclock_event_log_header_t header = fr->header;
+        char path[512], reason[64], stamp[32];
+        struct timespec wall;
+        clock_gettime(CLOCK_REALTIME, &wall);
+        struct tm tm_val;
+        gmtime_r(&wall.tv_sec, &tm_val);
+        strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm_val);
+        flightrec_reason_name(reasons, reason, sizeof(reason));
+        snprintf(path, sizeof(path), "%s-%s.%03ld-%s.bin", fr->prefix, stamp,
+                 wall.tv_nsec / 1000000L, reason);
+        pthread_mutex_unlock(&fr->lock);
+
+        // Producers keep recording while the snapshot is taken and written
+        long n = swclock_flightrec_write(fr, path, &header);
+
+        pthread_mutex_lock(&fr->lock);
+        if (n >= 0) {
+            fr->stats.dumps++;
+            snprintf(fr->stats.last_path, sizeof(fr->stats.last_path), "%s", path);
+        } else {
+            fr->stats.failures++;
+        }
+    }
+    pthread_mutex_unlock(&fr->lock);
+    return NULL;
+}
+
+int swclock_flightrec_start_triggers(swclock_flightrec_t* fr, const char* prefix, uint32_t triggers,
+                                     const swclock_event_log_header_t* header) {
+    if (!fr || !prefix || !header) {
+        errno = EINVAL;
+        return -1;
+    }
+    swclock_flightrec_stop_triggers(fr);
+    if (triggers == 0) return 0;
+
+    char* copy = strdup(prefix);
+    if (!copy) return -1;
+
+    pthread_mutex_lock(&fr->lock);
+    free(fr->prefix);
+    fr->prefix = copy;
+    fr->header = *header;
+    fr->triggers = triggers;
+    fr->pending = 0;
+    fr->stop = false;
+    int rc = pthread_create(&fr->worker, NULL, flightrec_worker_main, fr);
+    fr->worker_running = (rc == 0);
+    if (rc != 0) fr->triggers = 0;
+    pthread_mutex_unlock(&fr->lock);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+
+    if ((triggers & SWCLOCK_FLIGHTREC_ON_SIGNAL) && flightrec_sig_register(fr) != 0) {
+        int saved = errno;
+        swclock_flightrec_stop_triggers(fr);
+        errno = saved;
+        return -1;
+    }
+    return 0;
+}
+
+void swclock_flightrec_stop_triggers(swclock_flightrec_t* fr) {
+    if (!fr) return;
+    flightrec_sig_unregister(fr);
+
+    pthread_mutex_lock(&fr->lock);
+    bool running = fr->worker_running;
+    fr->worker_running = false;
+    fr->triggers = 0;
+    fr->stop = true;
+    pthread_cond_signal(&fr->cv);
+    pthread_mutex_unlock(&fr->lock);
+
+    if (running) pthread_join(fr->worker, NULL);
+}
+
+void swclock_flightrec_trigger(swclock_flightrec_t* fr, uint32_t reason) {
+    if (!fr) return;
+    pthread_mutex_lock(&fr->lock);
+    if (fr->triggers & reason) {
+        fr->stats.triggers++;
+        fr->pending |= reason;
+        pthread_cond_signal(&fr->cv);
+    }
+    pthread_mutex_unlock(&fr->lock);
+}
+
+void swclock_flightrec_get_stats(swclock_flightrec_t* fr, swclock_flightrec_stats_t* stats) {
+    pthread_mutex_lock(&fr->lock);
+    *stats = fr->stats;
+    pthread_mutex_unlock(&fr->lock);
+}
@@ -0,0 +1,154 @@
+/**
+ * @file sw_clock_flightrec.h
+ * @brief In-memory flight recorder for binary events
+ *
+ * Keeps the most recent events in memory with no consumer thread and no
+ * file, and writes them out only when asked (swclock_flightrec_write()) or
+ * when a trigger fires (threshold alert, servo watchdog, SIGUSR2).
+ *
+ * Design:
+ * - A power-of-two array of fixed-size slots, each large enough for any
+ *   event (SWCLOCK_EVENT_MAX_SIZE). Producers take a ticket with one
+ *   fetch-add and overwrite the oldest slot; they never wait and never
+ *   fail. The variable-length event ring (sw_clock_ringbuf.h) cannot
+ *   overwrite in place, because nothing would mark where its oldest
+ *   surviving record starts.
+ * - Each slot carries a sequence word (seqlock): odd while its producer
+ *   writes, 2 * ticket + 2 once committed. A snapshot copies the slots of
+ *   the last lap and keeps a copy only if the word read before and after
+ *   it is the committed value for that ticket, so producers are never
+ *   paused and torn or overwritten slots are skipped.
+ * - Dumps are ordinary event log files (v1 or compact v2, the format of
+ *   the header passed in), written to "<path>.tmp" and renamed into place,
+ *   so a reader never sees half a dump. swclock_event_dump reads them.
+ * - Triggered dumps run on a worker thread: triggers only set a reason bit
+ *   and signal it, so the poll thread (which finds the watchdog condition
+ *   holding the clock's write lock) never waits for I/O. SIGUSR2 reaches
+ *   the workers through a self-pipe; the handler is installed while any
+ *   recorder asks for it and the previous disposition is restored after.
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_FLIGHTREC_H
+#define SWCLOCK_FLIGHTREC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sw_clock_events.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Dump triggers and reasons
+ */
+#define SWCLOCK_FLIGHTREC_ON_THRESHOLD 0x1u  /**< Monitoring threshold alert */
+#define SWCLOCK_FLIGHTREC_ON_WATCHDOG  0x2u  /**< Poll watchdog: servo stuck */
+#define SWCLOCK_FLIGHTREC_ON_SIGNAL    0x4u  /**< SIGUSR2 */
+
+/**
+ * @brief Opaque flight recorder
+ */
+typedef struct swclock_flightrec swclock_flightrec_t;
+
+/**
+ * @brief Allocate a recorder keeping the last `events` events
+ *
+ * @param events Capacity, rounded up to a power of two (0: SWCLOCK_FLIGHTREC_EVENTS)
+ * @return Recorder, or NULL (errno set)
+ */
+swclock_flightrec_t* swclock_flightrec_create(uint32_t events);
+
+/**
+ * @brief Stop the trigger worker and free; no producer may still be recording
+ */
+void swclock_flightrec_destroy(swclock_flightrec_t* fr);
+
+/**
+ * @brief Capacity in events
+ */
+uint32_t swclock_flightrec_capacity(const swclock_flightrec_t* fr);
+
+/**
+ * @brief Events recorded since creation (including overwritten ones)
+ */
+uint64_t swclock_flightrec_recorded(const swclock_flightrec_t* fr);
+
+/**
+ * @brief Claim the slot of the next event (any thread, never blocks)
+ *
+ * @param ticket Output: pass to swclock_flightrec_commit()
+ * @return SWCLOCK_EVENT_MAX_SIZE bytes for the header and payload
+ */
+void* swclock_flightrec_reserve(swclock_flightrec_t* fr, uint64_t* ticket);
+
+/**
+ * @brief Publish a slot filled after swclock_flightrec_reserve()
+ */
+void swclock_flightrec_commit(swclock_flightrec_t* fr, uint64_t ticket);
+
+/**
+ * @brief Write the recorded events to an event log file
+ *
+ * Runs on the calling thread; producers keep recording meanwhile. Events
+ * are written in sequence order; the header's start_time_ns is replaced by
+ * the timestamp of the oldest event.
+ *
+ * @param path Output file (replaced atomically)
+ * @param header File header; version_major selects v1 or v2 records
+ * @return Events written, or -1 (errno set)
+ */
+long swclock_flightrec_write(swclock_flightrec_t* fr, const char* path,
+                             const swclock_event_log_header_t* header);
+
+/**
+ * @brief Start dumping on triggers
+ *
+ * Each triggered dump goes to "<prefix>-<UTC date>-<time>.<ms>-<reason>.bin"
+ * at most once per SWCLOCK_FLIGHTREC_MIN_INTERVAL_NS; triggers in between
+ * are counted but coalesced.
+ *
+ * @param prefix Dump path prefix
+ * @param triggers SWCLOCK_FLIGHTREC_ON_* (ON_SIGNAL installs the SIGUSR2 handler)
+ * @param header File header for the dumps (see swclock_flightrec_write())
+ * @return 0 on success, -1 (errno set)
+ */
+int swclock_flightrec_start_triggers(swclock_flightrec_t* fr, const char* prefix, uint32_t triggers,
+                                     const swclock_event_log_header_t* header);
+
+/**
+ * @brief Stop the trigger worker (waits for a dump in progress)
+ */
+void swclock_flightrec_stop_triggers(swclock_flightrec_t* fr);
+
+/**
+ * @brief Request a dump for reason (one SWCLOCK_FLIGHTREC_ON_* bit)
+ *
+ * Cheap and non-blocking apart from a short mutex; ignored unless the
+ * reason is among the recorder's triggers. Not async-signal-safe.
+ */
+void swclock_flightrec_trigger(swclock_flightrec_t* fr, uint32_t reason);
+
+/**
+ * @brief Trigger counters
+ */
+typedef struct {
+    uint64_t triggers;          /**< Triggers received (enabled reasons only) */
+    uint64_t dumps;             /**< Triggered dumps written */
+    uint64_t failures;          /**< Triggered dumps that failed */
+    char     last_path[512];    /**< Most recent triggered dump */
+} swclock_flightrec_stats_t;
+
+/**
+ * @brief Get trigger counters
+ */
+void swclock_flightrec_get_stats(swclock_flightrec_t* fr, swclock_flightrec_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_FLIGHTREC_H */
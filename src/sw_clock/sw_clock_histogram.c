@@ -0,0 +1,54 @@
+/**
+ * @file sw_clock_histogram.c
+ * @brief Log2 latency histogram
+ */
+
+#include "sw_clock_histogram.h"
+
+static unsigned bucket_of(uint64_t v) {
+    if (v == 0) return 0;
+
+    unsigned bits = 64u - (unsigned)__builtin_clzll(v);  // v in [2^(bits-1), 2^bits)
+    return (bits < SWCLOCK_HIST_BUCKETS) ? bits : SWCLOCK_HIST_BUCKETS - 1;
+}
+
+void swclock_histogram_record(swclock_histogram_t* h, int64_t value_ns) {
+    if (!h) return;
+
+    uint64_t v = (value_ns > 0) ? (uint64_t)value_ns : 0;
+    h->buckets[bucket_of(v)]++;
+    h->count++;
+    h->sum_ns += v;
+    if (v > h->max_ns) h->max_ns = v;
+}
+
+uint64_t swclock_histogram_bucket_limit_ns(unsigned bucket) {
+    if (bucket >= SWCLOCK_HIST_BUCKETS - 1) return UINT64_MAX;
+    return 1ULL << bucket;
+}
+
+uint64_t swclock_histogram_quantile_ns(const swclock_histogram_t* h, double q) {
+    if (!h || h->count == 0) return 0;
+
+    if (q < 0.0) q = 0.0;
+    if (q > 1.0) q = 1.0;
+
+    // Rank of the quantile sample (1-based)
+    uint64_t rank = (uint64_t)(q * (double)h->count + 0.5);
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < SWCLOCK_HIST_BUCKETS; i++) {
+        seen += h->buckets[i];
+        if (seen >= rank) {
+            uint64_t limit = swclock_histogram_bucket_limit_ns(i);
+            return (limit < h->max_ns) ? limit : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+uint64_t swclock_histogram_mean_ns(const swclock_histogram_t* h) {
+    if (!h || h->count == 0) return 0;
+    return h->sum_ns / h->count;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file sw_clock_histogram.h
+ * @brief Fixed-size log2 latency histogram
+ *
+ * Records non-negative durations (ns) into power-of-two buckets: bucket 0
+ * holds 0, bucket i (i >= 1) holds [2^(i-1), 2^i), and the last bucket
+ * also collects everything larger. Recording is a count-leading-zeros and
+ * a few adds with no allocation, so it can stay enabled on every poll.
+ *
+ * Not thread-safe: callers serialize recording and copying.
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_HISTOGRAM_H
+#define SWCLOCK_HISTOGRAM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of buckets; the last one starts at 2^30 ns (~1.07 s) */
+#define SWCLOCK_HIST_BUCKETS 32
+
+/**
+ * @brief Histogram of durations in nanoseconds
+ */
+typedef struct {
+    uint64_t count;                             /**< Samples recorded */
+    uint64_t sum_ns;                            /**< Sum of samples */
+    uint64_t max_ns;                            /**< Largest sample */
+    uint64_t buckets[SWCLOCK_HIST_BUCKETS];     /**< Samples per log2 bucket */
+} swclock_histogram_t;
+
+/**
+ * @brief Record one sample; negative values count as 0
+ */
+void swclock_histogram_record(swclock_histogram_t* h, int64_t value_ns);
+
+/**
+ * @brief Exclusive upper bound of a bucket (ns); UINT64_MAX for the last
+ */
+uint64_t swclock_histogram_bucket_limit_ns(unsigned bucket);
+
+/**
+ * @brief Approximate quantile: upper bound of the bucket holding it
+ *
+ * Clamped to max_ns, so the result never exceeds an observed sample.
+ *
+ * @param h Histogram
+ * @param q Quantile in [0, 1] (e.g. 0.99)
+ * @return Quantile estimate in ns, 0 if the histogram is empty
+ */
+uint64_t swclock_histogram_quantile_ns(const swclock_histogram_t* h, double q);
+
+/**
+ * @brief Mean sample (ns), 0 if the histogram is empty
+ */
+uint64_t swclock_histogram_mean_ns(const swclock_histogram_t* h);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_HISTOGRAM_H */
@@ -0,0 +1,137 @@
+/**
+ * @file sw_clock_history.c
+ * @brief Timebase history ring implementation
+ */
+
+#include "sw_clock_history.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define HISTORY_MASK ((uint64_t)SWCLOCK_HISTORY_SEGMENTS - 1)
+
+void swclock_history_init(swclock_history_t* h) {
+    if (!h) return;
+
+    atomic_init(&h->head, 0);
+    for (size_t i = 0; i < SWCLOCK_HISTORY_SEGMENTS; i++) {
+        swclock_history_slot_t* s = &h->slots[i];
+        atomic_init(&s->seq, 0);
+        atomic_init(&s->shift, 0);
+        atomic_init(&s->index, UINT64_MAX);
+        atomic_init(&s->ref_raw_ns, 0);
+        atomic_init(&s->base_rt_ns, 0);
+        atomic_init(&s->base_mono_ns, 0);
+        atomic_init(&s->mult, 0);
+    }
+}
+
+void swclock_history_append(swclock_history_t* h, const swclock_timebase_snapshot_t* snap) {
+    if (!h || !snap) return;
+
+    uint64_t idx = atomic_load_explicit(&h->head, memory_order_relaxed);
+    swclock_history_slot_t* s = &h->slots[idx & HISTORY_MASK];
+
+    uint32_t seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+    atomic_store_explicit(&s->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&s->index, idx, memory_order_relaxed);
+    atomic_store_explicit(&s->ref_raw_ns, snap->ref_raw_ns, memory_order_relaxed);
+    atomic_store_explicit(&s->base_rt_ns, snap->base_rt_ns, memory_order_relaxed);
+    atomic_store_explicit(&s->base_mono_ns, snap->base_mono_ns, memory_order_relaxed);
+    atomic_store_explicit(&s->mult, snap->mult, memory_order_relaxed);
+    atomic_store_explicit(&s->shift, snap->shift, memory_order_relaxed);
+
+    atomic_store_explicit(&s->seq, seq + 2, memory_order_release);
+
+    // Make the segment visible to readers only once it is complete
+    atomic_store_explicit(&h->head, idx + 1, memory_order_release);
+}
+
+// Copy slot for logical index idx. Returns false if the writer has already
+// reused the slot for a newer segment.
+static bool history_read(const swclock_history_t* h, uint64_t idx,
+                         swclock_timebase_snapshot_t* out) {
+    swclock_history_slot_t* s = (swclock_history_slot_t*)&h->slots[idx & HISTORY_MASK];
+    uint32_t seq1, seq2;
+    uint64_t stored;
+
+    for (;;) {
+        seq1 = atomic_load_explicit(&s->seq, memory_order_acquire);
+        if (seq1 & 1u) {
+            swclock_timebase_cpu_relax();
+            continue;
+        }
+
+        stored            = atomic_load_explicit(&s->index, memory_order_relaxed);
+        out->ref_raw_ns   = atomic_load_explicit(&s->ref_raw_ns, memory_order_relaxed);
+        out->base_rt_ns   = atomic_load_explicit(&s->base_rt_ns, memory_order_relaxed);
+        out->base_mono_ns = atomic_load_explicit(&s->base_mono_ns, memory_order_relaxed);
+        out->mult         = atomic_load_explicit(&s->mult, memory_order_relaxed);
+        out->shift        = atomic_load_explicit(&s->shift, memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        seq2 = atomic_load_explicit(&s->seq, memory_order_relaxed);
+        if (seq1 == seq2) break;
+    }
+    return stored == idx;
+}
+
+int swclock_history_find(const swclock_history_t* h, int64_t raw_ns,
+                         swclock_timebase_snapshot_t* seg, int64_t* seg_end_ns) {
+    if (!h || !seg) return -1;
+
+    swclock_history_t* hh = (swclock_history_t*)h;
+
+    for (;;) {
+        uint64_t head = atomic_load_explicit(&hh->head, memory_order_acquire);
+        if (head == 0) return -1;
+
+        uint64_t lo = (head > SWCLOCK_HISTORY_SEGMENTS) ? head - SWCLOCK_HISTORY_SEGMENTS : 0;
+        uint64_t hi = head - 1;
+        swclock_timebase_snapshot_t s;
+
+        // Fast path: the newest segment covers everything after its reference
+        if (!history_read(h, hi, &s)) continue;
+        if (s.ref_raw_ns <= raw_ns) {
+            *seg = s;
+            if (seg_end_ns) *seg_end_ns = INT64_MAX;
+            return 0;
+        }
+
+        // Oldest retained segment
+        swclock_timebase_snapshot_t first;
+        if (!history_read(h, lo, &first)) continue;
+        if (first.ref_raw_ns > raw_ns) {
+            *seg = first;
+            if (seg_end_ns) *seg_end_ns = first.ref_raw_ns;
+            return 1;
+        }
+
+        // Invariant: ref(lo) <= raw_ns < ref(hi)
+        swclock_timebase_snapshot_t found = first, next = s;
+        bool lapped = false;
+        while (hi - lo > 1) {
+            uint64_t mid = lo + (hi - lo) / 2;
+            if (!history_read(h, mid, &s)) {
+                lapped = true;
+                break;
+            }
+            if (s.ref_raw_ns <= raw_ns) {
+                lo = mid;
+                found = s;
+            } else {
+                hi = mid;
+                next = s;
+            }
+        }
+        if (lapped) continue;
+
+        // The lower bound may have been overwritten while searching
+        if (!history_read(h, lo, &found)) continue;
+
+        *seg = found;
+        if (seg_end_ns) *seg_end_ns = next.ref_raw_ns;
+        return 0;
+    }
+}
@@ -0,0 +1,93 @@
+/**
+ * @file sw_clock_history.h
+ * @brief Bounded lock-free history of published timebase segments
+ *
+ * Every timebase publish (poll rebase, settime, adjtime, reset) appends a
+ * segment (ref_raw_ns, bases, mult/shift) that is valid from its ref_raw_ns
+ * until the next segment's. Converting a raw timestamp taken in the past
+ * looks up the segment in force at that raw time, so delayed conversions
+ * use the rate and steps that actually applied rather than the current
+ * ones.
+ *
+ * Single writer (serialized by the SwClock write lock), any number of
+ * readers. Each slot is an independent seqlock tagged with its logical
+ * index, so readers detect slots the writer has lapped and retry; they
+ * never block and never write shared memory.
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_HISTORY_H
+#define SWCLOCK_HISTORY_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "sw_clock_constants.h"
+#include "sw_clock_timebase.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if (SWCLOCK_HISTORY_SEGMENTS & (SWCLOCK_HISTORY_SEGMENTS - 1)) != 0
+#error "SWCLOCK_HISTORY_SEGMENTS must be a power of two"
+#endif
+
+/**
+ * @brief One history slot
+ */
+typedef struct {
+    _Atomic uint32_t seq;       /**< Odd while the slot is being rewritten */
+    _Atomic uint32_t shift;
+    _Atomic uint64_t index;     /**< Logical segment index stored in the slot */
+    _Atomic int64_t  ref_raw_ns;
+    _Atomic int64_t  base_rt_ns;
+    _Atomic int64_t  base_mono_ns;
+    _Atomic uint64_t mult;
+} swclock_history_slot_t;
+
+/**
+ * @brief History ring
+ */
+typedef struct {
+    _Atomic uint64_t head;      /**< Number of segments ever appended */
+    swclock_history_slot_t slots[SWCLOCK_HISTORY_SEGMENTS];
+} swclock_history_t;
+
+/**
+ * @brief Initialize an empty history
+ */
+void swclock_history_init(swclock_history_t* h);
+
+/**
+ * @brief Append a segment (writer side)
+ *
+ * Thread safety: callers must serialize writers.
+ *
+ * @param h History
+ * @param snap Segment that starts at snap->ref_raw_ns
+ */
+void swclock_history_append(swclock_history_t* h, const swclock_timebase_snapshot_t* snap);
+
+/**
+ * @brief Find the segment in force at a raw time (reader side, lock-free)
+ *
+ * Binary search for the newest segment with ref_raw_ns <= raw_ns.
+ *
+ * @param h History
+ * @param raw_ns Raw time to look up
+ * @param seg Output segment
+ * @param seg_end_ns Output: raw time at which the next segment starts
+ *                   (INT64_MAX for the newest segment); may be NULL
+ * @return 0 if found, 1 if raw_ns predates the retained history (seg is
+ *         the oldest retained segment), -1 if the history is empty
+ */
+int swclock_history_find(const swclock_history_t* h, int64_t raw_ns,
+                         swclock_timebase_snapshot_t* seg, int64_t* seg_end_ns);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_HISTORY_H */
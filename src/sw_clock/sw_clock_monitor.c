@@ -305,6 +305,23 @@ static int compute_metrics(
     return 0;
 }
 
+/**
+ * @brief Report one alert to the callback and the hook
+ */
+static void raise_alert(
+    const swclock_monitor_t* monitor,
+    const char* metric,
+    double value,
+    double threshold
+) {
+    if (monitor->thresholds.alert_callback) {
+        monitor->thresholds.alert_callback(metric, value, threshold);
+    }
+    if (monitor->alert_hook) {
+        monitor->alert_hook(monitor->alert_hook_ctx, metric, value, threshold);
+    }
+}
+
 /**
  * @brief Check thresholds and trigger alerts
  */
@@ -312,26 +329,27 @@ static void check_thresholds(
     swclock_monitor_t* monitor,
     const swclock_metrics_snapshot_t* metrics
 ) {
-    if (!monitor->thresholds.enabled || !monitor->thresholds.alert_callback) {
+    if (!monitor->thresholds.enabled ||
+        (!monitor->thresholds.alert_callback && !monitor->alert_hook)) {
         return;
     }
     
     const swclock_threshold_config_t* cfg = &monitor->thresholds;
     
     if (metrics->mtie_1s_ns > cfg->mtie_1s_threshold_ns) {
-        cfg->alert_callback("MTIE(1s)", metrics->mtie_1s_ns, cfg->mtie_1s_threshold_ns);
+        raise_alert(monitor, "MTIE(1s)", metrics->mtie_1s_ns, cfg->mtie_1s_threshold_ns);
     }
     
     if (metrics->mtie_10s_ns > cfg->mtie_10s_threshold_ns) {
-        cfg->alert_callback("MTIE(10s)", metrics->mtie_10s_ns, cfg->mtie_10s_threshold_ns);
+        raise_alert(monitor, "MTIE(10s)", metrics->mtie_10s_ns, cfg->mtie_10s_threshold_ns);
     }
     
     if (metrics->tdev_1s_ns > cfg->tdev_1s_threshold_ns) {
-        cfg->alert_callback("TDEV(1s)", metrics->tdev_1s_ns, cfg->tdev_1s_threshold_ns);
+        raise_alert(monitor, "TDEV(1s)", metrics->tdev_1s_ns, cfg->tdev_1s_threshold_ns);
     }
     
     if (fabs(metrics->max_te_ns) > cfg->max_te_threshold_ns) {
-        cfg->alert_callback("Max TE", metrics->max_te_ns, cfg->max_te_threshold_ns);
+        raise_alert(monitor, "Max TE", metrics->max_te_ns, cfg->max_te_threshold_ns);
     }
 }
 
@@ -403,6 +421,8 @@ int swclock_monitor_init(swclock_monitor_t* monitor, double sample_rate_hz) {
     monitor->thresholds.tdev_1s_threshold_ns = 40000.0;     // 40 µs
     monitor->thresholds.max_te_threshold_ns = 300000.0;     // 300 µs
     monitor->thresholds.alert_callback = NULL;
+    monitor->alert_hook = NULL;
+    monitor->alert_hook_ctx = NULL;
     
     return 0;
 }
@@ -102,6 +102,11 @@ typedef struct {
     
     uint64_t last_compute_time_ns;
     uint64_t compute_count;
+
+    // Called with every alert, besides thresholds.alert_callback (set by the
+    // owning clock; survives swclock_monitor_set_thresholds())
+    void (*alert_hook)(void* ctx, const char* metric, double value, double threshold);
+    void* alert_hook_ctx;
 } swclock_monitor_t;
 
 /**
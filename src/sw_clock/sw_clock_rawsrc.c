@@ -0,0 +1,381 @@
+/**
+ * @file sw_clock_rawsrc.c
+ * @brief Raw time source selection and TSC calibration
+ */
+
+#include "sw_clock_rawsrc.h"
+#include "sw_clock_timebase.h"
+#include "sw_clock_utilities.h"
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <cpuid.h>
+  #include <x86intrin.h>
+  #define SWCLOCK_HAVE_TSC 1
+#else
+  #define SWCLOCK_HAVE_TSC 0
+#endif
+
+#ifndef CLOCK_MONOTONIC_RAW
+  #ifdef CLOCK_UPTIME_RAW
+    #define CLOCK_MONOTONIC_RAW CLOCK_UPTIME_RAW
+  #else
+    #define CLOCK_MONOTONIC_RAW CLOCK_MONOTONIC
+  #endif
+#endif
+
+// Active source (swclock_rawsrc_t)
+static _Atomic int g_source = SWCLOCK_RAWSRC_CLOCK_GETTIME;
+
+// Seqlock-published TSC -> ns conversion: ns = ns_ref + ((tsc - tsc_ref) * mult) >> SHIFT
+// for the first slew_ticks after tsc_ref, then slew_ns on from there at base_mult
+static struct {
+    _Atomic uint32_t seq;
+    _Atomic uint64_t tsc_ref;
+    _Atomic int64_t  ns_ref;
+    _Atomic uint64_t mult;
+    _Atomic uint64_t slew_ticks;
+    _Atomic int64_t  slew_ns;
+    _Atomic uint64_t base_mult;
+} g_conv;
+
+// Offset carried into the clock_gettime source after leaving the TSC:
+// (TSC time - MONOTONIC_RAW) at ref_ns, slewed linearly to zero at end_ns
+static struct {
+    _Atomic uint32_t seq;
+    _Atomic int64_t  ref_ns;
+    _Atomic int64_t  off_ns;
+    _Atomic int64_t  end_ns;
+} g_carry;
+
+// Calibration state, owned by whoever holds g_calib_lock
+static pthread_mutex_t g_calib_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t g_last_tsc;          // Last calibration pair
+static int64_t  g_last_raw_ns;
+static double   g_ns_per_tick;       // Smoothed frequency estimate
+static uint64_t g_freq_samples;
+static swclock_rawsrc_stats_t g_stats;
+
+static int64_t clock_raw_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ts_to_ns(&ts);
+}
+
+#if SWCLOCK_HAVE_TSC
+
+static inline uint64_t read_tsc(void) {
+    unsigned int aux;
+    return __rdtscp(&aux);
+}
+
+// Read TSC and MONOTONIC_RAW as close together as possible: keep the
+// tightest of a few rdtscp brackets and use its midpoint.
+static void read_pair(uint64_t* tsc, int64_t* raw_ns) {
+    uint64_t best = UINT64_MAX, best_tsc = 0;
+    int64_t  best_ns = 0;
+    for (int i = 0; i < 5; i++) {
+        uint64_t t0 = read_tsc();
+        int64_t  ns = clock_raw_ns();
+        uint64_t t1 = read_tsc();
+        if (i == 0 || t1 - t0 < best) {
+            best     = t1 - t0;
+            best_tsc = t0 + (t1 - t0) / 2;
+            best_ns  = ns;
+        }
+    }
+    *tsc    = best_tsc;
+    *raw_ns = best_ns;
+}
+
+// Anchor the TSC timeline at (tsc_ref, ns_ref): scaled by mult for the next
+// slew_ticks, by base_mult after that
+static void publish_conv(uint64_t tsc_ref, int64_t ns_ref, uint64_t base_mult,
+                         uint64_t mult, uint64_t slew_ticks) {
+    int64_t slew_ns = (int64_t)mul_u64_shr(slew_ticks, mult, SWCLOCK_RATE_SHIFT);
+
+    uint32_t seq = atomic_load_explicit(&g_conv.seq, memory_order_relaxed);
+    atomic_store_explicit(&g_conv.seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&g_conv.tsc_ref, tsc_ref, memory_order_relaxed);
+    atomic_store_explicit(&g_conv.ns_ref, ns_ref, memory_order_relaxed);
+    atomic_store_explicit(&g_conv.mult, mult, memory_order_relaxed);
+    atomic_store_explicit(&g_conv.slew_ticks, slew_ticks, memory_order_relaxed);
+    atomic_store_explicit(&g_conv.slew_ns, slew_ns, memory_order_relaxed);
+    atomic_store_explicit(&g_conv.base_mult, base_mult, memory_order_relaxed);
+
+    atomic_store_explicit(&g_conv.seq, seq + 2, memory_order_release);
+}
+
+static int64_t tsc_to_ns(uint64_t tsc) {
+    uint64_t tsc_ref, mult, slew_ticks, base_mult;
+    int64_t ns_ref, slew_ns;
+    uint32_t seq1, seq2;
+
+    for (;;) {
+        seq1 = atomic_load_explicit(&g_conv.seq, memory_order_acquire);
+        if (seq1 & 1u) {
+            swclock_timebase_cpu_relax();
+            continue;
+        }
+        tsc_ref = atomic_load_explicit(&g_conv.tsc_ref, memory_order_relaxed);
+        ns_ref  = atomic_load_explicit(&g_conv.ns_ref, memory_order_relaxed);
+        mult    = atomic_load_explicit(&g_conv.mult, memory_order_relaxed);
+        slew_ticks = atomic_load_explicit(&g_conv.slew_ticks, memory_order_relaxed);
+        slew_ns    = atomic_load_explicit(&g_conv.slew_ns, memory_order_relaxed);
+        base_mult  = atomic_load_explicit(&g_conv.base_mult, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        seq2 = atomic_load_explicit(&g_conv.seq, memory_order_relaxed);
+        if (seq1 == seq2) break;
+    }
+
+    // A TSC read that raced ahead of a recalibration maps to ns_ref
+    uint64_t delta = (tsc > tsc_ref) ? tsc - tsc_ref : 0;
+    if (delta <= slew_ticks) {
+        return ns_ref + (int64_t)mul_u64_shr(delta, mult, SWCLOCK_RATE_SHIFT);
+    }
+    return ns_ref + slew_ns + (int64_t)mul_u64_shr(delta - slew_ticks, base_mult, SWCLOCK_RATE_SHIFT);
+}
+
+static void publish_carry(int64_t ref_ns, int64_t off_ns) {
+    // Same rate bounds as the calibration slew
+    double max_ppm = (llabs(off_ns) > SWCLOCK_TSC_RESYNC_NS) ? SWCLOCK_TSC_RESYNC_SLEW_PPM
+                                                             : SWCLOCK_TSC_MAX_SLEW_PPM;
+    int64_t end_ns = ref_ns + (int64_t)((double)llabs(off_ns) * 1e6 / max_ppm);
+
+    uint32_t seq = atomic_load_explicit(&g_carry.seq, memory_order_relaxed);
+    atomic_store_explicit(&g_carry.seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&g_carry.ref_ns, ref_ns, memory_order_relaxed);
+    atomic_store_explicit(&g_carry.off_ns, off_ns, memory_order_relaxed);
+    atomic_store_explicit(&g_carry.end_ns, end_ns, memory_order_relaxed);
+
+    atomic_store_explicit(&g_carry.seq, seq + 2, memory_order_release);
+}
+
+// Part of the carried offset left at raw_ns
+static int64_t carry_ns(int64_t raw_ns) {
+    int64_t ref_ns, off_ns, end_ns;
+    uint32_t seq1, seq2;
+
+    for (;;) {
+        seq1 = atomic_load_explicit(&g_carry.seq, memory_order_acquire);
+        if (seq1 & 1u) {
+            swclock_timebase_cpu_relax();
+            continue;
+        }
+        ref_ns = atomic_load_explicit(&g_carry.ref_ns, memory_order_relaxed);
+        off_ns = atomic_load_explicit(&g_carry.off_ns, memory_order_relaxed);
+        end_ns = atomic_load_explicit(&g_carry.end_ns, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        seq2 = atomic_load_explicit(&g_carry.seq, memory_order_relaxed);
+        if (seq1 == seq2) break;
+    }
+
+    if (raw_ns >= end_ns) return 0;
+    if (raw_ns <= ref_ns) return off_ns;
+    return (int64_t)((double)off_ns * (double)(end_ns - raw_ns) / (double)(end_ns - ref_ns));
+}
+
+#endif /* SWCLOCK_HAVE_TSC */
+
+bool swclock_rawsrc_tsc_available(void) {
+#if SWCLOCK_HAVE_TSC
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+        return false;
+    }
+    // rdtscp: CPUID.80000001H:EDX[27]
+    if (!__get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 27))) {
+        return false;
+    }
+    // Invariant TSC: CPUID.80000007H:EDX[8]
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) {
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+int swclock_rawsrc_select(swclock_rawsrc_t src) {
+    if (src == SWCLOCK_RAWSRC_CLOCK_GETTIME) {
+        pthread_mutex_lock(&g_calib_lock);
+#if SWCLOCK_HAVE_TSC
+        if (atomic_load_explicit(&g_source, memory_order_relaxed) == SWCLOCK_RAWSRC_TSC) {
+            // Clocks extrapolate from raw references on the TSC timeline:
+            // continue from it and slew the difference out
+            uint64_t tsc;
+            int64_t  raw_ns;
+            read_pair(&tsc, &raw_ns);
+            publish_carry(raw_ns, tsc_to_ns(tsc) - raw_ns);
+        }
+#endif
+        atomic_store_explicit(&g_source, SWCLOCK_RAWSRC_CLOCK_GETTIME, memory_order_release);
+        g_stats.source = SWCLOCK_RAWSRC_CLOCK_GETTIME;
+        pthread_mutex_unlock(&g_calib_lock);
+        return 0;
+    }
+
+    if (src != SWCLOCK_RAWSRC_TSC) {
+        errno = EINVAL;
+        return -1;
+    }
+
+#if SWCLOCK_HAVE_TSC
+    if (!swclock_rawsrc_tsc_available()) {
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_calib_lock);
+    if (atomic_load_explicit(&g_source, memory_order_relaxed) == SWCLOCK_RAWSRC_TSC) {
+        pthread_mutex_unlock(&g_calib_lock);
+        return 0;
+    }
+
+    // Initial frequency estimate over a short window
+    uint64_t tsc0, tsc1;
+    int64_t  raw0, raw1;
+    read_pair(&tsc0, &raw0);
+    sleep_ns(SWCLOCK_TSC_CALIB_INITIAL_NS);
+    read_pair(&tsc1, &raw1);
+
+    if (tsc1 <= tsc0 || raw1 <= raw0) {
+        pthread_mutex_unlock(&g_calib_lock);
+        errno = ENOTSUP;
+        return -1;
+    }
+
+    g_ns_per_tick  = (double)(raw1 - raw0) / (double)(tsc1 - tsc0);
+    g_freq_samples = 0;
+    g_last_tsc     = tsc1;
+    g_last_raw_ns  = raw1;
+    // Start where the clock_gettime source is, carried offset included;
+    // calibration slews out what is left of it
+    uint64_t mult = factor_to_mult(g_ns_per_tick, SWCLOCK_RATE_SHIFT);
+    publish_conv(tsc1, raw1 + carry_ns(raw1), mult, mult, 0);
+
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_stats.source = SWCLOCK_RAWSRC_TSC;
+    g_stats.tsc_hz = 1e9 / g_ns_per_tick;
+
+    atomic_store_explicit(&g_source, SWCLOCK_RAWSRC_TSC, memory_order_release);
+    pthread_mutex_unlock(&g_calib_lock);
+    return 0;
+#else
+    errno = ENOTSUP;
+    return -1;
+#endif
+}
+
+swclock_rawsrc_t swclock_rawsrc_active(void) {
+    return (swclock_rawsrc_t)atomic_load_explicit(&g_source, memory_order_relaxed);
+}
+
+int64_t swclock_rawsrc_now_ns(void) {
+#if SWCLOCK_HAVE_TSC
+    if (atomic_load_explicit(&g_source, memory_order_acquire) == SWCLOCK_RAWSRC_TSC) {
+        return tsc_to_ns(read_tsc());
+    }
+    int64_t raw_ns = clock_raw_ns();
+    if (raw_ns < atomic_load_explicit(&g_carry.end_ns, memory_order_relaxed)) {
+        return raw_ns + carry_ns(raw_ns);
+    }
+    return raw_ns;
+#else
+    return clock_raw_ns();
+#endif
+}
+
+void swclock_rawsrc_calibrate(void) {
+#if SWCLOCK_HAVE_TSC
+    if (atomic_load_explicit(&g_source, memory_order_relaxed) != SWCLOCK_RAWSRC_TSC) {
+        return;
+    }
+    if (pthread_mutex_trylock(&g_calib_lock) != 0) {
+        return;  // Another SwClock's poll thread is calibrating
+    }
+    if (atomic_load_explicit(&g_source, memory_order_relaxed) != SWCLOCK_RAWSRC_TSC) {
+        pthread_mutex_unlock(&g_calib_lock);
+        return;
+    }
+
+    uint64_t tsc;
+    int64_t  raw_ns;
+    read_pair(&tsc, &raw_ns);
+
+    int64_t interval_ns = raw_ns - g_last_raw_ns;
+    if (interval_ns < SWCLOCK_TSC_CALIB_INTERVAL_NS || tsc <= g_last_tsc) {
+        pthread_mutex_unlock(&g_calib_lock);
+        return;
+    }
+
+    // Drift re-estimation: running mean over the first intervals, then EWMA (1/8)
+    double measured = (double)interval_ns / (double)(tsc - g_last_tsc);
+    double alpha = (g_freq_samples < 8) ? 1.0 / (double)(g_freq_samples + 1) : 1.0 / 8.0;
+    g_ns_per_tick += alpha * (measured - g_ns_per_tick);
+    g_freq_samples++;
+
+    g_last_tsc    = tsc;
+    g_last_raw_ns = raw_ns;
+
+    // Where the TSC timeline is now vs. MONOTONIC_RAW
+    int64_t est_ns = tsc_to_ns(tsc);
+    int64_t err_ns = est_ns - raw_ns;
+
+    g_stats.last_error_ns = err_ns;
+    if (llabs(err_ns) > g_stats.max_abs_error_ns) g_stats.max_abs_error_ns = llabs(err_ns);
+
+    uint64_t mult = factor_to_mult(g_ns_per_tick, SWCLOCK_RATE_SHIFT);
+    if (err_ns < -SWCLOCK_TSC_RESYNC_NS) {
+        // Far behind (e.g. the TSC stopped in suspend): re-anchor to
+        // MONOTONIC_RAW, which only ever steps the timeline forward
+        publish_conv(tsc, raw_ns, mult, mult, 0);
+        g_stats.resyncs++;
+    } else if (err_ns != 0) {
+        // Continue from the current TSC time and slew the error out so
+        // readers never see a step. The slew aims at one calibration
+        // interval but is bounded in rate, and it ends once the error is
+        // gone rather than at the next calibration, which the poll thread
+        // may run much later. Far ahead is slewed out at a higher rate.
+        double max_ppm = (err_ns > SWCLOCK_TSC_RESYNC_NS) ? SWCLOCK_TSC_RESYNC_SLEW_PPM
+                                                          : SWCLOCK_TSC_MAX_SLEW_PPM;
+        double corr = (double)err_ns / (double)SWCLOCK_TSC_CALIB_INTERVAL_NS;
+        if (corr > max_ppm / 1e6)  corr = max_ppm / 1e6;
+        if (corr < -max_ppm / 1e6) corr = -max_ppm / 1e6;
+        double slew_ns = (double)err_ns / corr;
+        publish_conv(tsc, est_ns, mult,
+                     factor_to_mult(g_ns_per_tick * (1.0 - corr), SWCLOCK_RATE_SHIFT),
+                     (uint64_t)(slew_ns / g_ns_per_tick));
+    } else {
+        publish_conv(tsc, est_ns, mult, mult, 0);
+    }
+
+    g_stats.tsc_hz = 1e9 / g_ns_per_tick;
+    g_stats.calibrations++;
+    pthread_mutex_unlock(&g_calib_lock);
+#endif
+}
+
+int swclock_rawsrc_get_stats(swclock_rawsrc_stats_t* stats) {
+    if (!stats) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_calib_lock);
+    *stats = g_stats;
+    stats->source = swclock_rawsrc_active();
+    pthread_mutex_unlock(&g_calib_lock);
+    return 0;
+}
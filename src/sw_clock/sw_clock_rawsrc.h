@@ -0,0 +1,119 @@
+/**
+ * @file sw_clock_rawsrc.h
+ * @brief Pluggable raw (undisciplined) time source under SwClock
+ *
+ * Everything SwClock extrapolates from - swclock_gettime(), the poll
+ * rebase, event and monitor timestamps - reads the raw timeline through
+ * swclock_rawsrc_now_ns(). Two sources exist:
+ *
+ * - SWCLOCK_RAWSRC_CLOCK_GETTIME: clock_gettime(CLOCK_MONOTONIC_RAW)
+ *   (default, always available).
+ * - SWCLOCK_RAWSRC_TSC: x86 invariant TSC read with rdtscp and scaled
+ *   to nanoseconds with a fixed-point multiplier. The multiplier is
+ *   calibrated against CLOCK_MONOTONIC_RAW by the poll thread(s), which
+ *   also re-estimate drift and slew out any accumulated error, so the TSC
+ *   timeline stays continuous, monotonic and within a few hundred ns of
+ *   CLOCK_MONOTONIC_RAW. No system call on the read path.
+ *
+ * The source is process-wide. Select it with swclock_rawsrc_select() or
+ * SWCLOCK_RAW_SOURCE=tsc at swclock_create() time; if the CPU does not
+ * advertise an invariant TSC the selection fails and the default stays
+ * in effect.
+ *
+ * Shared-memory readers (sw_clock_shm.h) in other processes keep using
+ * CLOCK_MONOTONIC_RAW, so they see the calibration error on top of the
+ * owner's time.
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_RAWSRC_H
+#define SWCLOCK_RAWSRC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Raw time source kinds
+ */
+typedef enum {
+    SWCLOCK_RAWSRC_CLOCK_GETTIME = 0,   /**< clock_gettime(CLOCK_MONOTONIC_RAW) */
+    SWCLOCK_RAWSRC_TSC           = 1    /**< Calibrated invariant TSC (x86 only) */
+} swclock_rawsrc_t;
+
+/**
+ * @brief TSC calibration state
+ */
+typedef struct {
+    swclock_rawsrc_t source;        /**< Active source */
+    double   tsc_hz;                /**< Estimated TSC frequency (0 if unused) */
+    int64_t  last_error_ns;         /**< TSC time - MONOTONIC_RAW at last calibration */
+    int64_t  max_abs_error_ns;      /**< Largest |last_error_ns| seen */
+    uint64_t calibrations;          /**< Calibration updates applied */
+    uint64_t resyncs;               /**< Forward re-anchors (TSC behind by more than SWCLOCK_TSC_RESYNC_NS) */
+} swclock_rawsrc_stats_t;
+
+/**
+ * @brief Check whether the calibrated TSC source can be used
+ *
+ * @return true on x86 CPUs with rdtscp and an invariant TSC
+ */
+bool swclock_rawsrc_tsc_available(void);
+
+/**
+ * @brief Select the process-wide raw time source
+ *
+ * Selecting the TSC performs a short (~10 ms) initial calibration.
+ * Safe to call while SwClocks are running; switching does not step time.
+ * Leaving the TSC carries its offset from CLOCK_MONOTONIC_RAW (see
+ * swclock_rawsrc_stats_t::last_error_ns) into the clock_gettime source,
+ * where it is slewed out at the calibration slew rates.
+ *
+ * @param src Source to use
+ * @return 0 on success, -1 on failure (errno = ENOTSUP if the TSC is not
+ *         invariant or not available on this architecture)
+ */
+int swclock_rawsrc_select(swclock_rawsrc_t src);
+
+/**
+ * @brief Currently active raw source
+ */
+swclock_rawsrc_t swclock_rawsrc_active(void);
+
+/**
+ * @brief Read the raw timeline (nanoseconds)
+ *
+ * Lock-free. With the TSC source this is a seqlock copy of the
+ * calibration plus one rdtscp.
+ *
+ * @return Raw time in nanoseconds (CLOCK_MONOTONIC_RAW timeline)
+ */
+int64_t swclock_rawsrc_now_ns(void);
+
+/**
+ * @brief Re-estimate TSC frequency and slew out accumulated error
+ *
+ * Called from the SwClock poll thread. Rate-limited to
+ * SWCLOCK_TSC_CALIB_INTERVAL_NS and a no-op unless the TSC is active;
+ * concurrent callers (several SwClocks) simply skip.
+ */
+void swclock_rawsrc_calibrate(void);
+
+/**
+ * @brief Copy calibration statistics
+ *
+ * @param stats Output
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int swclock_rawsrc_get_stats(swclock_rawsrc_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_RAWSRC_H */
@@ -1,6 +1,6 @@
 /**
  * @file sw_clock_ringbuf.c
- * @brief Lock-free ring buffer implementation
+ * @brief Lock-free MPSC ring buffer implementation
  */
 
 #include "sw_clock_ringbuf.h"
@@ -8,6 +8,12 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <syslog.h>
+#include <time.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 static void swclock_ringbuf_log(int priority, const char *format, ...) {
     char message[256];
@@ -32,76 +38,227 @@ static void swclock_ringbuf_log(int priority, const char *format, ...) {
     fclose(sink);
 }
 
+_Static_assert((SWCLOCK_RINGBUF_SIZE & (SWCLOCK_RINGBUF_SIZE - 1)) == 0 &&
+               SWCLOCK_RINGBUF_SIZE >= 64,
+               "SWCLOCK_RINGBUF_SIZE must be a power of two");
+
+#define RING_MASK ((uint64_t)SWCLOCK_RINGBUF_SIZE - 1)
+
+// Record: 8-byte header followed by the payload, padded to SWCLOCK_RINGBUF_ALIGN.
+// Header word 0 is the commit word: 0 until committed, then the payload size,
+// or RECORD_PAD | length for the filler before a record moved to offset 0.
+// Word 1 holds the reserved size between reserve and commit.
+#define RECORD_HEADER_SIZE SWCLOCK_RINGBUF_ALIGN
+#define RECORD_PAD         0x80000000u
+
+static inline uint64_t record_size(size_t payload) {
+    return (RECORD_HEADER_SIZE + payload + SWCLOCK_RINGBUF_ALIGN - 1) &
+           ~(uint64_t)(SWCLOCK_RINGBUF_ALIGN - 1);
+}
+
+static inline uint32_t* record_header(swclock_ringbuf_t* rb, uint64_t pos) {
+    return (uint32_t*)&rb->buffer[pos & RING_MASK];
+}
+
+// Ring bytes taken by a committed record given its commit word
+static inline uint64_t committed_size(uint32_t commit) {
+    return (commit & RECORD_PAD) ? RECORD_HEADER_SIZE + (commit & ~RECORD_PAD)
+                                 : record_size(commit);
+}
+
+// Zero consumed ring space; a release can span the padded end of the buffer
+static void ring_zero(swclock_ringbuf_t* rb, uint64_t pos, size_t size) {
+    size_t off = (size_t)(pos & RING_MASK);
+    if (off + size <= SWCLOCK_RINGBUF_SIZE) {
+        memset(&rb->buffer[off], 0, size);
+    } else {
+        size_t first_part = SWCLOCK_RINGBUF_SIZE - off;
+        memset(&rb->buffer[off], 0, first_part);
+        memset(&rb->buffer[0], 0, size - first_part);
+    }
+}
+
 void swclock_ringbuf_init(swclock_ringbuf_t* rb) {
     if (!rb) return;
 
+    // Zeroed buffer: every header reads as uncommitted
     memset(rb, 0, sizeof(*rb));
     atomic_init(&rb->write_pos, 0);
+    atomic_init(&rb->cached_read_pos, 0);
     atomic_init(&rb->read_pos, 0);
     atomic_init(&rb->overrun_flag, false);
+    atomic_init(&rb->events_written, 0);
+    atomic_init(&rb->events_read, 0);
+    atomic_init(&rb->overrun_count, 0);
+    atomic_init(&rb->doorbell, 0);
+    atomic_init(&rb->consumer_waiting, 0);
+    atomic_init(&rb->wake_pending, 0);
+#if !defined(__linux__)
+    rb->wait_lock = (pthread_mutex_t)PTHREAD_MUTEX_INITIALIZER;
+    rb->wait_cv = (pthread_cond_t)PTHREAD_COND_INITIALIZER;
+#endif
 }
 
-bool swclock_ringbuf_push(
-    swclock_ringbuf_t* rb,
-    const void* data,
-    size_t size)
-{
-    if (!rb || !data || size == 0 || size > SWCLOCK_RINGBUF_SIZE / 2) {
-        return false;
-    }
+// ---- Doorbell ----
+
+static void doorbell_ring(swclock_ringbuf_t* rb) {
+#if defined(__linux__)
+    atomic_fetch_add_explicit(&rb->doorbell, 1, memory_order_release);
+    syscall(SYS_futex, (uint32_t*)&rb->doorbell, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+    pthread_mutex_lock(&rb->wait_lock);
+    atomic_fetch_add_explicit(&rb->doorbell, 1, memory_order_release);
+    pthread_cond_signal(&rb->wait_cv);
+    pthread_mutex_unlock(&rb->wait_lock);
+#endif
+}
 
-    // Read current positions (atomic)
-    uint64_t write_pos = atomic_load_explicit(&rb->write_pos, memory_order_acquire);
-    uint64_t read_pos = atomic_load_explicit(&rb->read_pos, memory_order_acquire);
+// Sleep while the doorbell still reads `bell`, at most timeout_ns
+static void doorbell_wait(swclock_ringbuf_t* rb, uint32_t bell, int64_t timeout_ns) {
+    struct timespec rel = {
+        .tv_sec  = (time_t)(timeout_ns / 1000000000LL),
+        .tv_nsec = (long)(timeout_ns % 1000000000LL)
+    };
+#if defined(__linux__)
+    // Returns at once if a producer rang after we sampled bell
+    syscall(SYS_futex, (uint32_t*)&rb->doorbell, FUTEX_WAIT_PRIVATE, bell, &rel, NULL, 0);
+#else
+    pthread_mutex_lock(&rb->wait_lock);
+    if (atomic_load_explicit(&rb->doorbell, memory_order_acquire) == bell) {
+#if defined(__APPLE__)
+        pthread_cond_timedwait_relative_np(&rb->wait_cv, &rb->wait_lock, &rel);
+#else
+        struct timespec abs;
+        clock_gettime(CLOCK_REALTIME, &abs);
+        abs.tv_sec += rel.tv_sec;
+        abs.tv_nsec += rel.tv_nsec;
+        if (abs.tv_nsec >= 1000000000L) {
+            abs.tv_sec++;
+            abs.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&rb->wait_cv, &rb->wait_lock, &abs);
+#endif
+    }
+    pthread_mutex_unlock(&rb->wait_lock);
+#endif
+}
 
-    // Calculate available space
-    uint64_t used = write_pos - read_pos;
-    uint64_t available = SWCLOCK_RINGBUF_SIZE - used;
+void* swclock_ringbuf_reserve(swclock_ringbuf_t* rb, size_t size) {
+    if (!rb || size == 0 || size > SWCLOCK_RINGBUF_MAX_RECORD) {
+        return NULL;
+    }
 
-    // Need space for: 4-byte size header + data
-    size_t total_size = sizeof(uint32_t) + size;
+    uint64_t rec = record_size(size);
+    uint64_t write_pos = atomic_load_explicit(&rb->write_pos, memory_order_relaxed);
+    uint64_t pad;
+
+    // Reserve [write_pos, write_pos + pad + rec) against other producers
+    for (;;) {
+        // A record that would cross the end of the buffer starts at offset 0
+        uint64_t off = write_pos & RING_MASK;
+        pad = (off + rec > SWCLOCK_RINGBUF_SIZE) ? SWCLOCK_RINGBUF_SIZE - off : 0;
+        uint64_t need = pad + rec;
+
+        // Acquire pairs with the release of read_pos (directly, or through
+        // the producer that refreshed the cache), so the consumer's zeroing
+        // of the slot happens before we write into it
+        uint64_t read_pos = atomic_load_explicit(&rb->cached_read_pos, memory_order_acquire);
+        if ((int64_t)(write_pos - read_pos) < 0) {
+            // Our write_pos is older than the cached read_pos
+            write_pos = atomic_load_explicit(&rb->write_pos, memory_order_relaxed);
+            continue;
+        }
+        if (write_pos - read_pos + need > SWCLOCK_RINGBUF_SIZE) {
+            read_pos = atomic_load_explicit(&rb->read_pos, memory_order_acquire);
+            atomic_store_explicit(&rb->cached_read_pos, read_pos, memory_order_release);
+            if (write_pos - read_pos + need > SWCLOCK_RINGBUF_SIZE) {
+                // Buffer full - drop the event
+                atomic_store_explicit(&rb->overrun_flag, true, memory_order_release);
+                atomic_fetch_add_explicit(&rb->overrun_count, 1, memory_order_relaxed);
+                return NULL;
+            }
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&rb->write_pos, &write_pos,
+                                                  write_pos + need,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+            break;
+        }
+    }
 
-    if (available < total_size) {
-        // Buffer full - set overrun flag
-        atomic_store_explicit(&rb->overrun_flag, true, memory_order_release);
-        rb->overrun_count++;
-        return false;
+    if (pad) {
+        // Filler up to the end of the buffer, committed at once
+        __atomic_store_n(record_header(rb, write_pos),
+                         RECORD_PAD | (uint32_t)(pad - RECORD_HEADER_SIZE), __ATOMIC_RELEASE);
+        write_pos += pad;
     }
 
-    // Write size header (4 bytes)
-    uint32_t size_header = (uint32_t)size;
-    size_t pos = write_pos % SWCLOCK_RINGBUF_SIZE;
+    uint32_t* hdr = record_header(rb, write_pos);
+    hdr[1] = (uint32_t)size;
+    return (uint8_t*)hdr + RECORD_HEADER_SIZE;
+}
+
+void swclock_ringbuf_commit(swclock_ringbuf_t* rb, void* data) {
+    if (!rb || !data) return;
 
-    // Handle wrap-around for size header
-    if (pos + sizeof(uint32_t) <= SWCLOCK_RINGBUF_SIZE) {
-        memcpy(&rb->buffer[pos], &size_header, sizeof(uint32_t));
-    } else {
-        // Wrap around
-        size_t first_part = SWCLOCK_RINGBUF_SIZE - pos;
-        memcpy(&rb->buffer[pos], &size_header, first_part);
-        memcpy(&rb->buffer[0], ((uint8_t*)&size_header) + first_part,
-               sizeof(uint32_t) - first_part);
-    }
+    uint32_t* hdr = (uint32_t*)((uint8_t*)data - RECORD_HEADER_SIZE);
 
-    pos = (write_pos + sizeof(uint32_t)) % SWCLOCK_RINGBUF_SIZE;
+    // Publish the size header. Sequentially consistent with the
+    // consumer_waiting load below: either we see the consumer going to
+    // sleep, or it sees this record before sleeping.
+    __atomic_store_n(&hdr[0], hdr[1], __ATOMIC_SEQ_CST);
+    atomic_fetch_add_explicit(&rb->events_written, 1, memory_order_relaxed);
 
-    // Write data with wrap-around handling
-    if (pos + size <= SWCLOCK_RINGBUF_SIZE) {
-        memcpy(&rb->buffer[pos], data, size);
-    } else {
-        // Wrap around
-        size_t first_part = SWCLOCK_RINGBUF_SIZE - pos;
-        memcpy(&rb->buffer[pos], data, first_part);
-        memcpy(&rb->buffer[0], ((uint8_t*)data) + first_part, size - first_part);
+    // Ring only if the consumer is asleep on an empty ring; exactly one of
+    // the producers racing here does
+    if (atomic_load_explicit(&rb->consumer_waiting, memory_order_seq_cst) &&
+        atomic_exchange_explicit(&rb->consumer_waiting, 0, memory_order_acq_rel)) {
+        doorbell_ring(rb);
     }
+}
+
+bool swclock_ringbuf_push(
+    swclock_ringbuf_t* rb,
+    const void* data,
+    size_t size)
+{
+    if (!data) return false;
 
-    // Update write position (atomic)
-    atomic_store_explicit(&rb->write_pos, write_pos + total_size, memory_order_release);
-    rb->events_written++;
+    void* slot = swclock_ringbuf_reserve(rb, size);
+    if (!slot) return false;
 
+    memcpy(slot, data, size);
+    swclock_ringbuf_commit(rb, slot);
     return true;
 }
 
+size_t swclock_ringbuf_peek(
+    swclock_ringbuf_t* rb,
+    const void** data,
+    size_t* size)
+{
+    if (!rb) return 0;
+
+    uint64_t read_pos = atomic_load_explicit(&rb->read_pos, memory_order_relaxed);
+    for (;;) {
+        // Zero header: empty, or reserved and producer still copying
+        uint32_t commit = __atomic_load_n(record_header(rb, read_pos), __ATOMIC_ACQUIRE);
+        if (commit == 0) return 0;
+
+        if (commit & RECORD_PAD) {
+            // Consume filler right away
+            swclock_ringbuf_release(rb, (size_t)committed_size(commit), 0);
+            read_pos += committed_size(commit);
+            continue;
+        }
+
+        if (data) *data = (const uint8_t*)record_header(rb, read_pos) + RECORD_HEADER_SIZE;
+        if (size) *size = commit;
+        return (size_t)record_size(commit);
+    }
+}
+
 bool swclock_ringbuf_pop(
     swclock_ringbuf_t* rb,
     void* data,
@@ -112,63 +269,106 @@ bool swclock_ringbuf_pop(
         return false;
     }
 
-    // Read current positions (atomic)
-    uint64_t write_pos = atomic_load_explicit(&rb->write_pos, memory_order_acquire);
-    uint64_t read_pos = atomic_load_explicit(&rb->read_pos, memory_order_acquire);
-
-    // Check if empty
-    if (write_pos == read_pos) {
+    const void* rec;
+    size_t size;
+    size_t ring_bytes = swclock_ringbuf_peek(rb, &rec, &size);
+    if (ring_bytes == 0) {
         return false;
     }
 
-    // Read size header (4 bytes)
-    uint32_t size_header;
-    size_t pos = read_pos % SWCLOCK_RINGBUF_SIZE;
-
-    // Handle wrap-around for size header
-    if (pos + sizeof(uint32_t) <= SWCLOCK_RINGBUF_SIZE) {
-        memcpy(&size_header, &rb->buffer[pos], sizeof(uint32_t));
-    } else {
-        // Wrap around
-        size_t first_part = SWCLOCK_RINGBUF_SIZE - pos;
-        memcpy(&size_header, &rb->buffer[pos], first_part);
-        memcpy(((uint8_t*)&size_header) + first_part, &rb->buffer[0],
-               sizeof(uint32_t) - first_part);
-    }
-
     // Validate size
-    if (size_header == 0 || size_header > max_size) {
+    if (size > max_size) {
         // Corrupted data or buffer too small
         swclock_ringbuf_log(LOG_WARNING,
-                    "Invalid size %u (max %zu)",
-                    size_header, max_size);
+                    "Invalid size %zu (max %zu)",
+                    size, max_size);
         return false;
     }
 
+    memcpy(data, rec, size);
     if (actual_size) {
-        *actual_size = size_header;
+        *actual_size = size;
     }
 
-    pos = (read_pos + sizeof(uint32_t)) % SWCLOCK_RINGBUF_SIZE;
+    swclock_ringbuf_release(rb, ring_bytes, 1);
+    return true;
+}
 
-    // Read data with wrap-around handling
-    if (pos + size_header <= SWCLOCK_RINGBUF_SIZE) {
-        memcpy(data, &rb->buffer[pos], size_header);
-    } else {
-        // Wrap around
-        size_t first_part = SWCLOCK_RINGBUF_SIZE - pos;
-        memcpy(data, &rb->buffer[pos], first_part);
-        memcpy(((uint8_t*)data) + first_part, &rb->buffer[0],
-               size_header - first_part);
+size_t swclock_ringbuf_peek_batch(
+    swclock_ringbuf_t* rb,
+    struct iovec* iov,
+    size_t max_iov,
+    size_t* iov_count,
+    size_t* records)
+{
+    size_t n = 0;
+    uint64_t pos = 0, start = 0;
+
+    if (rb && iov) {
+        start = atomic_load_explicit(&rb->read_pos, memory_order_relaxed);
+        pos = start;
+        // A full ring holds exactly SWCLOCK_RINGBUF_SIZE bytes of committed
+        // records; stop there instead of lapping back onto the first one
+        while (n < max_iov && pos - start < SWCLOCK_RINGBUF_SIZE) {
+            uint32_t commit = __atomic_load_n(record_header(rb, pos), __ATOMIC_ACQUIRE);
+            if (commit == 0) break;  // Empty, or producer still copying
+
+            if (!(commit & RECORD_PAD)) {
+                iov[n].iov_base = (uint8_t*)record_header(rb, pos) + RECORD_HEADER_SIZE;
+                iov[n].iov_len  = commit;
+                n++;
+            }
+            pos += committed_size(commit);
+        }
     }
 
-    // Update read position (atomic)
-    atomic_store_explicit(&rb->read_pos,
-                         read_pos + sizeof(uint32_t) + size_header,
-                         memory_order_release);
-    rb->events_read++;
+    if (iov_count) *iov_count = n;
+    if (records) *records = n;
+    return (size_t)(pos - start);
+}
 
-    return true;
+void swclock_ringbuf_release(
+    swclock_ringbuf_t* rb,
+    size_t ring_bytes,
+    size_t records)
+{
+    if (!rb || ring_bytes == 0) return;
+
+    // Hand the space back zeroed, so the next producer to reserve it starts
+    // from an uncommitted header
+    uint64_t read_pos = atomic_load_explicit(&rb->read_pos, memory_order_relaxed);
+    ring_zero(rb, read_pos, ring_bytes);
+    atomic_store_explicit(&rb->read_pos, read_pos + ring_bytes, memory_order_release);
+    atomic_fetch_add_explicit(&rb->events_read, records, memory_order_relaxed);
+}
+
+bool swclock_ringbuf_wait(swclock_ringbuf_t* rb, int64_t timeout_ns) {
+    if (!rb) return false;
+
+    // Sample the doorbell before announcing ourselves: a ring after this
+    // point makes the sleep below return immediately
+    uint32_t bell = atomic_load_explicit(&rb->doorbell, memory_order_acquire);
+    atomic_store_explicit(&rb->consumer_waiting, 1, memory_order_seq_cst);
+
+    bool ready = atomic_exchange_explicit(&rb->wake_pending, 0, memory_order_acq_rel) != 0;
+    if (!ready) {
+        uint64_t read_pos = atomic_load_explicit(&rb->read_pos, memory_order_relaxed);
+        ready = __atomic_load_n(record_header(rb, read_pos), __ATOMIC_SEQ_CST) != 0;
+    }
+
+    if (!ready && timeout_ns > 0) {
+        doorbell_wait(rb, bell, timeout_ns);
+    }
+
+    atomic_store_explicit(&rb->consumer_waiting, 0, memory_order_relaxed);
+    return ready || atomic_load_explicit(&rb->doorbell, memory_order_acquire) != bell;
+}
+
+void swclock_ringbuf_wake(swclock_ringbuf_t* rb) {
+    if (!rb) return;
+
+    atomic_store_explicit(&rb->wake_pending, 1, memory_order_seq_cst);
+    doorbell_ring(rb);
 }
 
 bool swclock_ringbuf_is_empty(const swclock_ringbuf_t* rb) {
@@ -213,7 +413,13 @@ void swclock_ringbuf_stats(
 {
     if (!rb) return;
 
-    if (events_written) *events_written = rb->events_written;
-    if (events_read) *events_read = rb->events_read;
-    if (overrun_count) *overrun_count = rb->overrun_count;
+    if (events_written) {
+        *events_written = atomic_load_explicit(&rb->events_written, memory_order_relaxed);
+    }
+    if (events_read) {
+        *events_read = atomic_load_explicit(&rb->events_read, memory_order_relaxed);
+    }
+    if (overrun_count) {
+        *overrun_count = atomic_load_explicit(&rb->overrun_count, memory_order_relaxed);
+    }
 }
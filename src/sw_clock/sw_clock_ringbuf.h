@@ -2,14 +2,34 @@
  * @file sw_clock_ringbuf.h
  * @brief Lock-free ring buffer for event logging
  * 
- * Single-producer, single-consumer (SPSC) lock-free ring buffer
- * optimized for low-latency event logging from servo thread.
+ * Multi-producer, single-consumer (MPSC) lock-free ring buffer
+ * optimized for low-latency event logging. Events come from the poll
+ * thread (servo updates) and from any application thread calling
+ * swclock_adjtime() and friends.
  * 
  * Design:
- * - Producer (servo thread): Pushes events without blocking
- * - Consumer (logger thread): Pops events and writes to disk
- * - No locks in hot path (atomic operations only)
- * - Overrun detection with flag
+ * - Producers reserve a record with a CAS on write_pos, serialize into it
+ *   in place (swclock_ringbuf_reserve()), then commit it by publishing the
+ *   record's size header (swclock_ringbuf_commit()). Producers never block
+ *   each other beyond a failed CAS retry.
+ * - Records are contiguous in memory: one that would cross the end of the
+ *   buffer is preceded by a padding record and placed at offset 0. The
+ *   size is a power of two, so positions wrap with a mask.
+ * - Consumer (logger thread) reads records in place in reservation order
+ *   (swclock_ringbuf_peek(), swclock_ringbuf_peek_batch()) and hands the
+ *   space back with swclock_ringbuf_release(). A zero size header means
+ *   the next record is reserved but not yet committed.
+ * - The consumer zeroes every record it consumes, so a freshly reserved
+ *   slot always reads as uncommitted.
+ * - Producer and consumer indices sit on separate cache lines. Producers
+ *   check space against a shared cached copy of read_pos and only load the
+ *   consumer's line when that copy says the ring is full.
+ * - Counters are atomic; a full buffer drops the event and counts it.
+ * - An idle consumer blocks in swclock_ringbuf_wait() instead of polling.
+ *   It announces itself before sleeping; only a producer that commits while
+ *   the consumer sleeps (the empty -> non-empty transition) rings the
+ *   doorbell (futex on Linux, condition variable elsewhere). Otherwise the
+ *   commit path stays a plain store and a flag load.
  * 
  * Part of Priority 1 implementation (Recommendation 2).
  * 
@@ -24,13 +44,18 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdatomic.h>
+#include <sys/uio.h>
+#include "sw_clock_constants.h"
+#if !defined(__linux__)
+#include <pthread.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * @brief Ring buffer size (1 MB default)
+ * @brief Ring buffer size (1 MB default, must be a power of two)
  * 
  * At ~80 bytes per event, this holds ~12,800 events.
  * At 100 Hz servo rate, this provides ~128 seconds of buffering.
@@ -39,20 +64,53 @@ extern "C" {
 #define SWCLOCK_RINGBUF_SIZE (1024 * 1024)
 #endif
 
+/**
+ * @brief Record alignment; each record starts with an 8-byte header
+ *
+ * Reserved payloads are 8-byte aligned, so events can be built in place.
+ */
+#define SWCLOCK_RINGBUF_ALIGN 8
+
+/**
+ * @brief Largest payload of one record
+ */
+#define SWCLOCK_RINGBUF_MAX_RECORD (SWCLOCK_RINGBUF_SIZE / 2)
+
 /**
  * @brief Lock-free ring buffer structure
  * 
- * IMPORTANT: Producer writes to write_pos, consumer reads from read_pos.
- * These must be accessed atomically to ensure thread safety.
+ * IMPORTANT: Producers reserve at write_pos, the consumer reads from
+ * read_pos. These must be accessed atomically to ensure thread safety.
+ * The structure must be at least SWCLOCK_RINGBUF_ALIGN aligned (malloc'd).
+ * The pad members keep each group of fields off its neighbours' cache
+ * lines whatever the allocation's alignment.
  */
 typedef struct {
     uint8_t buffer[SWCLOCK_RINGBUF_SIZE]; /**< Circular buffer data */
-    _Atomic uint64_t write_pos;           /**< Producer write position */
-    _Atomic uint64_t read_pos;            /**< Consumer read position */
+    uint8_t pad_producer[SWCLOCK_CACHELINE];
+
+    // Producer side: written by every producer
+    _Atomic uint64_t write_pos;           /**< Reservation position (shared by producers) */
+    _Atomic uint64_t cached_read_pos;     /**< read_pos as last seen by a producer */
+    _Atomic uint64_t events_written;      /**< Total events committed */
+    _Atomic uint64_t overrun_count;       /**< Events dropped on buffer full */
     _Atomic bool overrun_flag;            /**< Set on buffer full */
-    uint64_t events_written;              /**< Total events written */
-    uint64_t events_read;                 /**< Total events read */
-    uint64_t overrun_count;               /**< Number of overruns */
+    uint8_t pad_consumer[SWCLOCK_CACHELINE];
+
+    // Consumer side: written by the consumer only
+    _Atomic uint64_t read_pos;            /**< Consumer read position */
+    _Atomic uint64_t events_read;         /**< Total events read */
+    uint8_t pad_doorbell[SWCLOCK_CACHELINE];
+
+    // Doorbell: read by producers on commit, written when the consumer sleeps
+    _Atomic uint32_t doorbell;            /**< Bumped to wake the consumer (futex word) */
+    _Atomic uint32_t consumer_waiting;    /**< Consumer found nothing and is going to sleep */
+    _Atomic uint32_t wake_pending;        /**< swclock_ringbuf_wake() not yet seen by the consumer */
+#if !defined(__linux__)
+    pthread_mutex_t wait_lock;            /**< Doorbell fallback without futex */
+    pthread_cond_t wait_cv;
+#endif
+    uint8_t pad_end[SWCLOCK_CACHELINE];
 } swclock_ringbuf_t;
 
 /**
@@ -62,13 +120,39 @@ typedef struct {
  */
 void swclock_ringbuf_init(swclock_ringbuf_t* rb);
 
+/**
+ * @brief Reserve a contiguous record for in-place serialization (producer side)
+ * 
+ * Non-blocking operation. The returned memory belongs to the caller until
+ * swclock_ringbuf_commit(); the consumer stops at it until then, so commit
+ * promptly. If buffer is full, sets overrun flag and returns NULL.
+ * 
+ * Thread safety: Safe to call from any number of producer threads
+ * concurrently with the consumer.
+ * 
+ * @param rb Ring buffer
+ * @param size Payload size in bytes (1 .. SWCLOCK_RINGBUF_MAX_RECORD)
+ * @return 8-byte aligned payload memory, or NULL if buffer full
+ */
+void* swclock_ringbuf_reserve(swclock_ringbuf_t* rb, size_t size);
+
+/**
+ * @brief Publish a record obtained from swclock_ringbuf_reserve()
+ * 
+ * @param rb Ring buffer
+ * @param data Pointer returned by swclock_ringbuf_reserve()
+ */
+void swclock_ringbuf_commit(swclock_ringbuf_t* rb, void* data);
+
 /**
  * @brief Push data to ring buffer (producer side)
  * 
+ * Copying wrapper around swclock_ringbuf_reserve()/swclock_ringbuf_commit().
  * Non-blocking operation. If buffer is full, sets overrun flag
  * and returns false.
  * 
- * Thread safety: Safe to call from single producer thread.
+ * Thread safety: Safe to call from any number of producer threads
+ * concurrently with the consumer.
  * 
  * @param rb Ring buffer
  * @param data Data to write
@@ -84,7 +168,9 @@ bool swclock_ringbuf_push(
 /**
  * @brief Pop data from ring buffer (consumer side)
  * 
- * Non-blocking operation. If no data available, returns false.
+ * Copying wrapper around swclock_ringbuf_peek()/swclock_ringbuf_release().
+ * Non-blocking operation. If no data available, or the oldest record
+ * is still being written by its producer, returns false.
  * 
  * Thread safety: Safe to call from single consumer thread.
  * 
@@ -101,9 +187,97 @@ bool swclock_ringbuf_pop(
     size_t* actual_size
 );
 
+/**
+ * @brief Map the oldest committed record in place (consumer side)
+ * 
+ * Nothing is consumed until swclock_ringbuf_release(); the record stays
+ * valid until then.
+ * 
+ * Thread safety: Safe to call from single consumer thread.
+ * 
+ * @param rb Ring buffer
+ * @param data Output: record payload
+ * @param size Output: payload size in bytes
+ * @return Ring bytes to pass to swclock_ringbuf_release() (0 if no
+ *         committed record)
+ */
+size_t swclock_ringbuf_peek(
+    swclock_ringbuf_t* rb,
+    const void** data,
+    size_t* size
+);
+
+/**
+ * @brief Map committed records for a batched read (consumer side)
+ * 
+ * Fills iov with the payloads of consecutive committed records starting at
+ * the read position, one entry per record, pointing straight into ring
+ * memory. Stops at the first uncommitted record or when iov is full.
+ * Nothing is consumed until swclock_ringbuf_release(); the mapped memory
+ * stays valid until then.
+ * 
+ * Thread safety: Safe to call from single consumer thread.
+ * 
+ * @param rb Ring buffer
+ * @param iov Output payload spans, suitable for writev()
+ * @param max_iov Capacity of iov
+ * @param iov_count Output: iov entries filled (= records mapped)
+ * @param records Output: number of records mapped
+ * @return Ring bytes covered by the mapped records (0 if none); pass to
+ *         swclock_ringbuf_release()
+ */
+size_t swclock_ringbuf_peek_batch(
+    swclock_ringbuf_t* rb,
+    struct iovec* iov,
+    size_t max_iov,
+    size_t* iov_count,
+    size_t* records
+);
+
+/**
+ * @brief Consume records mapped by swclock_ringbuf_peek() or
+ *        swclock_ringbuf_peek_batch()
+ * 
+ * @param rb Ring buffer
+ * @param ring_bytes Value returned by the peek call
+ * @param records Number of records mapped by the peek call
+ */
+void swclock_ringbuf_release(
+    swclock_ringbuf_t* rb,
+    size_t ring_bytes,
+    size_t records
+);
+
+/**
+ * @brief Block until a producer commits or the timeout expires (consumer side)
+ * 
+ * Returns at once if the oldest record is already committed. Spurious
+ * returns are possible; the caller drains and waits again.
+ * 
+ * Thread safety: Safe to call from single consumer thread.
+ * 
+ * @param rb Ring buffer
+ * @param timeout_ns Longest time to sleep (ns)
+ * @return true if woken by a producer or swclock_ringbuf_wake(), false on timeout
+ */
+bool swclock_ringbuf_wait(swclock_ringbuf_t* rb, int64_t timeout_ns);
+
+/**
+ * @brief Wake the consumer regardless of ring contents
+ * 
+ * A wake that arrives before the consumer's next swclock_ringbuf_wait() makes
+ * that wait return immediately, so shutdown flags set before calling this
+ * are always seen.
+ * 
+ * @param rb Ring buffer
+ */
+void swclock_ringbuf_wake(swclock_ringbuf_t* rb);
+
 /**
  * @brief Check if ring buffer is empty
  * 
+ * Reserved but uncommitted records count as not empty.
+ * 
  * @param rb Ring buffer
  * @return true if empty
  */
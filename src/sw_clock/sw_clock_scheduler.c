@@ -0,0 +1,343 @@
+/**
+ * @file sw_clock_scheduler.c
+ * @brief Deadline-heap scheduler with a small worker pool
+ */
+
+#include "sw_clock_scheduler.h"
+#include "sw_clock_constants.h"
+#include "sw_clock_utilities.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+struct swclock_sched_task {
+    int64_t          deadline_ns;   // Next run (CLOCK_MONOTONIC)
+    int64_t          period_ns;
+    swclock_sched_fn fn;
+    void*            arg;
+    long             heap_index;    // -1 while running or removed
+    bool             running;
+    bool             removed;
+    bool             kicked;        // Run again as soon as the current run returns
+};
+
+struct swclock_scheduler {
+    pthread_mutex_t lock;
+    pthread_cond_t  work_cv;        // Heap changed / more due work / stopping
+    pthread_cond_t  idle_cv;        // A task finished running
+    swclock_sched_task_t** heap;    // Min-heap on deadline_ns
+    size_t          count;
+    size_t          capacity;
+    bool            timer_armed;    // A worker sleeps on heap[0]'s deadline
+    bool            stopping;
+    unsigned        nthreads;
+    pthread_t*      threads;
+};
+
+static pthread_mutex_t g_shared_lock = PTHREAD_MUTEX_INITIALIZER;
+static swclock_scheduler_t* g_shared;
+static unsigned g_shared_refs;
+
+// ---- Heap (caller holds s->lock) ----
+
+static void heap_set(swclock_scheduler_t* s, size_t i, swclock_sched_task_t* t) {
+    s->heap[i] = t;
+    t->heap_index = (long)i;
+}
+
+static void heap_sift_up(swclock_scheduler_t* s, size_t i) {
+    swclock_sched_task_t* t = s->heap[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (s->heap[parent]->deadline_ns <= t->deadline_ns) break;
+        heap_set(s, i, s->heap[parent]);
+        i = parent;
+    }
+    heap_set(s, i, t);
+}
+
+static void heap_sift_down(swclock_scheduler_t* s, size_t i) {
+    swclock_sched_task_t* t = s->heap[i];
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= s->count) break;
+        if (child + 1 < s->count &&
+            s->heap[child + 1]->deadline_ns < s->heap[child]->deadline_ns) {
+            child++;
+        }
+        if (t->deadline_ns <= s->heap[child]->deadline_ns) break;
+        heap_set(s, i, s->heap[child]);
+        i = child;
+    }
+    heap_set(s, i, t);
+}
+
+static void heap_push(swclock_scheduler_t* s, swclock_sched_task_t* t) {
+    heap_set(s, s->count++, t);
+    heap_sift_up(s, s->count - 1);
+}
+
+static void heap_remove_at(swclock_scheduler_t* s, size_t i) {
+    swclock_sched_task_t* t = s->heap[i];
+    t->heap_index = -1;
+
+    s->count--;
+    if (i == s->count) return;
+
+    swclock_sched_task_t* moved = s->heap[s->count];
+    heap_set(s, i, moved);
+    heap_sift_down(s, i);
+    heap_sift_up(s, (size_t)moved->heap_index);
+}
+
+// Wake workers after t became the earliest deadline, so a worker sleeping
+// on a later deadline re-arms
+static void heap_notify_new_top(swclock_scheduler_t* s, swclock_sched_task_t* t) {
+    if (s->heap[0] == t) {
+        pthread_cond_broadcast(&s->work_cv);
+    }
+}
+
+// ---- Workers ----
+
+static void wait_until(swclock_scheduler_t* s, int64_t deadline_ns) {
+#if defined(__APPLE__)
+    // No pthread_condattr_setclock(): wait relative to now
+    int64_t rel_ns = deadline_ns - monotonic_now_ns();
+    struct timespec rel = ns_to_ts(rel_ns > 0 ? rel_ns : 0);
+    pthread_cond_timedwait_relative_np(&s->work_cv, &s->lock, &rel);
+#else
+    struct timespec abs = ns_to_ts(deadline_ns);
+    pthread_cond_timedwait(&s->work_cv, &s->lock, &abs);
+#endif
+}
+
+static void* sched_worker_main(void* arg) {
+    swclock_scheduler_t* s = (swclock_scheduler_t*)arg;
+
+    pthread_mutex_lock(&s->lock);
+    while (!s->stopping) {
+        if (s->count == 0) {
+            pthread_cond_wait(&s->work_cv, &s->lock);
+            continue;
+        }
+
+        int64_t now = monotonic_now_ns();
+        swclock_sched_task_t* t = s->heap[0];
+
+        if (t->deadline_ns > now + SWCLOCK_SCHED_SLACK_NS) {
+            // One worker sleeps on the earliest deadline, the rest wait for work
+            if (s->timer_armed) {
+                pthread_cond_wait(&s->work_cv, &s->lock);
+            } else {
+                s->timer_armed = true;
+                wait_until(s, t->deadline_ns);
+                s->timer_armed = false;
+            }
+            continue;
+        }
+
+        heap_remove_at(s, 0);
+        t->running = true;
+        int64_t deadline_ns = t->deadline_ns;
+
+        // Hand the remaining tasks to an idle worker: it runs the next one if
+        // it is due, or sleeps on its deadline while this tick runs
+        if (s->count > 0) {
+            pthread_cond_signal(&s->work_cv);
+        }
+
+        pthread_mutex_unlock(&s->lock);
+        int64_t next_period_ns = t->fn(t->arg, deadline_ns);
+        pthread_mutex_lock(&s->lock);
+
+        t->running = false;
+        if (t->removed) {
+            pthread_cond_broadcast(&s->idle_cv);
+            continue;
+        }
+
+        // Advance on the absolute grid; skip periods the tick overran
+        if (next_period_ns <= 0) next_period_ns = t->period_ns;
+        now = monotonic_now_ns();
+        if (t->kicked) {
+            t->kicked = false;
+            t->deadline_ns = now;
+        } else {
+            t->deadline_ns += next_period_ns;
+            if (t->deadline_ns <= now) {
+                t->deadline_ns += ((now - t->deadline_ns) / next_period_ns + 1) * next_period_ns;
+            }
+        }
+        heap_push(s, t);
+        if (s->timer_armed) {
+            heap_notify_new_top(s, t);
+        }
+    }
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+// ---- Public API ----
+
+swclock_scheduler_t* swclock_scheduler_create(unsigned threads) {
+    if (threads == 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    swclock_scheduler_t* s = (swclock_scheduler_t*)calloc(1, sizeof(*s));
+    if (!s) return NULL;
+
+    s->threads = (pthread_t*)calloc(threads, sizeof(pthread_t));
+    if (!s->threads) {
+        free(s);
+        return NULL;
+    }
+
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->idle_cv, NULL);
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#if !defined(__APPLE__)
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+    pthread_cond_init(&s->work_cv, &attr);
+    pthread_condattr_destroy(&attr);
+
+    for (unsigned i = 0; i < threads; i++) {
+        int rc = pthread_create(&s->threads[i], NULL, sched_worker_main, s);
+        if (rc != 0) {
+            s->nthreads = i;
+            swclock_scheduler_destroy(s);
+            errno = rc;
+            return NULL;
+        }
+    }
+    s->nthreads = threads;
+    return s;
+}
+
+void swclock_scheduler_destroy(swclock_scheduler_t* s) {
+    if (!s) return;
+
+    pthread_mutex_lock(&s->lock);
+    s->stopping = true;
+    pthread_cond_broadcast(&s->work_cv);
+    pthread_mutex_unlock(&s->lock);
+
+    for (unsigned i = 0; i < s->nthreads; i++) {
+        pthread_join(s->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&s->work_cv);
+    pthread_cond_destroy(&s->idle_cv);
+    pthread_mutex_destroy(&s->lock);
+    free(s->heap);
+    free(s->threads);
+    free(s);
+}
+
+swclock_sched_task_t* swclock_scheduler_add(swclock_scheduler_t* s, int64_t period_ns,
+                                            swclock_sched_fn fn, void* arg) {
+    if (!s || !fn || period_ns <= 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    swclock_sched_task_t* t = (swclock_sched_task_t*)calloc(1, sizeof(*t));
+    if (!t) return NULL;
+
+    t->period_ns  = period_ns;
+    t->fn         = fn;
+    t->arg        = arg;
+    t->heap_index = -1;
+
+    pthread_mutex_lock(&s->lock);
+
+    if (s->count == s->capacity) {
+        size_t cap = s->capacity ? s->capacity * 2 : 16;
+        swclock_sched_task_t** heap =
+            (swclock_sched_task_t**)realloc(s->heap, cap * sizeof(*heap));
+        if (!heap) {
+            pthread_mutex_unlock(&s->lock);
+            free(t);
+            errno = ENOMEM;
+            return NULL;
+        }
+        s->heap     = heap;
+        s->capacity = cap;
+    }
+
+    t->deadline_ns = monotonic_now_ns() + period_ns;
+    heap_push(s, t);
+    heap_notify_new_top(s, t);
+
+    pthread_mutex_unlock(&s->lock);
+    return t;
+}
+
+void swclock_scheduler_kick(swclock_scheduler_t* s, swclock_sched_task_t* t) {
+    if (!s || !t) return;
+
+    pthread_mutex_lock(&s->lock);
+    if (t->running) {
+        t->kicked = true;
+    } else if (t->heap_index >= 0) {
+        int64_t now = monotonic_now_ns();
+        if (t->deadline_ns > now) {
+            t->deadline_ns = now;
+            heap_sift_up(s, (size_t)t->heap_index);
+            heap_notify_new_top(s, t);
+        }
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+void swclock_scheduler_remove(swclock_scheduler_t* s, swclock_sched_task_t* t) {
+    if (!s || !t) return;
+
+    pthread_mutex_lock(&s->lock);
+    t->removed = true;
+    if (t->heap_index >= 0) {
+        heap_remove_at(s, (size_t)t->heap_index);
+    }
+    while (t->running) {
+        pthread_cond_wait(&s->idle_cv, &s->lock);
+    }
+    pthread_mutex_unlock(&s->lock);
+
+    free(t);
+}
+
+swclock_scheduler_t* swclock_scheduler_shared_acquire(unsigned threads) {
+    pthread_mutex_lock(&g_shared_lock);
+    if (!g_shared) {
+        g_shared = swclock_scheduler_create(threads);
+        if (!g_shared) {
+            pthread_mutex_unlock(&g_shared_lock);
+            return NULL;
+        }
+    }
+    g_shared_refs++;
+    swclock_scheduler_t* s = g_shared;
+    pthread_mutex_unlock(&g_shared_lock);
+    return s;
+}
+
+void swclock_scheduler_shared_release(void) {
+    swclock_scheduler_t* dead = NULL;
+
+    pthread_mutex_lock(&g_shared_lock);
+    if (g_shared_refs > 0 && --g_shared_refs == 0) {
+        dead = g_shared;
+        g_shared = NULL;
+    }
+    pthread_mutex_unlock(&g_shared_lock);
+
+    // Join the workers outside the lock so another clock can start a new pool
+    swclock_scheduler_destroy(dead);
+}
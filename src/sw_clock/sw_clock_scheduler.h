@@ -0,0 +1,111 @@
+/**
+ * @file sw_clock_scheduler.h
+ * @brief Shared periodic scheduler for SwClock poll ticks
+ *
+ * By default every SwClock owns a poll thread that sleeps SWCLOCK_POLL_NS
+ * between ticks. With hundreds of instances (one per PTP domain/port) that
+ * is hundreds of threads and independent wakeups per period. The shared
+ * scheduler replaces them with a small worker pool servicing all
+ * registered clocks from one deadline min-heap:
+ *
+ * - Deadlines are absolute on CLOCK_MONOTONIC and advance by exactly one
+ *   period per tick, so they do not accumulate the tick's own run time.
+ * - A worker that wakes runs every task due within SWCLOCK_SCHED_SLACK_NS
+ *   back to back, so clocks created together share a single wakeup.
+ * - Only one idle worker sleeps on the earliest deadline; the others wait
+ *   for work. A worker that takes a task hands the timer to an idle one,
+ *   so a long tick does not delay the other tasks' deadlines.
+ * - A task never runs on two workers at once; ticks that overrun skip the
+ *   missed periods instead of running late back to back.
+ * - Each run returns its next period, so tasks can poll adaptively, and
+ *   swclock_scheduler_kick() pulls a task's next run forward to now.
+ *
+ * SwClock uses one process-wide instance (swclock_use_shared_scheduler()
+ * or SWCLOCK_SHARED_POLL_THREADS in sw_clock.h).
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_SCHEDULER_H
+#define SWCLOCK_SCHEDULER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct swclock_scheduler swclock_scheduler_t;
+typedef struct swclock_sched_task swclock_sched_task_t;
+
+/**
+ * Periodic task body. deadline_ns is the CLOCK_MONOTONIC time it was due;
+ * returns the period until its next run, or <= 0 to keep the registered one.
+ */
+typedef int64_t (*swclock_sched_fn)(void* arg, int64_t deadline_ns);
+
+/**
+ * @brief Create a scheduler with its worker threads
+ *
+ * @param threads Number of worker threads (>= 1)
+ * @return Scheduler, or NULL on failure (errno set)
+ */
+swclock_scheduler_t* swclock_scheduler_create(unsigned threads);
+
+/**
+ * @brief Stop the workers and free the scheduler
+ *
+ * All tasks must have been removed.
+ */
+void swclock_scheduler_destroy(swclock_scheduler_t* s);
+
+/**
+ * @brief Register a periodic task; first run one period from now
+ *
+ * @param s Scheduler
+ * @param period_ns Period (ns, > 0)
+ * @param fn Task body, called from a worker thread
+ * @param arg Argument for fn
+ * @return Task handle, or NULL on failure (errno set)
+ */
+swclock_sched_task_t* swclock_scheduler_add(swclock_scheduler_t* s, int64_t period_ns,
+                                            swclock_sched_fn fn, void* arg);
+
+/**
+ * @brief Make a task due now
+ *
+ * If the task is running, it runs again as soon as the current run
+ * returns. Used to react to an event before a long period expires.
+ */
+void swclock_scheduler_kick(swclock_scheduler_t* s, swclock_sched_task_t* t);
+
+/**
+ * @brief Unregister and free a task
+ *
+ * Blocks until a run of the task in progress on another worker has
+ * returned; afterwards fn is never called again. Must not be called from
+ * the task's own body.
+ */
+void swclock_scheduler_remove(swclock_scheduler_t* s, swclock_sched_task_t* t);
+
+/**
+ * @brief Get the process-wide shared scheduler, creating it on first use
+ *
+ * Reference counted; the worker count is fixed by the first acquire.
+ *
+ * @param threads Worker threads if the scheduler has to be created
+ * @return Shared scheduler, or NULL on failure (errno set)
+ */
+swclock_scheduler_t* swclock_scheduler_shared_acquire(unsigned threads);
+
+/**
+ * @brief Drop a reference to the shared scheduler; the last one destroys it
+ */
+void swclock_scheduler_shared_release(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_SCHEDULER_H */
@@ -0,0 +1,268 @@
+/**
+ * @file sw_clock_seglog.c
+ * @brief Memory-mapped segment log writer
+ */
+
+#include "sw_clock_seglog.h"
+#include "sw_clock_constants.h"
+#include "sw_clock_evindex.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct swclock_seglog {
+    char*    path;
+    uint64_t segment_bytes;
+    uint32_t max_segments;      // 0 = unlimited
+    uint8_t* header;
+    size_t   header_len;
+
+    int      fd;                // Current segment
+    uint8_t* map;
+    uint64_t used;              // Bytes used in the current segment
+    uint64_t synced;            // Bytes already handed to msync()
+
+    swclock_seglog_stats_t stats;
+};
+
+int swclock_seglog_segment_path(const char* path, uint32_t index, char* buf, size_t len) {
+    int n = (index == 0) ? snprintf(buf, len, "%s", path)
+                         : snprintf(buf, len, "%s.%u", path, index);
+    if (n < 0 || (size_t)n >= len) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return 0;
+}
+
+// Start writeback of [synced, used) without waiting for it
+static void seglog_sync_async(swclock_seglog_t* log) {
+    static long page_size;
+    if (!page_size) page_size = sysconf(_SC_PAGESIZE);
+
+    uint64_t start = log->synced & ~(uint64_t)(page_size - 1);
+    if (log->used > start) {
+        msync(log->map + start, (size_t)(log->used - start), MS_ASYNC);
+    }
+    log->synced = log->used;
+}
+
+// Unmap the current segment; truncate it to the used length if requested
+static int seglog_unmap(swclock_seglog_t* log, int truncate) {
+    int rc = 0;
+
+    if (log->map) {
+        seglog_sync_async(log);
+        munmap(log->map, (size_t)log->segment_bytes);
+        log->map = NULL;
+    }
+    if (log->fd >= 0) {
+        if (truncate && ftruncate(log->fd, (off_t)log->used) != 0) rc = -1;
+        close(log->fd);
+        log->fd = -1;
+    }
+    return rc;
+}
+
+// Reserve the blocks of a new segment and set its size, so stores into the
+// mapping never fault on a full disk (SIGBUS)
+static int seglog_preallocate(int fd, uint64_t bytes) {
+#if defined(__APPLE__)
+    fstore_t fst = {
+        .fst_flags   = F_ALLOCATECONTIG | F_ALLOCATEALL,
+        .fst_posmode = F_PEOFPOSMODE,
+        .fst_offset  = 0,
+        .fst_length  = (off_t)bytes,
+    };
+    if (fcntl(fd, F_PREALLOCATE, &fst) == -1) {
+        // No contiguous run that large: any blocks will do
+        fst.fst_flags = F_ALLOCATEALL;
+        if (fcntl(fd, F_PREALLOCATE, &fst) == -1) return -1;
+    }
+    // F_PREALLOCATE reserves blocks past EOF without changing the size
+    return ftruncate(fd, (off_t)bytes);
+#else
+    int rc = posix_fallocate(fd, 0, (off_t)bytes);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return 0;
+#endif
+}
+
+// Create, pre-allocate and map segment `index`, dropping the oldest
+// segments beyond the size limit
+static int seglog_map_segment(swclock_seglog_t* log, uint32_t index) {
+    char name[1024];
+    if (swclock_seglog_segment_path(log->path, index, name, sizeof(name)) != 0) {
+        return -1;
+    }
+
+    int fd = open(name, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+
+    // Never map a sparse segment: fail now, and retry at the next append
+    if (seglog_preallocate(fd, log->segment_bytes) != 0) {
+        int saved = errno;
+        close(fd);
+        unlink(name);
+        errno = saved;
+        return -1;
+    }
+
+    void* map = mmap(NULL, (size_t)log->segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        int saved = errno;
+        close(fd);
+        unlink(name);
+        errno = saved;
+        return -1;
+    }
+    madvise(map, (size_t)log->segment_bytes, MADV_SEQUENTIAL);
+
+    log->fd     = fd;
+    log->map    = (uint8_t*)map;
+    log->used   = 0;
+    log->synced = 0;
+    log->stats.current_segment = index;
+    log->stats.segments++;
+
+    if (log->header_len) {
+        memcpy(log->map, log->header, log->header_len);
+        log->used = log->header_len;
+    }
+
+    // Keep at most max_segments files, the new one included
+    while (log->max_segments &&
+           index - log->stats.first_segment + 1 > log->max_segments) {
+        if (swclock_seglog_segment_path(log->path, log->stats.first_segment, name, sizeof(name)) == 0) {
+            unlink(name);
+            // Its sidecar index, if the writer kept one
+            char idx[1024 + sizeof(SWCLOCK_EVENT_INDEX_SUFFIX)];
+            if (swclock_evindex_path(name, idx, sizeof(idx)) == 0) unlink(idx);
+        }
+        log->stats.first_segment++;
+        log->stats.segments_deleted++;
+    }
+    return 0;
+}
+
+swclock_seglog_t* swclock_seglog_open(const char* path, uint64_t segment_bytes,
+                                      uint64_t max_total_bytes,
+                                      const void* header, size_t header_len) {
+    long page_size = sysconf(_SC_PAGESIZE);
+    segment_bytes = (segment_bytes + (uint64_t)page_size - 1) & ~(uint64_t)(page_size - 1);
+
+    if (!path || segment_bytes == 0 || header_len >= segment_bytes || (header_len && !header)) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    swclock_seglog_t* log = (swclock_seglog_t*)calloc(1, sizeof(*log));
+    if (!log) return NULL;
+
+    log->fd            = -1;
+    log->segment_bytes = segment_bytes;
+    log->max_segments  = max_total_bytes ? (uint32_t)(max_total_bytes / segment_bytes) : 0;
+    if (max_total_bytes && log->max_segments == 0) log->max_segments = 1;
+    log->path          = strdup(path);
+    log->header_len    = header_len;
+    if (header_len) log->header = (uint8_t*)malloc(header_len);
+
+    if (!log->path || (header_len && !log->header)) {
+        free(log->path);
+        free(log->header);
+        free(log);
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (header_len) memcpy(log->header, header, header_len);
+
+    if (seglog_map_segment(log, 0) != 0) {
+        int saved = errno;
+        free(log->path);
+        free(log->header);
+        free(log);
+        errno = saved;
+        return NULL;
+    }
+    return log;
+}
+
+void* swclock_seglog_reserve(swclock_seglog_t* log, size_t len, bool* new_segment) {
+    if (new_segment) *new_segment = false;
+    if (!log) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (log->header_len + len > log->segment_bytes) {
+        errno = EMSGSIZE;
+        return NULL;
+    }
+
+    // A failed roll-over left no mapping; try the next segment again
+    if (!log->map) {
+        if (seglog_map_segment(log, log->stats.current_segment + 1) != 0) return NULL;
+        if (new_segment) *new_segment = true;
+    }
+
+    if (log->used + len > log->segment_bytes) {
+        // A failed truncate only leaves a zero tail that readers skip
+        uint32_t next = log->stats.current_segment + 1;
+        seglog_unmap(log, 1);
+        if (seglog_map_segment(log, next) != 0) return NULL;
+        if (new_segment) *new_segment = true;
+    }
+    return log->map + log->used;
+}
+
+void swclock_seglog_commit(swclock_seglog_t* log, size_t len) {
+    log->used += len;
+    log->stats.bytes += len;
+
+    if (log->used - log->synced >= SWCLOCK_SEGLOG_SYNC_BYTES) {
+        seglog_sync_async(log);
+    }
+}
+
+int swclock_seglog_append(swclock_seglog_t* log, const struct iovec* rec, size_t count) {
+    if (!log || (!rec && count)) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        void* dst = swclock_seglog_reserve(log, rec[i].iov_len, NULL);
+        if (!dst) return -1;
+        memcpy(dst, rec[i].iov_base, rec[i].iov_len);
+        swclock_seglog_commit(log, rec[i].iov_len);
+    }
+    return 0;
+}
+
+uint64_t swclock_seglog_offset(const swclock_seglog_t* log) {
+    return log->used;
+}
+
+void swclock_seglog_get_stats(const swclock_seglog_t* log, swclock_seglog_stats_t* stats) {
+    if (!log || !stats) return;
+    *stats = log->stats;
+}
+
+int swclock_seglog_close(swclock_seglog_t* log) {
+    if (!log) return 0;
+
+    int rc = seglog_unmap(log, 1);
+    int saved = errno;
+    free(log->path);
+    free(log->header);
+    free(log);
+    errno = saved;
+    return rc;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file sw_clock_seglog.h
+ * @brief Memory-mapped, pre-allocated segment files for the binary event log
+ *
+ * The event logger appends records by memcpy into a shared file mapping
+ * instead of issuing a write() per batch:
+ *
+ * - The log is a sequence of fixed-size segment files: the configured path
+ *   itself, then path.1, path.2, ... Each is pre-allocated
+ *   (posix_fallocate(), F_PREALLOCATE on macOS) and mapped once, so
+ *   appends never extend a file or allocate blocks, and a full disk fails
+ *   the segment's creation instead of faulting a store into the mapping.
+ * - Every segment starts with the same file header and records never span
+ *   segments, so each segment can be read on its own.
+ * - Dirty ranges are handed to the kernel with msync(MS_ASYNC) every
+ *   SWCLOCK_SEGLOG_SYNC_BYTES and at roll-over; nothing waits for disk.
+ * - When the segments would exceed the total size limit, the oldest
+ *   segment file is deleted, together with its sidecar index
+ *   (sw_clock_evindex.h) if there is one.
+ * - close() truncates the last segment to its used length. After a crash,
+ *   the file keeps its pre-allocated length and the unused tail reads as
+ *   zeros; readers stop at the first all-zero record header. Data already
+ *   copied into the mapping survives a process crash; only an OS crash
+ *   can lose the part not yet written back.
+ *
+ * Not thread-safe: one writer (the event logger thread) per log.
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_SEGLOG_H
+#define SWCLOCK_SEGLOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Opaque segment log writer
+ */
+typedef struct swclock_seglog swclock_seglog_t;
+
+/**
+ * @brief Segment log counters
+ */
+typedef struct {
+    uint64_t bytes;             /**< Record bytes appended */
+    uint32_t segments;          /**< Segment files created */
+    uint32_t segments_deleted;  /**< Oldest segments removed to honour the size limit */
+    uint32_t first_segment;     /**< Index of the oldest segment still on disk */
+    uint32_t current_segment;   /**< Index of the segment being appended to */
+} swclock_seglog_stats_t;
+
+/**
+ * @brief Create the first segment and map it
+ *
+ * @param path Path of segment 0; later segments append ".N"
+ * @param segment_bytes Size of each segment file (rounded up to the page size)
+ * @param max_total_bytes Limit on all segments together, 0 for none; the
+ *        current segment is always kept
+ * @param header Written at the start of every segment (may be NULL)
+ * @param header_len Header length, smaller than segment_bytes
+ * @return Writer, or NULL on failure (errno set)
+ */
+swclock_seglog_t* swclock_seglog_open(const char* path, uint64_t segment_bytes,
+                                      uint64_t max_total_bytes,
+                                      const void* header, size_t header_len);
+
+/**
+ * @brief Reserve space for one record directly in the mapping
+ *
+ * Starts the next segment if fewer than len bytes are left in the current
+ * one. The caller writes at most len bytes at the returned address and
+ * then calls swclock_seglog_commit() before any other call on the log.
+ *
+ * @param log Writer
+ * @param len Largest number of bytes the record may take
+ * @param new_segment Set to true if the record starts a segment (may be
+ *        NULL); state carried between records, such as delta coding, must
+ *        restart there
+ * @return Address in the mapping, or NULL on failure (errno set; EMSGSIZE
+ *         if len cannot fit in an empty segment)
+ */
+void* swclock_seglog_reserve(swclock_seglog_t* log, size_t len, bool* new_segment);
+
+/**
+ * @brief Commit the len bytes written at the last reservation (len <= reserved)
+ */
+void swclock_seglog_commit(swclock_seglog_t* log, size_t len);
+
+/**
+ * @brief Append records by copying them into the mapping
+ *
+ * Each iovec is one record and is never split across segments; a record
+ * that does not fit in the current segment starts the next one.
+ *
+ * @param log Writer
+ * @param rec Records
+ * @param count Number of records
+ * @return 0 on success, -1 on failure (errno set; EMSGSIZE if a record
+ *         cannot fit in an empty segment)
+ */
+int swclock_seglog_append(swclock_seglog_t* log, const struct iovec* rec, size_t count);
+
+/**
+ * @brief File offset in the current segment where the next record goes
+ *
+ * After swclock_seglog_reserve(), the offset of the reserved record.
+ */
+uint64_t swclock_seglog_offset(const swclock_seglog_t* log);
+
+/**
+ * @brief Get counters
+ */
+void swclock_seglog_get_stats(const swclock_seglog_t* log, swclock_seglog_stats_t* stats);
+
+/**
+ * @brief Flush asynchronously, truncate the last segment to its used length, unmap and free
+ *
+ * @return 0 on success, -1 on failure (errno set); the writer is freed either way
+ */
+int swclock_seglog_close(swclock_seglog_t* log);
+
+/**
+ * @brief File name of segment `index` of the log at `path`
+ *
+ * @return 0 on success, -1 if buf is too small (errno = ENAMETOOLONG)
+ */
+int swclock_seglog_segment_path(const char* path, uint32_t index, char* buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_SEGLOG_H */
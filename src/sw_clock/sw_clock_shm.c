@@ -0,0 +1,264 @@
+/**
+ * @file sw_clock_shm.c
+ * @brief Shared-memory timebase page writer and reader
+ */
+
+#include "sw_clock_shm.h"
+#include "sw_clock_timebase.h"
+#include "sw_clock_utilities.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef CLOCK_MONOTONIC_RAW
+  #ifdef CLOCK_UPTIME_RAW
+    #define CLOCK_MONOTONIC_RAW CLOCK_UPTIME_RAW
+  #else
+    #define CLOCK_MONOTONIC_RAW CLOCK_MONOTONIC
+  #endif
+#endif
+
+/**
+ * Layout of the shared timebase page. The header is written once before
+ * the object is made visible; the timebase is republished by the owning
+ * SwClock on every update. Bump SWCLOCK_SHM_VERSION on any change.
+ */
+struct swclock_shm_page {
+    uint32_t magic;              /**< SWCLOCK_SHM_MAGIC */
+    uint32_t version;            /**< SWCLOCK_SHM_VERSION */
+    uint32_t page_size;          /**< sizeof(swclock_shm_page_t) */
+    uint32_t writer_pid;         /**< Process that owns the SwClock */
+    swclock_timebase_t timebase; /**< Seqlock-protected timebase */
+};
+
+struct swclock_shm_reader {
+    const swclock_shm_page_t* page;
+};
+
+// POSIX shm names must start with a single '/'
+static int swclock_shm_normalize_name(const char* name, char* out, size_t out_len) {
+    if (!name || !*name) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    int n = snprintf(out, out_len, "%s%s", (name[0] == '/') ? "" : "/", name);
+    if (n < 0 || (size_t)n >= out_len) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    return 0;
+}
+
+// The recorded writer still exists (EPERM: alive, owned by another user)
+static bool swclock_shm_writer_alive(uint32_t pid) {
+    return kill((pid_t)pid, 0) == 0 || errno == EPERM;
+}
+
+// Fill a page this process just claimed; readers validate magic last
+static void swclock_shm_fill(swclock_shm_page_t* page,
+                             const swclock_timebase_snapshot_t* snap,
+                             bool fresh) {
+    page->magic = 0;
+    page->version = SWCLOCK_SHM_VERSION;
+    page->page_size = (uint32_t)sizeof(swclock_shm_page_t);
+    if (fresh) {
+        swclock_timebase_init(&page->timebase, snap);
+    } else {
+        // Readers of the stale page may still be mapped: republish through
+        // the seqlock, first closing a write section the dead writer left open
+        uint32_t seq = atomic_load_explicit(&page->timebase.seq, memory_order_relaxed);
+        if (seq & 1) {
+            atomic_store_explicit(&page->timebase.seq, seq + 1, memory_order_relaxed);
+        }
+        swclock_timebase_publish(&page->timebase, snap);
+    }
+    atomic_thread_fence(memory_order_release);
+    page->magic = SWCLOCK_SHM_MAGIC;
+}
+
+// Take over an existing page whose writer process is gone. Never unlinks
+// the name: the winner of the writer_pid exchange reuses the object in
+// place, so two processes reclaiming the same stale page cannot remove
+// each other's page. Fails with EEXIST while the writer is alive, or when
+// the page is not (yet) a SwClock page.
+static swclock_shm_page_t* swclock_shm_take_over(const char* shm_name,
+                                                 const swclock_timebase_snapshot_t* snap) {
+    int fd = shm_open(shm_name, O_RDWR, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(swclock_shm_page_t)) {
+        close(fd);
+        errno = EEXIST;
+        return NULL;
+    }
+
+    void* map = mmap(NULL, sizeof(swclock_shm_page_t), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    swclock_shm_page_t* page = (swclock_shm_page_t*)map;
+
+    // writer_pid 0: the creator has not filled the page in yet
+    uint32_t owner = __atomic_load_n(&page->writer_pid, __ATOMIC_ACQUIRE);
+    if ((page->magic != SWCLOCK_SHM_MAGIC && page->magic != 0) ||
+        owner == 0 || swclock_shm_writer_alive(owner) ||
+        !__atomic_compare_exchange_n(&page->writer_pid, &owner, (uint32_t)getpid(),
+                                     false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        munmap(map, sizeof(swclock_shm_page_t));
+        errno = EEXIST;
+        return NULL;
+    }
+
+    swclock_shm_fill(page, snap, false);
+    return page;
+}
+
+swclock_shm_page_t* swclock_shm_create(const char* name,
+                                       const swclock_timebase_snapshot_t* snap) {
+    char shm_name[256];
+    if (!snap || swclock_shm_normalize_name(name, shm_name, sizeof(shm_name)) != 0) {
+        if (!snap) errno = EINVAL;
+        return NULL;
+    }
+
+    // O_EXCL: never write into a page another live writer is publishing
+    int fd = shm_open(shm_name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        return (errno == EEXIST) ? swclock_shm_take_over(shm_name, snap) : NULL;
+    }
+
+    // From here on the name is ours, so error paths may unlink it
+    if (ftruncate(fd, (off_t)sizeof(swclock_shm_page_t)) != 0) {
+        int saved = errno;
+        close(fd);
+        shm_unlink(shm_name);
+        errno = saved;
+        return NULL;
+    }
+
+    void* map = mmap(NULL, sizeof(swclock_shm_page_t), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        int saved = errno;
+        shm_unlink(shm_name);
+        errno = saved;
+        return NULL;
+    }
+
+    swclock_shm_page_t* page = (swclock_shm_page_t*)map;
+    __atomic_store_n(&page->writer_pid, (uint32_t)getpid(), __ATOMIC_RELEASE);
+    swclock_shm_fill(page, snap, true);
+    return page;
+}
+
+void swclock_shm_publish(swclock_shm_page_t* page,
+                         const swclock_timebase_snapshot_t* snap) {
+    if (!page) return;
+    swclock_timebase_publish(&page->timebase, snap);
+}
+
+void swclock_shm_destroy(swclock_shm_page_t* page, const char* name) {
+    char shm_name[256];
+
+    if (!page) return;
+
+    // Unlink only a page this process still owns (not one inherited
+    // across fork())
+    bool owner = __atomic_load_n(&page->writer_pid, __ATOMIC_ACQUIRE) == (uint32_t)getpid();
+    munmap(page, sizeof(swclock_shm_page_t));
+    if (owner && swclock_shm_normalize_name(name, shm_name, sizeof(shm_name)) == 0) {
+        shm_unlink(shm_name);
+    }
+}
+
+swclock_shm_reader_t* swclock_shm_open(const char* name) {
+    char shm_name[256];
+    if (swclock_shm_normalize_name(name, shm_name, sizeof(shm_name)) != 0) {
+        return NULL;
+    }
+
+    int fd = shm_open(shm_name, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(swclock_shm_page_t)) {
+        close(fd);
+        errno = EPROTO;
+        return NULL;
+    }
+
+    void* map = mmap(NULL, sizeof(swclock_shm_page_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+
+    const swclock_shm_page_t* page = (const swclock_shm_page_t*)map;
+    if (page->magic != SWCLOCK_SHM_MAGIC ||
+        page->version != SWCLOCK_SHM_VERSION ||
+        page->page_size != sizeof(swclock_shm_page_t)) {
+        munmap(map, sizeof(swclock_shm_page_t));
+        errno = EPROTO;
+        return NULL;
+    }
+    atomic_thread_fence(memory_order_acquire);
+
+    swclock_shm_reader_t* r = (swclock_shm_reader_t*)calloc(1, sizeof(*r));
+    if (!r) {
+        munmap(map, sizeof(swclock_shm_page_t));
+        return NULL;
+    }
+    r->page = page;
+    return r;
+}
+
+int swclock_shm_gettime(const swclock_shm_reader_t* r, clockid_t clk_id,
+                        struct timespec* tp) {
+    if (!r || !tp) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    if (clk_id == CLOCK_MONOTONIC_RAW) {
+        return clock_gettime(CLOCK_MONOTONIC_RAW, tp);
+    }
+
+    if (clk_id != CLOCK_REALTIME && clk_id != CLOCK_MONOTONIC) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    swclock_timebase_snapshot_t snap;
+    swclock_timebase_read(&r->page->timebase, &snap);
+
+    struct timespec now_raw;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &now_raw);
+
+    int64_t base_ns = (clk_id == CLOCK_REALTIME) ? snap.base_rt_ns : snap.base_mono_ns;
+    *tp = ns_to_ts(swclock_timebase_extrapolate(&snap, base_ns, ts_to_ns(&now_raw)));
+    return 0;
+}
+
+void swclock_shm_close(swclock_shm_reader_t* r) {
+    if (!r) return;
+
+    munmap((void*)r->page, sizeof(swclock_shm_page_t));
+    free(r);
+}
@@ -0,0 +1,129 @@
+/**
+ * @file sw_clock_shm.h
+ * @brief Shared-memory ("vDSO-style") timebase page for cross-process readers
+ *
+ * A SwClock can publish its seqlock timebase into a named POSIX shared
+ * memory object. Any process on the host can then map that page read-only
+ * and compute disciplined REALTIME/MONOTONIC with one raw clock read and
+ * no lock, at roughly clock_gettime() cost, instead of IPC'ing into the
+ * process that owns the SwClock.
+ *
+ * Writer side: swclock_enable_shm() / swclock_disable_shm() in sw_clock.h
+ * (or SWCLOCK_SHM_NAME=<name> at swclock_create() time).
+ *
+ * Reader side:
+ * @code
+ *   swclock_shm_reader_t* r = swclock_shm_open("/swclock0");
+ *   struct timespec now;
+ *   swclock_shm_gettime(r, CLOCK_REALTIME, &now);
+ *   swclock_shm_close(r);
+ * @endcode
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_SHM_H
+#define SWCLOCK_SHM_H
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Shared page magic number ("SWTB" in ASCII)
+ */
+#define SWCLOCK_SHM_MAGIC 0x53575442
+
+/**
+ * @brief Shared page layout version (bumped on any layout change)
+ */
+#define SWCLOCK_SHM_VERSION 2
+
+struct swclock_timebase_snapshot;
+
+/**
+ * @brief Opaque writer-side page (layout in sw_clock_shm.c)
+ */
+typedef struct swclock_shm_page swclock_shm_page_t;
+
+/**
+ * @brief Opaque reader handle
+ */
+typedef struct swclock_shm_reader swclock_shm_reader_t;
+
+/**
+ * @brief Create and map a shared timebase page for writing
+ *
+ * The name is created exclusively. An existing page is taken over in place
+ * only when the process recorded as its writer no longer exists; a page
+ * with a live writer is left untouched.
+ *
+ * @param name POSIX shm name; a leading '/' is added if missing
+ * @param snap Initial timebase to publish
+ * @return Mapped page, or NULL on error (errno set; EEXIST if the name is
+ *         held by a live writer or is not a SwClock page)
+ */
+swclock_shm_page_t* swclock_shm_create(const char* name,
+                                       const struct swclock_timebase_snapshot* snap);
+
+/**
+ * @brief Republish the timebase into a writer page
+ *
+ * Thread safety: callers must serialize writers.
+ *
+ * @param page Page returned by swclock_shm_create()
+ * @param snap New values
+ */
+void swclock_shm_publish(swclock_shm_page_t* page,
+                         const struct swclock_timebase_snapshot* snap);
+
+/**
+ * @brief Unmap a writer page and unlink its name
+ *
+ * Readers that already mapped the page keep extrapolating from the last
+ * published timebase; new swclock_shm_open() calls fail. The name is only
+ * unlinked by the process that owns the page.
+ *
+ * @param page Page returned by swclock_shm_create()
+ * @param name Name passed to swclock_shm_create()
+ */
+void swclock_shm_destroy(swclock_shm_page_t* page, const char* name);
+
+/**
+ * @brief Map a published timebase page read-only
+ *
+ * @param name POSIX shm name; a leading '/' is added if missing
+ * @return Reader handle, or NULL on error (errno set; EPROTO on
+ *         magic/version mismatch)
+ */
+swclock_shm_reader_t* swclock_shm_open(const char* name);
+
+/**
+ * @brief Read disciplined time from a shared timebase page
+ *
+ * Lock-free; the only system call is the CLOCK_MONOTONIC_RAW read.
+ *
+ * @param r Reader handle
+ * @param clk_id CLOCK_REALTIME, CLOCK_MONOTONIC or CLOCK_MONOTONIC_RAW
+ * @param tp Output time
+ * @return 0 on success, -1 on failure (errno set)
+ */
+int swclock_shm_gettime(const swclock_shm_reader_t* r, clockid_t clk_id,
+                        struct timespec* tp);
+
+/**
+ * @brief Unmap a reader handle
+ *
+ * @param r Reader handle
+ */
+void swclock_shm_close(swclock_shm_reader_t* r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_SHM_H */
@@ -0,0 +1,37 @@
+/**
+ * @file sw_clock_timebase.c
+ * @brief Seqlock timebase writer implementation
+ */
+
+#include "sw_clock_timebase.h"
+
+void swclock_timebase_init(swclock_timebase_t* tb,
+                           const swclock_timebase_snapshot_t* snap) {
+    if (!tb || !snap) return;
+
+    atomic_init(&tb->seq, 0);
+    atomic_init(&tb->shift, snap->shift);
+    atomic_init(&tb->ref_raw_ns, snap->ref_raw_ns);
+    atomic_init(&tb->base_rt_ns, snap->base_rt_ns);
+    atomic_init(&tb->base_mono_ns, snap->base_mono_ns);
+    atomic_init(&tb->mult, snap->mult);
+}
+
+void swclock_timebase_publish(swclock_timebase_t* tb,
+                              const swclock_timebase_snapshot_t* snap) {
+    if (!tb || !snap) return;
+
+    // Enter write section: seq becomes odd before any field changes
+    uint32_t seq = atomic_load_explicit(&tb->seq, memory_order_relaxed);
+    atomic_store_explicit(&tb->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&tb->ref_raw_ns, snap->ref_raw_ns, memory_order_relaxed);
+    atomic_store_explicit(&tb->base_rt_ns, snap->base_rt_ns, memory_order_relaxed);
+    atomic_store_explicit(&tb->base_mono_ns, snap->base_mono_ns, memory_order_relaxed);
+    atomic_store_explicit(&tb->mult, snap->mult, memory_order_relaxed);
+    atomic_store_explicit(&tb->shift, snap->shift, memory_order_relaxed);
+
+    // Leave write section: all field stores happen-before the even seq
+    atomic_store_explicit(&tb->seq, seq + 2, memory_order_release);
+}
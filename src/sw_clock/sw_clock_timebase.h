@@ -0,0 +1,152 @@
+/**
+ * @file sw_clock_timebase.h
+ * @brief Sequence-counter (seqlock) protected timebase snapshot
+ *
+ * The poll thread (and settime/adjtime) publish the extrapolation state
+ * used by swclock_gettime() into a swclock_timebase_t. Readers copy the
+ * snapshot without taking any lock and without performing an atomic
+ * read-modify-write, so concurrent timestamping threads never bounce a
+ * shared reader-count cache line and never block behind the poll thread.
+ *
+ * The rate is a fixed-point multiplier (mult >> shift), so the read path is
+ * integer-only and its rounding error is bounded independently of how long
+ * the snapshot is extrapolated.
+ *
+ * Protocol (single writer, any number of readers):
+ * - Writer bumps seq to an odd value, stores the fields, bumps seq to even.
+ * - Reader loads seq, copies the fields, re-loads seq and retries if the
+ *   two values differ or the first one was odd.
+ *
+ * Writers must be serialized externally (SwClock uses its rwlock write
+ * side for that).
+ *
+ * @author SwClock Development Team
+ * @date 2026-10-16
+ */
+
+#ifndef SWCLOCK_TIMEBASE_H
+#define SWCLOCK_TIMEBASE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "sw_clock_utilities.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Plain (non-atomic) copy of the published timebase
+ */
+typedef struct swclock_timebase_snapshot {
+    int64_t  ref_raw_ns;    /**< CLOCK_MONOTONIC_RAW at last rebase (ns) */
+    int64_t  base_rt_ns;    /**< Disciplined REALTIME at ref_raw_ns */
+    int64_t  base_mono_ns;  /**< Disciplined MONOTONIC at ref_raw_ns */
+    uint64_t mult;          /**< Rate factor * 2^shift */
+    uint32_t shift;         /**< Fraction bits of mult */
+} swclock_timebase_snapshot_t;
+
+/**
+ * @brief Seqlock-protected timebase shared between writer and readers
+ *
+ * Fields are individually atomic so that the racy copy done by readers is
+ * well defined in C11; all accesses are relaxed and compile to plain loads
+ * and stores on x86-64 and AArch64.
+ */
+typedef struct {
+    _Atomic uint32_t seq;          /**< Odd while an update is in progress */
+    _Atomic uint32_t shift;
+    _Atomic int64_t  ref_raw_ns;
+    _Atomic int64_t  base_rt_ns;
+    _Atomic int64_t  base_mono_ns;
+    _Atomic uint64_t mult;
+} swclock_timebase_t;
+
+/**
+ * @brief Initialize a timebase and publish the first snapshot
+ *
+ * @param tb Timebase to initialize
+ * @param snap Initial values
+ */
+void swclock_timebase_init(swclock_timebase_t* tb,
+                           const swclock_timebase_snapshot_t* snap);
+
+/**
+ * @brief Publish a new snapshot (writer side)
+ *
+ * Thread safety: callers must serialize writers.
+ *
+ * @param tb Timebase
+ * @param snap New values
+ */
+void swclock_timebase_publish(swclock_timebase_t* tb,
+                              const swclock_timebase_snapshot_t* snap);
+
+static inline void swclock_timebase_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * @brief Copy a consistent snapshot (reader side, lock-free)
+ *
+ * Never blocks and never writes shared memory; spins only while the
+ * writer is in the middle of an update (a few stores).
+ *
+ * @param tb Timebase
+ * @param out Output snapshot
+ */
+static inline void swclock_timebase_read(const swclock_timebase_t* tb,
+                                         swclock_timebase_snapshot_t* out) {
+    swclock_timebase_t* t = (swclock_timebase_t*)tb;
+    uint32_t seq1, seq2;
+
+    for (;;) {
+        seq1 = atomic_load_explicit(&t->seq, memory_order_acquire);
+        if (seq1 & 1u) {
+            swclock_timebase_cpu_relax();
+            continue;
+        }
+
+        out->ref_raw_ns   = atomic_load_explicit(&t->ref_raw_ns, memory_order_relaxed);
+        out->base_rt_ns   = atomic_load_explicit(&t->base_rt_ns, memory_order_relaxed);
+        out->base_mono_ns = atomic_load_explicit(&t->base_mono_ns, memory_order_relaxed);
+        out->mult         = atomic_load_explicit(&t->mult, memory_order_relaxed);
+        out->shift        = atomic_load_explicit(&t->shift, memory_order_relaxed);
+
+        atomic_thread_fence(memory_order_acquire);
+        seq2 = atomic_load_explicit(&t->seq, memory_order_relaxed);
+        if (seq1 == seq2) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Extrapolate disciplined time from a snapshot
+ *
+ * Pure integer multiply/shift. Elapsed raw time before the snapshot
+ * reference is clamped to zero so the result never runs backwards across
+ * a rebase.
+ *
+ * @param snap Snapshot returned by swclock_timebase_read()
+ * @param base_ns snap->base_rt_ns or snap->base_mono_ns
+ * @param raw_now_ns Current CLOCK_MONOTONIC_RAW (ns)
+ * @return Disciplined time (ns)
+ */
+static inline int64_t swclock_timebase_extrapolate(const swclock_timebase_snapshot_t* snap,
+                                                   int64_t base_ns, int64_t raw_now_ns) {
+    int64_t elapsed_raw_ns = raw_now_ns - snap->ref_raw_ns;
+    if (elapsed_raw_ns < 0) elapsed_raw_ns = 0;
+
+    return base_ns + (int64_t)mul_u64_shr((uint64_t)elapsed_raw_ns, snap->mult, snap->shift);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWCLOCK_TIMEBASE_H */
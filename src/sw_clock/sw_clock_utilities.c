@@ -19,6 +19,7 @@
 #include <time.h>
 #include <stdarg.h>
 #include <syslog.h>
+#include <unistd.h>
 
 #include "sw_clock.h"
 
@@ -56,6 +57,21 @@ static void swclock_util_log(int priority, const char *format, ...) {
 
 // -------- helpers -------------------------------------------
 
+int swclock_write_all(int fd, const void* buf, size_t len)
+{
+    const char* p = (const char*)buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
 void print_timespec_as_datetime(const struct timespec *ts)
 {
     if (!ts) {
@@ -13,6 +13,7 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include <time.h>
 #include <errno.h>
 #include <sys/time.h> // timeval
@@ -93,6 +94,67 @@ static inline double scaledppm_to_factor(long scaled_ppm) {
     return 1.0 + ((double)scaled_ppm) / (65536.0 * 1.0e6);
 }
 
+/**
+ * Convert a multiplicative factor to a fixed-point multiplier.
+ * E.g., 1.0001 -> round(1.0001 * 2^shift)
+ * @param factor Multiplicative factor (> 0)
+ * @param shift Fraction bits, normally SWCLOCK_RATE_SHIFT
+ * @return Fixed-point multiplier, or 0 for a non-positive factor
+ */
+static inline uint64_t factor_to_mult(double factor, uint32_t shift) {
+    if (!(factor > 0.0)) return 0;
+    return (uint64_t)(factor * (double)(1ULL << shift) + 0.5);
+}
+
+/**
+ * Compute (a * mult) >> shift with a 128-bit intermediate product.
+ * @param a Value to scale (e.g. elapsed raw nanoseconds)
+ * @param mult Fixed-point multiplier from factor_to_mult()
+ * @param shift Fraction bits of mult (< 64)
+ * @return Scaled value, truncated
+ */
+static inline uint64_t mul_u64_shr(uint64_t a, uint64_t mult, uint32_t shift) {
+#if defined(__SIZEOF_INT128__)
+    return (uint64_t)(((unsigned __int128)a * mult) >> shift);
+#else
+    // Portable 64x64->128 multiply from 32-bit halves
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t m_lo = (uint32_t)mult, m_hi = mult >> 32;
+
+    uint64_t ll = a_lo * m_lo;
+    uint64_t lh = a_lo * m_hi;
+    uint64_t hl = a_hi * m_lo;
+    uint64_t hh = a_hi * m_hi;
+
+    uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+    uint64_t lo  = (mid << 32) | (uint32_t)ll;
+    uint64_t hi  = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+
+    return shift ? (lo >> shift) | (hi << (64 - shift)) : lo;
+#endif
+}
+
+/**
+ * Compute floor((a * mult) / 2^shift) for a signed value.
+ * Equals mul_u64_shr() for a >= 0; negative values round toward -inf.
+ * @param a Value to scale (e.g. signed elapsed nanoseconds)
+ * @param mult Fixed-point multiplier from factor_to_mult()
+ * @param shift Fraction bits of mult (< 64)
+ * @return Scaled value
+ */
+static inline int64_t mul_s64_shr(int64_t a, uint64_t mult, uint32_t shift) {
+#if defined(__SIZEOF_INT128__)
+    return (int64_t)(((__int128)a * (__int128)mult) >> shift);
+#else
+    if (a >= 0) return (int64_t)mul_u64_shr((uint64_t)a, mult, shift);
+
+    uint64_t m = -(uint64_t)a;
+    uint64_t q = mul_u64_shr(m, mult, shift);
+    uint64_t rem = shift ? (m * mult) & ((1ULL << shift) - 1) : 0;
+    return -(int64_t)q - (rem != 0);
+#endif
+}
+
 static inline void sleep_ns(long long ns)
 {
     if (ns <= 0) return;
@@ -107,6 +169,25 @@ static inline void sleep_ns(long long ns)
     }
 }
 
+/**
+ * Current CLOCK_MONOTONIC time in nanoseconds (the poll deadline timeline).
+ */
+static inline int64_t monotonic_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts_to_ns(&ts);
+}
+
+/**
+ * Write all of buf to fd, continuing after short writes and EINTR.
+ * @param fd Open file descriptor
+ * @param buf Data to write
+ * @param len Number of bytes
+ * @return 0 on success, -1 on error (errno set)
+ */
+int swclock_write_all(int fd, const void* buf, size_t len);
+
 /**
  * Print a timespec structure as a formatted date/time string (UTC).
  * @param ts The timespec to print
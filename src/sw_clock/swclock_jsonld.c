@@ -4,14 +4,20 @@
  *
  * Implements SwClock Interchange Format (SIF) v1.0.0 with:
  * - JSON-LD context with IEEE 1588 vocabulary
+ * - Per-thread append buffers of binary records; a writer thread merges
+ *   them by enqueue time and formats them
  * - Thread-safe buffered I/O (1MB buffer)
- * - Log rotation by size/time with gzip compression
+ * - Log rotation by size/time: a file swap on the writer thread; renaming,
+ *   gzip compression and pruning on a background rotation worker
+ * - Streaming compression: each flush deflated into one gzip frame
  * - ISO 8601 timestamps with nanosecond precision
  *
  * Part of IEEE Audit Recommendation 10: Log Format Standardization
  */
 
 #include "swclock_jsonld.h"
+#include "sw_clock_ringbuf.h"
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -19,9 +25,12 @@
 #include <sys/time.h>
 #include <sys/stat.h>
 #include <sys/utsname.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sched.h>
 #include <errno.h>
+#include <math.h>
 #include <zlib.h>
 #include <stdarg.h>
 #include <syslog.h>
@@ -52,6 +61,43 @@ static void swclock_jsonld_log(int priority, const char *format, ...) {
 #define SWCLOCK_JSONLD_ERROR(fmt, ...)                                         \
     swclock_jsonld_log(LOG_ERR, fmt, ##__VA_ARGS__)
 
+/*
+ * Per-thread append buffer: a single-producer ring owned by one thread.
+ * The owner writes a record and publishes it with one release store of
+ * head; the writer thread consumes up to head and hands space back through
+ * tail. Each side's index sits on its own cache line, so threads logging
+ * at once share no written memory.
+ */
+typedef enum {
+    JSONLD_TBUF_FREE = 0,                  /* No owner; reusable */
+    JSONLD_TBUF_OWNED,                     /* A live thread appends here */
+    JSONLD_TBUF_ORPHANED                   /* Owner exited; writer frees it once drained */
+} jsonld_tbuf_state_t;
+
+typedef struct {
+    /* Owner thread */
+    _Alignas(64) uint64_t head;            /* Bytes published (release) */
+    uint64_t reserved;                     /* head after the record being written */
+    uint64_t tail_cache;                   /* Owner's copy of tail */
+    uint64_t dropped;                      /* Records lost to a full buffer (atomic) */
+    uint64_t inflight_ns;                  /* order_ns of the record being written,
+                                              JSONLD_STAMP_PENDING before it is taken,
+                                              0 when none (atomic) */
+    char* data;                            /* SWCLOCK_JSONLD_THREAD_BUFFER_SIZE bytes */
+    /* Writer thread */
+    _Alignas(64) uint64_t tail;            /* Bytes consumed (release) */
+    uint32_t state;                        /* jsonld_tbuf_state_t (atomic) */
+} jsonld_tbuf_t;
+
+/* Record header in a thread buffer; records are 8-byte aligned and never
+ * wrap: one that would cross the end follows a padding record */
+typedef struct {
+    uint32_t size;                         /* Header included */
+    uint32_t pad;                          /* Padding up to the end of the buffer */
+} jsonld_tbuf_hdr_t;
+
+#define JSONLD_TBUF_MASK ((uint64_t)SWCLOCK_JSONLD_THREAD_BUFFER_SIZE - 1)
+
 /* Internal logger context */
 struct swclock_jsonld_logger {
     FILE* fp;                              /* Log file handle */
@@ -65,17 +111,145 @@ struct swclock_jsonld_logger {
     uint64_t entry_count;                  /* Entries written */
     time_t created_at;                     /* File creation time */
     size_t current_size;                   /* Approximate file size */
+    time_t ts_cache_sec;                   /* Second of ts_cache (writer thread) */
+    bool ts_cache_valid;
+    char ts_cache[24];                     /* "YYYY-MM-DDTHH:MM:SS." of ts_cache_sec */
+
+    /* Streaming compression (rotation.stream_compress) */
+    z_stream* zs;                          /* gzip deflater, reset per frame */
+    unsigned char* zbuf;                   /* Compressed frame */
+    size_t zbuf_size;                      /* deflateBound() of a full buffer */
+    FILE* index_fp;                        /* "<log>.idx" */
+    uint64_t frame_first_ts;               /* First entry of the buffered frame */
+    uint32_t frame_entries;                /* Entries buffered */
+    uint64_t stream_raw_bytes;             /* Bytes deflated (logger lifetime) */
+    uint64_t stream_bytes;                 /* Frame bytes written (logger lifetime) */
+
+    /* Producers append records to their thread's buffer (or, past
+     * SWCLOCK_JSONLD_THREAD_BUFFERS threads, to the shared queue); only the
+     * writer thread formats and writes */
+    uint64_t id;                           /* Unique per logger (thread buffer lookup) */
+    swclock_jsonld_logger_t* next;         /* Live loggers (g_jsonld_loggers) */
+    jsonld_tbuf_t* tbufs;                  /* [SWCLOCK_JSONLD_THREAD_BUFFERS], cache aligned */
+    swclock_ringbuf_t* queue;              /* Overflow threads' records (MPSC) */
+    pthread_t writer;                      /* Formatter/writer thread */
+    bool writer_running;                   /* Cleared to stop the writer (atomic) */
+    uint64_t dropped;                      /* Shared queue full; reclaimed buffers' drops (atomic) */
+    pthread_mutex_t drain_lock;            /* Guards the wakeups and pass counters below */
+    pthread_cond_t writer_cv;              /* Writer sleeps here between batches */
+    pthread_cond_t drain_cv;               /* Flushers wait here for the writer */
+    bool drain_requested;                  /* A flusher is waiting: next pass takes everything */
+    uint64_t passes_begun;                 /* Writer passes started */
+    uint64_t passes_done;                  /* Writer passes finished */
+    bool wake_sent;                        /* A producer found its buffer half full (atomic) */
+
+    /* Rotation worker: rotated files wait under a staging name until it
+     * shifts the numbered chain, compresses and prunes */
+    pthread_t rotator;                     /* Started on the first rotation */
+    bool rotator_started;
+    bool rotator_stop;
+    pthread_mutex_t rot_lock;              /* Guards the job queue and rot_stats */
+    pthread_cond_t rot_cv;                 /* Job queued, or stop */
+    char rot_jobs[SWCLOCK_JSONLD_ROTATE_QUEUE][600]; /* Staged files, oldest first */
+    unsigned rot_head;                     /* Oldest job (being processed) */
+    unsigned rot_count;                    /* Jobs queued, including the running one */
+    uint64_t rot_seq;                      /* Staging name counter */
+    swclock_jsonld_rotation_stats_t rot_stats;
 };
 
+/* Record kinds, one per swclock_jsonld_log_* function */
+typedef enum {
+    JSONLD_REC_SERVO = 1,
+    JSONLD_REC_ADJUSTMENT,
+    JSONLD_REC_PI_UPDATE,
+    JSONLD_REC_ALERT,
+    JSONLD_REC_SYSTEM,
+    JSONLD_REC_METRICS,
+    JSONLD_REC_TEST
+} jsonld_rec_kind_t;
+
+/* Queued log call: the arguments as passed, strings copied after the struct */
+typedef struct {
+    uint32_t kind;                         /* jsonld_rec_kind_t */
+    uint32_t nstrings;                     /* NUL-terminated strings that follow */
+    uint64_t timestamp_ns;
+    uint64_t order_ns;                     /* CLOCK_MONOTONIC at the call: merge key */
+    union {
+        struct {
+            double freq_ppm;
+            int64_t phase_error_ns;
+            int64_t time_error_ns;
+            double pi_freq_ppm;
+            double pi_int_error_s;
+            bool servo_enabled;
+        } servo;
+        struct {
+            double value;
+            int64_t before_offset_ns;
+            int64_t after_offset_ns;
+        } adjustment;                      /* adjustment_type */
+        struct {
+            double kp, ki, error_s, output_ppm, integral_state;
+        } pi;
+        struct {
+            double value_ns;
+            double threshold_ns;
+        } alert;                           /* metric_name, severity, standard */
+        struct {
+            uint32_t sample_count;
+            bool itu_g8260_pass;
+            double v[14];                  /* In swclock_jsonld_log_metrics() order */
+        } metrics;
+        struct {
+            double duration_ms;
+            double max_error_percent;
+            bool verified;
+        } test;                            /* test_name, status, csv_file, metrics_json */
+    } u;                                   /* JSONLD_REC_SYSTEM: event_type, details_json */
+} jsonld_record_t;
+
+/* Writer batch period. Producers wake the writer only when the queue is
+ * half full: a wakeup per entry would preempt the caller, inside the
+ * clock's critical section, on a busy core. Otherwise the queue is drained
+ * on this period, or at once for a flush. */
+#define JSONLD_WRITER_PERIOD_NS 1000000000LL
+
+/* inflight_ns while a producer has yet to read the clock: it may take any
+ * stamp from now on, so the writer merges nothing past it */
+#define JSONLD_STAMP_PENDING 1
+
+/* Live loggers, for exiting threads giving back their buffers */
+static pthread_mutex_t g_jsonld_loggers_lock = PTHREAD_MUTEX_INITIALIZER;
+static swclock_jsonld_logger_t* g_jsonld_loggers;
+static uint64_t g_jsonld_next_id = 1;
+
+/* This thread's buffer in up to JSONLD_TLS_ENTRIES loggers */
+#define JSONLD_TLS_ENTRIES 8
+typedef struct {
+    uint64_t logger_id;                    /* 0: unused */
+    swclock_jsonld_logger_t* logger;       /* Dereferenced only while registered */
+    jsonld_tbuf_t* tbuf;                   /* NULL: shared queue */
+} jsonld_tls_entry_t;
+
+static __thread jsonld_tls_entry_t jsonld_tls[JSONLD_TLS_ENTRIES];
+static __thread unsigned jsonld_tls_next;
+static __thread jsonld_tbuf_t* jsonld_tls_pending; /* Buffer of the record being written */
+static pthread_once_t jsonld_tls_once = PTHREAD_ONCE_INIT;
+static pthread_key_t jsonld_tls_key;
+
 /* Forward declarations */
 static int detect_system_context(swclock_system_context_t* ctx);
-static int format_iso8601_ns(uint64_t timestamp_ns, char* buf, size_t buflen);
-static void json_escape_string(const char* src, char* dst, size_t dst_len);
-static int write_jsonld_entry(swclock_jsonld_logger_t* logger, const char* entry);
 static int flush_buffer(swclock_jsonld_logger_t* logger);
+static int open_log_files(swclock_jsonld_logger_t* logger);
+static void close_log_files(swclock_jsonld_logger_t* logger);
+static void stream_free(swclock_jsonld_logger_t* logger);
 static int should_rotate(swclock_jsonld_logger_t* logger);
 static int perform_rotation(swclock_jsonld_logger_t* logger);
-static int compress_file(const char* src_path);
+static int compress_file(const char* src_path, int level, uint64_t* bytes_in, uint64_t* bytes_out);
+static void* jsonld_rotator_main(void* arg);
+static void* jsonld_writer_main(void* arg);
+static int jsonld_drain(swclock_jsonld_logger_t* logger);
+static uint64_t jsonld_mono_ns(void);
 
 /* ========================================================================
  * Lifecycle Functions
@@ -140,26 +314,90 @@ swclock_jsonld_logger_t* swclock_jsonld_init(
         return NULL;
     }
 
+    /* Deflater sized so any full buffer compresses in one call */
+    if (logger->rotation.stream_compress) {
+        int level = logger->rotation.compress_level;
+        logger->zs = calloc(1, sizeof(z_stream));
+        if (logger->zs &&
+            deflateInit2(logger->zs, (level >= 1 && level <= 9) ? level : SWCLOCK_JSONLD_COMPRESS_LEVEL,
+                         Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            free(logger->zs);
+            logger->zs = NULL;
+        }
+        if (logger->zs) {
+            logger->zbuf_size = deflateBound(logger->zs, logger->buffer_size);
+            logger->zbuf = malloc(logger->zbuf_size);
+        }
+        if (!logger->zbuf) {
+            SWCLOCK_JSONLD_ERROR("swclock_jsonld_init: Failed to set up stream compression");
+            stream_free(logger);
+            pthread_mutex_destroy(&logger->lock);
+            free(logger->buffer);
+            free(logger);
+            return NULL;
+        }
+    }
+
     /* Open log file (append mode for JSONL) */
-    logger->fp = fopen(log_path, "a");
-    if (!logger->fp) {
+    if (open_log_files(logger) != 0) {
         SWCLOCK_JSONLD_ERROR("swclock_jsonld_init: Failed to open %s: %s",
                      log_path, strerror(errno));
+        stream_free(logger);
         pthread_mutex_destroy(&logger->lock);
         free(logger->buffer);
         free(logger);
         return NULL;
     }
 
-    /* Get current file size */
-    struct stat st;
-    if (fstat(fileno(logger->fp), &st) == 0) {
-        logger->current_size = st.st_size;
-    }
-
     logger->created_at = time(NULL);
     logger->entry_count = 0;
 
+    /* Record queue and the writer thread that drains it */
+    logger->queue = malloc(sizeof(swclock_ringbuf_t));
+    void* tbufs = NULL;
+    const size_t tbufs_size = SWCLOCK_JSONLD_THREAD_BUFFERS * sizeof(jsonld_tbuf_t);
+    if (!logger->queue || posix_memalign(&tbufs, 64, tbufs_size) != 0) {
+        SWCLOCK_JSONLD_ERROR("swclock_jsonld_init: Failed to allocate queue");
+        free(logger->queue);
+        close_log_files(logger);
+        stream_free(logger);
+        pthread_mutex_destroy(&logger->lock);
+        free(logger->buffer);
+        free(logger);
+        return NULL;
+    }
+    memset(tbufs, 0, tbufs_size);
+    logger->tbufs = tbufs;
+    swclock_ringbuf_init(logger->queue);
+    pthread_mutex_init(&logger->drain_lock, NULL);
+    pthread_cond_init(&logger->writer_cv, NULL);
+    pthread_cond_init(&logger->drain_cv, NULL);
+    pthread_mutex_init(&logger->rot_lock, NULL);
+    pthread_cond_init(&logger->rot_cv, NULL);
+    logger->writer_running = true;
+    if (pthread_create(&logger->writer, NULL, jsonld_writer_main, logger) != 0) {
+        SWCLOCK_JSONLD_ERROR("swclock_jsonld_init: Failed to start writer thread");
+        pthread_cond_destroy(&logger->rot_cv);
+        pthread_mutex_destroy(&logger->rot_lock);
+        pthread_cond_destroy(&logger->writer_cv);
+        pthread_cond_destroy(&logger->drain_cv);
+        pthread_mutex_destroy(&logger->drain_lock);
+        free(logger->tbufs);
+        free(logger->queue);
+        close_log_files(logger);
+        stream_free(logger);
+        pthread_mutex_destroy(&logger->lock);
+        free(logger->buffer);
+        free(logger);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_jsonld_loggers_lock);
+    logger->id = g_jsonld_next_id++;
+    logger->next = g_jsonld_loggers;
+    g_jsonld_loggers = logger;
+    pthread_mutex_unlock(&g_jsonld_loggers_lock);
+
     return logger;
 }
 
@@ -169,18 +407,52 @@ void swclock_jsonld_close(swclock_jsonld_logger_t* logger)
         return;
     }
 
+    /* Threads exiting from now on leave this logger's buffers alone */
+    pthread_mutex_lock(&g_jsonld_loggers_lock);
+    for (swclock_jsonld_logger_t** l = &g_jsonld_loggers; *l; l = &(*l)->next) {
+        if (*l == logger) {
+            *l = logger->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_jsonld_loggers_lock);
+
+    /* Writer formats what is queued, then exits */
+    pthread_mutex_lock(&logger->drain_lock);
+    __atomic_store_n(&logger->writer_running, false, __ATOMIC_RELEASE);
+    pthread_cond_signal(&logger->writer_cv);
+    pthread_mutex_unlock(&logger->drain_lock);
+    pthread_join(logger->writer, NULL);
+
     /* Flush remaining buffer */
     pthread_mutex_lock(&logger->lock);
     flush_buffer(logger);
+    close_log_files(logger);
+    pthread_mutex_unlock(&logger->lock);
 
-    if (logger->fp) {
-        fclose(logger->fp);
-        logger->fp = NULL;
+    /* Rotation worker finishes the queued rotations, then exits */
+    pthread_mutex_lock(&logger->rot_lock);
+    bool rotator = logger->rotator_started;
+    logger->rotator_stop = true;
+    pthread_cond_signal(&logger->rot_cv);
+    pthread_mutex_unlock(&logger->rot_lock);
+    if (rotator) {
+        pthread_join(logger->rotator, NULL);
     }
-    pthread_mutex_unlock(&logger->lock);
 
     /* Cleanup */
+    pthread_cond_destroy(&logger->rot_cv);
+    pthread_mutex_destroy(&logger->rot_lock);
+    pthread_cond_destroy(&logger->writer_cv);
+    pthread_cond_destroy(&logger->drain_cv);
+    pthread_mutex_destroy(&logger->drain_lock);
     pthread_mutex_destroy(&logger->lock);
+    stream_free(logger);
+    for (int i = 0; i < SWCLOCK_JSONLD_THREAD_BUFFERS; i++) {
+        free(logger->tbufs[i].data);
+    }
+    free(logger->tbufs);
+    free(logger->queue);
     free(logger->buffer);
     free(logger);
 }
@@ -191,6 +463,8 @@ int swclock_jsonld_flush(swclock_jsonld_logger_t* logger)
         return -1;
     }
 
+    /* Entries logged before this call reach the file */
+    jsonld_drain(logger);
     pthread_mutex_lock(&logger->lock);
     int ret = flush_buffer(logger);
     pthread_mutex_unlock(&logger->lock);
@@ -199,10 +473,301 @@ int swclock_jsonld_flush(swclock_jsonld_logger_t* logger)
 }
 
 /* ========================================================================
- * Event Logging Functions
+ * Entry Serialization (writer thread)
+ *
+ * Entries are appended straight into the write buffer, with no format
+ * string and no intermediate copy. Output is byte for byte what the
+ * printf formats produced: "%.Nf" is computed from the value scaled by
+ * 10^N, and falls back to snprintf() where the scaled value could round
+ * either way (near a tie, very large, not finite). The date and time up
+ * to the second are cached, since consecutive entries share them.
  * ======================================================================== */
 
-int swclock_jsonld_log_servo(
+/* Entry being appended at the end of the write buffer */
+typedef struct {
+    char* p;                               /* Next byte */
+    char* end;                             /* Entry limit (SWCLOCK_JSONLD_MAX_SIZE - 1) */
+    bool overflow;                         /* Too long: the entry is discarded */
+    uint64_t timestamp_ns;                 /* Entry timestamp (frame index) */
+} jsonld_out_t;
+
+static const char jsonld_digits2[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+/* Scaled values below 2^43 are within 2^-11 of the exact product */
+#define JSONLD_FIXED_FAST_MAX 8796093022208.0
+#define JSONLD_FIXED_TIE_GUARD (1.0 / 1024.0)
+
+static inline void jsonld_put(jsonld_out_t* o, const char* s, size_t n)
+{
+    if (n > (size_t)(o->end - o->p)) {
+        o->overflow = true;
+        return;
+    }
+    memcpy(o->p, s, n);
+    o->p += n;
+}
+
+#define JSONLD_LIT(o, s) jsonld_put((o), (s), sizeof(s) - 1)
+
+static inline void jsonld_putc(jsonld_out_t* o, char c)
+{
+    if (o->p == o->end) {
+        o->overflow = true;
+        return;
+    }
+    *o->p++ = c;
+}
+
+static inline void jsonld_put_str(jsonld_out_t* o, const char* s)
+{
+    jsonld_put(o, s, strlen(s));
+}
+
+/* Exactly `width` digits of v (v < 10^width), two at a time, ending at end */
+static inline void jsonld_digits(char* end, uint64_t v, int width)
+{
+    while (width >= 2) {
+        end -= 2;
+        memcpy(end, &jsonld_digits2[(v % 100) * 2], 2);
+        v /= 100;
+        width -= 2;
+    }
+    if (width) {
+        *--end = (char)('0' + v % 10);
+    }
+}
+
+static void jsonld_put_u64(jsonld_out_t* o, uint64_t v)
+{
+    char buf[20];
+    char* p = buf + sizeof(buf);
+    while (v >= 100) {
+        p -= 2;
+        memcpy(p, &jsonld_digits2[(v % 100) * 2], 2);
+        v /= 100;
+    }
+    if (v >= 10) {
+        p -= 2;
+        memcpy(p, &jsonld_digits2[v * 2], 2);
+    } else {
+        *--p = (char)('0' + v);
+    }
+    jsonld_put(o, p, (size_t)(buf + sizeof(buf) - p));
+}
+
+/* "%ld" */
+static void jsonld_put_i64(jsonld_out_t* o, int64_t v)
+{
+    if (v < 0) {
+        jsonld_putc(o, '-');
+        jsonld_put_u64(o, 0 - (uint64_t)v);
+    } else {
+        jsonld_put_u64(o, (uint64_t)v);
+    }
+}
+
+/* "%.<prec>f", prec <= 12 */
+static void jsonld_put_fixed(jsonld_out_t* o, double v, int prec)
+{
+    static const double scale_d[13] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12
+    };
+    static const uint64_t scale_u[13] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+        100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL
+    };
+
+    /* |v| * 10^prec is rounded once; ties and near-ties go to snprintf */
+    const double a = fabs(v) * scale_d[prec];
+    if (isfinite(v) && a < JSONLD_FIXED_FAST_MAX) {
+        const double whole = floor(a);
+        const double frac = a - whole;
+        if (fabs(frac - 0.5) > JSONLD_FIXED_TIE_GUARD) {
+            const uint64_t n = (uint64_t)whole + (frac > 0.5);
+            if (signbit(v)) {
+                jsonld_putc(o, '-');
+            }
+            jsonld_put_u64(o, n / scale_u[prec]);
+            if (prec > 0) {
+                char buf[13];
+                buf[0] = '.';
+                jsonld_digits(buf + 1 + prec, n % scale_u[prec], prec);
+                jsonld_put(o, buf, (size_t)prec + 1);
+            }
+            return;
+        }
+    }
+
+    char buf[400];
+    int len = snprintf(buf, sizeof(buf), "%.*f", prec, v);
+    if (len < 0 || (size_t)len >= sizeof(buf)) {
+        o->overflow = true;
+        return;
+    }
+    jsonld_put(o, buf, (size_t)len);
+}
+
+static void jsonld_put_bool(jsonld_out_t* o, bool v)
+{
+    if (v) {
+        JSONLD_LIT(o, "true");
+    } else {
+        JSONLD_LIT(o, "false");
+    }
+}
+
+/*
+ * JSON-escaped string, truncated as if escaped into a dst_len buffer (so
+ * long names are cut where they always were)
+ */
+static void jsonld_put_escaped(jsonld_out_t* o, const char* src, size_t dst_len)
+{
+    size_t j = 0;
+    for (size_t i = 0; src[i] != '\0' && j < dst_len - 2; i++) {
+        const char c = src[i];
+        const char* esc = NULL;
+        switch (c) {
+            case '"':  esc = "\\\""; break;
+            case '\\': esc = "\\\\"; break;
+            case '\n': esc = "\\n"; break;
+            case '\r': esc = "\\r"; break;
+            case '\t': esc = "\\t"; break;
+            default: break;
+        }
+        if (esc) {
+            if (j < dst_len - 3) {
+                jsonld_put(o, esc, 2);
+                j += 2;
+            }
+        } else if ((unsigned char)c < 32) {
+            /* Escape control characters */
+            if (j < dst_len - 7) {
+                static const char hex[] = "0123456789abcdef";
+                char u[6] = { '\\', 'u', '0', '0', hex[(unsigned char)c >> 4], hex[c & 0xf] };
+                jsonld_put(o, u, sizeof(u));
+                j += 6;
+            }
+        } else {
+            jsonld_putc(o, c);
+            j++;
+        }
+    }
+}
+
+/* ISO 8601 UTC with nanoseconds: 2026-01-13T18:30:45.123456789Z */
+static void jsonld_put_timestamp(swclock_jsonld_logger_t* logger, jsonld_out_t* o, uint64_t timestamp_ns)
+{
+    const time_t seconds = (time_t)(timestamp_ns / 1000000000ULL);
+    if (!logger->ts_cache_valid || logger->ts_cache_sec != seconds) {
+        struct tm tm_info;
+        if (gmtime_r(&seconds, &tm_info) == NULL) {
+            o->overflow = true;
+            return;
+        }
+        char* c = logger->ts_cache;
+        jsonld_digits(c + 4, (uint64_t)(tm_info.tm_year + 1900), 4);
+        c[4] = '-';
+        jsonld_digits(c + 7, (uint64_t)(tm_info.tm_mon + 1), 2);
+        c[7] = '-';
+        jsonld_digits(c + 10, (uint64_t)tm_info.tm_mday, 2);
+        c[10] = 'T';
+        jsonld_digits(c + 13, (uint64_t)tm_info.tm_hour, 2);
+        c[13] = ':';
+        jsonld_digits(c + 16, (uint64_t)tm_info.tm_min, 2);
+        c[16] = ':';
+        jsonld_digits(c + 19, (uint64_t)tm_info.tm_sec, 2);
+        c[19] = '.';
+        logger->ts_cache_sec = seconds;
+        logger->ts_cache_valid = true;
+    }
+
+    char buf[30];
+    memcpy(buf, logger->ts_cache, 20);
+    jsonld_digits(buf + 29, timestamp_ns % 1000000000ULL, 9);
+    buf[29] = 'Z';
+    jsonld_put(o, buf, sizeof(buf));
+}
+
+/*
+ * Common head of every entry: `head` runs up to "timestamp":" and the
+ * event object is left open
+ */
+static void jsonld_put_head(swclock_jsonld_logger_t* logger, jsonld_out_t* o,
+                            const char* head, size_t head_len, uint64_t timestamp_ns)
+{
+    o->timestamp_ns = timestamp_ns;
+    jsonld_put(o, head, head_len);
+    jsonld_put_timestamp(logger, o, timestamp_ns);
+    JSONLD_LIT(o, "\",\"timestamp_monotonic_ns\":");
+    jsonld_put_u64(o, timestamp_ns);
+    JSONLD_LIT(o, ",\"event\":{");
+}
+
+#define JSONLD_HEAD(logger, o, head, ts) jsonld_put_head((logger), (o), (head), sizeof(head) - 1, (ts))
+
+/*
+ * Start an entry: takes logger->lock, rotates if due and makes room for
+ * SWCLOCK_JSONLD_MAX_SIZE bytes in the write buffer. On success the lock
+ * is held until jsonld_entry_end().
+ */
+static int jsonld_entry_begin(swclock_jsonld_logger_t* logger, jsonld_out_t* o)
+{
+    pthread_mutex_lock(&logger->lock);
+
+    /* Check if rotation is needed; a deferred rotation keeps the current file */
+    if (logger->rotation.enabled && should_rotate(logger)) {
+        perform_rotation(logger);
+    }
+    if (!logger->fp) {
+        pthread_mutex_unlock(&logger->lock);
+        return -1;
+    }
+
+    /* If an entry might not fit in the buffer, flush first */
+    if (logger->buffer_pos + SWCLOCK_JSONLD_MAX_SIZE > logger->buffer_size) {
+        if (flush_buffer(logger) != 0) {
+            pthread_mutex_unlock(&logger->lock);
+            return -1;
+        }
+    }
+
+    o->p = logger->buffer + logger->buffer_pos;
+    o->end = o->p + SWCLOCK_JSONLD_MAX_SIZE - 1;
+    o->overflow = false;
+    return 0;
+}
+
+/* Finish an entry: commit it (unless it overflowed) and release logger->lock */
+static int jsonld_entry_end(swclock_jsonld_logger_t* logger, jsonld_out_t* o)
+{
+    if (o->overflow) {
+        pthread_mutex_unlock(&logger->lock);
+        return -1;
+    }
+
+    if (logger->buffer_pos == 0) {
+        logger->frame_first_ts = o->timestamp_ns;
+    }
+    logger->buffer_pos = (size_t)(o->p - logger->buffer);
+    logger->entry_count++;
+    logger->frame_entries++;
+
+    /* Flush if buffer is getting full (>90%) or every 100 entries */
+    if (logger->buffer_pos > (logger->buffer_size * 9 / 10) ||
+        (logger->entry_count % 100) == 0) {
+        flush_buffer(logger);
+    }
+
+    pthread_mutex_unlock(&logger->lock);
+    return 0;
+}
+
+/* ========================================================================
+ * Entry Rendering (writer thread)
+ * ======================================================================== */
+
+static int render_servo(
     swclock_jsonld_logger_t* logger,
     uint64_t timestamp_mono_ns,
     double freq_ppm,
@@ -212,55 +777,52 @@ int swclock_jsonld_log_servo(
     double pi_int_error_s,
     bool servo_enabled)
 {
-    if (!logger) {
+    jsonld_out_t o;
+    if (!logger || jsonld_entry_begin(logger, &o) != 0) {
         return -1;
     }
 
-    char entry[SWCLOCK_JSONLD_MAX_SIZE];
-    char ts_buf[64];
-    format_iso8601_ns(timestamp_mono_ns, ts_buf, sizeof(ts_buf));
-
-    snprintf(entry, sizeof(entry),
+    JSONLD_HEAD(logger, &o,
         "{"
         "\"@context\":{\"@vocab\":\"https://swclock.org/vocab#\","
         "\"ieee1588\":\"https://standards.ieee.org/1588/vocab#\"},"
         "\"@type\":\"ServoStateUpdate\","
-        "\"timestamp\":\"%s\","
-        "\"timestamp_monotonic_ns\":%llu,"
-        "\"event\":{"
-        "\"freq_ppm\":%.6f,"
-        "\"phase_error_ns\":%ld,"
-        "\"time_error_ns\":%ld,"
-        "\"pi_freq_ppm\":%.6f,"
-        "\"pi_int_error_s\":%.12f,"
-        "\"servo_enabled\":%s"
+        "\"timestamp\":\"",
+        timestamp_mono_ns);
+    JSONLD_LIT(&o, "\"freq_ppm\":");
+    jsonld_put_fixed(&o, freq_ppm, 6);
+    JSONLD_LIT(&o, ",\"phase_error_ns\":");
+    jsonld_put_i64(&o, phase_error_ns);
+    JSONLD_LIT(&o, ",\"time_error_ns\":");
+    jsonld_put_i64(&o, time_error_ns);
+    JSONLD_LIT(&o, ",\"pi_freq_ppm\":");
+    jsonld_put_fixed(&o, pi_freq_ppm, 6);
+    JSONLD_LIT(&o, ",\"pi_int_error_s\":");
+    jsonld_put_fixed(&o, pi_int_error_s, 12);
+    JSONLD_LIT(&o, ",\"servo_enabled\":");
+    jsonld_put_bool(&o, servo_enabled);
+    JSONLD_LIT(&o,
         "},"
         "\"system\":{"
-        "\"hostname\":\"%s\","
-        "\"os\":\"%s\","
-        "\"kernel\":\"%s\","
-        "\"arch\":\"%s\","
-        "\"swclock_version\":\"%s\""
+        "\"hostname\":\"");
+    jsonld_put_str(&o, logger->system.hostname);
+    JSONLD_LIT(&o, "\",\"os\":\"");
+    jsonld_put_str(&o, logger->system.os);
+    JSONLD_LIT(&o, "\",\"kernel\":\"");
+    jsonld_put_str(&o, logger->system.kernel);
+    JSONLD_LIT(&o, "\",\"arch\":\"");
+    jsonld_put_str(&o, logger->system.arch);
+    JSONLD_LIT(&o, "\",\"swclock_version\":\"");
+    jsonld_put_str(&o, logger->system.swclock_version);
+    JSONLD_LIT(&o,
+        "\""
         "}"
-        "}\n",
-        ts_buf,
-        (unsigned long long)timestamp_mono_ns,
-        freq_ppm,
-        (long)phase_error_ns,
-        (long)time_error_ns,
-        pi_freq_ppm,
-        pi_int_error_s,
-        servo_enabled ? "true" : "false",
-        logger->system.hostname,
-        logger->system.os,
-        logger->system.kernel,
-        logger->system.arch,
-        logger->system.swclock_version);
-
-    return write_jsonld_entry(logger, entry);
+        "}\n");
+
+    return jsonld_entry_end(logger, &o);
 }
 
-int swclock_jsonld_log_adjustment(
+static int render_adjustment(
     swclock_jsonld_logger_t* logger,
     uint64_t timestamp_mono_ns,
     const char* adjustment_type,
@@ -268,41 +830,33 @@ int swclock_jsonld_log_adjustment(
     int64_t before_offset_ns,
     int64_t after_offset_ns)
 {
-    if (!logger || !adjustment_type) {
+    jsonld_out_t o;
+    if (!logger || !adjustment_type || jsonld_entry_begin(logger, &o) != 0) {
         return -1;
     }
 
-    char entry[SWCLOCK_JSONLD_MAX_SIZE];
-    char ts_buf[64];
-    char escaped_type[128];
-
-    format_iso8601_ns(timestamp_mono_ns, ts_buf, sizeof(ts_buf));
-    json_escape_string(adjustment_type, escaped_type, sizeof(escaped_type));
-
-    snprintf(entry, sizeof(entry),
+    JSONLD_HEAD(logger, &o,
         "{"
         "\"@context\":{\"@vocab\":\"https://swclock.org/vocab#\"},"
         "\"@type\":\"TimeAdjustment\","
-        "\"timestamp\":\"%s\","
-        "\"timestamp_monotonic_ns\":%llu,"
-        "\"event\":{"
-        "\"adjustment_type\":\"%s\","
-        "\"value\":%.6f,"
-        "\"before_offset_ns\":%ld,"
-        "\"after_offset_ns\":%ld"
+        "\"timestamp\":\"",
+        timestamp_mono_ns);
+    JSONLD_LIT(&o, "\"adjustment_type\":\"");
+    jsonld_put_escaped(&o, adjustment_type, 128);
+    JSONLD_LIT(&o, "\",\"value\":");
+    jsonld_put_fixed(&o, value, 6);
+    JSONLD_LIT(&o, ",\"before_offset_ns\":");
+    jsonld_put_i64(&o, before_offset_ns);
+    JSONLD_LIT(&o, ",\"after_offset_ns\":");
+    jsonld_put_i64(&o, after_offset_ns);
+    JSONLD_LIT(&o,
         "}"
-        "}\n",
-        ts_buf,
-        (unsigned long long)timestamp_mono_ns,
-        escaped_type,
-        value,
-        (long)before_offset_ns,
-        (long)after_offset_ns);
+        "}\n");
 
-    return write_jsonld_entry(logger, entry);
+    return jsonld_entry_end(logger, &o);
 }
 
-int swclock_jsonld_log_pi_update(
+static int render_pi_update(
     swclock_jsonld_logger_t* logger,
     uint64_t timestamp_mono_ns,
     double kp,
@@ -311,40 +865,35 @@ int swclock_jsonld_log_pi_update(
     double output_ppm,
     double integral_state)
 {
-    if (!logger) {
+    jsonld_out_t o;
+    if (!logger || jsonld_entry_begin(logger, &o) != 0) {
         return -1;
     }
 
-    char entry[SWCLOCK_JSONLD_MAX_SIZE];
-    char ts_buf[64];
-    format_iso8601_ns(timestamp_mono_ns, ts_buf, sizeof(ts_buf));
-
-    snprintf(entry, sizeof(entry),
+    JSONLD_HEAD(logger, &o,
         "{"
         "\"@context\":{\"@vocab\":\"https://swclock.org/vocab#\"},"
         "\"@type\":\"PIUpdate\","
-        "\"timestamp\":\"%s\","
-        "\"timestamp_monotonic_ns\":%llu,"
-        "\"event\":{"
-        "\"kp\":%.3f,"
-        "\"ki\":%.3f,"
-        "\"error_s\":%.12f,"
-        "\"output_ppm\":%.6f,"
-        "\"integral_state\":%.12f"
+        "\"timestamp\":\"",
+        timestamp_mono_ns);
+    JSONLD_LIT(&o, "\"kp\":");
+    jsonld_put_fixed(&o, kp, 3);
+    JSONLD_LIT(&o, ",\"ki\":");
+    jsonld_put_fixed(&o, ki, 3);
+    JSONLD_LIT(&o, ",\"error_s\":");
+    jsonld_put_fixed(&o, error_s, 12);
+    JSONLD_LIT(&o, ",\"output_ppm\":");
+    jsonld_put_fixed(&o, output_ppm, 6);
+    JSONLD_LIT(&o, ",\"integral_state\":");
+    jsonld_put_fixed(&o, integral_state, 12);
+    JSONLD_LIT(&o,
         "}"
-        "}\n",
-        ts_buf,
-        (unsigned long long)timestamp_mono_ns,
-        kp,
-        ki,
-        error_s,
-        output_ppm,
-        integral_state);
+        "}\n");
 
-    return write_jsonld_entry(logger, entry);
+    return jsonld_entry_end(logger, &o);
 }
 
-int swclock_jsonld_log_alert(
+static int render_alert(
     swclock_jsonld_logger_t* logger,
     uint64_t timestamp_mono_ns,
     const char* metric_name,
@@ -353,167 +902,114 @@ int swclock_jsonld_log_alert(
     const char* severity,
     const char* standard)
 {
-    if (!logger || !metric_name || !severity) {
+    jsonld_out_t o;
+    if (!logger || !metric_name || !severity || jsonld_entry_begin(logger, &o) != 0) {
         return -1;
     }
 
-    char entry[SWCLOCK_JSONLD_MAX_SIZE];
-    char ts_buf[64];
-    char escaped_metric[128], escaped_severity[64], escaped_standard[128];
-
-    format_iso8601_ns(timestamp_mono_ns, ts_buf, sizeof(ts_buf));
-    json_escape_string(metric_name, escaped_metric, sizeof(escaped_metric));
-    json_escape_string(severity, escaped_severity, sizeof(escaped_severity));
-    json_escape_string(standard ? standard : "", escaped_standard, sizeof(escaped_standard));
-
-    snprintf(entry, sizeof(entry),
+    JSONLD_HEAD(logger, &o,
         "{"
         "\"@context\":{\"@vocab\":\"https://swclock.org/vocab#\"},"
         "\"@type\":\"ThresholdAlert\","
-        "\"timestamp\":\"%s\","
-        "\"timestamp_monotonic_ns\":%llu,"
-        "\"event\":{"
-        "\"metric\":\"%s\","
-        "\"value\":%.6f,"
-        "\"threshold\":%.6f,"
-        "\"severity\":\"%s\","
-        "\"standard\":\"%s\""
+        "\"timestamp\":\"",
+        timestamp_mono_ns);
+    JSONLD_LIT(&o, "\"metric\":\"");
+    jsonld_put_escaped(&o, metric_name, 128);
+    JSONLD_LIT(&o, "\",\"value\":");
+    jsonld_put_fixed(&o, value_ns, 6);
+    JSONLD_LIT(&o, ",\"threshold\":");
+    jsonld_put_fixed(&o, threshold_ns, 6);
+    JSONLD_LIT(&o, ",\"severity\":\"");
+    jsonld_put_escaped(&o, severity, 64);
+    JSONLD_LIT(&o, "\",\"standard\":\"");
+    jsonld_put_escaped(&o, standard ? standard : "", 128);
+    JSONLD_LIT(&o,
+        "\""
         "}"
-        "}\n",
-        ts_buf,
-        (unsigned long long)timestamp_mono_ns,
-        escaped_metric,
-        value_ns,
-        threshold_ns,
-        escaped_severity,
-        escaped_standard);
+        "}\n");
 
-    return write_jsonld_entry(logger, entry);
+    return jsonld_entry_end(logger, &o);
 }
 
-int swclock_jsonld_log_system(
+static int render_system(
     swclock_jsonld_logger_t* logger,
     uint64_t timestamp_mono_ns,
     const char* event_type,
     const char* details_json)
 {
-    if (!logger || !event_type) {
+    jsonld_out_t o;
+    if (!logger || !event_type || jsonld_entry_begin(logger, &o) != 0) {
         return -1;
     }
 
-    char entry[SWCLOCK_JSONLD_MAX_SIZE];
-    char ts_buf[64];
-    char escaped_type[128];
-
-    format_iso8601_ns(timestamp_mono_ns, ts_buf, sizeof(ts_buf));
-    json_escape_string(event_type, escaped_type, sizeof(escaped_type));
-    // details_json is already JSON, don't escape it
-
-    snprintf(entry, sizeof(entry),
+    JSONLD_HEAD(logger, &o,
         "{"
         "\"@context\":{\"@vocab\":\"https://swclock.org/vocab#\"},"
         "\"@type\":\"SystemEvent\","
-        "\"timestamp\":\"%s\","
-        "\"timestamp_monotonic_ns\":%llu,"
-        "\"event\":{"
-        "\"event_type\":\"%s\","
-        "\"details\":%s"
+        "\"timestamp\":\"",
+        timestamp_mono_ns);
+    JSONLD_LIT(&o, "\"event_type\":\"");
+    jsonld_put_escaped(&o, event_type, 128);
+    JSONLD_LIT(&o, "\",\"details\":");
+    // details_json is already JSON, don't escape it
+    jsonld_put_str(&o, details_json ? details_json : "{}");
+    JSONLD_LIT(&o,
         "}"
-        "}\n",
-        ts_buf,
-        (unsigned long long)timestamp_mono_ns,
-        escaped_type,
-        details_json ? details_json : "{}");
+        "}\n");
 
-    return write_jsonld_entry(logger, entry);
+    return jsonld_entry_end(logger, &o);
 }
 
-int swclock_jsonld_log_metrics(
+static int render_metrics(
     swclock_jsonld_logger_t* logger,
     uint64_t timestamp_mono_ns,
     uint32_t sample_count,
-    double window_duration_s,
-    double mean_te_ns,
-    double std_te_ns,
-    double min_te_ns,
-    double max_te_ns,
-    double p95_te_ns,
-    double p99_te_ns,
-    double mtie_1s_ns,
-    double mtie_10s_ns,
-    double mtie_30s_ns,
-    double mtie_60s_ns,
-    double tdev_0_1s_ns,
-    double tdev_1s_ns,
-    double tdev_10s_ns,
+    const double v[14],
     bool itu_g8260_pass)
 {
-    if (!logger) {
+    /* v[]: window_duration_s, then the members below in order */
+    static const char* const keys[13] = {
+        ",\"te_stats\":{\"mean_ns\":", ",\"std_ns\":", ",\"min_ns\":", ",\"max_ns\":",
+        ",\"p95_ns\":", ",\"p99_ns\":",
+        "},\"mtie\":{\"1s_ns\":", ",\"10s_ns\":", ",\"30s_ns\":", ",\"60s_ns\":",
+        "},\"tdev\":{\"0_1s_ns\":", ",\"1s_ns\":", ",\"10s_ns\":"
+    };
+
+    jsonld_out_t o;
+    if (!logger || jsonld_entry_begin(logger, &o) != 0) {
         return -1;
     }
 
-    char entry[SWCLOCK_JSONLD_MAX_SIZE];
-    char ts_buf[64];
-    format_iso8601_ns(timestamp_mono_ns, ts_buf, sizeof(ts_buf));
-
-    snprintf(entry, sizeof(entry),
+    JSONLD_HEAD(logger, &o,
         "{"
         "\"@context\":{\"@vocab\":\"https://swclock.org/vocab#\"},"
         "\"@type\":\"MetricsSnapshot\","
-        "\"timestamp\":\"%s\","
-        "\"timestamp_monotonic_ns\":%llu,"
-        "\"event\":{"
-        "\"sample_count\":%u,"
-        "\"window_duration_s\":%.2f,"
-        "\"te_stats\":{"
-        "\"mean_ns\":%.2f,"
-        "\"std_ns\":%.2f,"
-        "\"min_ns\":%.2f,"
-        "\"max_ns\":%.2f,"
-        "\"p95_ns\":%.2f,"
-        "\"p99_ns\":%.2f"
-        "},"
-        "\"mtie\":{"
-        "\"1s_ns\":%.2f,"
-        "\"10s_ns\":%.2f,"
-        "\"30s_ns\":%.2f,"
-        "\"60s_ns\":%.2f"
-        "},"
-        "\"tdev\":{"
-        "\"0_1s_ns\":%.2f,"
-        "\"1s_ns\":%.2f,"
-        "\"10s_ns\":%.2f"
+        "\"timestamp\":\"",
+        timestamp_mono_ns);
+    JSONLD_LIT(&o, "\"sample_count\":");
+    jsonld_put_u64(&o, sample_count);
+    JSONLD_LIT(&o, ",\"window_duration_s\":");
+    jsonld_put_fixed(&o, v[0], 2);
+    for (int i = 0; i < 13; i++) {
+        jsonld_put_str(&o, keys[i]);
+        jsonld_put_fixed(&o, v[i + 1], 2);
+    }
+    JSONLD_LIT(&o,
         "},"
         "\"compliance\":{"
         "\"itu_g8260_class_c\":{"
-        "\"overall_pass\":%s"
+        "\"overall_pass\":");
+    jsonld_put_bool(&o, itu_g8260_pass);
+    JSONLD_LIT(&o,
         "}"
         "}"
         "}"
-        "}\n",
-        ts_buf,
-        (unsigned long long)timestamp_mono_ns,
-        (unsigned)sample_count,
-        window_duration_s,
-        mean_te_ns,
-        std_te_ns,
-        min_te_ns,
-        max_te_ns,
-        p95_te_ns,
-        p99_te_ns,
-        mtie_1s_ns,
-        mtie_10s_ns,
-        mtie_30s_ns,
-        mtie_60s_ns,
-        tdev_0_1s_ns,
-        tdev_1s_ns,
-        tdev_10s_ns,
-        itu_g8260_pass ? "true" : "false");
-
-    return write_jsonld_entry(logger, entry);
+        "}\n");
+
+    return jsonld_entry_end(logger, &o);
 }
 
-int swclock_jsonld_log_test(
+static int render_test(
     swclock_jsonld_logger_t* logger,
     uint64_t timestamp_mono_ns,
     const char* test_name,
@@ -524,251 +1020,860 @@ int swclock_jsonld_log_test(
     bool verified,
     double max_error_percent)
 {
-    if (!logger || !test_name || !status) {
+    jsonld_out_t o;
+    if (!logger || !test_name || !status || jsonld_entry_begin(logger, &o) != 0) {
         return -1;
     }
 
-    char entry[SWCLOCK_JSONLD_MAX_SIZE];
-    char ts_buf[64];
-    char escaped_test[256], escaped_status[64], escaped_csv[512];
-
-    format_iso8601_ns(timestamp_mono_ns, ts_buf, sizeof(ts_buf));
-    json_escape_string(test_name, escaped_test, sizeof(escaped_test));
-    json_escape_string(status, escaped_status, sizeof(escaped_status));
-    json_escape_string(csv_file ? csv_file : "", escaped_csv, sizeof(escaped_csv));
-    // metrics_json is already JSON, don't escape it
-
-    snprintf(entry, sizeof(entry),
+    JSONLD_HEAD(logger, &o,
         "{"
         "\"@context\":{\"@vocab\":\"https://swclock.org/vocab#\"},"
         "\"@type\":\"TestResult\","
-        "\"timestamp\":\"%s\","
-        "\"timestamp_monotonic_ns\":%llu,"
-        "\"event\":{"
-        "\"test_name\":\"%s\","
-        "\"status\":\"%s\","
-        "\"duration_ms\":%.2f,"
-        "\"csv_file\":\"%s\","
-        "\"metrics\":%s,"
+        "\"timestamp\":\"",
+        timestamp_mono_ns);
+    JSONLD_LIT(&o, "\"test_name\":\"");
+    jsonld_put_escaped(&o, test_name, 256);
+    JSONLD_LIT(&o, "\",\"status\":\"");
+    jsonld_put_escaped(&o, status, 64);
+    JSONLD_LIT(&o, "\",\"duration_ms\":");
+    jsonld_put_fixed(&o, duration_ms, 2);
+    JSONLD_LIT(&o, ",\"csv_file\":\"");
+    jsonld_put_escaped(&o, csv_file ? csv_file : "", 512);
+    JSONLD_LIT(&o, "\",\"metrics\":");
+    // metrics_json is already JSON, don't escape it
+    jsonld_put_str(&o, metrics_json ? metrics_json : "{}");
+    JSONLD_LIT(&o,
+        ","
         "\"validation\":{"
-        "\"verified\":%s,"
-        "\"max_error_percent\":%.2f"
+        "\"verified\":");
+    jsonld_put_bool(&o, verified);
+    JSONLD_LIT(&o, ",\"max_error_percent\":");
+    jsonld_put_fixed(&o, max_error_percent, 2);
+    JSONLD_LIT(&o,
         "}"
         "}"
-        "}\n",
-        ts_buf,
-        (unsigned long long)timestamp_mono_ns,
-        escaped_test,
-        escaped_status,
-        duration_ms,
-        escaped_csv,
-        metrics_json ? metrics_json : "{}",
-        verified ? "true" : "false",
-        max_error_percent);
+        "}\n");
 
-    return write_jsonld_entry(logger, entry);
+    return jsonld_entry_end(logger, &o);
 }
 
 /* ========================================================================
- * Management Functions
+ * Event Logging Functions
+ *
+ * Callers (the servo poll, adjtime, under the clock's write lock) only copy
+ * their arguments into their thread's append buffer; formatting, buffering,
+ * rotation and compression all happen on the writer thread. A full buffer
+ * drops the entry and returns -1.
  * ======================================================================== */
 
-int swclock_jsonld_rotate(swclock_jsonld_logger_t* logger)
+/* Give up this thread's buffer in e's logger, if the logger is still open */
+static void jsonld_tls_release(jsonld_tls_entry_t* e)
 {
-    if (!logger) {
-        return -1;
+    if (e->tbuf) {
+        pthread_mutex_lock(&g_jsonld_loggers_lock);
+        for (swclock_jsonld_logger_t* l = g_jsonld_loggers; l; l = l->next) {
+            if (l == e->logger && l->id == e->logger_id) {
+                __atomic_store_n(&e->tbuf->state, JSONLD_TBUF_ORPHANED, __ATOMIC_RELEASE);
+                break;
+            }
+        }
+        pthread_mutex_unlock(&g_jsonld_loggers_lock);
     }
+    memset(e, 0, sizeof(*e));
+}
 
-    pthread_mutex_lock(&logger->lock);
-    int ret = perform_rotation(logger);
-    pthread_mutex_unlock(&logger->lock);
+static void jsonld_tls_exit(void* unused)
+{
+    (void)unused;
+    for (int i = 0; i < JSONLD_TLS_ENTRIES; i++) {
+        if (jsonld_tls[i].logger_id) {
+            jsonld_tls_release(&jsonld_tls[i]);
+        }
+    }
+}
 
-    return ret;
+static void jsonld_tls_key_create(void)
+{
+    pthread_key_create(&jsonld_tls_key, jsonld_tls_exit);
 }
 
-size_t swclock_jsonld_get_size(swclock_jsonld_logger_t* logger)
+/* This thread's append buffer; claimed on its first call. NULL: shared queue */
+static jsonld_tbuf_t* jsonld_thread_buffer(swclock_jsonld_logger_t* logger)
 {
-    if (!logger) {
-        return 0;
+    for (int i = 0; i < JSONLD_TLS_ENTRIES; i++) {
+        if (jsonld_tls[i].logger_id == logger->id) {
+            return jsonld_tls[i].tbuf;
+        }
     }
 
-    pthread_mutex_lock(&logger->lock);
-    size_t size = logger->current_size + logger->buffer_pos;
-    pthread_mutex_unlock(&logger->lock);
+    jsonld_tbuf_t* tbuf = NULL;
+    for (int i = 0; i < SWCLOCK_JSONLD_THREAD_BUFFERS && !tbuf; i++) {
+        uint32_t expected = JSONLD_TBUF_FREE;
+        if (__atomic_load_n(&logger->tbufs[i].state, __ATOMIC_RELAXED) == JSONLD_TBUF_FREE &&
+            __atomic_compare_exchange_n(&logger->tbufs[i].state, &expected, JSONLD_TBUF_OWNED,
+                                        false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            tbuf = &logger->tbufs[i];
+        }
+    }
+    if (tbuf && !tbuf->data) {
+        /* Kept for later owners; freed with the logger */
+        tbuf->data = malloc(SWCLOCK_JSONLD_THREAD_BUFFER_SIZE);
+        if (!tbuf->data) {
+            __atomic_store_n(&tbuf->state, JSONLD_TBUF_FREE, __ATOMIC_RELEASE);
+            tbuf = NULL;
+        } else {
+            /* Fault the pages in now rather than during the first lap */
+            memset(tbuf->data, 0, SWCLOCK_JSONLD_THREAD_BUFFER_SIZE);
+        }
+    }
 
-    return size;
+    /* The key's destructor gives the buffer back when the thread exits */
+    pthread_once(&jsonld_tls_once, jsonld_tls_key_create);
+    pthread_setspecific(jsonld_tls_key, (void*)1);
+
+    jsonld_tls_entry_t* e = NULL;
+    for (int i = 0; i < JSONLD_TLS_ENTRIES && !e; i++) {
+        if (jsonld_tls[i].logger_id == 0) {
+            e = &jsonld_tls[i];
+        }
+    }
+    if (!e) {
+        e = &jsonld_tls[jsonld_tls_next++ % JSONLD_TLS_ENTRIES];
+        jsonld_tls_release(e);
+    }
+    e->logger_id = logger->id;
+    e->logger = logger;
+    e->tbuf = tbuf;
+    return tbuf;
 }
 
-uint64_t swclock_jsonld_get_count(swclock_jsonld_logger_t* logger)
+/* Owner: room for a size-byte record, or NULL when the writer is a buffer behind */
+static void* jsonld_tbuf_reserve(jsonld_tbuf_t* tbuf, size_t size)
 {
-    if (!logger) {
-        return 0;
+    const uint64_t rec = sizeof(jsonld_tbuf_hdr_t) + ((size + 7) & ~(uint64_t)7);
+    if (rec > SWCLOCK_JSONLD_THREAD_BUFFER_SIZE / 2) {
+        return NULL;
     }
 
-    pthread_mutex_lock(&logger->lock);
-    uint64_t count = logger->entry_count;
-    pthread_mutex_unlock(&logger->lock);
+    uint64_t head = tbuf->head;
+    uint64_t off = head & JSONLD_TBUF_MASK;
+    const uint64_t pad = (off + rec > SWCLOCK_JSONLD_THREAD_BUFFER_SIZE) ?
+                         SWCLOCK_JSONLD_THREAD_BUFFER_SIZE - off : 0;
+    if (head + pad + rec - tbuf->tail_cache > SWCLOCK_JSONLD_THREAD_BUFFER_SIZE) {
+        tbuf->tail_cache = __atomic_load_n(&tbuf->tail, __ATOMIC_ACQUIRE);
+        if (head + pad + rec - tbuf->tail_cache > SWCLOCK_JSONLD_THREAD_BUFFER_SIZE) {
+            return NULL;
+        }
+    }
 
-    return count;
+    /* Published together with the record */
+    if (pad) {
+        jsonld_tbuf_hdr_t* filler = (jsonld_tbuf_hdr_t*)(tbuf->data + off);
+        filler->size = (uint32_t)pad;
+        filler->pad = 1;
+        head += pad;
+        off = 0;
+    }
+    jsonld_tbuf_hdr_t* hdr = (jsonld_tbuf_hdr_t*)(tbuf->data + off);
+    hdr->size = (uint32_t)rec;
+    hdr->pad = 0;
+    tbuf->reserved = head + rec;
+    return hdr + 1;
 }
 
-/* ========================================================================
- * Helper Functions
- * ======================================================================== */
-
-static int detect_system_context(swclock_system_context_t* ctx)
+/* Reserve a record with room for nstrings strings; NULL strings become "" */
+static jsonld_record_t* jsonld_reserve(
+    swclock_jsonld_logger_t* logger,
+    jsonld_rec_kind_t kind,
+    uint64_t timestamp_ns,
+    size_t nstrings,
+    const char* const* strings,
+    size_t* lens)
 {
-    if (!ctx) {
-        return -1;
+    size_t size = sizeof(jsonld_record_t);
+    for (size_t i = 0; i < nstrings; i++) {
+        lens[i] = strings[i] ? strnlen(strings[i], SWCLOCK_JSONLD_MAX_SIZE - 1) : 0;
+        size += lens[i] + 1;
     }
 
-    /* Get hostname */
-    if (gethostname(ctx->hostname, sizeof(ctx->hostname)) != 0) {
-        strncpy(ctx->hostname, "unknown", sizeof(ctx->hostname) - 1);
+    jsonld_tbuf_t* tbuf = jsonld_thread_buffer(logger);
+    jsonld_record_t* rec;
+    if (tbuf) {
+        rec = jsonld_tbuf_reserve(tbuf, size);
+        if (!rec) {
+            __atomic_fetch_add(&tbuf->dropped, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    } else {
+        rec = swclock_ringbuf_reserve(logger->queue, size);
+        if (!rec) {
+            __atomic_fetch_add(&logger->dropped, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
     }
-
-    /* Get OS and kernel info */
-    struct utsname uts;
-    if (uname(&uts) == 0) {
-        strncpy(ctx->os, uts.sysname, sizeof(ctx->os) - 1);
-        strncpy(ctx->kernel, uts.release, sizeof(ctx->kernel) - 1);
-        strncpy(ctx->arch, uts.machine, sizeof(ctx->arch) - 1);
+    jsonld_tls_pending = tbuf;
+    rec->kind = kind;
+    rec->nstrings = (uint32_t)nstrings;
+    rec->timestamp_ns = timestamp_ns;
+    if (tbuf) {
+        /* Announced before the clock is read, so a writer pass that reads
+           the clock later sees the record in flight (see jsonld_merge()) */
+        __atomic_store_n(&tbuf->inflight_ns, JSONLD_STAMP_PENDING, __ATOMIC_SEQ_CST);
+        rec->order_ns = jsonld_mono_ns();
+        __atomic_store_n(&tbuf->inflight_ns, rec->order_ns, __ATOMIC_RELAXED);
     } else {
-        strncpy(ctx->os, "unknown", sizeof(ctx->os) - 1);
-        strncpy(ctx->kernel, "unknown", sizeof(ctx->kernel) - 1);
-        strncpy(ctx->arch, "unknown", sizeof(ctx->arch) - 1);
+        rec->order_ns = jsonld_mono_ns();
     }
 
-    /* SwClock version - this should ideally come from a build-time constant */
-    strncpy(ctx->swclock_version, SWCLOCK_SIF_VERSION, sizeof(ctx->swclock_version) - 1);
+    char* p = (char*)(rec + 1);
+    for (size_t i = 0; i < nstrings; i++) {
+        if (lens[i]) memcpy(p, strings[i], lens[i]);
+        p[lens[i]] = '\0';
+        p += lens[i] + 1;
+    }
+    return rec;
+}
+
+static int jsonld_commit(swclock_jsonld_logger_t* logger, jsonld_record_t* rec)
+{
+    bool half_full;
+    jsonld_tbuf_t* tbuf = jsonld_tls_pending;
+    if (tbuf) {
+        __atomic_store_n(&tbuf->head, tbuf->reserved, __ATOMIC_RELEASE);
+        __atomic_store_n(&tbuf->inflight_ns, 0, __ATOMIC_RELEASE);
+        half_full = tbuf->reserved - tbuf->tail_cache > SWCLOCK_JSONLD_THREAD_BUFFER_SIZE / 2;
+        if (half_full) {
+            tbuf->tail_cache = __atomic_load_n(&tbuf->tail, __ATOMIC_ACQUIRE);
+            half_full = tbuf->reserved - tbuf->tail_cache > SWCLOCK_JSONLD_THREAD_BUFFER_SIZE / 2;
+        }
+    } else {
+        swclock_ringbuf_commit(logger->queue, rec);
+        half_full = swclock_ringbuf_used(logger->queue) > SWCLOCK_RINGBUF_SIZE / 2;
+    }
 
+    /* Rare: one producer per writer pass rings once its buffer is half full */
+    if (half_full && !__atomic_load_n(&logger->wake_sent, __ATOMIC_RELAXED) &&
+        !__atomic_exchange_n(&logger->wake_sent, true, __ATOMIC_ACQ_REL)) {
+        pthread_mutex_lock(&logger->drain_lock);
+        pthread_cond_signal(&logger->writer_cv);
+        pthread_mutex_unlock(&logger->drain_lock);
+    }
     return 0;
 }
 
-static int format_iso8601_ns(uint64_t timestamp_ns, char* buf, size_t buflen)
+int swclock_jsonld_log_servo(
+    swclock_jsonld_logger_t* logger,
+    uint64_t timestamp_mono_ns,
+    double freq_ppm,
+    int64_t phase_error_ns,
+    int64_t time_error_ns,
+    double pi_freq_ppm,
+    double pi_int_error_s,
+    bool servo_enabled)
 {
-    if (!buf || buflen < 64) {
+    if (!logger) {
         return -1;
     }
 
-    /* Convert nanoseconds to seconds and fractional part */
-    time_t seconds = timestamp_ns / 1000000000ULL;
-    uint32_t nanoseconds = timestamp_ns % 1000000000ULL;
+    jsonld_record_t* rec = jsonld_reserve(logger, JSONLD_REC_SERVO, timestamp_mono_ns, 0, NULL, NULL);
+    if (!rec) {
+        return -1;
+    }
+    rec->u.servo.freq_ppm = freq_ppm;
+    rec->u.servo.phase_error_ns = phase_error_ns;
+    rec->u.servo.time_error_ns = time_error_ns;
+    rec->u.servo.pi_freq_ppm = pi_freq_ppm;
+    rec->u.servo.pi_int_error_s = pi_int_error_s;
+    rec->u.servo.servo_enabled = servo_enabled;
+    return jsonld_commit(logger, rec);
+}
 
-    /* Format ISO 8601 with UTC timezone */
-    struct tm tm_info;
-    if (gmtime_r(&seconds, &tm_info) == NULL) {
+int swclock_jsonld_log_adjustment(
+    swclock_jsonld_logger_t* logger,
+    uint64_t timestamp_mono_ns,
+    const char* adjustment_type,
+    double value,
+    int64_t before_offset_ns,
+    int64_t after_offset_ns)
+{
+    if (!logger || !adjustment_type) {
         return -1;
     }
 
-    /* Format: 2026-01-13T18:30:45.123456789Z */
-    snprintf(buf, buflen, "%04d-%02d-%02dT%02d:%02d:%02d.%09uZ",
-             tm_info.tm_year + 1900,
-             tm_info.tm_mon + 1,
-             tm_info.tm_mday,
-             tm_info.tm_hour,
-             tm_info.tm_min,
-             tm_info.tm_sec,
-             nanoseconds);
+    const char* strings[1] = { adjustment_type };
+    size_t lens[1];
+    jsonld_record_t* rec = jsonld_reserve(logger, JSONLD_REC_ADJUSTMENT, timestamp_mono_ns, 1, strings, lens);
+    if (!rec) {
+        return -1;
+    }
+    rec->u.adjustment.value = value;
+    rec->u.adjustment.before_offset_ns = before_offset_ns;
+    rec->u.adjustment.after_offset_ns = after_offset_ns;
+    return jsonld_commit(logger, rec);
+}
 
-    return 0;
+int swclock_jsonld_log_pi_update(
+    swclock_jsonld_logger_t* logger,
+    uint64_t timestamp_mono_ns,
+    double kp,
+    double ki,
+    double error_s,
+    double output_ppm,
+    double integral_state)
+{
+    if (!logger) {
+        return -1;
+    }
+
+    jsonld_record_t* rec = jsonld_reserve(logger, JSONLD_REC_PI_UPDATE, timestamp_mono_ns, 0, NULL, NULL);
+    if (!rec) {
+        return -1;
+    }
+    rec->u.pi.kp = kp;
+    rec->u.pi.ki = ki;
+    rec->u.pi.error_s = error_s;
+    rec->u.pi.output_ppm = output_ppm;
+    rec->u.pi.integral_state = integral_state;
+    return jsonld_commit(logger, rec);
 }
 
-static void json_escape_string(const char* src, char* dst, size_t dst_len)
+int swclock_jsonld_log_alert(
+    swclock_jsonld_logger_t* logger,
+    uint64_t timestamp_mono_ns,
+    const char* metric_name,
+    double value_ns,
+    double threshold_ns,
+    const char* severity,
+    const char* standard)
 {
-    if (!src || !dst || dst_len == 0) {
-        return;
+    if (!logger || !metric_name || !severity) {
+        return -1;
     }
 
-    size_t j = 0;
-    for (size_t i = 0; src[i] != '\0' && j < dst_len - 2; i++) {
-        switch (src[i]) {
-            case '"':
-                if (j < dst_len - 3) {
-                    dst[j++] = '\\';
-                    dst[j++] = '"';
-                }
-                break;
-            case '\\':
-                if (j < dst_len - 3) {
-                    dst[j++] = '\\';
-                    dst[j++] = '\\';
-                }
-                break;
-            case '\n':
-                if (j < dst_len - 3) {
-                    dst[j++] = '\\';
-                    dst[j++] = 'n';
-                }
-                break;
-            case '\r':
-                if (j < dst_len - 3) {
-                    dst[j++] = '\\';
-                    dst[j++] = 'r';
-                }
-                break;
-            case '\t':
-                if (j < dst_len - 3) {
-                    dst[j++] = '\\';
-                    dst[j++] = 't';
-                }
-                break;
-            default:
-                if ((unsigned char)src[i] < 32) {
-                    /* Escape control characters */
-                    if (j < dst_len - 7) {
-                        j += snprintf(&dst[j], dst_len - j, "\\u%04x", (unsigned char)src[i]);
-                    }
-                } else {
-                    dst[j++] = src[i];
-                }
-                break;
-        }
+    const char* strings[3] = { metric_name, severity, standard };
+    size_t lens[3];
+    jsonld_record_t* rec = jsonld_reserve(logger, JSONLD_REC_ALERT, timestamp_mono_ns, 3, strings, lens);
+    if (!rec) {
+        return -1;
     }
-    dst[j] = '\0';
+    rec->u.alert.value_ns = value_ns;
+    rec->u.alert.threshold_ns = threshold_ns;
+    return jsonld_commit(logger, rec);
 }
 
-static int write_jsonld_entry(swclock_jsonld_logger_t* logger, const char* entry)
+int swclock_jsonld_log_system(
+    swclock_jsonld_logger_t* logger,
+    uint64_t timestamp_mono_ns,
+    const char* event_type,
+    const char* details_json)
 {
-    if (!logger || !entry) {
+    if (!logger || !event_type) {
         return -1;
     }
 
-    size_t entry_len = strlen(entry);
-    if (entry_len == 0 || entry_len >= SWCLOCK_JSONLD_MAX_SIZE) {
+    const char* strings[2] = { event_type, details_json ? details_json : "{}" };
+    size_t lens[2];
+    jsonld_record_t* rec = jsonld_reserve(logger, JSONLD_REC_SYSTEM, timestamp_mono_ns, 2, strings, lens);
+    if (!rec) {
         return -1;
     }
+    return jsonld_commit(logger, rec);
+}
+
+int swclock_jsonld_log_metrics(
+    swclock_jsonld_logger_t* logger,
+    uint64_t timestamp_mono_ns,
+    uint32_t sample_count,
+    double window_duration_s,
+    double mean_te_ns,
+    double std_te_ns,
+    double min_te_ns,
+    double max_te_ns,
+    double p95_te_ns,
+    double p99_te_ns,
+    double mtie_1s_ns,
+    double mtie_10s_ns,
+    double mtie_30s_ns,
+    double mtie_60s_ns,
+    double tdev_0_1s_ns,
+    double tdev_1s_ns,
+    double tdev_10s_ns,
+    bool itu_g8260_pass)
+{
+    if (!logger) {
+        return -1;
+    }
+
+    jsonld_record_t* rec = jsonld_reserve(logger, JSONLD_REC_METRICS, timestamp_mono_ns, 0, NULL, NULL);
+    if (!rec) {
+        return -1;
+    }
+    const double v[14] = {
+        window_duration_s, mean_te_ns, std_te_ns, min_te_ns, max_te_ns, p95_te_ns, p99_te_ns,
+        mtie_1s_ns, mtie_10s_ns, mtie_30s_ns, mtie_60s_ns, tdev_0_1s_ns, tdev_1s_ns, tdev_10s_ns
+    };
+    rec->u.metrics.sample_count = sample_count;
+    rec->u.metrics.itu_g8260_pass = itu_g8260_pass;
+    memcpy(rec->u.metrics.v, v, sizeof(v));
+    return jsonld_commit(logger, rec);
+}
+
+int swclock_jsonld_log_test(
+    swclock_jsonld_logger_t* logger,
+    uint64_t timestamp_mono_ns,
+    const char* test_name,
+    const char* status,
+    double duration_ms,
+    const char* csv_file,
+    const char* metrics_json,
+    bool verified,
+    double max_error_percent)
+{
+    if (!logger || !test_name || !status) {
+        return -1;
+    }
+
+    const char* strings[4] = { test_name, status, csv_file, metrics_json ? metrics_json : "{}" };
+    size_t lens[4];
+    jsonld_record_t* rec = jsonld_reserve(logger, JSONLD_REC_TEST, timestamp_mono_ns, 4, strings, lens);
+    if (!rec) {
+        return -1;
+    }
+    rec->u.test.duration_ms = duration_ms;
+    rec->u.test.max_error_percent = max_error_percent;
+    rec->u.test.verified = verified;
+    return jsonld_commit(logger, rec);
+}
+
+void swclock_jsonld_get_rotation_stats(
+    swclock_jsonld_logger_t* logger,
+    swclock_jsonld_rotation_stats_t* stats)
+{
+    if (!logger || !stats) {
+        return;
+    }
+
+    pthread_mutex_lock(&logger->rot_lock);
+    *stats = logger->rot_stats;
+    stats->pending = logger->rot_count;
+    pthread_mutex_unlock(&logger->rot_lock);
+}
+
+void swclock_jsonld_get_stream_bytes(
+    swclock_jsonld_logger_t* logger,
+    uint64_t* raw_bytes,
+    uint64_t* written_bytes)
+{
+    if (!logger || !raw_bytes || !written_bytes) {
+        return;
+    }
 
     pthread_mutex_lock(&logger->lock);
+    *raw_bytes = logger->stream_raw_bytes;
+    *written_bytes = logger->stream_bytes;
+    pthread_mutex_unlock(&logger->lock);
+}
 
-    /* Check if rotation is needed */
-    if (logger->rotation.enabled && should_rotate(logger)) {
-        if (perform_rotation(logger) != 0) {
-            pthread_mutex_unlock(&logger->lock);
-            return -1;
+uint64_t swclock_jsonld_get_dropped(swclock_jsonld_logger_t* logger)
+{
+    if (!logger) {
+        return 0;
+    }
+
+    uint64_t dropped = __atomic_load_n(&logger->dropped, __ATOMIC_RELAXED);
+    for (int i = 0; i < SWCLOCK_JSONLD_THREAD_BUFFERS; i++) {
+        dropped += __atomic_load_n(&logger->tbufs[i].dropped, __ATOMIC_RELAXED);
+    }
+    return dropped;
+}
+
+/* ========================================================================
+ * Writer Thread
+ * ======================================================================== */
+
+/* Format one queued record and append it to the write buffer */
+static void render_record(swclock_jsonld_logger_t* logger, const jsonld_record_t* rec)
+{
+    const char* str[4] = { "", "", "", "" };
+    const char* p = (const char*)(rec + 1);
+    for (uint32_t i = 0; i < rec->nstrings && i < 4; i++) {
+        str[i] = p;
+        p += strlen(p) + 1;
+    }
+
+    const uint64_t ts = rec->timestamp_ns;
+    switch (rec->kind) {
+        case JSONLD_REC_SERVO:
+            render_servo(logger, ts, rec->u.servo.freq_ppm, rec->u.servo.phase_error_ns,
+                         rec->u.servo.time_error_ns, rec->u.servo.pi_freq_ppm,
+                         rec->u.servo.pi_int_error_s, rec->u.servo.servo_enabled);
+            break;
+        case JSONLD_REC_ADJUSTMENT:
+            render_adjustment(logger, ts, str[0], rec->u.adjustment.value,
+                              rec->u.adjustment.before_offset_ns, rec->u.adjustment.after_offset_ns);
+            break;
+        case JSONLD_REC_PI_UPDATE:
+            render_pi_update(logger, ts, rec->u.pi.kp, rec->u.pi.ki, rec->u.pi.error_s,
+                             rec->u.pi.output_ppm, rec->u.pi.integral_state);
+            break;
+        case JSONLD_REC_ALERT:
+            render_alert(logger, ts, str[0], rec->u.alert.value_ns, rec->u.alert.threshold_ns,
+                         str[1], str[2]);
+            break;
+        case JSONLD_REC_SYSTEM:
+            render_system(logger, ts, str[0], str[1]);
+            break;
+        case JSONLD_REC_METRICS:
+            render_metrics(logger, ts, rec->u.metrics.sample_count, rec->u.metrics.v,
+                           rec->u.metrics.itu_g8260_pass);
+            break;
+        case JSONLD_REC_TEST:
+            render_test(logger, ts, str[0], str[1], rec->u.test.duration_ms, str[2], str[3],
+                        rec->u.test.verified, rec->u.test.max_error_percent);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Absolute CLOCK_REALTIME deadline ns from now, for pthread_cond_timedwait() */
+static struct timespec jsonld_deadline(int64_t ns)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += (time_t)(ns / 1000000000LL);
+    deadline.tv_nsec += (long)(ns % 1000000000LL);
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return deadline;
+}
+
+/* One producer's pending records during a writer pass */
+typedef struct {
+    jsonld_tbuf_t* tbuf;                   /* NULL: the shared queue */
+    uint64_t pos;                          /* Thread buffer: next byte */
+    uint64_t end;                          /* Thread buffer: head when the pass began */
+    const jsonld_record_t* rec;            /* Oldest record, NULL when none */
+    size_t bytes;                          /* Its size in the buffer or queue */
+} jsonld_source_t;
+
+/* Point src->rec at the source's oldest unconsumed record */
+static void source_load(swclock_jsonld_logger_t* logger, jsonld_source_t* src)
+{
+    src->rec = NULL;
+    if (!src->tbuf) {
+        const void* data;
+        size_t size;
+        src->bytes = swclock_ringbuf_peek(logger->queue, &data, &size);
+        if (src->bytes > 0) {
+            src->rec = data;
+        }
+        return;
+    }
+
+    while (src->pos < src->end) {
+        const jsonld_tbuf_hdr_t* hdr =
+            (const jsonld_tbuf_hdr_t*)(src->tbuf->data + (src->pos & JSONLD_TBUF_MASK));
+        if (hdr->pad) {
+            src->pos += hdr->size;
+            continue;
         }
+        src->rec = (const jsonld_record_t*)(hdr + 1);
+        src->bytes = hdr->size;
+        return;
     }
+}
 
-    /* If entry won't fit in buffer, flush first */
-    if (logger->buffer_pos + entry_len > logger->buffer_size) {
-        if (flush_buffer(logger) != 0) {
+/* Hand the current record's space back to its producer, load the next */
+static void source_next(swclock_jsonld_logger_t* logger, jsonld_source_t* src)
+{
+    if (src->tbuf) {
+        src->pos += src->bytes;
+        __atomic_store_n(&src->tbuf->tail, src->pos, __ATOMIC_RELEASE);
+    } else {
+        swclock_ringbuf_release(logger->queue, src->bytes, 1);
+    }
+    source_load(logger, src);
+}
+
+/* Wait for thread-buffer producers that took their stamp before `before`
+ * to publish; they hold no lock, so this is bounded by their preemption */
+static void jsonld_wait_inflight(swclock_jsonld_logger_t* logger, uint64_t before)
+{
+    for (int i = 0; i < SWCLOCK_JSONLD_THREAD_BUFFERS; i++) {
+        jsonld_tbuf_t* tbuf = &logger->tbufs[i];
+        uint64_t stamp;
+        while ((stamp = __atomic_load_n(&tbuf->inflight_ns, __ATOMIC_ACQUIRE)) != 0 && stamp < before) {
+            sched_yield();
+        }
+    }
+}
+
+/*
+ * Format the records published by all producers, oldest order_ns first, up
+ * to horizon, a CLOCK_MONOTONIC time read before the call. Each producer's
+ * records come out in its own order. A thread-buffer record stamped but not
+ * yet published lowers the horizon below its stamp, so no later record
+ * overtakes it; shared-queue records are not tracked this way. Returns the
+ * number formatted.
+ */
+static size_t jsonld_merge(swclock_jsonld_logger_t* logger, uint64_t horizon)
+{
+    jsonld_source_t src[SWCLOCK_JSONLD_THREAD_BUFFERS + 1];
+    size_t n = 0;
+
+    /* Order the caller's clock read before the scan: a producer not seen
+       in flight here reads the clock after it and stamps past horizon.
+       Heads are read after the scan, so a record seen as no longer in
+       flight is published. */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    for (int i = 0; i < SWCLOCK_JSONLD_THREAD_BUFFERS; i++) {
+        const uint64_t stamp = __atomic_load_n(&logger->tbufs[i].inflight_ns, __ATOMIC_ACQUIRE);
+        if (stamp != 0 && stamp - 1 < horizon) {
+            horizon = stamp - 1;
+        }
+    }
+
+    for (int i = 0; i < SWCLOCK_JSONLD_THREAD_BUFFERS; i++) {
+        jsonld_tbuf_t* tbuf = &logger->tbufs[i];
+        if (__atomic_load_n(&tbuf->state, __ATOMIC_ACQUIRE) == JSONLD_TBUF_FREE) {
+            continue;
+        }
+        src[n].tbuf = tbuf;
+        src[n].pos = tbuf->tail;
+        src[n].end = __atomic_load_n(&tbuf->head, __ATOMIC_ACQUIRE);
+        source_load(logger, &src[n]);
+        if (src[n].rec) {
+            n++;
+        } else if (src[n].pos != tbuf->tail) {
+            __atomic_store_n(&tbuf->tail, src[n].pos, __ATOMIC_RELEASE);
+        }
+    }
+    src[n].tbuf = NULL;
+    source_load(logger, &src[n]);
+    if (src[n].rec) {
+        n++;
+    }
+
+    size_t records = 0;
+    while (n > 0) {
+        size_t best = n;
+        for (size_t i = 0; i < n; i++) {
+            if (src[i].rec->order_ns <= horizon &&
+                (best == n || src[i].rec->order_ns < src[best].rec->order_ns)) {
+                best = i;
+            }
+        }
+        if (best == n) {
+            break;
+        }
+        render_record(logger, src[best].rec);
+        records++;
+        source_next(logger, &src[best]);
+        if (!src[best].rec) {
+            src[best] = src[--n];
+        }
+    }
+
+    /* Buffers of exited threads go back to the pool once drained */
+    for (int i = 0; i < SWCLOCK_JSONLD_THREAD_BUFFERS; i++) {
+        jsonld_tbuf_t* tbuf = &logger->tbufs[i];
+        if (__atomic_load_n(&tbuf->state, __ATOMIC_ACQUIRE) == JSONLD_TBUF_ORPHANED &&
+            __atomic_load_n(&tbuf->head, __ATOMIC_ACQUIRE) == tbuf->tail) {
+            tbuf->head = 0;
+            tbuf->reserved = 0;
+            tbuf->tail_cache = 0;
+            tbuf->tail = 0;
+            __atomic_store_n(&tbuf->state, JSONLD_TBUF_FREE, __ATOMIC_RELEASE);
+        }
+    }
+    return records;
+}
+
+static void* jsonld_writer_main(void* arg)
+{
+    swclock_jsonld_logger_t* logger = (swclock_jsonld_logger_t*)arg;
+
+    for (;;) {
+        /* A pass for a flush, or the last one, takes everything published */
+        pthread_mutex_lock(&logger->drain_lock);
+        __atomic_store_n(&logger->wake_sent, false, __ATOMIC_RELEASE);
+        const uint64_t pass = ++logger->passes_begun;
+        const bool stopping = !__atomic_load_n(&logger->writer_running, __ATOMIC_ACQUIRE);
+        const bool drain = logger->drain_requested || stopping;
+        logger->drain_requested = false;
+        pthread_mutex_unlock(&logger->drain_lock);
+
+        /* Records stamped after the pass began wait for the next one; a
+           flush first lets producers already past their stamp publish */
+        const uint64_t horizon = stopping ? UINT64_MAX : jsonld_mono_ns();
+        if (drain) {
+            jsonld_wait_inflight(logger, horizon);
+        }
+        size_t records = jsonld_merge(logger, horizon);
+
+        /* Entries are written every 100 (see jsonld_entry_end()), or after
+           a period in which nothing was logged */
+        if (records == 0) {
+            pthread_mutex_lock(&logger->lock);
+            flush_buffer(logger);
             pthread_mutex_unlock(&logger->lock);
-            return -1;
         }
+
+        pthread_mutex_lock(&logger->drain_lock);
+        logger->passes_done = pass;
+        pthread_cond_broadcast(&logger->drain_cv);
+        if (stopping) {
+            pthread_mutex_unlock(&logger->drain_lock);
+            break;
+        }
+        /* A producer that rang during the pass found the writer awake */
+        if (!logger->drain_requested && !__atomic_load_n(&logger->wake_sent, __ATOMIC_ACQUIRE) &&
+            __atomic_load_n(&logger->writer_running, __ATOMIC_ACQUIRE)) {
+            struct timespec deadline = jsonld_deadline(JSONLD_WRITER_PERIOD_NS);
+            pthread_cond_timedwait(&logger->writer_cv, &logger->drain_lock, &deadline);
+        }
+        pthread_mutex_unlock(&logger->drain_lock);
     }
+    return NULL;
+}
 
-    /* Add to buffer */
-    memcpy(logger->buffer + logger->buffer_pos, entry, entry_len);
-    logger->buffer_pos += entry_len;
-    logger->entry_count++;
+/* Wait until the writer has formatted every record published before the
+ * call: a pass that begins after this request takes all of them */
+static int jsonld_drain(swclock_jsonld_logger_t* logger)
+{
+    pthread_mutex_lock(&logger->drain_lock);
+    const uint64_t target = logger->passes_begun + 1;
+    while (logger->passes_done < target) {
+        logger->drain_requested = true;
+        pthread_cond_signal(&logger->writer_cv);
+        struct timespec deadline = jsonld_deadline(10000000LL);
+        pthread_cond_timedwait(&logger->drain_cv, &logger->drain_lock, &deadline);
+    }
+    pthread_mutex_unlock(&logger->drain_lock);
+    return 0;
+}
 
-    /* Flush if buffer is getting full (>90%) or every 100 entries */
-    if (logger->buffer_pos > (logger->buffer_size * 9 / 10) ||
-        (logger->entry_count % 100) == 0) {
-        flush_buffer(logger);
+/* ========================================================================
+ * Management Functions
+ * ======================================================================== */
+
+int swclock_jsonld_rotate(swclock_jsonld_logger_t* logger)
+{
+    if (!logger) {
+        return -1;
+    }
+
+    jsonld_drain(logger);
+    pthread_mutex_lock(&logger->lock);
+    int ret = perform_rotation(logger);
+    pthread_mutex_unlock(&logger->lock);
+
+    return ret;
+}
+
+size_t swclock_jsonld_get_size(swclock_jsonld_logger_t* logger)
+{
+    if (!logger) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&logger->lock);
+    size_t size = logger->current_size + logger->buffer_pos;
+    pthread_mutex_unlock(&logger->lock);
+
+    return size;
+}
+
+uint64_t swclock_jsonld_get_count(swclock_jsonld_logger_t* logger)
+{
+    if (!logger) {
+        return 0;
     }
 
+    pthread_mutex_lock(&logger->lock);
+    uint64_t count = logger->entry_count;
     pthread_mutex_unlock(&logger->lock);
+
+    return count;
+}
+
+/* ========================================================================
+ * Helper Functions
+ * ======================================================================== */
+
+static int detect_system_context(swclock_system_context_t* ctx)
+{
+    if (!ctx) {
+        return -1;
+    }
+
+    /* Get hostname */
+    if (gethostname(ctx->hostname, sizeof(ctx->hostname)) != 0) {
+        strncpy(ctx->hostname, "unknown", sizeof(ctx->hostname) - 1);
+    }
+
+    /* Get OS and kernel info */
+    struct utsname uts;
+    if (uname(&uts) == 0) {
+        strncpy(ctx->os, uts.sysname, sizeof(ctx->os) - 1);
+        strncpy(ctx->kernel, uts.release, sizeof(ctx->kernel) - 1);
+        strncpy(ctx->arch, uts.machine, sizeof(ctx->arch) - 1);
+    } else {
+        strncpy(ctx->os, "unknown", sizeof(ctx->os) - 1);
+        strncpy(ctx->kernel, "unknown", sizeof(ctx->kernel) - 1);
+        strncpy(ctx->arch, "unknown", sizeof(ctx->arch) - 1);
+    }
+
+    /* SwClock version - this should ideally come from a build-time constant */
+    strncpy(ctx->swclock_version, SWCLOCK_SIF_VERSION, sizeof(ctx->swclock_version) - 1);
+
+    return 0;
+}
+
+/* Deflate the buffer into one gzip frame, write it and index it */
+static int flush_frame(swclock_jsonld_logger_t* logger)
+{
+    z_stream* zs = logger->zs;
+    deflateReset(zs);
+    zs->next_in = (Bytef*)logger->buffer;
+    zs->avail_in = (uInt)logger->buffer_pos;
+    zs->next_out = logger->zbuf;
+    zs->avail_out = (uInt)logger->zbuf_size;
+    if (deflate(zs, Z_FINISH) != Z_STREAM_END) {
+        SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to compress frame");
+        return -1;
+    }
+    const size_t frame_size = logger->zbuf_size - zs->avail_out;
+
+    size_t written = fwrite(logger->zbuf, 1, frame_size, logger->fp);
+    if (written != frame_size) {
+        SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to write frame: %s", strerror(errno));
+        return -1;
+    }
+    fflush(logger->fp);
+
+    /* Indexed only once the frame is in the file */
+    if (logger->index_fp) {
+        swclock_jsonld_index_entry_t entry = {
+            .timestamp_ns = logger->frame_first_ts,
+            .offset = logger->current_size,
+            .size = (uint32_t)frame_size,
+            .raw_size = (uint32_t)logger->buffer_pos,
+            .entries = logger->frame_entries,
+            .reserved = 0
+        };
+        fwrite(&entry, sizeof(entry), 1, logger->index_fp);
+        fflush(logger->index_fp);
+    }
+
+    logger->stream_raw_bytes += logger->buffer_pos;
+    logger->stream_bytes += frame_size;
+    logger->current_size += frame_size;
+    logger->buffer_pos = 0;
+    logger->frame_entries = 0;
     return 0;
 }
 
@@ -778,6 +1883,10 @@ static int flush_buffer(swclock_jsonld_logger_t* logger)
         return 0;
     }
 
+    if (logger->zs) {
+        return flush_frame(logger);
+    }
+
     size_t written = fwrite(logger->buffer, 1, logger->buffer_pos, logger->fp);
     if (written != logger->buffer_pos) {
         SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to write buffer: %s", strerror(errno));
@@ -787,6 +1896,7 @@ static int flush_buffer(swclock_jsonld_logger_t* logger)
     /* Update file size */
     logger->current_size += logger->buffer_pos;
     logger->buffer_pos = 0;
+    logger->frame_entries = 0;
 
     /* Sync to OS buffers (fsync removed to avoid blocking while holding locks) */
     fflush(logger->fp);
@@ -794,6 +1904,117 @@ static int flush_buffer(swclock_jsonld_logger_t* logger)
     return 0;
 }
 
+/* A crash can leave a partly written frame at the end of the log and a
+   partly written entry at the end of the index. Cut both back to the last
+   indexed frame that is wholly in the log, so appended frames follow a
+   complete gzip member. Without a valid index the log is left alone. */
+static void stream_truncate_tail(const char* log_path, const char* index_path)
+{
+    int ifd = open(index_path, O_RDWR | O_CLOEXEC);
+    if (ifd < 0) {
+        return;
+    }
+
+    swclock_jsonld_index_header_t header;
+    struct stat ist, lst;
+    if (fstat(ifd, &ist) != 0 || stat(log_path, &lst) != 0 ||
+        pread(ifd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        header.magic != SWCLOCK_JSONLD_INDEX_MAGIC ||
+        header.entry_size != sizeof(swclock_jsonld_index_entry_t)) {
+        close(ifd);
+        return;
+    }
+
+    /* Entries whose frame is not in the log were indexed after a write
+       that did not reach the disk */
+    uint64_t count = ((uint64_t)ist.st_size - sizeof(header)) / sizeof(swclock_jsonld_index_entry_t);
+    uint64_t end = 0;
+    while (count > 0) {
+        swclock_jsonld_index_entry_t entry;
+        off_t at = (off_t)(sizeof(header) + (count - 1) * sizeof(entry));
+        if (pread(ifd, &entry, sizeof(entry), at) != (ssize_t)sizeof(entry)) {
+            close(ifd);
+            return;
+        }
+        if (entry.offset + entry.size <= (uint64_t)lst.st_size) {
+            end = entry.offset + entry.size;
+            break;
+        }
+        count--;
+    }
+
+    off_t index_size = (off_t)(sizeof(header) + count * sizeof(swclock_jsonld_index_entry_t));
+    if (ist.st_size > index_size && ftruncate(ifd, index_size) != 0) {
+        SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to truncate %s: %s", index_path, strerror(errno));
+    }
+    close(ifd);
+
+    if ((uint64_t)lst.st_size > end && truncate(log_path, (off_t)end) != 0) {
+        SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to truncate %s: %s", log_path, strerror(errno));
+    }
+}
+
+/* Open the log (append) and, when streaming, its frame index */
+static int open_log_files(swclock_jsonld_logger_t* logger)
+{
+    char index_path[620];
+    snprintf(index_path, sizeof(index_path), "%s%s", logger->log_path, SWCLOCK_JSONLD_INDEX_SUFFIX);
+    if (logger->zs) {
+        stream_truncate_tail(logger->log_path, index_path);
+    }
+
+    logger->fp = fopen(logger->log_path, "a");
+    if (!logger->fp) {
+        return -1;
+    }
+
+    /* Get current file size */
+    struct stat st;
+    if (fstat(fileno(logger->fp), &st) == 0) {
+        logger->current_size = st.st_size;
+    }
+
+    if (logger->zs) {
+        logger->index_fp = fopen(index_path, "a");
+        if (!logger->index_fp) {
+            SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to open %s: %s", index_path, strerror(errno));
+        } else if (fstat(fileno(logger->index_fp), &st) == 0 && st.st_size == 0) {
+            swclock_jsonld_index_header_t header = {
+                .magic = SWCLOCK_JSONLD_INDEX_MAGIC,
+                .version = 1,
+                .entry_size = sizeof(swclock_jsonld_index_entry_t),
+                .reserved = 0
+            };
+            fwrite(&header, sizeof(header), 1, logger->index_fp);
+            fflush(logger->index_fp);
+        }
+    }
+    return 0;
+}
+
+static void close_log_files(swclock_jsonld_logger_t* logger)
+{
+    if (logger->fp) {
+        fclose(logger->fp);
+        logger->fp = NULL;
+    }
+    if (logger->index_fp) {
+        fclose(logger->index_fp);
+        logger->index_fp = NULL;
+    }
+}
+
+static void stream_free(swclock_jsonld_logger_t* logger)
+{
+    if (logger->zs) {
+        deflateEnd(logger->zs);
+        free(logger->zs);
+        logger->zs = NULL;
+    }
+    free(logger->zbuf);
+    logger->zbuf = NULL;
+}
+
 static int should_rotate(swclock_jsonld_logger_t* logger)
 {
     if (!logger || !logger->rotation.enabled) {
@@ -821,72 +2042,213 @@ static int should_rotate(swclock_jsonld_logger_t* logger)
     return 0;
 }
 
+static uint64_t jsonld_mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Swap the log file (writer thread, logger->lock held): close it, rename it
+ * once to a staging name, reopen the log path and hand the staged file to
+ * the rotation worker. No file is copied, compressed or shifted here.
+ */
 static int perform_rotation(swclock_jsonld_logger_t* logger)
 {
     if (!logger) {
         return -1;
     }
+    const uint64_t t0 = jsonld_mono_ns();
+
+    /* Bounded queue: with the worker this far behind, keep the current file */
+    pthread_mutex_lock(&logger->rot_lock);
+    if (logger->rot_count >= SWCLOCK_JSONLD_ROTATE_QUEUE) {
+        logger->rot_stats.deferred++;
+        pthread_mutex_unlock(&logger->rot_lock);
+        errno = EBUSY;
+        return -1;
+    }
+    uint64_t seq = logger->rot_seq++;
+    pthread_mutex_unlock(&logger->rot_lock);
 
     /* Flush and close current file */
     flush_buffer(logger);
-    if (logger->fp) {
-        fclose(logger->fp);
-        logger->fp = NULL;
+    close_log_files(logger);
+
+    char staged[600];
+    snprintf(staged, sizeof(staged), "%s.rotating-%llu", logger->log_path, (unsigned long long)seq);
+    bool have_staged = rename(logger->log_path, staged) == 0;
+    if (!have_staged) {
+        SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to rotate log file: %s", strerror(errno));
+        /* Try to continue by opening new file anyway */
+    } else if (logger->zs) {
+        char index_path[620], staged_index[620];
+        snprintf(index_path, sizeof(index_path), "%s%s", logger->log_path, SWCLOCK_JSONLD_INDEX_SUFFIX);
+        snprintf(staged_index, sizeof(staged_index), "%s%s", staged, SWCLOCK_JSONLD_INDEX_SUFFIX);
+        rename(index_path, staged_index);
     }
 
-    /* Rotate existing files: .1 -> .2, .2 -> .3, etc. */
-    for (int i = logger->rotation.max_files - 1; i >= 1; i--) {
-        char old_path[600], new_path[600];
-        snprintf(old_path, sizeof(old_path), "%s.%d", logger->log_path, i);
-        snprintf(new_path, sizeof(new_path), "%s.%d", logger->log_path, i + 1);
+    /* Reset counters */
+    logger->created_at = time(NULL);
+    logger->current_size = 0;
+
+    /* Open new log file */
+    if (open_log_files(logger) != 0) {
+        SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to open new log file: %s", strerror(errno));
+    }
 
-        /* Check if old file exists */
-        if (access(old_path, F_OK) == 0) {
-            if (i >= logger->rotation.max_files - 1) {
-                /* Delete oldest file */
-                unlink(old_path);
-            } else {
-                /* Rename to next number */
-                rename(old_path, new_path);
+    pthread_mutex_lock(&logger->rot_lock);
+    if (have_staged) {
+        unsigned tail = (logger->rot_head + logger->rot_count) % SWCLOCK_JSONLD_ROTATE_QUEUE;
+        snprintf(logger->rot_jobs[tail], sizeof(logger->rot_jobs[tail]), "%s", staged);
+        logger->rot_count++;
+        if (!logger->rotator_started) {
+            logger->rotator_started =
+                pthread_create(&logger->rotator, NULL, jsonld_rotator_main, logger) == 0;
+            if (!logger->rotator_started) {
+                SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to start rotation worker");
             }
         }
+        pthread_cond_signal(&logger->rot_cv);
     }
+    logger->rot_stats.rotations++;
+    swclock_histogram_record(&logger->rot_stats.swap_latency, (int64_t)(jsonld_mono_ns() - t0));
+    pthread_mutex_unlock(&logger->rot_lock);
 
-    /* Rename current log to .1 */
-    char rotated_path[600];
-    snprintf(rotated_path, sizeof(rotated_path), "%s.1", logger->log_path);
-    if (rename(logger->log_path, rotated_path) != 0) {
-        SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to rotate log file: %s", strerror(errno));
-        /* Try to continue by opening new file anyway */
+    return logger->fp ? 0 : -1;
+}
+
+/* Files of one rotated log: the log, compressed or not, and a frame index */
+static const char* const rotated_suffixes[] = { "", ".gz", SWCLOCK_JSONLD_INDEX_SUFFIX };
+#define ROTATED_SUFFIXES (sizeof(rotated_suffixes) / sizeof(rotated_suffixes[0]))
+
+/* "<log>.<index><suffix>" */
+static void rotated_path(const char* log_path, int index, const char* suffix, char* buf, size_t len)
+{
+    snprintf(buf, len, "%s.%d%s", log_path, index, suffix);
+}
+
+static bool rotated_exists(const char* log_path, int index)
+{
+    char path[620];
+    for (size_t k = 0; k < ROTATED_SUFFIXES; k++) {
+        rotated_path(log_path, index, rotated_suffixes[k], path, sizeof(path));
+        if (access(path, F_OK) == 0) {
+            return true;
+        }
     }
+    return false;
+}
+
+/*
+ * One rotation (worker thread): shift .1..N to .2..N+1, drop what falls
+ * beyond max_files (which counts the live file), move the staged file (and
+ * its frame index) to .1 and compress it unless it was written compressed.
+ * Returns 0, or -1 if a step failed.
+ */
+static int rotate_job(swclock_jsonld_logger_t* logger, const char* staged,
+                      uint64_t* bytes_in, uint64_t* bytes_out)
+{
+    const swclock_log_rotation_t* r = &logger->rotation;
+    const char* log_path = logger->log_path;
+    int ret = 0;
 
-    /* Compress rotated file if enabled */
-    if (logger->rotation.compress) {
-        compress_file(rotated_path);
+    int last = 0;
+    while (rotated_exists(log_path, last + 1)) {
+        last++;
+    }
+    for (int i = last; i >= 1; i--) {
+        for (size_t k = 0; k < ROTATED_SUFFIXES; k++) {
+            char old_path[620], new_path[620];
+            rotated_path(log_path, i, rotated_suffixes[k], old_path, sizeof(old_path));
+            if (access(old_path, F_OK) != 0) {
+                continue;
+            }
+            if (r->max_files > 0 && i + 1 >= r->max_files) {
+                unlink(old_path);
+            } else {
+                rotated_path(log_path, i + 1, rotated_suffixes[k], new_path, sizeof(new_path));
+                if (rename(old_path, new_path) != 0) {
+                    ret = -1;
+                }
+            }
+        }
     }
 
-    /* Open new log file */
-    logger->fp = fopen(logger->log_path, "a");
-    if (!logger->fp) {
-        SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to open new log file: %s", strerror(errno));
+    char first[620], staged_index[620], first_index[620];
+    rotated_path(log_path, 1, "", first, sizeof(first));
+    rotated_path(log_path, 1, SWCLOCK_JSONLD_INDEX_SUFFIX, first_index, sizeof(first_index));
+    snprintf(staged_index, sizeof(staged_index), "%s%s", staged, SWCLOCK_JSONLD_INDEX_SUFFIX);
+    if (r->max_files == 1) {
+        /* Only the live file is kept */
+        unlink(staged);
+        unlink(staged_index);
+        return ret;
+    }
+    if (rename(staged, first) != 0) {
+        SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to rename %s: %s", staged, strerror(errno));
         return -1;
     }
+    if (r->stream_compress) {
+        rename(staged_index, first_index);
+    } else if (r->compress && compress_file(first, r->compress_level, bytes_in, bytes_out) != 0) {
+        SWCLOCK_JSONLD_ERROR("swclock_jsonld: Failed to compress %s", first);
+        ret = -1;
+    }
+    return ret;
+}
 
-    /* Reset counters */
-    logger->created_at = time(NULL);
-    logger->current_size = 0;
+static void* jsonld_rotator_main(void* arg)
+{
+    swclock_jsonld_logger_t* logger = (swclock_jsonld_logger_t*)arg;
 
-    return 0;
+    pthread_mutex_lock(&logger->rot_lock);
+    for (;;) {
+        while (logger->rot_count == 0 && !logger->rotator_stop) {
+            pthread_cond_wait(&logger->rot_cv, &logger->rot_lock);
+        }
+        if (logger->rot_count == 0) {
+            break;
+        }
+
+        /* The job stays queued (and counted) until done */
+        char staged[600];
+        memcpy(staged, logger->rot_jobs[logger->rot_head], sizeof(staged));
+        pthread_mutex_unlock(&logger->rot_lock);
+
+        const uint64_t t0 = jsonld_mono_ns();
+        uint64_t bytes_in = 0, bytes_out = 0;
+        int ret = rotate_job(logger, staged, &bytes_in, &bytes_out);
+        const uint64_t elapsed = jsonld_mono_ns() - t0;
+
+        pthread_mutex_lock(&logger->rot_lock);
+        logger->rot_head = (logger->rot_head + 1) % SWCLOCK_JSONLD_ROTATE_QUEUE;
+        logger->rot_count--;
+        if (ret != 0) {
+            logger->rot_stats.failures++;
+        }
+        if (bytes_in > 0) {
+            logger->rot_stats.compressed++;
+            logger->rot_stats.bytes_in += bytes_in;
+            logger->rot_stats.bytes_out += bytes_out;
+        }
+        swclock_histogram_record(&logger->rot_stats.job_latency, (int64_t)elapsed);
+    }
+    pthread_mutex_unlock(&logger->rot_lock);
+    return NULL;
 }
 
-static int compress_file(const char* src_path)
+/* gzip src_path to src_path.gz (via a temporary name), then delete it */
+static int compress_file(const char* src_path, int level, uint64_t* bytes_in, uint64_t* bytes_out)
 {
     if (!src_path) {
         return -1;
     }
 
-    char dst_path[600];
+    char dst_path[640], tmp_path[660];
     snprintf(dst_path, sizeof(dst_path), "%s.gz", src_path);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", dst_path);
 
     /* Open source file */
     FILE* src = fopen(src_path, "rb");
@@ -895,26 +2257,45 @@ static int compress_file(const char* src_path)
     }
 
     /* Open gzip destination */
-    gzFile dst = gzopen(dst_path, "wb9"); /* Best compression */
+    char mode[8];
+    snprintf(mode, sizeof(mode), "wb%d", (level >= 1 && level <= 9) ? level : SWCLOCK_JSONLD_COMPRESS_LEVEL);
+    gzFile dst = gzopen(tmp_path, mode);
     if (!dst) {
         fclose(src);
         return -1;
     }
 
     /* Compress in chunks */
-    char buf[8192];
+    static const size_t chunk = 65536;
+    char* buf = malloc(chunk);
+    if (!buf) {
+        fclose(src);
+        gzclose(dst);
+        unlink(tmp_path);
+        return -1;
+    }
+    uint64_t total = 0;
     size_t nread;
-    while ((nread = fread(buf, 1, sizeof(buf), src)) > 0) {
-        if (gzwrite(dst, buf, nread) != (int)nread) {
+    while ((nread = fread(buf, 1, chunk, src)) > 0) {
+        if (gzwrite(dst, buf, (unsigned)nread) != (int)nread) {
+            free(buf);
             fclose(src);
             gzclose(dst);
-            unlink(dst_path);
+            unlink(tmp_path);
             return -1;
         }
+        total += nread;
     }
-
+    free(buf);
     fclose(src);
-    gzclose(dst);
+    if (gzclose(dst) != Z_OK || rename(tmp_path, dst_path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+
+    struct stat st;
+    *bytes_in = total;
+    *bytes_out = stat(dst_path, &st) == 0 ? (uint64_t)st.st_size : 0;
 
     /* Delete original file */
     unlink(src_path);
@@ -6,8 +6,16 @@
  * - JSON-LD format with semantic web compatibility
  * - IEEE 1588 and ITU-T standards compliance
  * - Schema versioning (semantic versioning)
+ * - Non-blocking logging: each swclock_jsonld_log_* call copies its
+ *   arguments as a binary record into the calling thread's own append
+ *   buffer (nothing shared is written); a writer thread merges the
+ *   buffers in call order, formats, buffers, rotates and compresses (see
+ *   swclock_jsonld_flush())
  * - Thread-safe buffered I/O
- * - Log rotation and compression
+ * - Log rotation and compression: the writer thread only swaps the file
+ *   handle; a rotation worker renames, compresses and prunes
+ * - Optional streaming compression: the log itself is written as gzip
+ *   frames, one per buffer flush, with a sidecar frame index
  * - Multi-vendor interoperability
  * 
  * @author SwClock Development Team
@@ -21,6 +29,7 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <time.h>
+#include "sw_clock_histogram.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,6 +50,26 @@ extern "C" {
  */
 #define SWCLOCK_JSONLD_BUFFER_SIZE (1024 * 1024)
 
+/**
+ * @brief Threads per logger with their own append buffer; later ones share one queue
+ */
+#define SWCLOCK_JSONLD_THREAD_BUFFERS 64
+
+/**
+ * @brief Size of each thread's append buffer (power of two)
+ */
+#define SWCLOCK_JSONLD_THREAD_BUFFER_SIZE (256 * 1024)
+
+/**
+ * @brief Rotations waiting for the rotation worker before further ones are deferred
+ */
+#define SWCLOCK_JSONLD_ROTATE_QUEUE 4
+
+/**
+ * @brief gzip level of rotated logs when swclock_log_rotation_t.compress_level is 0
+ */
+#define SWCLOCK_JSONLD_COMPRESS_LEVEL 6
+
 /**
  * @brief JSON-LD logger context
  */
@@ -55,8 +84,50 @@ typedef struct {
     int max_age_hours;          // Rotate after this time (0 = disabled)
     int max_files;              // Keep this many rotated logs (0 = unlimited)
     bool compress;              // gzip compress rotated logs
+    int compress_level;         // gzip level 1-9 (0 = SWCLOCK_JSONLD_COMPRESS_LEVEL)
+    bool stream_compress;       // Write the log as gzip frames (name it *.gz); rotated logs stay as is
 } swclock_log_rotation_t;
 
+/**
+ * @brief Streaming compression: frame index
+ *
+ * With stream_compress each buffer flush is written as one complete gzip
+ * member holding whole entries, so the file is an ordinary multi-member
+ * gzip file (zcat reads it) and a crash loses at most the frame being
+ * written. Every frame is also recorded in "<log>.idx"; a tool can seek to
+ * any frame's offset and inflate from there. When the log is reopened,
+ * it and its index are cut back to the end of the last indexed frame, so
+ * frames appended after a crash never follow a partly written one.
+ */
+#define SWCLOCK_JSONLD_INDEX_MAGIC 0x584a5753  /* "SWJX" in ASCII */
+
+/**
+ * @brief Frame index file name suffix, appended to the log file name
+ */
+#define SWCLOCK_JSONLD_INDEX_SUFFIX ".idx"
+
+/**
+ * @brief Frame index file header
+ */
+typedef struct __attribute__((packed)) {
+    uint32_t magic;             /**< SWCLOCK_JSONLD_INDEX_MAGIC */
+    uint16_t version;           /**< Index format version (1) */
+    uint16_t entry_size;        /**< sizeof(swclock_jsonld_index_entry_t) */
+    uint64_t reserved;          /**< Reserved for future use */
+} swclock_jsonld_index_header_t;
+
+/**
+ * @brief One gzip frame
+ */
+typedef struct __attribute__((packed)) {
+    uint64_t timestamp_ns;      /**< timestamp_monotonic_ns of the frame's first entry */
+    uint64_t offset;            /**< File offset of the frame */
+    uint32_t size;              /**< Compressed size */
+    uint32_t raw_size;          /**< Uncompressed size (whole entries) */
+    uint32_t entries;           /**< Entries in the frame */
+    uint32_t reserved;
+} swclock_jsonld_index_entry_t;
+
 /**
  * @brief System context for log entries
  */
@@ -90,6 +161,9 @@ void swclock_jsonld_close(swclock_jsonld_logger_t* logger);
 
 /**
  * @brief Flush buffered entries to disk
+ *
+ * Waits until the writer thread has formatted every entry logged before
+ * the call, then writes them out.
  * @param logger Logger handle
  * @return 0 on success, -1 on error
  */
@@ -214,9 +288,12 @@ int swclock_jsonld_log_test(
 /**
  * @brief Rotate log file manually
  * 
- * Renames current log to .1, compresses if configured
+ * Renames current log to .1, compresses if configured. Waits for queued
+ * entries to be written; the rename chain, compression and pruning of old
+ * logs finish in the background.
  * @param logger Logger handle
- * @return 0 on success, -1 on error
+ * @return 0 on success, -1 on error (EBUSY: SWCLOCK_JSONLD_ROTATE_QUEUE
+ *         rotations already pending)
  */
 int swclock_jsonld_rotate(swclock_jsonld_logger_t* logger);
 
@@ -234,6 +311,52 @@ size_t swclock_jsonld_get_size(swclock_jsonld_logger_t* logger);
  */
 uint64_t swclock_jsonld_get_count(swclock_jsonld_logger_t* logger);
 
+/**
+ * @brief Get number of entries dropped because the queue was full
+ *
+ * The swclock_jsonld_log_* functions never wait; when the writer falls
+ * behind by a whole append buffer (SWCLOCK_JSONLD_THREAD_BUFFER_SIZE of
+ * the calling thread's records) they return -1 instead.
+ * @param logger Logger handle
+ * @return Dropped entry count
+ */
+uint64_t swclock_jsonld_get_dropped(swclock_jsonld_logger_t* logger);
+
+/**
+ * @brief Get streaming compression volume (stream_compress only)
+ * @param logger Logger handle
+ * @param raw_bytes Output: entry bytes compressed
+ * @param written_bytes Output: gzip frame bytes written
+ */
+void swclock_jsonld_get_stream_bytes(
+    swclock_jsonld_logger_t* logger,
+    uint64_t* raw_bytes,
+    uint64_t* written_bytes);
+
+/**
+ * @brief Rotation counters and latencies
+ */
+typedef struct {
+    uint64_t rotations;                 /**< File swaps */
+    uint64_t deferred;                  /**< Rotations postponed: worker queue full */
+    uint64_t compressed;                /**< Rotated logs compressed */
+    uint64_t failures;                  /**< Worker jobs with a failed rename or compression */
+    uint64_t pending;                   /**< Jobs queued or in progress */
+    uint64_t bytes_in;                  /**< Bytes compressed */
+    uint64_t bytes_out;                 /**< Compressed bytes written */
+    swclock_histogram_t swap_latency;   /**< File swap on the writer thread */
+    swclock_histogram_t job_latency;    /**< Rename chain, compression and pruning */
+} swclock_jsonld_rotation_stats_t;
+
+/**
+ * @brief Get rotation counters and latencies
+ * @param logger Logger handle
+ * @param stats Output
+ */
+void swclock_jsonld_get_rotation_stats(
+    swclock_jsonld_logger_t* logger,
+    swclock_jsonld_rotation_stats_t* stats);
+
 #ifdef __cplusplus
 }
 #endif